@@ -25,4 +25,13 @@
 		}                                                                     \
 /**/
 
+	/**
+	 * @brief Add a value to a named counter.
+	 *
+	 * @see @a Performance::count().
+	 */
+# define CUBE_DEBUG_COUNTER(name, value)                                      \
+	::cube::debug::Performance::instance().count(name, value)                 \
+/**/
+
 #endif
@@ -15,6 +15,7 @@
 #include <cstring>
 #include <iomanip>
 #include <list>
+#include <mutex>
 #include <numeric>
 #include <stack>
 #include <thread>
@@ -97,6 +98,9 @@ namespace cube { namespace debug {
 		ThreadStackMap                                 stacks;
 		RootSet                                        roots;
 
+		mutable std::mutex                             counters_mutex;
+		counter_map_type                               counters;
+
 		boost::asio::io_service                        service;
 		std::unique_ptr<boost::asio::io_service::work> work;
 		std::thread                                    worker_thread;
@@ -107,6 +111,8 @@ namespace cube { namespace debug {
 			, timers{}
 			, stacks{}
 			, roots{}
+			, counters_mutex{}
+			, counters{}
 			, service{}
 			, work{new boost::asio::io_service::work{service}}
 			, worker_thread{
@@ -212,6 +218,52 @@ namespace cube { namespace debug {
 		}
 	}
 
+	void
+	Performance::count(std::string const& name, int64_t const value) ETC_NOEXCEPT
+	{
+		try {
+			std::lock_guard<std::mutex> guard(_this->counters_mutex);
+			_this->counters[name] += value;
+		} catch (...) {
+			ETC_LOG.warn("Couldn't update counter", name);
+		}
+	}
+
+	void
+	Performance::gauge(std::string const& name, int64_t const value) ETC_NOEXCEPT
+	{
+		try {
+			std::lock_guard<std::mutex> guard(_this->counters_mutex);
+			_this->counters[name] = value;
+		} catch (...) {
+			ETC_LOG.warn("Couldn't update counter", name);
+		}
+	}
+
+	int64_t
+	Performance::counter(std::string const& name) const
+	{
+		std::lock_guard<std::mutex> guard(_this->counters_mutex);
+		auto it = _this->counters.find(name);
+		if (it == _this->counters.end())
+			return 0;
+		return it->second;
+	}
+
+	Performance::counter_map_type
+	Performance::counters() const
+	{
+		std::lock_guard<std::mutex> guard(_this->counters_mutex);
+		return _this->counters;
+	}
+
+	void
+	Performance::reset_counters()
+	{
+		std::lock_guard<std::mutex> guard(_this->counters_mutex);
+		_this->counters.clear();
+	}
+
 	void
 	Performance::shutdown()
 	{
@@ -234,6 +286,14 @@ namespace cube { namespace debug {
 		}
 
 		this->dump_set(_this->roots, max_name_len, 0);
+
+		auto counters = this->counters();
+		if (counters.empty())
+			return;
+		etc::print("Counters:");
+		for (auto const& pair: counters)
+			std::cout << "    ---[ " << pair.first << " ] " << pair.second
+			          << std::endl;
 	}
 
 	void
@@ -8,6 +8,8 @@
 # include <etc/compiler.hpp>
 
 # include <cassert>
+# include <cstdint>
+# include <map>
 # include <memory>
 # include <string>
 # include <unordered_set>
@@ -17,6 +19,9 @@ namespace cube { namespace debug {
 	/**
 	 * The performance class stores performance statistics over time. You must
 	 * use the Section class in order to insert new values.
+	 *
+	 * It also holds named counters, for statistics that are not durations
+	 * (like the number of drawn objects).
 	 */
 	class CUBE_API Performance
 	{
@@ -32,6 +37,23 @@ namespace cube { namespace debug {
 		static
 		Performance& instance();
 
+	public:
+		typedef std::map<std::string, int64_t> counter_map_type;
+
+		/// Add @a value to a counter.
+		void count(std::string const& name, int64_t const value = 1) ETC_NOEXCEPT;
+
+		/// Set the value of a counter.
+		void gauge(std::string const& name, int64_t const value) ETC_NOEXCEPT;
+
+		/// Value of a counter, 0 if it was never set.
+		int64_t counter(std::string const& name) const;
+
+		/// Snapshot of all counters.
+		counter_map_type counters() const;
+
+		void reset_counters();
+
 	public:
 		void shutdown();
 		void dump();
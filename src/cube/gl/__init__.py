@@ -7,6 +7,7 @@ Exported modules:
     matrix
     font
     frustum
+    occlusion
 
 Exported classes:
 
@@ -24,7 +25,7 @@ Exported classes:
     ShaderProgram, ShaderProgramParameter
     Sphere{f,d,i,u,il,ul}
     Surface
-    Text
+    Text, TextBatch
     Vector{2,3,4}{f,d,i,u,il,ul} (and aliases vec*)
     Viewport
 
@@ -47,7 +48,8 @@ Exported enumerations:
     TextureMapMode (wrap, clamp, decal, mirror)
     BlendMode (basic, additive)
     TextureType (diffuse, specular, ambient, emissive, height, normals,
-                 shininess, opacity, displacement, lightmap, reflection)
+                 shininess, opacity, displacement, lightmap, reflection,
+                 distance_field)
 
     LightKind (point, spot, directional)
 """
@@ -57,6 +59,7 @@ from .renderer.Bindable import Bindable # Required by camera
 from . import font
 from . import frustum
 from . import matrix
+from . import occlusion
 
 from .camera import Camera
 from .color import Color3f, Color4f
@@ -70,7 +73,7 @@ from .plane import Planef, Planed
 from .rectangle import Rectanglef, Rectangleu, Rectanglei
 from .sphere import Spheref, Sphered, Spherei, Sphereu, Sphereil, Sphereul
 from .surface import Surface
-from .text import Text
+from .text import Text, TextBatch
 from .vector import Vector2f, Vector2d, Vector2i, Vector2u, Vector2il, Vector2ul
 from .vector import Vector3f, Vector3d, Vector3i, Vector3u, Vector3il, Vector3ul
 from .vector import Vector4f, Vector4d, Vector4i, Vector4u, Vector4il, Vector4ul
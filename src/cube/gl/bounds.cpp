@@ -0,0 +1,88 @@
+#include "bounds.hpp"
+
+#include <etc/test.hpp>
+
+#include <iostream>
+
+namespace cube { namespace gl { namespace bounds {
+
+	template<typename T>
+	std::ostream& operator <<(std::ostream& out, AABB<T> const& box)
+	{
+		if (box.empty())
+			return out << "AABB(empty)";
+		if (box.is_infinite())
+			return out << "AABB(infinite)";
+		return out << "AABB(" << box.min << ", " << box.max << ")";
+	}
+
+	template CUBE_API
+	std::ostream& operator <<<float>(std::ostream&, AABB<float> const&);
+	template CUBE_API
+	std::ostream& operator <<<double>(std::ostream&, AABB<double> const&);
+
+	std::ostream& operator <<(std::ostream& out, Containment const value)
+	{
+		switch (value)
+		{
+		case Containment::outside:
+			return out << "Containment::outside";
+		case Containment::intersects:
+			return out << "Containment::intersects";
+		case Containment::inside:
+			return out << "Containment::inside";
+		}
+		return out << "Containment::unknown";
+	}
+
+	namespace {
+
+		typedef vector::vec3f vec3;
+
+		ETC_TEST_CASE(aabb_extend)
+		{
+			AABBf box;
+			ETC_TEST(box.empty());
+			box.extend(vec3(1, 2, 3)).extend(vec3(-1, 0, 5));
+			ETC_TEST(!box.empty());
+			ETC_TEST_EQ(box.min, vec3(-1, 0, 3));
+			ETC_TEST_EQ(box.max, vec3(1, 2, 5));
+			box.extend(AABBf{});
+			ETC_TEST_EQ(box.max, vec3(1, 2, 5));
+			ETC_TEST(AABBf::infinite().is_infinite());
+		}
+
+		ETC_TEST_CASE(aabb_transform)
+		{
+			AABBf box{vec3(-1, -1, -1), vec3(1, 1, 1)};
+			auto moved = box.transform(
+				matrix::translate(matrix::mat4f(1), vec3(10, 0, 0))
+			);
+			ETC_TEST_EQ(moved.min, vec3(9, -1, -1));
+			ETC_TEST_EQ(moved.max, vec3(11, 1, 1));
+			auto scaled = box.transform(
+				matrix::scale(matrix::mat4f(1), vec3(2, 3, 4))
+			);
+			ETC_TEST_EQ(scaled.max, vec3(2, 3, 4));
+		}
+
+		ETC_TEST_CASE(clip_planes)
+		{
+			// The identity clips to the [-1, 1] cube.
+			ClipPlanes<float> planes{matrix::mat4f(1)};
+			ETC_TEST_EQ(planes.test(AABBf{vec3(-.5f), vec3(.5f)}),
+			            Containment::inside);
+			ETC_TEST_EQ(planes.test(AABBf{vec3(0), vec3(2)}),
+			            Containment::intersects);
+			ETC_TEST_EQ(planes.test(AABBf{vec3(3), vec3(4)}),
+			            Containment::outside);
+			ETC_TEST_EQ(planes.test(AABBf{vec3(-4, 0, 0), vec3(-2, 0, 0)}),
+			            Containment::outside);
+			ETC_TEST_EQ(planes.test(AABBf{}), Containment::outside);
+			ETC_TEST_EQ(planes.test(AABBf::infinite()),
+			            Containment::intersects);
+		}
+
+	} // !anonymous
+
+}}}
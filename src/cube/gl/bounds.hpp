@@ -0,0 +1,200 @@
+#ifndef  CUBE_GL_BOUNDS_HPP
+# define CUBE_GL_BOUNDS_HPP
+
+# include "fwd.hpp"
+# include "matrix.hpp"
+# include "vector.hpp"
+
+# include <cube/api.hpp>
+
+# include <etc/compiler.hpp>
+
+# include <cmath>
+# include <iosfwd>
+# include <limits>
+
+namespace cube { namespace gl { namespace bounds {
+
+	/**
+	 * @brief Axis aligned bounding box.
+	 *
+	 * A default constructed box is empty: it contains nothing and extending
+	 * it with anything gives the other operand. An infinite box contains
+	 * everything, it is used for volumes that cannot be bounded.
+	 */
+	template<typename T>
+	struct AABB
+	{
+	public:
+		typedef vector::Vector3<T>  vec3;
+		typedef matrix::Matrix44<T> mat4;
+
+	public:
+		vec3 min;
+		vec3 max;
+
+	public:
+		/// Construct an empty box.
+		AABB() ETC_NOEXCEPT
+			: min(std::numeric_limits<T>::infinity())
+			, max(-std::numeric_limits<T>::infinity())
+		{}
+
+		AABB(vec3 const& min, vec3 const& max) ETC_NOEXCEPT
+			: min(min)
+			, max(max)
+		{}
+
+		/// A box that contains everything.
+		static
+		AABB infinite() ETC_NOEXCEPT
+		{ return AABB{vec3(-std::numeric_limits<T>::infinity()),
+		              vec3(std::numeric_limits<T>::infinity())}; }
+
+	public:
+		inline
+		bool empty() const ETC_NOEXCEPT
+		{ return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+		inline
+		bool is_infinite() const ETC_NOEXCEPT
+		{
+			return std::isinf(min.x) || std::isinf(min.y) || std::isinf(min.z)
+			    || std::isinf(max.x) || std::isinf(max.y) || std::isinf(max.z);
+		}
+
+		inline
+		vec3 center() const ETC_NOEXCEPT
+		{ return (min + max) / T(2); }
+
+		/// Half size of the box.
+		inline
+		vec3 extent() const ETC_NOEXCEPT
+		{ return (max - min) / T(2); }
+
+		/// Grow the box to contain a point.
+		inline
+		AABB& extend(vec3 const& point) ETC_NOEXCEPT
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+			return *this;
+		}
+
+		/// Grow the box to contain another box.
+		inline
+		AABB& extend(AABB const& other) ETC_NOEXCEPT
+		{
+			if (!other.empty())
+			{
+				min = glm::min(min, other.min);
+				max = glm::max(max, other.max);
+			}
+			return *this;
+		}
+
+		/**
+		 * @brief Bounding box of this box transformed by an affine matrix.
+		 *
+		 * The result encloses the transformed box, it is computed from the
+		 * center and the extent without transforming the 8 corners.
+		 */
+		AABB transform(mat4 const& m) const ETC_NOEXCEPT
+		{
+			if (this->empty() || this->is_infinite())
+				return *this;
+			vec3 c{m * vector::Vector4<T>(this->center(), T(1))};
+			vec3 e = this->extent();
+			vec3 r;
+			for (int i = 0; i < 3; ++i)
+				r[i] = std::abs(m[0][i]) * e.x
+				     + std::abs(m[1][i]) * e.y
+				     + std::abs(m[2][i]) * e.z;
+			return AABB{c - r, c + r};
+		}
+	};
+
+	/// Position of a volume relative to clip planes.
+	enum class Containment
+	{
+		outside,
+		intersects,
+		inside,
+	};
+
+	/**
+	 * @brief The six planes of a view volume.
+	 *
+	 * The planes are extracted from a projection * view matrix, so that
+	 * volumes are tested in world space (or in model space when the model
+	 * matrix is included). Normals point inward.
+	 */
+	template<typename T>
+	struct ClipPlanes
+	{
+	public:
+		typedef vector::Vector4<T>  vec4;
+		typedef matrix::Matrix44<T> mat4;
+
+	public:
+		vec4 planes[6];
+
+	public:
+		explicit
+		ClipPlanes(mat4 const& m) ETC_NOEXCEPT
+		{
+			vec4 rows[4];
+			for (int i = 0; i < 4; ++i)
+				rows[i] = vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+			for (int i = 0; i < 3; ++i)
+			{
+				planes[2 * i] = rows[3] + rows[i];
+				planes[2 * i + 1] = rows[3] - rows[i];
+			}
+		}
+
+		/// Test a box against the planes.
+		Containment test(AABB<T> const& box) const ETC_NOEXCEPT
+		{
+			if (box.empty())
+				return Containment::outside;
+			if (box.is_infinite())
+				return Containment::intersects;
+			Containment res = Containment::inside;
+			for (auto const& p: planes)
+			{
+				// Distance of the corners the furthest along and against the
+				// normal.
+				T far = p.w, near = p.w;
+				for (int i = 0; i < 3; ++i)
+				{
+					if (p[i] >= 0)
+					{
+						far += p[i] * box.max[i];
+						near += p[i] * box.min[i];
+					}
+					else
+					{
+						far += p[i] * box.min[i];
+						near += p[i] * box.max[i];
+					}
+				}
+				if (far < 0)
+					return Containment::outside;
+				if (near < 0)
+					res = Containment::intersects;
+			}
+			return res;
+		}
+	};
+
+	template<typename T>
+	CUBE_API
+	std::ostream& operator <<(std::ostream& out, AABB<T> const& box);
+
+	CUBE_API
+	std::ostream& operator <<(std::ostream& out, Containment const value);
+
+}}}
+
+#endif
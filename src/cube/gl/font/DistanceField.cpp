@@ -0,0 +1,170 @@
+#include "DistanceField.hpp"
+
+#include <cube/gl/exception.hpp>
+
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cube { namespace gl { namespace font {
+
+	namespace {
+
+		float const infinity = std::numeric_limits<float>::max() / 2;
+
+		// One dimension squared distance transform of @a f (size @a n)
+		// into @a d, using the lower envelope of the parabolas rooted at
+		// each sample. @a v and @a z are scratch buffers of size n and n + 1.
+		void edt_1d(float const* f,
+		            etc::size_type const n,
+		            float* d,
+		            etc::size_type* v,
+		            float* z)
+		{
+			etc::size_type k = 0;
+			v[0] = 0;
+			z[0] = -infinity;
+			z[1] = infinity;
+			for (etc::size_type q = 1; q < n; ++q)
+			{
+				float s;
+				// z[0] is -infinity, so k never goes below 0.
+				while (true)
+				{
+					float const p = static_cast<float>(v[k]);
+					float const fq = static_cast<float>(q);
+					s = ((f[q] + fq * fq) - (f[v[k]] + p * p)) / (2 * fq - 2 * p);
+					if (s > z[k])
+						break;
+					k -= 1;
+				}
+				k += 1;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = infinity;
+			}
+			k = 0;
+			for (etc::size_type q = 0; q < n; ++q)
+			{
+				while (z[k + 1] < static_cast<float>(q))
+					k += 1;
+				float const dq = static_cast<float>(q) - static_cast<float>(v[k]);
+				d[q] = dq * dq + f[v[k]];
+			}
+		}
+
+		// Squared distance transform of a grid, in place.
+		void edt_2d(std::vector<float>& grid,
+		            etc::size_type const width,
+		            etc::size_type const height)
+		{
+			etc::size_type const n = std::max(width, height);
+			std::vector<float> f(n), d(n), z(n + 1);
+			std::vector<etc::size_type> v(n);
+			for (etc::size_type x = 0; x < width; ++x)
+			{
+				for (etc::size_type y = 0; y < height; ++y)
+					f[y] = grid[y * width + x];
+				edt_1d(&f[0], height, &d[0], &v[0], &z[0]);
+				for (etc::size_type y = 0; y < height; ++y)
+					grid[y * width + x] = d[y];
+			}
+			for (etc::size_type y = 0; y < height; ++y)
+			{
+				float* row = &grid[y * width];
+				std::copy(row, row + width, f.begin());
+				edt_1d(&f[0], width, row, &v[0], &z[0]);
+			}
+		}
+
+	}
+
+	void distance_field(uint8_t const* coverage,
+	                    etc::size_type const width,
+	                    etc::size_type const height,
+	                    etc::size_type const pitch,
+	                    etc::size_type const spread,
+	                    std::vector<uint8_t>& out)
+	{
+		if (spread == 0)
+			throw exception::Exception{"Distance field spread cannot be 0"};
+		etc::size_type const w = width + 2 * spread;
+		etc::size_type const h = height + 2 * spread;
+		// Distance to the closest texel inside and outside the glyph.
+		std::vector<float> outside(w * h, infinity);
+		std::vector<float> inside(w * h, 0.0f);
+		for (etc::size_type y = 0; y < height; ++y)
+			for (etc::size_type x = 0; x < width; ++x)
+				if (coverage[y * pitch + x] >= 128)
+				{
+					etc::size_type const i = (y + spread) * w + x + spread;
+					outside[i] = 0.0f;
+					inside[i] = infinity;
+				}
+		edt_2d(outside, w, h);
+		edt_2d(inside, w, h);
+
+		out.resize(w * h);
+		float const scale = 127.0f / static_cast<float>(spread);
+		for (etc::size_type i = 0; i < w * h; ++i)
+		{
+			float const dist = (
+				std::sqrt(inside[i]) - std::sqrt(outside[i])
+			);
+			// Outline halfway between texel centers.
+			float const value = 128.0f + (
+				dist > 0 ? dist - 0.5f : dist + 0.5f
+			) * scale;
+			out[i] = static_cast<uint8_t>(
+				std::min(255.0f, std::max(0.0f, value + 0.5f))
+			);
+		}
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(distance_field_empty)
+		{
+			uint8_t coverage[4] = {};
+			std::vector<uint8_t> out;
+			distance_field(coverage, 2, 2, 2, 3, out);
+			ETC_ENFORCE_EQ(out.size(), 8u * 8u);
+			for (auto v: out)
+				ETC_ENFORCE_EQ(v, 0);
+		}
+
+		ETC_TEST_CASE(distance_field_square)
+		{
+			// A 4x4 square in the middle of a 8x8 bitmap, with a pitch of 10.
+			uint8_t coverage[8 * 10] = {};
+			for (int y = 2; y < 6; ++y)
+				for (int x = 2; x < 6; ++x)
+					coverage[y * 10 + x] = 255;
+			std::vector<uint8_t> out;
+			etc::size_type const spread = 4;
+			distance_field(coverage, 8, 8, 10, spread, out);
+			etc::size_type const w = 8 + 2 * spread;
+			ETC_ENFORCE_EQ(out.size(), w * w);
+			auto at = [&] (etc::size_type x, etc::size_type y) {
+				return out[(y + spread) * w + x + spread];
+			};
+			// Inner border texels are just above the outline.
+			ETC_ENFORCE_GT(at(2, 2), 128);
+			ETC_ENFORCE_LT(at(1, 2), 128);
+			ETC_ENFORCE_GT(at(3, 3), at(2, 3));
+			// Symmetry.
+			ETC_ENFORCE_EQ(at(2, 3), at(5, 3));
+			ETC_ENFORCE_EQ(at(3, 1), at(1, 3));
+			ETC_ENFORCE_EQ(at(0, 0), at(7, 7));
+			// Exact euclidean distance on the diagonal: sqrt(8) from (2, 2).
+			float expected = 128.0f - (std::sqrt(8.0f) - 0.5f) * 127.0f / spread;
+			ETC_ENFORCE_LTE(std::abs(at(0, 0) - expected), 1.0f);
+			// Far corners are clamped.
+			ETC_ENFORCE_EQ(out[0], 0);
+		}
+
+	}
+
+}}}
@@ -0,0 +1,40 @@
+#ifndef  CUBE_GL_FONT_DISTANCEFIELD_HPP
+# define CUBE_GL_FONT_DISTANCEFIELD_HPP
+
+# include <cube/api.hpp>
+
+# include <etc/types.hpp>
+
+# include <cstdint>
+# include <vector>
+
+namespace cube { namespace gl { namespace font {
+
+	/**
+	 * @brief Convert a coverage bitmap into a signed distance field.
+	 *
+	 * The result is @a spread texels bigger than the source on each side.
+	 * Values are 128 on the glyph outline, grow inside and reach 0 and 255
+	 * @a spread texels away from it.
+	 *
+	 * Distances are computed with the exact linear time euclidean distance
+	 * transform of Felzenszwalb and Huttenlocher.
+	 *
+	 * @param   coverage    Source bitmap (one byte per texel).
+	 * @param   width       Source width.
+	 * @param   height      Source height.
+	 * @param   pitch       Bytes between two source rows.
+	 * @param   spread      Distance mapped to the full output range.
+	 * @param   out         Resized to hold the tightly packed result.
+	 */
+	CUBE_API
+	void distance_field(uint8_t const* coverage,
+	                    etc::size_type const width,
+	                    etc::size_type const height,
+	                    etc::size_type const pitch,
+	                    etc::size_type const spread,
+	                    std::vector<uint8_t>& out);
+
+}}}
+
+#endif
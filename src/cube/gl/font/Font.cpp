@@ -1,9 +1,11 @@
 #include "Font.hpp"
+#include "DistanceField.hpp"
 
 #include <cube/gl/exception.hpp>
 #include <cube/gl/renderer/Painter.hpp>
 #include <cube/gl/renderer/Renderer.hpp>
 #include <cube/gl/renderer/ShaderProgram.hpp>
+#include <cube/gl/renderer/SkylinePacker.hpp>
 #include <cube/gl/renderer/Texture.hpp>
 #include <cube/gl/renderer/VertexBuffer.hpp>
 #include <cube/gl/surface.hpp>
@@ -19,7 +21,11 @@
 
 #include <boost/regex/pending/unicode_iterator.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <list>
 #include <unordered_map>
+#include <vector>
 
 ETC_LOG_COMPONENT("cube.gl.font.Font");
 
@@ -133,19 +139,23 @@ namespace cube { namespace gl { namespace font {
 
 		struct Glyph
 		{
-			::FT_Glyph          handle;
-			::FT_BitmapGlyph    bitmap_glyph;
-			::FT_Bitmap         bitmap;
-			uint32_t            id;
-			vector::Vector2f    position;
-			vector::Vector2f    size;
-			vector::Vector2f    offset;
-			vector::Vector2f    advance;
-
-			Glyph(Face& face, char32_t charcode, uint32_t id)
+			::FT_Glyph                      handle;
+			::FT_BitmapGlyph                bitmap_glyph;
+			::FT_Bitmap                     bitmap;
+			vector::Vector2f                size;
+			vector::Vector2f                offset;
+			vector::Vector2f                advance;
+			// Page of the glyph map, or `no_page` for empty glyphs.
+			etc::size_type                  page;
+			renderer::SkylinePacker::Slot   slot;
+			vector::Vector2f                tex_coords[4];
+
+			static etc::size_type const no_page = static_cast<etc::size_type>(-1);
+
+			Glyph(Face& face, char32_t charcode)
 				: handle(nullptr)
 				, bitmap()
-				, id(id)
+				, page{no_page}
 			{
 				::FT_GlyphSlot slot = face.handle->glyph;
 				ETC_TRACE.debug("New FreeType Glyph of", charcode);
@@ -184,134 +194,244 @@ namespace cube { namespace gl { namespace font {
 			}
 		};
 
+		/**
+		 * @brief Glyph coverage stored in single channel textures.
+		 *
+		 * Glyphs are packed in pages with a skyline packer. When a new page
+		 * would exceed the memory budget, the least recently used page is
+		 * emptied and reused instead.
+		 */
 		struct GlyphMap
 		{
 		private:
 			typedef std::unique_ptr<Glyph>    GlyphPtr;
 			typedef renderer::TexturePtr      TexturePtr;
-			typedef renderer::VertexBufferPtr VertexBufferPtr;
+
+			struct Page
+			{
+				TexturePtr                  texture;
+				renderer::SkylinePacker     packer;
+				std::vector<char32_t>       glyphs;
+				etc::size_type              last_use;
+
+				Page(TexturePtr texture,
+				     etc::size_type const width,
+				     etc::size_type const height)
+					: texture{std::move(texture)}
+					, packer{width, height, 1}
+					, glyphs{}
+					, last_use{0}
+				{}
+
+				etc::size_type memory() const ETC_NOEXCEPT
+				{ return this->packer.width() * this->packer.height(); }
+			};
+			typedef std::unique_ptr<Page> PagePtr;
+
 		private:
 			renderer::Renderer&                     _renderer;
 			std::unordered_map<char32_t, GlyphPtr>  _glyphs;
 			Face&                                   _face;
-			vector::Vector2f                        _texture_size;
-			TexturePtr                              _texture;
-			std::vector<vector::Vector2f>           _tex_coords;
-			VertexBufferPtr                         _vertex_buffer;
-			uint32_t                                _next_id;
-			vector::Vector2f                        _pen;
-			etc::size_type                          _max_line_height;
+			etc::size_type                          _spread;
+			std::vector<PagePtr>                    _pages;
+			etc::size_type                          _page_size;
+			etc::size_type                          _memory_budget;
+			etc::size_type                          _tick;
+			etc::size_type                          _evictions;
+
 		public:
-			GlyphMap(Face& face, renderer::Renderer& renderer)
+			/// Glyphs are stored as distance fields when @a spread is not 0.
+			GlyphMap(Face& face,
+			         renderer::Renderer& renderer,
+			         etc::size_type const spread)
 				: _renderer(renderer)
 				, _glyphs{}
 				, _face(face)
-				, _texture_size{512, 512}
-				, _texture{renderer.new_texture(
-				    surface::Surface{
-						renderer::PixelFormat::rgba,
-						(unsigned int)_texture_size.x,
-						(unsigned int)_texture_size.y,
-						renderer::PixelFormat::rgba,
-						renderer::ContentPacking::uint8,
-						nullptr,
-					}
-				)}
-				, _tex_coords{}
-				, _vertex_buffer{}
-				, _next_id{0}
-				, _pen{0, 0}
-				, _max_line_height{0}
+				, _spread{spread}
+				, _pages{}
+				, _page_size{CUBE_GL_FONT_PAGE_SIZE}
+				, _memory_budget{CUBE_GL_FONT_MEMORY_BUDGET}
+				, _tick{0}
+				, _evictions{0}
 			{
 				ETC_TRACE.debug("New GlyphMap");
+				_new_page(_page_size, _page_size);
 			}
 
-			vector::Vector2f const&
-			tex_coord(etc::size_type index) const
+			renderer::TexturePtr& texture(etc::size_type const page)
 			{
-				return _tex_coords[index];
+				if (page >= _pages.size())
+					throw Exception{"Invalid font page " + etc::to_string(page)};
+				return _pages[page]->texture;
 			}
 
-			renderer::TexturePtr& texture() { return _texture; }
+			etc::size_type pages() const ETC_NOEXCEPT
+			{ return _pages.size(); }
+
+			etc::size_type memory() const ETC_NOEXCEPT
+			{
+				etc::size_type res = 0;
+				for (auto const& page: _pages)
+					res += page->memory();
+				return res;
+			}
+
+			etc::size_type memory_budget() const ETC_NOEXCEPT
+			{ return _memory_budget; }
+
+			void memory_budget(etc::size_type const budget) ETC_NOEXCEPT
+			{ _memory_budget = budget; }
+
+			etc::size_type evictions() const ETC_NOEXCEPT
+			{ return _evictions; }
 
-			bool has_glyph(char32_t c)
-			{ return _glyphs.find(c) != _glyphs.end(); }
+			/// Pages touched since the last call cannot be evicted.
+			void begin_use() ETC_NOEXCEPT
+			{ _tick += 1; }
 
 			Glyph& get_glyph(char32_t c)
 			{
 				auto it = _glyphs.find(c);
-				if (it != _glyphs.end())
-					return *it->second.get();
-				else
-					return _gen_glyph(c);
+				Glyph& glyph = (
+					it != _glyphs.end() ? *it->second : _gen_glyph(c)
+				);
+				if (glyph.page != Glyph::no_page)
+					_pages[glyph.page]->last_use = _tick;
+				return glyph;
 			}
-		private:
 
-			Glyph& _gen_glyph(char32_t c)
+		private:
+			Page& _new_page(etc::size_type const width,
+			                etc::size_type const height)
 			{
-				ETC_TRACE.debug("Generate glyph", c, "at", _pen, "with id =", _next_id + 1);
-				_vertex_buffer.reset(); // tex coord buffer needs to be regenerated
+				ETC_LOG.debug("New glyph page of", width, 'x', height);
+				auto texture = _renderer.new_texture(
+					renderer::PixelFormat::r8, width, height
+				);
+				texture->min_filter(renderer::TextureFilter::linear);
+				texture->mag_filter(renderer::TextureFilter::linear);
+				_pages.emplace_back(new Page{std::move(texture), width, height});
+				return *_pages.back();
+			}
 
-				_glyphs[c].reset(new Glyph(_face, c, _next_id++));
-				Glyph& glyph = *_glyphs[c].get();
+			void _evict(Page& page)
+			{
+				ETC_LOG.debug("Evict glyph page with", page.glyphs.size(),
+				              "glyphs");
+				for (auto c: page.glyphs)
+					_glyphs.erase(c);
+				page.glyphs.clear();
+				page.packer.clear();
+				_evictions += 1;
+			}
 
-				if (_pen.x + glyph.bitmap.width >= _texture->width)
+			etc::size_type _find_room(etc::size_type const w,
+			                           etc::size_type const h,
+			                           renderer::SkylinePacker::Slot& slot)
+			{
+				for (etc::size_type i = 0; i < _pages.size(); ++i)
+					if (_pages[i]->packer.insert(w, h, slot))
+						return i;
+
+				// Glyphs bigger than a page get a page of their own.
+				etc::size_type width = _page_size;
+				while (width < w + 1) width *= 2;
+				etc::size_type height = _page_size;
+				while (height < h + 1) height *= 2;
+
+				Page* lru = nullptr;
+				etc::size_type lru_index = 0;
+				for (etc::size_type i = 0; i < _pages.size(); ++i)
 				{
-					_pen.x = 0;
-					_pen.y += _max_line_height;
-					ETC_LOG.debug("Carriage return in the texture, y =", _pen.y);
-					_max_line_height = 0;
-
-					if (_pen.y + glyph.bitmap.rows >= _texture->height)
-						throw Exception{"Texture too small !"};
+					Page& page = *_pages[i];
+					if (page.last_use == _tick ||
+					    page.packer.width() < w || page.packer.height() < h)
+						continue;
+					if (lru == nullptr || page.last_use < lru->last_use)
+					{
+						lru = &page;
+						lru_index = i;
+					}
 				}
+				if (lru != nullptr &&
+				    this->memory() + width * height > _memory_budget)
+				{
+					_evict(*lru);
+					if (!lru->packer.insert(w, h, slot))
+						throw Exception{"Couldn't insert a glyph in an empty page"};
+					return lru_index;
+				}
+				if (this->memory() + width * height > _memory_budget)
+					ETC_LOG.warn("Font pages exceed the memory budget of",
+					             _memory_budget, "bytes");
+				if (!_new_page(width, height).packer.insert(w, h, slot))
+					throw Exception{"Couldn't insert a glyph in an empty page"};
+				return _pages.size() - 1;
+			}
 
-				glyph.position = _pen;
-
-
-				if (glyph.size.y > _max_line_height)
-					_max_line_height = (etc::size_type) glyph.size.y;
+			Glyph& _gen_glyph(char32_t c)
+			{
+				GlyphPtr ptr{new Glyph(_face, c)};
+				Glyph& glyph = *ptr;
+				etc::size_type w = glyph.bitmap.width;
+				etc::size_type h = glyph.bitmap.rows;
+				ETC_TRACE.debug("Generate glyph", c, "of size", w, 'x', h);
+				if (w > 0 && h > 0)
+				{
+					std::vector<uint8_t> buffer;
+					uint8_t const* data = glyph.bitmap.buffer;
+					if (_spread > 0)
+					{
+						distance_field(data, w, h, glyph.bitmap.pitch,
+						               _spread, buffer);
+						data = &buffer[0];
+						w += 2 * _spread;
+						h += 2 * _spread;
+						glyph.offset.x -= _spread;
+						glyph.offset.y += _spread;
+						glyph.size.x += 2 * _spread;
+						glyph.size.y += 2 * _spread;
+					}
 
-				ETC_LOG.debug("glyph size:", glyph.bitmap.width, ',', glyph.bitmap.rows);
+					glyph.page = _find_room(w, h, glyph.slot);
+					Page& page = *_pages[glyph.page];
+					auto const& slot = glyph.slot;
 
-				_tex_coords.emplace_back(
-					_pen.x / _texture_size.x,
-					_pen.y / _texture_size.y
-				);
-				_tex_coords.emplace_back(
-					_pen.x / _texture_size.x,
-					(_pen.y + glyph.bitmap.rows) / _texture_size.y
-				);
-				_tex_coords.emplace_back(
-					(_pen.x + glyph.bitmap.width) / _texture_size.x,
-					(_pen.y + glyph.bitmap.rows) / _texture_size.y
-				);
-				_tex_coords.emplace_back(
-					(_pen.x + glyph.bitmap.width) / _texture_size.x,
-					_pen.y / _texture_size.y
-				);
-				std::vector<uint8_t> buffer(glyph.bitmap.width * glyph.bitmap.rows * 4);
-				ETC_ASSERT_EQ(buffer.size(), static_cast<size_t>(glyph.bitmap.width * glyph.bitmap.rows * 4));
-				for (unsigned i = 0; i < glyph.bitmap.width; ++i)
-					for (unsigned j = 0; j < glyph.bitmap.rows; ++j)
+					// Coverage rows might be padded by FreeType.
+					if (_spread == 0 &&
+					    static_cast<etc::size_type>(glyph.bitmap.pitch) != w)
 					{
-						etc::size_type idx = i + j * glyph.bitmap.width;
-						uint8_t col = glyph.bitmap.buffer[idx];
-
-						buffer[idx * 4 + 0] = col;
-						buffer[idx * 4 + 1] = col;
-						buffer[idx * 4 + 2] = col;
-						buffer[idx * 4 + 3] = 255;
+						buffer.resize(w * h);
+						for (etc::size_type y = 0; y < h; ++y)
+							std::memcpy(&buffer[y * w],
+							            data + y * glyph.bitmap.pitch,
+							            w);
+						data = &buffer[0];
 					}
-				_texture->set_data((int)_pen.x, (int)_pen.y,
-				                   glyph.bitmap.width, glyph.bitmap.rows,
-				                   renderer::PixelFormat::rgba,
-				                   renderer::ContentPacking::uint8,
-				                   &buffer[0]);
-				_pen.x += glyph.bitmap.width;
-				_pen.y += 0; //glyph.bitmap.rows;
+					page.texture->set_data(
+						slot.x, slot.y, w, h,
+						renderer::PixelFormat::red,
+						renderer::ContentPacking::uint8,
+						data
+					);
 
-				return glyph;
+					float const pw = static_cast<float>(page.packer.width());
+					float const ph = static_cast<float>(page.packer.height());
+					glyph.tex_coords[0] = vector::Vector2f(
+						slot.x / pw, slot.y / ph
+					);
+					glyph.tex_coords[1] = vector::Vector2f(
+						slot.x / pw, (slot.y + h) / ph
+					);
+					glyph.tex_coords[2] = vector::Vector2f(
+						(slot.x + w) / pw, (slot.y + h) / ph
+					);
+					glyph.tex_coords[3] = vector::Vector2f(
+						(slot.x + w) / pw, slot.y / ph
+					);
+					page.glyphs.push_back(c);
+				}
+				return *(_glyphs[c] = std::move(ptr));
 			}
 		};
 
@@ -324,39 +444,117 @@ namespace cube { namespace gl { namespace font {
 	{
 	public:
 		renderer::Renderer&         renderer;
-	private:
-		freetype::Face              _face;
-		freetype::GlyphMap          _glyphs;
+		etc::size_type const        size;
+		RenderMode const            mode;
+		freetype::Face              face;
+		freetype::GlyphMap          glyphs;
+
+		struct LayoutCache
+		{
+			typedef std::list<std::string> Order;
+			Order order; // Most recently used first.
+			std::unordered_map<
+				std::string,
+				std::pair<TextLayoutPtr, Order::iterator>
+			> layouts;
+			etc::size_type evictions;
+
+			void clear()
+			{
+				this->layouts.clear();
+				this->order.clear();
+			}
+		} layouts;
 
 	public:
 		Impl(renderer::Renderer& renderer,
 		     Infos const& infos,
-		     etc::size_type size)
+		     etc::size_type size,
+		     RenderMode mode)
 			: renderer(renderer)
-			, _face{infos, size}
-			, _glyphs{_face, renderer}
-		{}
+			, size{size}
+			, mode{mode}
+			, face{infos, size}
+			, glyphs{
+				face,
+				renderer,
+				mode == RenderMode::distance_field ? distance_field_spread(size) : 0
+			}
+			, layouts{}
+		{ this->layouts.evictions = 0; }
 
-		vector::Vector2f const&
-		tex_coord(etc::size_type idx) const
+		// Enough to draw the glyphs a few times bigger than their size.
+		static etc::size_type distance_field_spread(etc::size_type size)
+		{ return std::max<etc::size_type>(2, size / 8); }
+
+		TextLayoutPtr make_layout(std::string const& str)
 		{
-			return _glyphs.tex_coord(idx);
-		}
+			std::basic_string<char32_t> wstr{
+				boost::u8_to_u32_iterator<char const*>{str.c_str()},
+				boost::u8_to_u32_iterator<char const*>{str.c_str() + str.size()}
+			};
+			ETC_TRACE.debug("Layout text of", str, wstr.size());
 
+			std::shared_ptr<TextLayout> layout{new TextLayout};
+			auto& vertices = layout->vertices;
+			auto& tex_coords = layout->tex_coords;
+			auto& parts = layout->parts;
+			vertices.resize(wstr.size() * 4);
+			tex_coords.resize(wstr.size() * 4);
+			vector::Vector2f pos{0,0};
+			vector::Vector2f max_offset{0, 0};
 
-		template<typename CharType>
-		bool has_glyph(CharType c)
-		{ return _glyphs.has_glyph(c); }
+			// Pages holding glyphs of this string are not evicted while
+			// generating it.
+			this->glyphs.begin_use();
 
-		template<typename CharType>
-		freetype::Glyph& get_glyph(CharType c)
-		{
-			return _glyphs.get_glyph(c);
-		}
+			// Compute max offset and generate all glyphs.
+			std::vector<freetype::Glyph*> glyphs(wstr.size());
+			for (etc::size_type i = 0; i < wstr.size(); ++i)
+			{
+				glyphs[i] = &this->glyphs.get_glyph(wstr[i]);
+				if (glyphs[i]->offset.x > max_offset.x)
+					max_offset.x = glyphs[i]->offset.x;
+				if (glyphs[i]->offset.y > max_offset.y)
+					max_offset.y = glyphs[i]->offset.y;
+			}
+			ETC_LOG.debug("Computed max offset:", max_offset);
 
-		renderer::TexturePtr& texture()
-		{
-			return _glyphs.texture();
+			for (etc::size_type i = 0; i < wstr.size(); ++i)
+			{
+				freetype::Glyph& glyph = *glyphs[i];
+				etc::size_type idx = i * 4;
+				vector::Vector2f orig(pos.x + glyph.offset.x, pos.y + (max_offset.y - glyph.offset.y));
+				vertices[idx + 0] = orig;
+				vertices[idx + 1] = vector::Vector2f(orig.x, orig.y + glyph.size.y);
+				vertices[idx + 2] = vector::Vector2f(orig.x + glyph.size.x, orig.y + glyph.size.y);
+				vertices[idx + 3] = vector::Vector2f(orig.x + glyph.size.x, orig.y);
+				pos.x += glyph.advance.x;
+
+				if (glyph.page == freetype::Glyph::no_page)
+				{
+					// Empty glyphs are degenerated quads, drawn with any page.
+					if (!parts.empty())
+						parts.back().count += 4;
+					continue;
+				}
+				for (etc::size_type j = 0; j < 4; ++j)
+					tex_coords[idx + j] = glyph.tex_coords[j];
+				if (parts.empty() || parts.back().page != glyph.page)
+					parts.push_back(TextPart{glyph.page, idx, 4});
+				else
+					parts.back().count += 4;
+			}
+			if (parts.empty())
+				parts.push_back(TextPart{0, 0, vertices.size()});
+			else
+			{
+				// Leading empty glyphs belong to the first part.
+				parts.front().count += parts.front().first;
+				parts.front().first = 0;
+			}
+			layout->advance = pos;
+			return layout;
 		}
 	};
 
@@ -365,8 +563,9 @@ namespace cube { namespace gl { namespace font {
 
 	Font::Font(renderer::Renderer& renderer,
 	           Infos const& infos,
-	           etc::size_type size)
-		: _impl{new Impl{renderer, infos, size}}
+	           etc::size_type size,
+	           RenderMode mode)
+		: _impl{new Impl{renderer, infos, size, mode}}
 	{}
 
 	Font::~Font()
@@ -375,92 +574,65 @@ namespace cube { namespace gl { namespace font {
 	renderer::Renderer& Font::renderer() ETC_NOEXCEPT
 	{ return _impl->renderer; }
 
-	renderer::VertexBufferPtr
-	Font::generate_text(std::string const& str)
-	{
-		std::vector<vector::Vector2f>   vertices(str.size() * 4);
-		std::vector<vector::Vector2f>   tex_coords(str.size() * 4);
-		vector::Vector2f pos{0,0};
-		vector::Vector2f max_offset{0, 0};
-
-		std::basic_string<char32_t> wstr{
-			boost::u8_to_u32_iterator<char const*>{str.c_str()},
-			boost::u8_to_u32_iterator<char const*>{str.c_str() + str.size()}
-		};
-		ETC_TRACE.debug("Generate text of", str, wstr.size());
+	etc::size_type Font::size() const ETC_NOEXCEPT
+	{ return _impl->size; }
+
+	Font::RenderMode Font::render_mode() const ETC_NOEXCEPT
+	{ return _impl->mode; }
 
+	Font::TextLayoutPtr Font::layout(std::string const& str)
+	{
+		auto& cache = _impl->layouts;
+		if (cache.evictions != _impl->glyphs.evictions())
 		{
-			// Compute max offset and generate all glyphs.
-			etc::stack_ptr<renderer::Bindable::Guard> guard{etc::stack_ptr_no_init};
-			for (auto c: wstr)
-			{
-				if (!_impl->has_glyph(c))
-				{
-					// Bind texture once and for all.
-					guard.reset(
-						*this->texture(),
-						_impl->renderer.current_state().lock()
-					);
-				}
-				freetype::Glyph& glyph = _impl->get_glyph(c);
-				if (glyph.offset.x > max_offset.x)
-					max_offset.x = glyph.offset.x;
-				if (glyph.offset.y > max_offset.y)
-					max_offset.y = glyph.offset.y;
-			}
-			guard.clear();
-			ETC_LOG.debug("Computed max offset:", max_offset);
+			// Cached layouts might use glyphs that are gone.
+			cache.clear();
+			cache.evictions = _impl->glyphs.evictions();
 		}
-
-		for (etc::size_type i = 0; i < wstr.size(); ++i)
+		auto it = cache.layouts.find(str);
+		if (it != cache.layouts.end())
 		{
-			ETC_LOG.debug("Adding char", wstr[i]);
-			freetype::Glyph& glyph = _impl->get_glyph(wstr[i]);
-
-			etc::size_type idx0 = i * 4 + 0;
-			etc::size_type idx1 = idx0 + 1;
-			etc::size_type idx2 = idx0 + 2;
-			etc::size_type idx3 = idx0 + 3;
-
-
-			{
-				vector::Vector2f orig(pos.x + glyph.offset.x, pos.y + (max_offset.y - glyph.offset.y));
-				vertices[idx0] = orig;
-				vertices[idx1] = vector::Vector2f(orig.x, orig.y + glyph.size.y);
-				vertices[idx2] = vector::Vector2f(orig.x + glyph.size.x, orig.y + glyph.size.y);
-				vertices[idx3] = vector::Vector2f(orig.x + glyph.size.x, orig.y);
-				ETC_LOG.debug(
-					"Stored vertices",
-					vertices[idx0],
-					vertices[idx1],
-					vertices[idx2],
-					vertices[idx3]
-				);
-			}
+			cache.order.splice(cache.order.begin(), cache.order, it->second.second);
+			return it->second.first;
+		}
 
-			pos.x += glyph.advance.x;
-			{
-				etc::size_type tex_index = glyph.id * 4;
-				tex_coords[idx0] = _impl->tex_coord(tex_index++);
-				tex_coords[idx1] = _impl->tex_coord(tex_index++);
-				tex_coords[idx2] = _impl->tex_coord(tex_index++);
-				tex_coords[idx3] = _impl->tex_coord(tex_index++);
-			}
+		TextLayoutPtr res = _impl->make_layout(str);
+		if (cache.evictions != _impl->glyphs.evictions())
+		{
+			cache.clear();
+			cache.evictions = _impl->glyphs.evictions();
+		}
+		if (cache.layouts.size() >= CUBE_GL_FONT_LAYOUT_CACHE_SIZE)
+		{
+			cache.layouts.erase(cache.order.back());
+			cache.order.pop_back();
 		}
+		cache.order.push_front(str);
+		cache.layouts.emplace(str, std::make_pair(res, cache.order.begin()));
+		return res;
+	}
 
-		auto vb = _impl->renderer.new_vertex_buffer(
+	renderer::VertexBufferPtr
+	Font::generate_text(std::string const& str,
+	                    std::vector<TextPart>* parts)
+	{
+		auto layout = this->layout(str);
+		if (parts != nullptr)
+			*parts = layout->parts;
+		if (layout->vertices.empty())
+			return nullptr;
+		return _impl->renderer.new_vertex_buffer(
 			renderer::make_vertex_buffer_attribute(
 				renderer::ContentKind::vertex,
-				&vertices[0],
-				static_cast<etc::size_type>(vertices.size())
+				&layout->vertices[0],
+				static_cast<etc::size_type>(layout->vertices.size())
 			),
 			renderer::make_vertex_buffer_attribute(
 				renderer::ContentKind::tex_coord0, // XXX should be configurable
-				&tex_coords[0],
-				static_cast<etc::size_type>(tex_coords.size())
+				&layout->tex_coords[0],
+				static_cast<etc::size_type>(layout->tex_coords.size())
 			)
 		);
-		return vb;
 	}
 
 	/*
@@ -485,9 +657,25 @@ namespace cube { namespace gl { namespace font {
 	Font::generate_text<char32_t>(std::basic_string<char32_t> const& str);
 */
 	renderer::TexturePtr& Font::texture()
-	{
-		return _impl->texture();
-	}
+	{ return _impl->glyphs.texture(0); }
+
+	renderer::TexturePtr& Font::texture(etc::size_type const page)
+	{ return _impl->glyphs.texture(page); }
+
+	etc::size_type Font::pages() const ETC_NOEXCEPT
+	{ return _impl->glyphs.pages(); }
+
+	etc::size_type Font::memory() const ETC_NOEXCEPT
+	{ return _impl->glyphs.memory(); }
+
+	etc::size_type Font::memory_budget() const ETC_NOEXCEPT
+	{ return _impl->glyphs.memory_budget(); }
+
+	void Font::memory_budget(etc::size_type const budget) ETC_NOEXCEPT
+	{ _impl->glyphs.memory_budget(budget); }
+
+	etc::size_type Font::evictions() const ETC_NOEXCEPT
+	{ return _impl->glyphs.evictions(); }
 
 	Infos::Infos(std::string const& path,
 	             std::string const& family_name,
@@ -518,9 +706,10 @@ namespace cube { namespace gl { namespace font {
 
 	std::unique_ptr<Font>
 	Infos::font(renderer::Renderer& renderer,
-	            etc::size_type size)
+	            etc::size_type size,
+	            Font::RenderMode mode)
 	{
-		return etc::make_unique<Font>(renderer, *this, size);
+		return etc::make_unique<Font>(renderer, *this, size, mode);
 	}
 
 	etc::size_type
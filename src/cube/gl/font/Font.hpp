@@ -4,6 +4,7 @@
 # include <cube/api.hpp>
 # include <cube/gl/renderer/Bindable.hpp>
 # include <cube/gl/renderer/fwd.hpp>
+# include <cube/gl/vector.hpp>
 # include <cube/resource/Resource.hpp>
 
 # include <etc/compiler.hpp>
@@ -13,16 +14,41 @@
 # include <list>
 # include <memory>
 # include <string>
+# include <vector>
 
 namespace cube { namespace gl { namespace font {
 
 # define CUBE_GL_FONT_DEFAULT_SIZE 12
 
+/// Default size of a glyph page.
+# define CUBE_GL_FONT_PAGE_SIZE 512
+
+/// Default memory budget of the glyph pages (in bytes).
+# define CUBE_GL_FONT_MEMORY_BUDGET (4 * 1024 * 1024)
+
+/// Number of string layouts cached by a font.
+# define CUBE_GL_FONT_LAYOUT_CACHE_SIZE 256
+
 	struct Infos;
 
 	class CUBE_API Font
 		: public resource::Resource
 	{
+	public:
+		/**
+		 * @brief How glyphs are stored in the font textures.
+		 *
+		 * Bitmap glyphs are coverage values rasterized at the font size.
+		 * Distance field glyphs are rasterized once at the font size, and
+		 * store the distance to the glyph outline instead. They stay sharp
+		 * at any scale when drawn with TextureType::distance_field.
+		 */
+		enum class RenderMode
+		{
+			bitmap,
+			distance_field,
+		};
+
 	private:
 		struct Impl;
 		std::unique_ptr<Impl> _impl;
@@ -31,7 +57,8 @@ namespace cube { namespace gl { namespace font {
 		explicit
 		Font(renderer::Renderer& renderer,
 		     Infos const& infos,
-		     etc::size_type size = CUBE_GL_FONT_DEFAULT_SIZE);
+		     etc::size_type size = CUBE_GL_FONT_DEFAULT_SIZE,
+		     RenderMode mode = RenderMode::bitmap);
 		~Font();
 
 		/**
@@ -39,18 +66,64 @@ namespace cube { namespace gl { namespace font {
 		 */
 		renderer::Renderer& renderer() ETC_NOEXCEPT;
 
+		/// Size used to rasterize glyphs.
+		etc::size_type size() const ETC_NOEXCEPT;
+
+		RenderMode render_mode() const ETC_NOEXCEPT;
+
+		/**
+		 * @brief Range of vertices using the same glyph page.
+		 */
+		struct TextPart
+		{
+			etc::size_type page;
+			etc::size_type first;
+			etc::size_type count;
+		};
+
+		/**
+		 * @brief Positions and texture coordinates of a string.
+		 *
+		 * There are four vertices per character, the origin is the top left
+		 * corner of the text.
+		 */
+		struct TextLayout
+		{
+			std::vector<vector::Vector2f> vertices;
+			std::vector<vector::Vector2f> tex_coords;
+			std::vector<TextPart>         parts;
+			/// Pen position after the last character.
+			vector::Vector2f              advance;
+		};
+		typedef std::shared_ptr<TextLayout const> TextLayoutPtr;
+
+		/**
+		 * @brief Layout a string.
+		 *
+		 * Layouts of the most recently used strings are cached, the cache is
+		 * dropped when a glyph page is evicted.
+		 */
+		TextLayoutPtr layout(std::string const& str);
+
 		/**
 		 * @brief Generate a vertex buffer corresponding to a string.
 		 *
 		 * The vertex buffer returned is filled with vertices and font texture
-		 * coordinates.
+		 * coordinates, four vertices per character. When @a parts is not
+		 * null, it is filled with the vertex ranges to draw with each page.
+		 *
+		 * Glyphs are stored in pages of single channel (red) textures. When
+		 * the memory budget is reached, the least recently used page is
+		 * emptied to make room, which invalidates previously generated texts
+		 * (see evictions()).
 		 */
 		//template<typename CharType>
 		renderer::VertexBufferPtr
-		generate_text(std::string const& str);
+		generate_text(std::string const& str,
+		              std::vector<TextPart>* parts = nullptr);
 
 		/**
-		 * @brief The texture of the font.
+		 * @brief The texture of the first glyph page.
 		 *
 		 * The texture is generated according the needs of previous calls to
 		 * generate_text(), and will be updated depending on characters needed.
@@ -60,6 +133,22 @@ namespace cube { namespace gl { namespace font {
 		 *          will be updated inplace.
 		 */
 		renderer::TexturePtr& texture();
+
+		/// The texture of a glyph page.
+		renderer::TexturePtr& texture(etc::size_type const page);
+
+		/// Number of glyph pages.
+		etc::size_type pages() const ETC_NOEXCEPT;
+
+		/// Memory used by the glyph pages (in bytes).
+		etc::size_type memory() const ETC_NOEXCEPT;
+
+		/// Memory allowed for the glyph pages before evicting one.
+		etc::size_type memory_budget() const ETC_NOEXCEPT;
+		void memory_budget(etc::size_type const budget) ETC_NOEXCEPT;
+
+		/// Number of page evictions so far.
+		etc::size_type evictions() const ETC_NOEXCEPT;
 	};
 
 
@@ -134,7 +223,8 @@ namespace cube { namespace gl { namespace font {
 		 */
 		std::unique_ptr<Font>
 		font(renderer::Renderer& renderer,
-		     etc::size_type size = CUBE_GL_FONT_DEFAULT_SIZE);
+		     etc::size_type size = CUBE_GL_FONT_DEFAULT_SIZE,
+		     Font::RenderMode mode = Font::RenderMode::bitmap);
 		~Infos();
 
 		/**
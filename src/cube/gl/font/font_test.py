@@ -60,6 +60,25 @@ class _(PainterSetup, Case):
         #self.assertIsInstance(text, gl.VertexBuffer)
         self.assertIsInstance(font.texture, gl.Texture)
 
+    def test_distance_field(self):
+        info = gl.font.get_infos(self.font_path)[0]
+        font = gl.Font(self.renderer, info, 32, gl.font.RenderMode.distance_field)
+        self.assertEqual(font.render_mode, gl.font.RenderMode.distance_field)
+        self.assertEqual(font.size, 32)
+        self.assertIsNotNone(font.generate_text("abc"))
+        self.assertIsInstance(font.texture, gl.Texture)
+
+    def test_page_eviction(self):
+        info = gl.font.get_infos(self.font_path)[0]
+        font = gl.Font(self.renderer, info, 200)
+        self.assertEqual(font.pages, 1)
+        font.memory_budget = font.memory
+        for c in "abcdefghijklmnopqrstuvwxyz":
+            self.assertIsNotNone(font.generate_text(c))
+        self.assertEqual(font.pages, 1)
+        self.assertGreater(font.evictions, 0)
+        self.assertLessEqual(font.memory, font.memory_budget)
+
 
     @painter_test(gl.mode_2d)
     def test_render(self, painter):
@@ -10,6 +10,14 @@
 
 namespace cube { namespace gl {
 
+	namespace bounds {
+
+		template<typename T> struct AABB;
+		typedef AABB<float>  AABBf;
+		typedef AABB<double> AABBd;
+
+	}
+
 	namespace color {
 
 		template<typename T> struct CUBE_API Color3;
@@ -69,6 +77,13 @@ namespace cube { namespace gl {
 
 	}
 
+	namespace occlusion {
+
+		class CUBE_API Culler;
+		typedef std::shared_ptr<Culler> CullerPtr;
+
+	}
+
 	namespace rectangle {
 
 		template<typename T> struct Rectangle;
@@ -5,6 +5,8 @@
 #include <cube/resource/Manager.hpp>
 #include <cube/gl/renderer/ShaderProgram.hpp>
 #include <cube/gl/renderer/Light.hpp>
+#include <cube/gl/renderer/LightClusters.hpp>
+#include <cube/gl/renderer/State.hpp>
 #include <cube/gl/surface.hpp>
 #include <cube/gl/renderer/Texture.hpp>
 
@@ -62,11 +64,19 @@ namespace cube { namespace gl { namespace material {
 					dir_light_idx = 0;
 			shader["cube_ModelView"] = this->bound_state().model_view();
 			shader["cube_Normal"] = this->bound_state().normal();
+			// Point lights are lit per fragment by the light clusters.
+			auto clusters = this->bound_state().light_clusters();
+			if (clusters != nullptr)
+				clusters->setup(shader, _guards, this->shared_state());
+			else
+				shader["cube_ClusteredLighting"] = int32_t{0};
 			for (auto const& ref: this->bound_state().lights())
 			{
 				auto const& light = ref.get();
 				if (light.kind == renderer::LightKind::point)
 				{
+					if (clusters != nullptr)
+						continue;
 					auto const& info = light.point();
 					ETC_TRACE.debug("Update point light", point_light_idx, "with",
 					                "position =", info.position,
@@ -94,6 +104,19 @@ namespace cube { namespace gl { namespace material {
 		}
 	}
 
+	void Bindable::update_matrices()
+	{
+		if (this->bound() == 0)
+			throw Exception{"Cannot update the matrices of an unbound material"};
+		auto& shader = *_shader_program;
+		shader["cube_MVP"] = this->bound_state().mvp();
+		if (_material->shading_model() != ShadingModel::none)
+		{
+			shader["cube_ModelView"] = this->bound_state().model_view();
+			shader["cube_Normal"] = this->bound_state().normal();
+		}
+	}
+
 	void Bindable::_unbind() ETC_NOEXCEPT
 	{
 		_guards.clear();
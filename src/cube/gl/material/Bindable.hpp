@@ -24,6 +24,14 @@ namespace cube { namespace gl { namespace material {
 
 		void _bind() override;
 		void _unbind() ETC_NOEXCEPT override;
+
+		/**
+		 * @brief Upload the matrices of the bound state again.
+		 *
+		 * Lets a caller change the model matrix of the bound state without
+		 * rebinding the whole material.
+		 */
+		void update_matrices();
 	};
 }}}
 
@@ -2,6 +2,7 @@
 #include "ShaderRoutine.hpp"
 #include "Bindable.hpp"
 
+#include <cube/gl/renderer/LightClusters.hpp>
 #include <cube/gl/renderer/Renderer.hpp>
 #include <cube/gl/renderer/Texture.hpp>
 #include <cube/gl/renderer.hpp>
@@ -84,6 +85,19 @@ namespace cube { namespace gl { namespace material {
 			.routine<ShaderRoutine>("main", *this)
 		;
 
+		if (_shading_model != ShadingModel::none)
+		{
+			// Eye space position and normal for the clustered lighting.
+			vs.output(ShaderParameterType::vec3, "cube_EyePosition")
+				.output(ShaderParameterType::vec3, "cube_EyeNormal");
+			fs.input(ShaderParameterType::vec3, "cube_EyePosition")
+				.input(ShaderParameterType::vec3, "cube_EyeNormal")
+				.parameter(ShaderParameterType::float_, "cube_Shininess")
+				.parameter(ShaderParameterType::vec3, "cube_Diffuse")
+				.parameter(ShaderParameterType::vec3, "cube_Specular");
+			renderer::LightClusters::declare(fs);
+		}
+
 		idx = 0;
 		for (auto const& channel: _textures)
 		{
@@ -60,6 +60,7 @@ namespace cube { namespace gl { namespace material {
 		displacement,
 		lightmap,
 		reflection,
+		distance_field,
 	};
 
 	enum class ShadingModel
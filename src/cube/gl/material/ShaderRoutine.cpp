@@ -30,6 +30,8 @@ namespace cube { namespace gl { namespace material {
 	{
 		std::string res;
 		res += "\tvec4 Color = cube_Color;\n";
+		if (_material.shading_model() != ShadingModel::none)
+			res += this->glsl_clustered_lighting();
 		int idx = 0;
 		for (auto const& ch: _material.textures())
 		{
@@ -46,6 +48,17 @@ namespace cube { namespace gl { namespace material {
 				res += "\tColor.a = texture2D(" + tex
 					+ ", " + coord + ".xy).r;\n";
 			}
+			else if (ch.type == TextureType::distance_field)
+			{
+				// The outline is at 0.5, antialiased over one pixel.
+				auto dist = "Distance" + i;
+				auto width = "Width" + i;
+				res += "\tfloat " + dist + " = texture2D(" + tex
+					+ ", " + coord + ".xy).r;\n"
+					"\tfloat " + width + " = fwidth(" + dist + ");\n"
+					"\tColor.a = smoothstep(0.5 - " + width + ", 0.5 + "
+					+ width + ", " + dist + ");\n";
+			}
 			else
 			{
 				throw Exception{"Unimplemented texture type '" + etc::to_string(ch.type) + "'"};
@@ -55,6 +68,52 @@ namespace cube { namespace gl { namespace material {
 		return res;
 	}
 
+	std::string ShaderRoutine::glsl_clustered_lighting() const
+	{
+		// The cluster of the fragment gives a range of the light index
+		// list, see renderer::LightClusters for the textures layout. The
+		// light fades out smoothly at its range.
+		return
+			"\tif (cube_ClusteredLighting != 0)\n"
+			"\t{\n"
+			"\t\tvec3 EyeNorm = normalize(cube_EyeNormal);\n"
+			"\t\tvec3 v = normalize(-cube_EyePosition);\n"
+			"\t\tvec3 Cluster = floor(vec3(\n"
+				"\t\t\tgl_FragCoord.xy * cube_ClusterScale.xy,\n"
+				"\t\t\tlog(max(-cube_EyePosition.z / cube_ClusterNear, 1.0)) * cube_ClusterScale.z\n"
+			"\t\t));\n"
+			"\t\tCluster = min(Cluster, cube_ClusterSize - 1.0);\n"
+			"\t\tvec2 Range = texture2D(cube_ClusterGrid, vec2(\n"
+				"\t\t\t(Cluster.x + Cluster.y * cube_ClusterSize.x + 0.5) / (cube_ClusterSize.x * cube_ClusterSize.y),\n"
+				"\t\t\t(Cluster.z + 0.5) / cube_ClusterSize.z\n"
+			"\t\t)).rg;\n"
+			"\t\tvec3 Lit = vec3(0.0);\n"
+			"\t\tfor (float i = 0.0; i < Range.y; i += 1.0)\n"
+			"\t\t{\n"
+			"\t\t\tfloat Index = Range.x + i;\n"
+			"\t\t\tfloat Row = floor(Index / cube_ClusterTextureSize.y);\n"
+			"\t\t\tfloat Light = texture2D(cube_ClusterIndices, vec2(\n"
+				"\t\t\t\t(Index - Row * cube_ClusterTextureSize.y + 0.5) / cube_ClusterTextureSize.y,\n"
+				"\t\t\t\t(Row + 0.5) / cube_ClusterTextureSize.z\n"
+			"\t\t\t)).r;\n"
+			"\t\t\tfloat u = (Light + 0.5) / cube_ClusterTextureSize.x;\n"
+			"\t\t\tvec4 Position = texture2D(cube_ClusterLights, vec2(u, 0.5 / 3.0));\n"
+			"\t\t\tvec3 Diffuse = texture2D(cube_ClusterLights, vec2(u, 1.5 / 3.0)).rgb;\n"
+			"\t\t\tvec3 Specular = texture2D(cube_ClusterLights, vec2(u, 2.5 / 3.0)).rgb;\n"
+			"\t\t\tvec3 d = Position.xyz - cube_EyePosition;\n"
+			"\t\t\tfloat Falloff = clamp(1.0 - dot(d, d) * Position.w * Position.w, 0.0, 1.0);\n"
+			"\t\t\tvec3 s = normalize(d);\n"
+			"\t\t\tvec3 r = reflect(-s, EyeNorm);\n"
+			"\t\t\tLit += Falloff * Falloff * (\n"
+				"\t\t\t\tcube_Diffuse * Diffuse * max(dot(s, EyeNorm), 0.0) +\n"
+				"\t\t\t\tcube_Specular * Specular * pow(max(dot(r, v), 0.0), cube_Shininess)\n"
+			"\t\t\t);\n"
+			"\t\t}\n"
+			"\t\tColor = clamp(Color + vec4(Lit, 0.0), 0.0, 1.0);\n"
+			"\t}\n"
+		;
+	}
+
 	std::string ShaderRoutine::glsl_source_vertex() const
 	{
 		std::string res;
@@ -92,6 +151,8 @@ namespace cube { namespace gl { namespace material {
 			"\tvec3 EyeNorm = "
 				"normalize(cube_Normal * cube_VertexNormal);\n"
 			"\tvec4 Eye = cube_ModelView * vec4(cube_Vertex, 1);\n"
+			"\tcube_EyePosition = Eye.xyz;\n"
+			"\tcube_EyeNormal = EyeNorm;\n"
 			"\tfor (int i = 0; i < cube_PointLightCount; i++)\n"
 			"\t{\n"
 			"\t\tvec3 s = normalize(cube_PointLightPosition[i].xyz - Eye.xyz);\n"
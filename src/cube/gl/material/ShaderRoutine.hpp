@@ -17,6 +17,8 @@ namespace cube { namespace gl { namespace material {
 		std::string glsl_source() const override;
 		std::string glsl_source_fragment() const;
 		std::string glsl_source_vertex() const;
+		/// Per fragment lighting from the light clusters.
+		std::string glsl_clustered_lighting() const;
 	};
 
 }}}
@@ -1,5 +1,8 @@
 #include "matrix.hpp"
 
+#include <etc/test.hpp>
+
+#include <cmath>
 #include <ostream>
 
 using namespace cube::gl::matrix;
@@ -21,3 +24,25 @@ operator <<(std::ostream& out,
 	return out;
 }
 
+
+namespace {
+
+	using cube::gl::vector::vec3f;
+
+	ETC_TEST_CASE(multiply)
+	{
+		mat4f a = rotate(
+			translate(mat4f(1), vec3f(1, 2, 3)),
+			cube::units::deg(30),
+			vec3f(0, 1, 0)
+		);
+		mat4f b = scale(translate(mat4f(1), vec3f(-4, 5, 0)), vec3f(2, 2, 2));
+		mat4f res;
+		multiply(a, b, res);
+		mat4f expected = a * b;
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				ETC_TEST_LT(std::abs(res[i][j] - expected[i][j]), 1e-5f);
+	}
+
+}
@@ -17,6 +17,11 @@
 
 # include <iosfwd>
 
+# if defined(__SSE__) || defined(_M_X64)
+#  include <xmmintrin.h>
+#  define CUBE_GL_MATRIX_SSE 1
+# endif
+
 namespace cube { namespace gl { namespace matrix {
 
 	using glm::translate;
@@ -47,6 +52,39 @@ namespace cube { namespace gl { namespace matrix {
 	                        T const far) ETC_NOEXCEPT
 	{ return ::glm::perspective(units::rad_value(fov), aspect, near, far); }
 
+	/**
+	 * @brief Compute @a lhs * @a rhs into @a out.
+	 *
+	 * Same result as the product operator, with SSE when available. @a out
+	 * must not alias one of the operands.
+	 */
+	inline
+	void multiply(mat4f const& lhs,
+	              mat4f const& rhs,
+	              mat4f& out) ETC_NOEXCEPT
+	{
+# ifdef CUBE_GL_MATRIX_SSE
+		float const* a = &lhs[0][0];
+		float const* b = &rhs[0][0];
+		float* r = &out[0][0];
+		__m128 const c0 = _mm_loadu_ps(a);
+		__m128 const c1 = _mm_loadu_ps(a + 4);
+		__m128 const c2 = _mm_loadu_ps(a + 8);
+		__m128 const c3 = _mm_loadu_ps(a + 12);
+		for (int i = 0; i < 4; ++i)
+		{
+			// Column i of the result is lhs * (column i of rhs).
+			__m128 col = _mm_mul_ps(c0, _mm_set1_ps(b[4 * i]));
+			col = _mm_add_ps(col, _mm_mul_ps(c1, _mm_set1_ps(b[4 * i + 1])));
+			col = _mm_add_ps(col, _mm_mul_ps(c2, _mm_set1_ps(b[4 * i + 2])));
+			col = _mm_add_ps(col, _mm_mul_ps(c3, _mm_set1_ps(b[4 * i + 3])));
+			_mm_storeu_ps(r + 4 * i, col);
+		}
+# else
+		out = lhs * rhs;
+# endif
+	}
+
 
 }}}
 
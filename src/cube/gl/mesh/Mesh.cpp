@@ -1,5 +1,6 @@
 #include "Mesh.hpp"
 
+#include <cube/gl/bounds.hpp>
 #include <cube/gl/content_traits.hpp>
 #include <cube/gl/exception.hpp>
 #include <cube/gl/renderer/Drawable.hpp>
@@ -259,6 +260,74 @@ namespace cube { namespace gl { namespace mesh {
 		};
 	}
 
+	bounds::AABBf Mesh::bounds() const
+	{
+		bounds::AABBf res;
+		for (auto const& vertex: _this->vertice.data)
+			res.extend(vertex);
+		return res;
+	}
+
+	std::vector<Mesh::vertex_t> const& Mesh::vertice() const
+	{ return _this->vertice.data; }
+
+	std::vector<uint32_t> Mesh::triangles() const
+	{
+		std::vector<uint32_t> res;
+		for (auto const& pair: _this->indice)
+		{
+			auto const& idx = pair.second;
+			etc::size_type const size = idx.size();
+			switch (pair.first)
+			{
+			case Mode::triangles:
+				res.insert(res.end(), idx.begin(), idx.end() - size % 3);
+				break;
+			case Mode::triangle_strip:
+				for (etc::size_type i = 2; i < size; ++i)
+				{
+					// Keep the winding of odd triangles.
+					res.push_back(idx[i - 2 + i % 2]);
+					res.push_back(idx[i - 1 - i % 2]);
+					res.push_back(idx[i]);
+				}
+				break;
+			case Mode::triangle_fan:
+			case Mode::polygon:
+				for (etc::size_type i = 2; i < size; ++i)
+				{
+					res.push_back(idx[0]);
+					res.push_back(idx[i - 1]);
+					res.push_back(idx[i]);
+				}
+				break;
+			case Mode::quads:
+				for (etc::size_type i = 0; i + 3 < size; i += 4)
+				{
+					uint32_t const q[6] = {
+						idx[i], idx[i + 1], idx[i + 2],
+						idx[i], idx[i + 2], idx[i + 3],
+					};
+					res.insert(res.end(), q, q + 6);
+				}
+				break;
+			case Mode::quad_strip:
+				for (etc::size_type i = 0; i + 3 < size; i += 2)
+				{
+					uint32_t const q[6] = {
+						idx[i], idx[i + 1], idx[i + 3],
+						idx[i], idx[i + 3], idx[i + 2],
+					};
+					res.insert(res.end(), q, q + 6);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+		return res;
+	}
+
 	void
 	Mesh::_push(Kind const kind, Mode const mode, vertex_t const& el)
 	{
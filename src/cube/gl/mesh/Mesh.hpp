@@ -11,6 +11,7 @@
 
 # include <iosfwd>
 # include <memory>
+# include <vector>
 
 namespace cube { namespace gl { namespace mesh {
 
@@ -140,6 +141,22 @@ namespace cube { namespace gl { namespace mesh {
 		renderer::DrawablePtr
 		drawable(renderer::Renderer& renderer) const;
 
+		/**
+		 * @brief Bounding box of the vertice, empty when there is none.
+		 */
+		bounds::AABBf bounds() const;
+
+		/// Vertice of the mesh.
+		std::vector<vertex_t> const& vertice() const;
+
+		/**
+		 * @brief Vertex indices of the triangles of the mesh.
+		 *
+		 * Strips, fans, quads and polygons are split in triangles, points and
+		 * lines are ignored.
+		 */
+		std::vector<uint32_t> triangles() const;
+
 	protected:
 		template<typename T>
 		inline
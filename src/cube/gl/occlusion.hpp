@@ -0,0 +1,6 @@
+#ifndef  CUBE_GL_OCCLUSION_HPP
+# define CUBE_GL_OCCLUSION_HPP
+
+# include "occlusion/Culler.hpp"
+
+#endif
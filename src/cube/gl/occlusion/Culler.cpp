@@ -0,0 +1,665 @@
+#include "Culler.hpp"
+
+#include <cube/debug.hpp>
+#include <cube/gl/bounds.hpp>
+#include <cube/gl/exception.hpp>
+#include <cube/gl/mesh.hpp>
+
+#include <etc/assert.hpp>
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+#include <etc/to_string.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace cube { namespace gl { namespace occlusion {
+
+	ETC_LOG_COMPONENT("cube.gl.occlusion.Culler");
+
+	using exception::Exception;
+	using vector::vec3f;
+
+	namespace {
+
+		etc::size_type const tile_size = Culler::tile_width * Culler::tile_height;
+
+		// Vertices closer to the eye (in clip space) are not projected.
+		float const near_w = 1e-5f;
+
+		struct ClipVertex
+		{
+			float x, y, z, w;
+		};
+
+		/// Screen space triangle.
+		struct Triangle
+		{
+			// Edge functions a * x + b * y + c, positive inside.
+			float a[3], b[3], c[3];
+			// Depth plane.
+			float da, db, dc;
+			// Covered pixels, max excluded.
+			int32_t x0, y0, x1, y1;
+		};
+
+		/// Column major matrix times (p, 1).
+		inline
+		ClipVertex transform(float const* m, vec3f const& p) ETC_NOEXCEPT
+		{
+			ClipVertex res;
+# ifdef CUBE_GL_MATRIX_SSE
+			__m128 r = _mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(p.x));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(p.y)));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(p.z)));
+			r = _mm_add_ps(r, _mm_loadu_ps(m + 12));
+			_mm_storeu_ps(&res.x, r);
+# else
+			float* out = &res.x;
+			for (int i = 0; i < 4; ++i)
+				out[i] = m[i] * p.x + m[4 + i] * p.y + m[8 + i] * p.z + m[12 + i];
+# endif
+			return res;
+		}
+
+		inline
+		int32_t clamp_pixel(float const value, etc::size_type const max)
+		{
+			return static_cast<int32_t>(
+				std::min(std::max(value, 0.0f), static_cast<float>(max))
+			);
+		}
+
+		etc::size_type default_threads()
+		{
+			etc::size_type count = std::thread::hardware_concurrency();
+			return std::min<etc::size_type>(std::max<etc::size_type>(count, 1), 4);
+		}
+
+	} // !anonymous
+
+	struct Culler::Impl
+	{
+		etc::size_type const            tiles_x;
+		etc::size_type const            tiles_y;
+		etc::size_type const            width;
+		etc::size_type const            height;
+		matrix::mat4f                   view_projection;
+		// Tile major: the pixels of a tile are contiguous.
+		std::vector<float>              depth;
+		// Farthest depth of each tile.
+		std::vector<float>              tile_max;
+		std::vector<Triangle>           triangles;
+		// Triangles overlapping each tile.
+		std::vector<std::vector<uint32_t>> bins;
+		Stats                           stats;
+		bool                            rasterized;
+
+		std::mutex                      mutex;
+		std::condition_variable         condition;
+		std::condition_variable         done;
+		std::vector<std::thread>        workers;
+		bool                            running;
+		etc::size_type                  generation;
+		etc::size_type                  busy;
+		std::atomic<etc::size_type>     next_tile;
+
+		Impl(etc::size_type const width, etc::size_type const height)
+			: tiles_x{(width + tile_width - 1) / tile_width}
+			, tiles_y{(height + tile_height - 1) / tile_height}
+			, width{tiles_x * tile_width}
+			, height{tiles_y * tile_height}
+			, view_projection{1}
+			, depth(tiles_x * tiles_y * tile_size, 1.0f)
+			, tile_max(tiles_x * tiles_y, 1.0f)
+			, triangles{}
+			, bins(tiles_x * tiles_y)
+			, stats{0, 0, 0, 0}
+			, rasterized{false}
+			, running{true}
+			, generation{0}
+			, busy{0}
+			, next_tile{0}
+		{}
+
+		inline
+		float& pixel(etc::size_type const x, etc::size_type const y)
+		{
+			return this->depth[
+				((y / tile_height) * this->tiles_x + x / tile_width) * tile_size +
+				(y % tile_height) * tile_width + x % tile_width
+			];
+		}
+
+		void setup(ClipVertex const* v[3])
+		{
+			float x[3], y[3], d[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				if (v[i]->w < near_w)
+				{
+					// Clipping would only add small triangles close to the
+					// eye, dropping the occluder is conservative.
+					this->stats.clipped += 1;
+					return;
+				}
+				float const inv_w = 1.0f / v[i]->w;
+				x[i] = (v[i]->x * inv_w * 0.5f + 0.5f) * this->width;
+				y[i] = (v[i]->y * inv_w * 0.5f + 0.5f) * this->height;
+				d[i] = v[i]->z * inv_w * 0.5f + 0.5f;
+			}
+			float area = (x[1] - x[0]) * (y[2] - y[0]) -
+			             (x[2] - x[0]) * (y[1] - y[0]);
+			if (std::abs(area) < 1e-8f)
+				return;
+			if (area < 0)
+			{
+				std::swap(x[1], x[2]);
+				std::swap(y[1], y[2]);
+				std::swap(d[1], d[2]);
+				area = -area;
+			}
+
+			Triangle t;
+			t.x0 = clamp_pixel(std::floor(std::min({x[0], x[1], x[2]})), this->width);
+			t.y0 = clamp_pixel(std::floor(std::min({y[0], y[1], y[2]})), this->height);
+			t.x1 = clamp_pixel(std::ceil(std::max({x[0], x[1], x[2]})), this->width);
+			t.y1 = clamp_pixel(std::ceil(std::max({y[0], y[1], y[2]})), this->height);
+			if (t.x0 >= t.x1 || t.y0 >= t.y1)
+				return;
+			for (int i = 0; i < 3; ++i)
+			{
+				int const j = (i + 1) % 3;
+				t.a[i] = y[i] - y[j];
+				t.b[i] = x[j] - x[i];
+				t.c[i] = -(t.a[i] * x[i] + t.b[i] * y[i]);
+			}
+			t.da = ((d[1] - d[0]) * (y[2] - y[0]) -
+			        (d[2] - d[0]) * (y[1] - y[0])) / area;
+			t.db = ((d[2] - d[0]) * (x[1] - x[0]) -
+			        (d[1] - d[0]) * (x[2] - x[0])) / area;
+			t.dc = d[0] - t.da * x[0] - t.db * y[0];
+
+			uint32_t const index = static_cast<uint32_t>(this->triangles.size());
+			this->triangles.push_back(t);
+			this->stats.triangles += 1;
+			for (etc::size_type ty = t.y0 / tile_height;
+			     ty <= (t.y1 - 1) / tile_height; ++ty)
+				for (etc::size_type tx = t.x0 / tile_width;
+				     tx <= (t.x1 - 1) / tile_width; ++tx)
+					this->bins[ty * this->tiles_x + tx].push_back(index);
+		}
+
+		void rasterize_tile(etc::size_type const tile)
+		{
+			auto const& bin = this->bins[tile];
+			if (bin.empty())
+				return;
+			float* pixels = &this->depth[tile * tile_size];
+			int32_t const px = static_cast<int32_t>((tile % this->tiles_x) * tile_width);
+			int32_t const py = static_cast<int32_t>((tile / this->tiles_x) * tile_height);
+			for (uint32_t index: bin)
+			{
+				Triangle const& t = this->triangles[index];
+				int32_t const xa = std::max(t.x0, px) - px;
+				int32_t const xb = std::min<int32_t>(t.x1, px + tile_width) - px;
+				int32_t const ya = std::max(t.y0, py) - py;
+				int32_t const yb = std::min<int32_t>(t.y1, py + tile_height) - py;
+				for (int32_t y = ya; y < yb; ++y)
+				{
+					float const fy = py + y + 0.5f;
+					float const e0 = t.b[0] * fy + t.c[0];
+					float const e1 = t.b[1] * fy + t.c[1];
+					float const e2 = t.b[2] * fy + t.c[2];
+					float const dy = t.db * fy + t.dc;
+					float* row = pixels + y * tile_width;
+# ifdef CUBE_GL_MATRIX_SSE
+					__m128 const zero = _mm_setzero_ps();
+					__m128 const lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+					for (int32_t x = xa & ~3; x < xb; x += 4)
+					{
+						__m128 const fx = _mm_add_ps(_mm_set1_ps(float(px + x)), lanes);
+						__m128 inside = _mm_cmpge_ps(
+							_mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[0]), fx), _mm_set1_ps(e0)),
+							zero
+						);
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(
+							_mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[1]), fx), _mm_set1_ps(e1)),
+							zero
+						));
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(
+							_mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[2]), fx), _mm_set1_ps(e2)),
+							zero
+						));
+						__m128 const d = _mm_add_ps(
+							_mm_mul_ps(_mm_set1_ps(t.da), fx), _mm_set1_ps(dy)
+						);
+						__m128 current = _mm_loadu_ps(row + x);
+						__m128 const closer = _mm_and_ps(inside, _mm_cmplt_ps(d, current));
+						current = _mm_or_ps(_mm_and_ps(closer, d),
+						                    _mm_andnot_ps(closer, current));
+						_mm_storeu_ps(row + x, current);
+					}
+# else
+					for (int32_t x = xa; x < xb; ++x)
+					{
+						float const fx = px + x + 0.5f;
+						if (t.a[0] * fx + e0 >= 0 &&
+						    t.a[1] * fx + e1 >= 0 &&
+						    t.a[2] * fx + e2 >= 0)
+						{
+							float const d = t.da * fx + dy;
+							if (d < row[x])
+								row[x] = d;
+						}
+					}
+# endif
+				}
+			}
+			this->tile_max[tile] = *std::max_element(pixels, pixels + tile_size);
+		}
+
+		void rasterize_tiles()
+		{
+			etc::size_type const count = this->bins.size();
+			while (true)
+			{
+				etc::size_type tile = this->next_tile++;
+				if (tile >= count)
+					return;
+				this->rasterize_tile(tile);
+			}
+		}
+
+		void worker()
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			etc::size_type seen = 0;
+			while (true)
+			{
+				this->condition.wait(lock, [&] {
+					return !this->running || this->generation != seen;
+				});
+				if (!this->running)
+					return;
+				seen = this->generation;
+				lock.unlock();
+				this->rasterize_tiles();
+				lock.lock();
+				if (--this->busy == 0)
+					this->done.notify_all();
+			}
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> guard(this->mutex);
+				this->running = false;
+			}
+			this->condition.notify_all();
+			for (auto& thread: this->workers)
+				if (thread.joinable())
+					thread.join();
+			this->workers.clear();
+		}
+	};
+
+	Culler::Culler(etc::size_type const width,
+	               etc::size_type const height,
+	               etc::size_type const threads)
+		: _this{new Impl{width, height}}
+	{
+		etc::size_type count = threads == 0 ? default_threads() : threads;
+		ETC_TRACE_CTOR(_this->width, 'x', _this->height, "with", count,
+		               "threads");
+		if (width == 0 || height == 0)
+			throw Exception{"Cannot cull with an empty depth buffer"};
+		try
+		{
+			for (etc::size_type i = 1; i < count; ++i)
+				_this->workers.emplace_back([this] { _this->worker(); });
+		}
+		catch (...)
+		{
+			_this->stop();
+			throw;
+		}
+	}
+
+	Culler::~Culler()
+	{
+		ETC_TRACE_DTOR();
+		_this->stop();
+	}
+
+	void Culler::clear(matrix::mat4f const& view_projection)
+	{
+		_this->view_projection = view_projection;
+		std::fill(_this->depth.begin(), _this->depth.end(), 1.0f);
+		std::fill(_this->tile_max.begin(), _this->tile_max.end(), 1.0f);
+		_this->triangles.clear();
+		for (auto& bin: _this->bins)
+			bin.clear();
+		_this->stats = Stats{0, 0, 0, 0};
+		_this->rasterized = false;
+	}
+
+	void Culler::add_occluder(std::vector<vec3f> const& vertices,
+	                          std::vector<uint32_t> const& indices,
+	                          matrix::mat4f const& model)
+	{
+		if (indices.size() % 3 != 0)
+			throw Exception{
+				"Occluder indices are not triangles (" +
+				etc::to_string(indices.size()) + " indices)"
+			};
+		matrix::mat4f mvp;
+		matrix::multiply(_this->view_projection, model, mvp);
+		float const* m = &mvp[0][0];
+		std::vector<ClipVertex> clip;
+		clip.reserve(vertices.size());
+		for (auto const& vertex: vertices)
+			clip.push_back(transform(m, vertex));
+		ClipVertex const* triangle[3];
+		for (etc::size_type i = 0; i < indices.size(); i += 3)
+		{
+			for (etc::size_type j = 0; j < 3; ++j)
+			{
+				if (indices[i + j] >= clip.size())
+					throw Exception{
+						"Invalid occluder vertex index " +
+						etc::to_string(indices[i + j])
+					};
+				triangle[j] = &clip[indices[i + j]];
+			}
+			_this->setup(triangle);
+		}
+	}
+
+	void Culler::add_occluder(mesh::Mesh const& mesh,
+	                          matrix::mat4f const& model)
+	{ this->add_occluder(mesh.vertice(), mesh.triangles(), model); }
+
+	void Culler::rasterize()
+	{
+		CUBE_DEBUG_PERFORMANCE_SECTION("cube.gl.occlusion.Culler");
+		_this->next_tile = 0;
+		if (_this->workers.empty())
+			_this->rasterize_tiles();
+		else
+		{
+			{
+				std::lock_guard<std::mutex> guard(_this->mutex);
+				_this->busy = _this->workers.size();
+				_this->generation += 1;
+			}
+			_this->condition.notify_all();
+			_this->rasterize_tiles();
+			std::unique_lock<std::mutex> lock(_this->mutex);
+			_this->done.wait(lock, [&] { return _this->busy == 0; });
+		}
+		_this->rasterized = true;
+		ETC_LOG.debug("Rasterized", _this->stats.triangles, "triangles,",
+		              _this->stats.clipped, "clipped");
+		CUBE_DEBUG_COUNTER("cube.gl.occlusion.Culler.triangles",
+		                   _this->stats.triangles);
+	}
+
+	bool Culler::visible(bounds::AABBf const& box) const
+	{
+		if (box.empty())
+			return false;
+		_this->stats.tested += 1;
+		if (box.is_infinite() || !_this->rasterized ||
+		    _this->triangles.empty())
+			return true;
+
+		float const* m = &_this->view_projection[0][0];
+		float min_x = std::numeric_limits<float>::max();
+		float min_y = min_x;
+		float min_d = min_x;
+		float max_x = -min_x;
+		float max_y = -min_x;
+		for (int i = 0; i < 8; ++i)
+		{
+			ClipVertex const v = transform(m, vec3f(
+				(i & 1) ? box.max.x : box.min.x,
+				(i & 2) ? box.max.y : box.min.y,
+				(i & 4) ? box.max.z : box.min.z
+			));
+			if (v.w < near_w)
+				return true;
+			float const inv_w = 1.0f / v.w;
+			float const x = (v.x * inv_w * 0.5f + 0.5f) * _this->width;
+			float const y = (v.y * inv_w * 0.5f + 0.5f) * _this->height;
+			min_x = std::min(min_x, x);
+			max_x = std::max(max_x, x);
+			min_y = std::min(min_y, y);
+			max_y = std::max(max_y, y);
+			min_d = std::min(min_d, v.z * inv_w * 0.5f + 0.5f);
+		}
+		int32_t const x0 = clamp_pixel(std::floor(min_x), _this->width);
+		int32_t const y0 = clamp_pixel(std::floor(min_y), _this->height);
+		int32_t const x1 = clamp_pixel(std::ceil(max_x), _this->width);
+		int32_t const y1 = clamp_pixel(std::ceil(max_y), _this->height);
+		if (x0 < x1 && y0 < y1)
+		{
+			for (int32_t ty = y0 / tile_height; ty <= (y1 - 1) / tile_height; ++ty)
+				for (int32_t tx = x0 / tile_width; tx <= (x1 - 1) / tile_width; ++tx)
+				{
+					etc::size_type const tile = ty * _this->tiles_x + tx;
+					// The whole tile is closer than the box.
+					if (_this->tile_max[tile] < min_d)
+						continue;
+					float const* pixels = &_this->depth[tile * tile_size];
+					int32_t const px = tx * tile_width;
+					int32_t const py = ty * tile_height;
+					for (int32_t y = std::max(y0, py);
+					     y < std::min<int32_t>(y1, py + tile_height); ++y)
+						for (int32_t x = std::max(x0, px);
+						     x < std::min<int32_t>(x1, px + tile_width); ++x)
+							if (min_d <= pixels[(y - py) * tile_width + x - px])
+								return true;
+				}
+		}
+		_this->stats.occluded += 1;
+		return false;
+	}
+
+	etc::size_type Culler::width() const ETC_NOEXCEPT
+	{ return _this->width; }
+
+	etc::size_type Culler::height() const ETC_NOEXCEPT
+	{ return _this->height; }
+
+	etc::size_type Culler::threads() const ETC_NOEXCEPT
+	{ return _this->workers.size() + 1; }
+
+	Culler::Stats const& Culler::stats() const ETC_NOEXCEPT
+	{ return _this->stats; }
+
+	float Culler::depth(etc::size_type const x, etc::size_type const y) const
+	{
+		if (x >= _this->width || y >= _this->height)
+			throw Exception{
+				"Invalid pixel " + etc::to_string(x) + "x" + etc::to_string(y)
+			};
+		return _this->pixel(x, y);
+	}
+
+	namespace {
+
+		using bounds::AABBf;
+
+		// A quad covering [-1, 1] x [-1, 1] at depth z.
+		void add_wall(Culler& culler, float const z, float const size = 1)
+		{
+			culler.add_occluder(
+				{
+					vec3f(-size, -size, z),
+					vec3f(size, -size, z),
+					vec3f(size, size, z),
+					vec3f(-size, size, z),
+				},
+				{0, 1, 2, 0, 2, 3},
+				matrix::mat4f(1)
+			);
+		}
+
+		ETC_TEST_CASE(culler_wall)
+		{
+			Culler culler{64, 32, 1};
+			culler.clear(matrix::mat4f(1));
+			add_wall(culler, 0);
+			culler.rasterize();
+			ETC_ENFORCE_EQ(culler.stats().triangles, 2u);
+			ETC_ENFORCE_EQ(culler.depth(0, 0), 0.5f);
+			ETC_ENFORCE_EQ(culler.depth(63, 31), 0.5f);
+
+			ETC_ENFORCE(!culler.visible(AABBf{vec3f(-.5f, -.5f, .2f),
+			                                  vec3f(.5f, .5f, .4f)}));
+			ETC_ENFORCE(culler.visible(AABBf{vec3f(-.5f, -.5f, -.4f),
+			                                 vec3f(.5f, .5f, -.2f)}));
+			// Crossing the wall.
+			ETC_ENFORCE(culler.visible(AABBf{vec3f(-.5f, -.5f, -.2f),
+			                                 vec3f(.5f, .5f, .2f)}));
+			ETC_ENFORCE(culler.visible(AABBf::infinite()));
+			ETC_ENFORCE(!culler.visible(AABBf{}));
+			ETC_ENFORCE_EQ(culler.stats().occluded, 1u);
+		}
+
+		ETC_TEST_CASE(culler_partial_wall)
+		{
+			Culler culler{64, 64, 1};
+			culler.clear(matrix::mat4f(1));
+			culler.add_occluder(
+				{vec3f(-1, -1, 0), vec3f(0, -1, 0),
+				 vec3f(0, 1, 0), vec3f(-1, 1, 0)},
+				{0, 1, 2, 0, 2, 3},
+				matrix::mat4f(1)
+			);
+			culler.rasterize();
+			ETC_ENFORCE_EQ(culler.depth(10, 10), 0.5f);
+			ETC_ENFORCE_EQ(culler.depth(40, 10), 1.0f);
+			// Behind the left half only.
+			ETC_ENFORCE(!culler.visible(AABBf{vec3f(-.8f, -.5f, .5f),
+			                                  vec3f(-.2f, .5f, .6f)}));
+			// Overlaps the uncovered half.
+			ETC_ENFORCE(culler.visible(AABBf{vec3f(-.5f, -.5f, .5f),
+			                                 vec3f(.5f, .5f, .6f)}));
+			// Nothing is drawn outside the screen.
+			ETC_ENFORCE(!culler.visible(AABBf{vec3f(2, 2, .5f),
+			                                  vec3f(3, 3, .6f)}));
+		}
+
+		ETC_TEST_CASE(culler_near_plane)
+		{
+			auto projection = matrix::perspective<float>(
+				units::deg(60), 1.0f, 0.1f, 100.0f
+			);
+			Culler culler{32, 32, 1};
+			culler.clear(projection);
+			// The wall covers the screen, the triangle goes behind the eye.
+			add_wall(culler, -5, 10);
+			culler.add_occluder(
+				{vec3f(-1, -1, -1), vec3f(1, -1, -1), vec3f(0, 1, 10)},
+				{0, 1, 2},
+				matrix::mat4f(1)
+			);
+			culler.rasterize();
+			ETC_ENFORCE_EQ(culler.stats().triangles, 2u);
+			ETC_ENFORCE_EQ(culler.stats().clipped, 1u);
+			ETC_ENFORCE(!culler.visible(AABBf{vec3f(-1, -1, -20),
+			                                  vec3f(1, 1, -10)}));
+			ETC_ENFORCE(culler.visible(AABBf{vec3f(-1, -1, -4),
+			                                 vec3f(1, 1, -3)}));
+			// Around the eye.
+			ETC_ENFORCE(culler.visible(AABBf{vec3f(-1), vec3f(1)}));
+		}
+
+		ETC_TEST_CASE(culler_threads)
+		{
+			std::mt19937 gen{42};
+			std::uniform_real_distribution<float> coord{-1.2f, 1.2f};
+			std::vector<vec3f> vertices;
+			std::vector<uint32_t> indices;
+			for (uint32_t i = 0; i < 3000; ++i)
+			{
+				vertices.emplace_back(coord(gen), coord(gen), coord(gen) * .8f);
+				indices.push_back(i);
+			}
+			Culler single{128, 64, 1};
+			Culler multi{128, 64, 4};
+			ETC_ENFORCE_EQ(multi.threads(), 4u);
+			for (Culler* culler: {&single, &multi})
+			{
+				culler->clear(matrix::mat4f(1));
+				culler->add_occluder(vertices, indices, matrix::mat4f(1));
+				culler->rasterize();
+			}
+			for (etc::size_type y = 0; y < 64; ++y)
+				for (etc::size_type x = 0; x < 128; ++x)
+					ETC_ENFORCE_EQ(single.depth(x, y), multi.depth(x, y));
+		}
+
+		ETC_BENCHMARK_CASE(culler_benchmark)
+		{
+			typedef std::chrono::steady_clock clock_type;
+			std::mt19937 gen{1};
+			std::uniform_real_distribution<float> coord{-1.0f, 1.0f};
+			std::uniform_real_distribution<float> size{0.01f, 0.2f};
+			std::vector<vec3f> vertices;
+			std::vector<uint32_t> indices;
+			for (uint32_t i = 0; i < 2000; ++i)
+			{
+				vec3f c{coord(gen), coord(gen), coord(gen)};
+				float s = size(gen);
+				vertices.push_back(c + vec3f(-s, -s, 0));
+				vertices.push_back(c + vec3f(s, -s, 0));
+				vertices.push_back(c + vec3f(0, s, 0));
+				indices.push_back(3 * i);
+				indices.push_back(3 * i + 1);
+				indices.push_back(3 * i + 2);
+			}
+			std::vector<AABBf> boxes;
+			for (int i = 0; i < 10000; ++i)
+			{
+				vec3f c{coord(gen), coord(gen), coord(gen)};
+				float s = size(gen);
+				boxes.emplace_back(c - vec3f(s), c + vec3f(s));
+			}
+			Culler culler{256, 128};
+			auto start = clock_type::now();
+			culler.clear(matrix::mat4f(1));
+			culler.add_occluder(vertices, indices, matrix::mat4f(1));
+			culler.rasterize();
+			auto rasterized = clock_type::now();
+			etc::size_type hidden = 0;
+			for (auto const& box: boxes)
+				if (!culler.visible(box))
+					hidden += 1;
+			auto tested = clock_type::now();
+			ETC_ENFORCE_EQ(hidden, culler.stats().occluded);
+			ETC_LOG.info(
+				"Rasterized", culler.stats().triangles, "triangles with",
+				culler.threads(), "threads in",
+				std::chrono::duration_cast<std::chrono::microseconds>(
+					rasterized - start
+				).count(), "us, tested", boxes.size(), "boxes in",
+				std::chrono::duration_cast<std::chrono::microseconds>(
+					tested - rasterized
+				).count(), "us (" + etc::to_string(hidden), "hidden)"
+			);
+		}
+
+	} // !anonymous
+
+}}}
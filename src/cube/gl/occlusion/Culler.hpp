@@ -0,0 +1,114 @@
+#ifndef  CUBE_GL_OCCLUSION_CULLER_HPP
+# define CUBE_GL_OCCLUSION_CULLER_HPP
+
+# include <cube/api.hpp>
+# include <cube/gl/fwd.hpp>
+# include <cube/gl/matrix.hpp>
+# include <cube/gl/vector.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <memory>
+# include <vector>
+
+namespace cube { namespace gl { namespace occlusion {
+
+	/**
+	 * @brief Software occlusion culling.
+	 *
+	 * A few big occluders are rasterized on the CPU in a small depth buffer,
+	 * then bounding boxes are tested against it: a box entirely behind the
+	 * occluders at every pixel it covers cannot be seen.
+	 *
+	 * The depth buffer is split in tiles of tile_width x tile_height pixels.
+	 * Triangles are binned per tile, and tiles are rasterized in parallel,
+	 * four pixels at a time when SSE is available. The farthest depth of
+	 * each tile is kept to reject most boxes without looking at the pixels.
+	 *
+	 * A frame goes as follow:
+	 *  - clear() with the view projection matrix;
+	 *  - add_occluder() for every occluder;
+	 *  - rasterize();
+	 *  - visible() for every box to test.
+	 *
+	 * Depths are stored in [0, 1], 1 being the far plane.
+	 */
+	class CUBE_API Culler
+	{
+	public:
+		static etc::size_type const tile_width = 8;
+		static etc::size_type const tile_height = 8;
+
+		/// Statistics since the last clear().
+		struct Stats
+		{
+			/// Occluder triangles rasterized.
+			etc::size_type triangles;
+			/// Occluder triangles ignored because they cross the near plane.
+			etc::size_type clipped;
+			/// Boxes tested.
+			etc::size_type tested;
+			/// Boxes found hidden.
+			etc::size_type occluded;
+		};
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _this;
+
+	public:
+		/**
+		 * @brief Create a culler.
+		 *
+		 * @param   width       Depth buffer width, rounded up to tiles.
+		 * @param   height      Depth buffer height, rounded up to tiles.
+		 * @param   threads     Threads used to rasterize, the calling one
+		 *                      included. 0 picks a value from the hardware.
+		 */
+		Culler(etc::size_type const width,
+		       etc::size_type const height,
+		       etc::size_type const threads = 0);
+		~Culler();
+
+	public:
+		/// Forget occluders and start a frame seen through @a view_projection.
+		void clear(matrix::mat4f const& view_projection);
+
+		/**
+		 * @brief Add occluder triangles.
+		 *
+		 * The vertices are transformed right away, the arrays are not
+		 * referenced after the call.
+		 */
+		void add_occluder(std::vector<vector::vec3f> const& vertices,
+		                  std::vector<uint32_t> const& indices,
+		                  matrix::mat4f const& model);
+
+		/// Add the triangles of a mesh.
+		void add_occluder(mesh::Mesh const& mesh, matrix::mat4f const& model);
+
+		/// Rasterize the occluders added since the last clear().
+		void rasterize();
+
+		/**
+		 * @brief Whether some part of @a box might be visible.
+		 *
+		 * The test is conservative: boxes crossing the near plane or
+		 * infinite are always visible.
+		 */
+		bool visible(bounds::AABBf const& box) const;
+
+	public:
+		etc::size_type width() const ETC_NOEXCEPT;
+		etc::size_type height() const ETC_NOEXCEPT;
+		etc::size_type threads() const ETC_NOEXCEPT;
+		Stats const& stats() const ETC_NOEXCEPT;
+
+		/// Depth stored at a pixel.
+		float depth(etc::size_type const x, etc::size_type const y) const;
+	};
+
+}}}
+
+#endif
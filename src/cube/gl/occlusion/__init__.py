@@ -0,0 +1 @@
+from .Culler import *
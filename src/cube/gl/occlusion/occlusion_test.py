@@ -0,0 +1,36 @@
+# -*- encoding: utf8 -*-
+
+from cube.gl import occlusion, Mesh, DrawMode, mat4f, vec3f
+
+from cube.test import Case
+
+class _(Case):
+
+    def setUp(self):
+        self.culler = occlusion.Culler(64, 32, threads = 1)
+        wall = Mesh()
+        wall.mode = DrawMode.quads
+        wall.append(vec3f(-1, -1, 0))
+        wall.append(vec3f(1, -1, 0))
+        wall.append(vec3f(1, 1, 0))
+        wall.append(vec3f(-1, 1, 0))
+        self.culler.clear(mat4f())
+        self.culler.add_occluder(wall, mat4f())
+        self.culler.rasterize()
+
+    def test_size(self):
+        self.assertEqual(self.culler.width, 64)
+        self.assertEqual(self.culler.height, 32)
+        self.assertEqual(self.culler.threads, 1)
+
+    def test_depth(self):
+        self.assertEqual(self.culler.depth(0, 0), 0.5)
+        self.assertEqual(self.culler.depth(63, 31), 0.5)
+
+    def test_visible(self):
+        self.assertFalse(
+            self.culler.visible(vec3f(-.5, -.5, .2), vec3f(.5, .5, .4))
+        )
+        self.assertTrue(
+            self.culler.visible(vec3f(-.5, -.5, -.4), vec3f(.5, .5, -.2))
+        )
@@ -0,0 +1,73 @@
+#include "AsyncTexture.hpp"
+
+#include "Exception.hpp"
+#include "Texture.hpp"
+
+#include <etc/assert.hpp>
+#include <etc/log.hpp>
+
+namespace cube { namespace gl { namespace renderer {
+
+	ETC_LOG_COMPONENT("cube.gl.renderer.AsyncTexture");
+
+	AsyncTexture::AsyncTexture(boost::filesystem::path path,
+	                           TexturePtr placeholder)
+		: _path{std::move(path)}
+		, _placeholder{std::move(placeholder)}
+		, _texture{}
+		, _status{Status::pending}
+		, _error{}
+		, _guard{}
+	{
+		ETC_TRACE_CTOR(_path);
+		if (_placeholder == nullptr)
+			throw Exception{"An async texture needs a placeholder"};
+	}
+
+	AsyncTexture::~AsyncTexture()
+	{ ETC_TRACE_DTOR(_path); }
+
+	Texture& AsyncTexture::texture() const ETC_NOEXCEPT
+	{ return *this->texture_ptr(); }
+
+	TexturePtr const& AsyncTexture::texture_ptr() const ETC_NOEXCEPT
+	{
+		if (_status.load() == Status::ready)
+			return _texture;
+		return _placeholder;
+	}
+
+	void AsyncTexture::bind_unit(etc::size_type unit,
+	                             ShaderProgramParameter& param)
+	{ this->texture().bind_unit(unit, param); }
+
+	void AsyncTexture::_bind()
+	{
+		ETC_ASSERT_EQ(_guard, nullptr);
+		_guard.reset(new Guard{this->texture(), this->shared_state()});
+	}
+
+	void AsyncTexture::_unbind() ETC_NOEXCEPT
+	{ _guard.reset(); }
+
+	void AsyncTexture::_set_status(Status status) ETC_NOEXCEPT
+	{ _status.store(status); }
+
+	void AsyncTexture::_set_texture(TexturePtr texture)
+	{
+		ETC_ASSERT_NEQ(texture, nullptr);
+		// The handle might be bound while the upload happens, the swap will
+		// be visible at the next bind.
+		_texture = std::move(texture);
+		_status.store(Status::ready);
+		ETC_LOG.debug("Texture", _path, "is ready");
+	}
+
+	void AsyncTexture::_set_error(std::string error)
+	{
+		ETC_LOG.warn("Couldn't load texture", _path, ':', error);
+		_error = std::move(error);
+		_status.store(Status::failed);
+	}
+
+}}}
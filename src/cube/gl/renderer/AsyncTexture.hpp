@@ -0,0 +1,92 @@
+#ifndef  CUBE_GL_RENDERER_ASYNCTEXTURE_HPP
+# define CUBE_GL_RENDERER_ASYNCTEXTURE_HPP
+
+# include "Bindable.hpp"
+# include "fwd.hpp"
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <wrappers/boost/filesystem.hpp>
+
+# include <atomic>
+# include <memory>
+# include <string>
+
+namespace cube { namespace gl { namespace renderer {
+
+	/**
+	 * @brief Handle on a texture that is being loaded in background.
+	 *
+	 * Returned immediately by Renderer::new_texture_async(). Until the image
+	 * is decoded and uploaded, the handle forwards to a placeholder texture,
+	 * so it can be bound or assigned to a sampler right away.
+	 */
+	class CUBE_API AsyncTexture
+		: public Bindable
+	{
+	public:
+		enum class Status
+		{
+			pending,   ///< Queued or being decoded.
+			decoded,   ///< Pixels are waiting for an upload slot.
+			ready,     ///< The real texture is resident.
+			failed,    ///< Decoding or upload failed, see error().
+		};
+
+	private:
+		boost::filesystem::path _path;
+		TexturePtr              _placeholder;
+		TexturePtr              _texture;
+		std::atomic<Status>     _status;
+		std::string             _error;
+		std::unique_ptr<Guard>  _guard;
+
+	public:
+		AsyncTexture(boost::filesystem::path path, TexturePtr placeholder);
+		~AsyncTexture();
+
+	public:
+		/// Path of the image.
+		inline
+		boost::filesystem::path const& path() const ETC_NOEXCEPT
+		{ return _path; }
+
+		/// Current loading status.
+		inline
+		Status status() const ETC_NOEXCEPT
+		{ return _status.load(); }
+
+		/// True when the real texture is available.
+		inline
+		bool ready() const ETC_NOEXCEPT
+		{ return _status.load() == Status::ready; }
+
+		/// Error message when the status is Status::failed.
+		std::string const& error() const ETC_NOEXCEPT
+		{ return _error; }
+
+		/// The real texture when ready, the placeholder otherwise.
+		Texture& texture() const ETC_NOEXCEPT;
+
+		/// Same as texture(), as a shared pointer.
+		TexturePtr const& texture_ptr() const ETC_NOEXCEPT;
+
+		/// Forward to Texture::bind_unit() of the current texture.
+		void bind_unit(etc::size_type unit, ShaderProgramParameter& param);
+
+	protected:
+		void _bind() override;
+		void _unbind() ETC_NOEXCEPT override;
+
+	private:
+		// Only the loader updates the handle.
+		friend class TextureLoader;
+		void _set_status(Status status) ETC_NOEXCEPT;
+		void _set_texture(TexturePtr texture);
+		void _set_error(std::string error);
+	};
+
+}}}
+
+#endif
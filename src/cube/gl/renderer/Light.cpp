@@ -27,10 +27,12 @@ namespace cube { namespace gl { namespace renderer {
 
 	LightInfo<LightKind::point>::LightInfo(vector::Vector3f position,
 		                                   color::Color3f diffuse,
-		                                   color::Color3f specular)
+		                                   color::Color3f specular,
+		                                   float range)
 		: position(position)
 		, diffuse(diffuse)
 		, specular(specular)
+		, range{range}
 	{}
 
 	///////////////////////////////////////////////////////////////////////////
@@ -9,6 +9,8 @@
 # include <cube/gl/vector.hpp>
 # include <cube/units/angle.hpp>
 
+# include <limits>
+
 namespace cube { namespace gl { namespace renderer {
 
 	template<LightKind kind> struct CUBE_API LightInfo;
@@ -30,11 +32,14 @@ namespace cube { namespace gl { namespace renderer {
 		LightInfo(LightInfo const&) = default;
 		LightInfo(vector::Vector3f position,
 		          color::Color3f diffuse,
-		          color::Color3f specular);
+		          color::Color3f specular,
+		          float range = std::numeric_limits<float>::infinity());
 
 		vector::Vector3f position;
 		color::Color3f   diffuse;
 		color::Color3f   specular;
+		/// Distance beyond which the light has no effect.
+		float            range;
 	};
 
 	template<> struct CUBE_API LightInfo<LightKind::spot>
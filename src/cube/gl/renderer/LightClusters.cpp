@@ -0,0 +1,241 @@
+#include "LightClusters.hpp"
+
+#include "Exception.hpp"
+#include "Light.hpp"
+#include "Renderer.hpp"
+#include "ShaderGenerator.hpp"
+#include "ShaderProgram.hpp"
+#include "State.hpp"
+#include "Texture.hpp"
+
+#include <cube/debug.hpp>
+
+#include <etc/log.hpp>
+
+namespace cube { namespace gl { namespace renderer {
+
+	ETC_LOG_COMPONENT("cube.gl.renderer.LightClusters");
+
+	struct LightClusters::Impl
+	{
+		Renderer&                renderer;
+		LightGrid                grid;
+		std::vector<LightGrid::Light> spheres;
+		std::vector<float>       data;
+		TexturePtr               light_texture;
+		TexturePtr               cluster_texture;
+		TexturePtr               index_texture;
+		etc::size_type           light_capacity;
+		etc::size_type           index_rows;
+		etc::size_type           lights;
+
+		Impl(Renderer& renderer,
+		     etc::size_type const width,
+		     etc::size_type const height,
+		     etc::size_type const tiles_x,
+		     etc::size_type const tiles_y,
+		     etc::size_type const slices,
+		     etc::size_type const threads)
+			: renderer(renderer)
+			, grid{width, height, tiles_x, tiles_y, slices, threads}
+			, spheres{}
+			, data{}
+			, light_texture{}
+			, cluster_texture{
+				renderer.new_texture(PixelFormat::rg32f,
+				                     tiles_x * tiles_y,
+				                     slices)
+			}
+			, index_texture{}
+			, light_capacity{0}
+			, index_rows{0}
+			, lights{0}
+		{
+			this->reserve_lights(16);
+			this->reserve_index_rows(1);
+		}
+
+		void reserve_lights(etc::size_type const count)
+		{
+			if (count <= this->light_capacity)
+				return;
+			etc::size_type capacity = std::max<etc::size_type>(
+				count, this->light_capacity * 2
+			);
+			ETC_LOG.debug("Grow the light texture to", capacity, "lights");
+			this->light_texture = this->renderer.new_texture(
+				PixelFormat::rgba32f, capacity, 3
+			);
+			this->light_capacity = capacity;
+		}
+
+		void reserve_index_rows(etc::size_type const rows)
+		{
+			if (rows <= this->index_rows)
+				return;
+			etc::size_type capacity = std::max<etc::size_type>(
+				rows, this->index_rows * 2
+			);
+			ETC_LOG.debug("Grow the light index texture to", capacity, "rows");
+			this->index_texture = this->renderer.new_texture(
+				PixelFormat::r32f, index_texture_width, capacity
+			);
+			this->index_rows = capacity;
+		}
+	};
+
+	LightClusters::LightClusters(Renderer& renderer,
+	                             etc::size_type const width,
+	                             etc::size_type const height,
+	                             etc::size_type const tiles_x,
+	                             etc::size_type const tiles_y,
+	                             etc::size_type const slices,
+	                             etc::size_type const threads)
+		: _this{
+			new Impl{renderer, width, height, tiles_x, tiles_y, slices, threads}
+		}
+	{ ETC_TRACE_CTOR(width, 'x', height); }
+
+	LightClusters::~LightClusters()
+	{ ETC_TRACE_DTOR(); }
+
+	void LightClusters::resize(etc::size_type const width,
+	                           etc::size_type const height)
+	{ _this->grid.resize(width, height); }
+
+	void LightClusters::update(matrix::mat4f const& projection,
+	                           LightList const& lights)
+	{
+		ETC_TRACE.debug("Update with", lights.size(), "lights");
+		std::vector<PointLightInfo const*> points;
+		points.reserve(lights.size());
+		_this->spheres.clear();
+		for (auto const& ref: lights)
+		{
+			Light const& light = ref.get();
+			if (light.kind != LightKind::point)
+				continue;
+			auto const& info = light.point();
+			points.push_back(&info);
+			_this->spheres.push_back(LightGrid::Light{info.position, info.range});
+		}
+		_this->grid.update(projection, _this->spheres);
+
+		// Lights: position and inverse range, diffuse, specular.
+		etc::size_type const count = points.size();
+		_this->lights = count;
+		if (count > 0)
+		{
+			_this->reserve_lights(count);
+			auto& data = _this->data;
+			data.assign(count * 3 * 4, 0.0f);
+			for (etc::size_type i = 0; i < count; ++i)
+			{
+				auto const& info = *points[i];
+				float* pos = &data[i * 4];
+				float* diffuse = &data[(count + i) * 4];
+				float* specular = &data[(2 * count + i) * 4];
+				for (int c = 0; c < 3; ++c)
+				{
+					pos[c] = info.position[c];
+					diffuse[c] = info.diffuse.colors[c];
+					specular[c] = info.specular.colors[c];
+				}
+				pos[3] = 1.0f / info.range;
+			}
+			_this->light_texture->set_data(
+				0, 0, count, 3,
+				PixelFormat::rgba, ContentPacking::float32, data.data()
+			);
+		}
+
+		auto const& clusters = _this->grid.clusters();
+		auto& data = _this->data;
+		data.resize(clusters.size() * 2);
+		for (etc::size_type i = 0; i < clusters.size(); ++i)
+		{
+			data[2 * i] = static_cast<float>(clusters[i].offset);
+			data[2 * i + 1] = static_cast<float>(clusters[i].count);
+		}
+		_this->cluster_texture->set_data(
+			0, 0,
+			_this->grid.tiles_x() * _this->grid.tiles_y(),
+			_this->grid.slices(),
+			PixelFormat::rg, ContentPacking::float32, data.data()
+		);
+
+		auto const& indices = _this->grid.indices();
+		if (!indices.empty())
+		{
+			etc::size_type rows =
+				(indices.size() + index_texture_width - 1) / index_texture_width;
+			_this->reserve_index_rows(rows);
+			data.assign(rows * index_texture_width, 0.0f);
+			std::copy(indices.begin(), indices.end(), data.begin());
+			_this->index_texture->set_data(
+				0, 0, index_texture_width, rows,
+				PixelFormat::red, ContentPacking::float32, data.data()
+			);
+		}
+		CUBE_DEBUG_COUNTER("cube.gl.renderer.LightClusters.lights", count);
+	}
+
+	etc::size_type LightClusters::lights() const ETC_NOEXCEPT
+	{ return _this->lights; }
+
+	LightGrid const& LightClusters::grid() const ETC_NOEXCEPT
+	{ return _this->grid; }
+
+	void LightClusters::declare(ShaderGeneratorProxy& proxy)
+	{
+		proxy
+			.parameter(ShaderParameterType::int_, "cube_ClusteredLighting")
+			.parameter(ShaderParameterType::sampler2d, "cube_ClusterLights")
+			.parameter(ShaderParameterType::sampler2d, "cube_ClusterGrid")
+			.parameter(ShaderParameterType::sampler2d, "cube_ClusterIndices")
+			.parameter(ShaderParameterType::vec3, "cube_ClusterSize")
+			.parameter(ShaderParameterType::vec3, "cube_ClusterScale")
+			.parameter(ShaderParameterType::vec3, "cube_ClusterTextureSize")
+			.parameter(ShaderParameterType::float_, "cube_ClusterNear")
+		;
+	}
+
+	void LightClusters::setup(ShaderProgram& program,
+	                          std::vector<Bindable::Guard>& guards,
+	                          std::shared_ptr<State> const& state) const
+	{
+		auto const& grid = _this->grid;
+		guards.emplace_back(*_this->light_texture, state);
+		guards.emplace_back(*_this->cluster_texture, state);
+		guards.emplace_back(*_this->index_texture, state);
+		program["cube_ClusteredLighting"] = int32_t{1};
+		program["cube_ClusterLights"] = *_this->light_texture;
+		program["cube_ClusterGrid"] = *_this->cluster_texture;
+		program["cube_ClusterIndices"] = *_this->index_texture;
+		program["cube_ClusterSize"] = vector::vec3f(
+			grid.tiles_x(), grid.tiles_y(), grid.slices()
+		);
+		program["cube_ClusterScale"] = vector::vec3f(
+			1.0f / grid.tile_width(),
+			1.0f / grid.tile_height(),
+			grid.slice_scale()
+		);
+		program["cube_ClusterTextureSize"] = vector::vec3f(
+			_this->light_capacity, index_texture_width, _this->index_rows
+		);
+		program["cube_ClusterNear"] = grid.near();
+	}
+
+	void LightClusters::_bind()
+	{
+		ETC_LOG.debug("Binding light clusters");
+		this->bound_state().enable(*this);
+	}
+
+	void LightClusters::_unbind() ETC_NOEXCEPT
+	{
+		ETC_LOG.debug("Unbinding light clusters");
+		this->bound_state().disable(*this);
+	}
+
+}}}
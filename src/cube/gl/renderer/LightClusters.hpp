@@ -0,0 +1,95 @@
+#ifndef  CUBE_GL_RENDERER_LIGHTCLUSTERS_HPP
+# define CUBE_GL_RENDERER_LIGHTCLUSTERS_HPP
+
+# include "fwd.hpp"
+# include "Bindable.hpp"
+# include "LightGrid.hpp"
+
+# include <cube/gl/matrix.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <functional>
+# include <memory>
+# include <vector>
+
+namespace cube { namespace gl { namespace renderer {
+
+	/**
+	 * @brief Point lights assigned to the clusters of the view frustum.
+	 *
+	 * The light grid is computed on the CPU (@see LightGrid) and uploaded in
+	 * three float textures:
+	 *  - the lights, one texel per light and three rows: the view space
+	 *    position and inverse range, the diffuse and the specular colors;
+	 *  - the clusters, one texel (offset, count) per cluster, a row per
+	 *    slice;
+	 *  - the light indices, index_texture_width indices per row.
+	 *
+	 * Binding the light clusters registers them in the bound state, the
+	 * materials bound afterwards light their fragments with the lights of
+	 * the fragment cluster only, instead of the per vertex light arrays.
+	 */
+	class CUBE_API LightClusters
+		: public Bindable
+	{
+	public:
+		typedef std::vector<std::reference_wrapper<Light const>> LightList;
+		static etc::size_type const index_texture_width = 1024;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _this;
+
+	public:
+		/// @see LightGrid::LightGrid()
+		LightClusters(Renderer& renderer,
+		              etc::size_type const width,
+		              etc::size_type const height,
+		              etc::size_type const tiles_x = 16,
+		              etc::size_type const tiles_y = 8,
+		              etc::size_type const slices = 24,
+		              etc::size_type const threads = 0);
+		~LightClusters();
+
+	public:
+		/// Change the viewport size.
+		void resize(etc::size_type const width, etc::size_type const height);
+
+		/**
+		 * @brief Assign the point lights to the clusters and upload them.
+		 *
+		 * Light positions are expected in view space, as set before binding
+		 * them. Other kinds of light are ignored.
+		 */
+		void update(matrix::mat4f const& projection, LightList const& lights);
+
+		/// Point lights uploaded by the last update().
+		etc::size_type lights() const ETC_NOEXCEPT;
+
+		LightGrid const& grid() const ETC_NOEXCEPT;
+
+	public:
+		/// Declare the uniforms used by setup() in a shader.
+		static
+		void declare(ShaderGeneratorProxy& proxy);
+
+		/**
+		 * @brief Set the uniforms of a program.
+		 *
+		 * The textures are bound for the lifetime of the guards appended to
+		 * @a guards.
+		 */
+		void setup(ShaderProgram& program,
+		           std::vector<Bindable::Guard>& guards,
+		           std::shared_ptr<State> const& state) const;
+
+	protected:
+		void _bind() override;
+		void _unbind() ETC_NOEXCEPT override;
+	};
+
+}}}
+
+#endif
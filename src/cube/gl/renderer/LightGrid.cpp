@@ -0,0 +1,506 @@
+#include "LightGrid.hpp"
+
+#include "Exception.hpp"
+
+#include <cube/debug.hpp>
+
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace cube { namespace gl { namespace renderer {
+
+	ETC_LOG_COMPONENT("cube.gl.renderer.LightGrid");
+
+	namespace {
+
+		// Below this many sphere / cluster tests, threads cost more than
+		// they save.
+		etc::size_type const parallel_threshold = 32 * 1024;
+
+		etc::size_type default_threads()
+		{
+			etc::size_type count = std::thread::hardware_concurrency();
+			return std::max<etc::size_type>(1, std::min<etc::size_type>(count, 8));
+		}
+
+		/// Lights touching a slice, padded to a multiple of four.
+		struct SliceLights
+		{
+			std::vector<float>    x, y, depth, radius2;
+			std::vector<uint32_t> index;
+
+			void clear()
+			{
+				x.clear(); y.clear(); depth.clear(); radius2.clear();
+				index.clear();
+			}
+
+			void push(float px, float py, float pd, float r2, uint32_t i)
+			{
+				x.push_back(px);
+				y.push_back(py);
+				depth.push_back(pd);
+				radius2.push_back(r2);
+				index.push_back(i);
+			}
+
+			void pad()
+			{
+				// Never intersects: a distance is never negative.
+				while (x.size() % 4 != 0)
+					this->push(0, 0, 0, -1, 0);
+			}
+		};
+
+		/// Box of a cluster, depths are positive.
+		struct Box
+		{
+			float x0, x1, y0, y1, d0, d1;
+		};
+
+		/// Append to @a out the lights intersecting @a box.
+		void intersect(Box const& box,
+		               SliceLights const& lights,
+		               std::vector<uint32_t>& out)
+		{
+			etc::size_type const size = lights.x.size();
+# ifdef CUBE_GL_MATRIX_SSE
+			__m128 const zero = _mm_setzero_ps();
+			__m128 const x0 = _mm_set1_ps(box.x0), x1 = _mm_set1_ps(box.x1);
+			__m128 const y0 = _mm_set1_ps(box.y0), y1 = _mm_set1_ps(box.y1);
+			__m128 const d0 = _mm_set1_ps(box.d0), d1 = _mm_set1_ps(box.d1);
+			for (etc::size_type i = 0; i < size; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(&lights.x[i]);
+				__m128 y = _mm_loadu_ps(&lights.y[i]);
+				__m128 d = _mm_loadu_ps(&lights.depth[i]);
+				__m128 dx = _mm_max_ps(
+					_mm_max_ps(_mm_sub_ps(x0, x), _mm_sub_ps(x, x1)), zero
+				);
+				__m128 dy = _mm_max_ps(
+					_mm_max_ps(_mm_sub_ps(y0, y), _mm_sub_ps(y, y1)), zero
+				);
+				__m128 dd = _mm_max_ps(
+					_mm_max_ps(_mm_sub_ps(d0, d), _mm_sub_ps(d, d1)), zero
+				);
+				__m128 dist2 = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+					_mm_mul_ps(dd, dd)
+				);
+				int mask = _mm_movemask_ps(
+					_mm_cmple_ps(dist2, _mm_loadu_ps(&lights.radius2[i]))
+				);
+				for (int j = 0; mask != 0; ++j, mask >>= 1)
+					if (mask & 1)
+						out.push_back(lights.index[i + j]);
+			}
+# else
+			for (etc::size_type i = 0; i < size; ++i)
+			{
+				float dx = std::max(std::max(box.x0 - lights.x[i],
+				                             lights.x[i] - box.x1), 0.0f);
+				float dy = std::max(std::max(box.y0 - lights.y[i],
+				                             lights.y[i] - box.y1), 0.0f);
+				float dd = std::max(std::max(box.d0 - lights.depth[i],
+				                             lights.depth[i] - box.d1), 0.0f);
+				if (dx * dx + dy * dy + dd * dd <= lights.radius2[i])
+					out.push_back(lights.index[i]);
+			}
+# endif
+		}
+
+	} // !anonymous
+
+	struct LightGrid::Impl
+	{
+		etc::size_type              width;
+		etc::size_type              height;
+		etc::size_type const        tiles_x;
+		etc::size_type const        tiles_y;
+		etc::size_type const        slices;
+		etc::size_type const        threads;
+		float                       near;
+		float                       far;
+		float                       scale;
+		// View space x (or y) of the tile borders at a depth of 1.
+		std::vector<float>          borders_x;
+		std::vector<float>          borders_y;
+		std::vector<Cluster>        clusters;
+		std::vector<uint32_t>       indices;
+		std::vector<std::vector<uint32_t>> slice_indices;
+		std::vector<SliceLights>    slice_lights;
+		Stats                       stats;
+
+		Impl(etc::size_type const width,
+		     etc::size_type const height,
+		     etc::size_type const tiles_x,
+		     etc::size_type const tiles_y,
+		     etc::size_type const slices,
+		     etc::size_type const threads)
+			: width{width}
+			, height{height}
+			, tiles_x{tiles_x}
+			, tiles_y{tiles_y}
+			, slices{slices}
+			, threads{threads}
+			, near{1}
+			, far{1}
+			, scale{0}
+			, borders_x(tiles_x + 1)
+			, borders_y(tiles_y + 1)
+			, clusters(tiles_x * tiles_y * slices, Cluster{0, 0})
+			, indices{}
+			, slice_indices(slices)
+			, slice_lights(threads)
+			, stats{0, 0, 0}
+		{}
+
+		etc::size_type tile_width() const
+		{ return (this->width + this->tiles_x - 1) / this->tiles_x; }
+
+		etc::size_type tile_height() const
+		{ return (this->height + this->tiles_y - 1) / this->tiles_y; }
+
+		float slice_depth(etc::size_type const slice) const
+		{
+			if (slice == 0)
+				return 0;
+			if (slice == this->slices)
+				return this->far;
+			return this->near * std::exp(slice / this->scale);
+		}
+
+		/// Fill the clusters of a slice and its index list.
+		void assign(etc::size_type const slice,
+		            std::vector<Light> const& lights,
+		            SliceLights& candidates)
+		{
+			float const d0 = this->slice_depth(slice);
+			float const d1 = this->slice_depth(slice + 1);
+			candidates.clear();
+			for (etc::size_type i = 0; i < lights.size(); ++i)
+			{
+				Light const& light = lights[i];
+				float depth = -light.position.z;
+				if (depth + light.radius < d0 || depth - light.radius > d1)
+					continue;
+				candidates.push(light.position.x, light.position.y, depth,
+				                light.radius * light.radius,
+				                static_cast<uint32_t>(i));
+			}
+			candidates.pad();
+
+			auto& out = this->slice_indices[slice];
+			out.clear();
+			Cluster* cluster = &this->clusters[slice * this->tiles_x * this->tiles_y];
+			for (etc::size_type y = 0; y < this->tiles_y; ++y)
+			{
+				float by0 = this->borders_y[y], by1 = this->borders_y[y + 1];
+				for (etc::size_type x = 0; x < this->tiles_x; ++x, ++cluster)
+				{
+					float bx0 = this->borders_x[x], bx1 = this->borders_x[x + 1];
+					// Tile sides are planes through the eye, the box spans
+					// both ends of the slice.
+					Box box{
+						std::min(bx0 * d0, bx0 * d1), std::max(bx1 * d0, bx1 * d1),
+						std::min(by0 * d0, by0 * d1), std::max(by1 * d0, by1 * d1),
+						d0, d1,
+					};
+					cluster->offset = static_cast<uint32_t>(out.size());
+					if (!candidates.x.empty())
+						intersect(box, candidates, out);
+					cluster->count = static_cast<uint32_t>(
+						out.size() - cluster->offset
+					);
+				}
+			}
+		}
+	};
+
+	LightGrid::LightGrid(etc::size_type const width,
+	                     etc::size_type const height,
+	                     etc::size_type const tiles_x,
+	                     etc::size_type const tiles_y,
+	                     etc::size_type const slices,
+	                     etc::size_type const threads)
+		: _this{
+			new Impl{
+				width, height, tiles_x, tiles_y, slices,
+				threads == 0 ? default_threads() : threads
+			}
+		}
+	{
+		ETC_TRACE_CTOR(width, 'x', height, "with", tiles_x, 'x', tiles_y,
+		               'x', slices, "clusters");
+		if (tiles_x == 0 || tiles_y == 0 || slices == 0)
+			throw Exception{"A light grid needs at least one cluster"};
+		this->resize(width, height);
+	}
+
+	LightGrid::~LightGrid()
+	{ ETC_TRACE_DTOR(); }
+
+	void LightGrid::resize(etc::size_type const width,
+	                       etc::size_type const height)
+	{
+		if (width == 0 || height == 0)
+			throw Exception{"Cannot cluster an empty viewport"};
+		_this->width = width;
+		_this->height = height;
+	}
+
+	void LightGrid::update(matrix::mat4f const& projection,
+	                       std::vector<Light> const& lights)
+	{
+		CUBE_DEBUG_PERFORMANCE_SECTION("cube.gl.renderer.LightGrid");
+		if (projection[2][3] != -1.0f || projection[3][3] != 0.0f)
+			throw Exception{"Light clusters need a perspective projection"};
+		float const p22 = projection[2][2], p32 = projection[3][2];
+		_this->near = p32 / (p22 - 1.0f);
+		_this->far = p32 / (p22 + 1.0f);
+		if (!(_this->near > 0.0f) || !std::isfinite(_this->far) ||
+		    _this->far <= _this->near)
+			throw Exception{"Light clusters need finite near and far planes"};
+		_this->scale = _this->slices / std::log(_this->far / _this->near);
+
+		// A view point at depth d projects to ndc.x = p00 * x / d - p20.
+		float const tw = static_cast<float>(_this->tile_width());
+		float const th = static_cast<float>(_this->tile_height());
+		for (etc::size_type i = 0; i <= _this->tiles_x; ++i)
+		{
+			float ndc = 2.0f * (i * tw) / _this->width - 1.0f;
+			_this->borders_x[i] = (ndc + projection[2][0]) / projection[0][0];
+		}
+		for (etc::size_type i = 0; i <= _this->tiles_y; ++i)
+		{
+			float ndc = 2.0f * (i * th) / _this->height - 1.0f;
+			_this->borders_y[i] = (ndc + projection[2][1]) / projection[1][1];
+		}
+
+		etc::size_type const tests =
+			lights.size() * _this->tiles_x * _this->tiles_y * _this->slices;
+		etc::size_type const threads =
+			tests < parallel_threshold ? 1 : std::min(_this->threads, _this->slices);
+		if (threads == 1)
+			for (etc::size_type slice = 0; slice < _this->slices; ++slice)
+				_this->assign(slice, lights, _this->slice_lights[0]);
+		else
+		{
+			std::atomic<etc::size_type> next{0};
+			auto work = [&] (SliceLights& candidates) {
+				for (etc::size_type slice = next++;
+				     slice < _this->slices;
+				     slice = next++)
+					_this->assign(slice, lights, candidates);
+			};
+			std::vector<std::thread> workers;
+			for (etc::size_type i = 1; i < threads; ++i)
+				workers.emplace_back(work, std::ref(_this->slice_lights[i]));
+			work(_this->slice_lights[0]);
+			for (auto& worker: workers)
+				worker.join();
+		}
+
+		// Slices offsets are relative to their own index list.
+		etc::size_type const per_slice = _this->tiles_x * _this->tiles_y;
+		_this->indices.clear();
+		_this->stats = Stats{0, 0, 0};
+		for (etc::size_type slice = 0; slice < _this->slices; ++slice)
+		{
+			uint32_t base = static_cast<uint32_t>(_this->indices.size());
+			Cluster* cluster = &_this->clusters[slice * per_slice];
+			for (etc::size_type i = 0; i < per_slice; ++i)
+			{
+				cluster[i].offset += base;
+				_this->stats.max_cluster_lights = std::max<etc::size_type>(
+					_this->stats.max_cluster_lights, cluster[i].count
+				);
+			}
+			auto const& src = _this->slice_indices[slice];
+			_this->indices.insert(_this->indices.end(), src.begin(), src.end());
+		}
+
+		std::vector<bool> seen(lights.size(), false);
+		for (uint32_t idx: _this->indices)
+			seen[idx] = true;
+		_this->stats.lights = std::count(seen.begin(), seen.end(), true);
+		_this->stats.assignments = _this->indices.size();
+		CUBE_DEBUG_COUNTER("cube.gl.renderer.LightGrid.assignments",
+		                   _this->stats.assignments);
+		ETC_LOG.debug("Assigned", _this->stats.lights, "lights to",
+		              _this->clusters.size(), "clusters with",
+		              _this->stats.assignments, "assignments");
+	}
+
+	std::vector<LightGrid::Cluster> const&
+	LightGrid::clusters() const ETC_NOEXCEPT
+	{ return _this->clusters; }
+
+	std::vector<uint32_t> const& LightGrid::indices() const ETC_NOEXCEPT
+	{ return _this->indices; }
+
+	etc::size_type LightGrid::cluster(etc::size_type const x,
+	                                  etc::size_type const y,
+	                                  etc::size_type const slice) const ETC_NOEXCEPT
+	{ return (slice * _this->tiles_y + y) * _this->tiles_x + x; }
+
+	etc::size_type LightGrid::slice(float const depth) const ETC_NOEXCEPT
+	{
+		if (!(depth > _this->near))
+			return 0;
+		float s = std::floor(std::log(depth / _this->near) * _this->scale);
+		return std::min<etc::size_type>(
+			static_cast<etc::size_type>(s), _this->slices - 1
+		);
+	}
+
+	etc::size_type LightGrid::width() const ETC_NOEXCEPT
+	{ return _this->width; }
+
+	etc::size_type LightGrid::height() const ETC_NOEXCEPT
+	{ return _this->height; }
+
+	etc::size_type LightGrid::tiles_x() const ETC_NOEXCEPT
+	{ return _this->tiles_x; }
+
+	etc::size_type LightGrid::tiles_y() const ETC_NOEXCEPT
+	{ return _this->tiles_y; }
+
+	etc::size_type LightGrid::slices() const ETC_NOEXCEPT
+	{ return _this->slices; }
+
+	etc::size_type LightGrid::threads() const ETC_NOEXCEPT
+	{ return _this->threads; }
+
+	etc::size_type LightGrid::tile_width() const ETC_NOEXCEPT
+	{ return _this->tile_width(); }
+
+	etc::size_type LightGrid::tile_height() const ETC_NOEXCEPT
+	{ return _this->tile_height(); }
+
+	float LightGrid::near() const ETC_NOEXCEPT
+	{ return _this->near; }
+
+	float LightGrid::far() const ETC_NOEXCEPT
+	{ return _this->far; }
+
+	float LightGrid::slice_scale() const ETC_NOEXCEPT
+	{ return _this->scale; }
+
+	LightGrid::Stats const& LightGrid::stats() const ETC_NOEXCEPT
+	{ return _this->stats; }
+
+	namespace {
+
+		typedef LightGrid::Light Light;
+
+		matrix::mat4f test_projection()
+		{ return matrix::perspective<float>(units::deg(90), 1.0f, 1.0f, 100.0f); }
+
+		bool has_light(LightGrid const& grid,
+		               etc::size_type const cluster,
+		               uint32_t const light)
+		{
+			auto const& c = grid.clusters()[cluster];
+			auto begin = grid.indices().begin() + c.offset;
+			return std::find(begin, begin + c.count, light) != begin + c.count;
+		}
+
+		ETC_TEST_CASE(light_grid_single_light)
+		{
+			LightGrid grid{64, 64, 4, 4, 8, 1};
+			grid.update(test_projection(), {Light{{0.5f, 0.5f, -10}, 1}});
+			ETC_ENFORCE_LT(std::fabs(grid.near() - 1.0f), 0.001f);
+			ETC_ENFORCE_LT(std::fabs(grid.far() - 100.0f), 0.01f);
+			auto slice = grid.slice(10);
+			ETC_ENFORCE(has_light(grid, grid.cluster(2, 2, slice), 0));
+			ETC_ENFORCE(!has_light(grid, grid.cluster(0, 0, slice), 0));
+			ETC_ENFORCE(!has_light(grid, grid.cluster(2, 2, 0), 0));
+			ETC_ENFORCE(!has_light(grid, grid.cluster(2, 2, 7), 0));
+			ETC_ENFORCE_EQ(grid.stats().lights, 1u);
+			ETC_ENFORCE_LTE(grid.stats().assignments, 8u);
+		}
+
+		ETC_TEST_CASE(light_grid_unbounded_light)
+		{
+			LightGrid grid{64, 32, 4, 2, 4, 1};
+			grid.update(
+				test_projection(),
+				{
+					Light{{0, 0, -10}, std::numeric_limits<float>::infinity()},
+					Light{{0, 0, 10}, 1},
+				}
+			);
+			for (auto const& cluster: grid.clusters())
+				ETC_ENFORCE_EQ(cluster.count, 1u);
+			ETC_ENFORCE_EQ(grid.stats().lights, 1u);
+			ETC_ENFORCE_EQ(grid.stats().max_cluster_lights, 1u);
+		}
+
+		ETC_TEST_CASE(light_grid_orthogonal)
+		{
+			LightGrid grid{64, 64};
+			ETC_TEST_THROW_TYPE(
+				{ grid.update(matrix::ortho<float>(-1, 1, -1, 1, 1, 10), {}); },
+				Exception
+			);
+		}
+
+		// Every point lit by a light must find the light in its cluster.
+		ETC_TEST_CASE(light_grid_conservative)
+		{
+			std::mt19937 gen{42};
+			std::uniform_real_distribution<float> unit{0, 1};
+			std::vector<Light> lights;
+			for (int i = 0; i < 500; ++i)
+				lights.push_back(Light{
+					{unit(gen) * 80 - 40, unit(gen) * 80 - 40, -unit(gen) * 90},
+					0.5f + unit(gen) * 5,
+				});
+			auto projection = test_projection();
+			LightGrid grid{160, 90, 16, 9, 16, 4};
+			grid.update(projection, lights);
+			LightGrid single{160, 90, 16, 9, 16, 1};
+			single.update(projection, lights);
+			ETC_ENFORCE(grid.indices() == single.indices());
+			ETC_ENFORCE_EQ(grid.stats().lights, single.stats().lights);
+
+			etc::size_type checked = 0;
+			for (int i = 0; i < 20000; ++i)
+			{
+				float px = unit(gen) * 160, py = unit(gen) * 90;
+				float depth = 1 + unit(gen) * 99;
+				float ndc_x = 2 * px / 160 - 1, ndc_y = 2 * py / 90 - 1;
+				vector::vec3f point{
+					(ndc_x + projection[2][0]) / projection[0][0] * depth,
+					(ndc_y + projection[2][1]) / projection[1][1] * depth,
+					-depth,
+				};
+				auto cluster = grid.cluster(
+					static_cast<etc::size_type>(px) / grid.tile_width(),
+					static_cast<etc::size_type>(py) / grid.tile_height(),
+					grid.slice(depth)
+				);
+				for (uint32_t l = 0; l < lights.size(); ++l)
+				{
+					auto d = point - lights[l].position;
+					if (vector::dot(d, d) > lights[l].radius * lights[l].radius)
+						continue;
+					ETC_ENFORCE(has_light(grid, cluster, l));
+					checked += 1;
+				}
+			}
+			ETC_ENFORCE_GT(checked, 0u);
+			ETC_ENFORCE_LT(grid.stats().assignments, lights.size() * 16 * 9 * 16 / 4);
+		}
+
+	} // !anonymous
+
+}}}
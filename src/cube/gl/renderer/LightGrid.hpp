@@ -0,0 +1,135 @@
+#ifndef  CUBE_GL_RENDERER_LIGHTGRID_HPP
+# define CUBE_GL_RENDERER_LIGHTGRID_HPP
+
+# include <cube/api.hpp>
+# include <cube/gl/matrix.hpp>
+# include <cube/gl/vector.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <memory>
+# include <vector>
+
+namespace cube { namespace gl { namespace renderer {
+
+	/**
+	 * @brief Assign lights to the clusters of a view frustum.
+	 *
+	 * The frustum is split in tiles_x x tiles_y screen tiles, and every tile
+	 * in slices along the view depth. Slices grow exponentially from the
+	 * near to the far plane, so that clusters stay roughly cubic.
+	 *
+	 * Every light sphere is tested against the bounding box of the clusters
+	 * it might touch, four lights at a time when SSE is available, and
+	 * slices are processed in parallel. The result is a compact list of
+	 * light indices, and for each cluster the range of that list it uses.
+	 *
+	 * Clusters are stored slice by slice, then row by row.
+	 */
+	class CUBE_API LightGrid
+	{
+	public:
+		/// A light sphere, in view space.
+		struct Light
+		{
+			vector::vec3f position;
+			float         radius;
+		};
+
+		/// Lights of a cluster: indices()[offset, offset + count).
+		struct Cluster
+		{
+			uint32_t offset;
+			uint32_t count;
+		};
+
+		/// Statistics of the last update().
+		struct Stats
+		{
+			/// Lights intersecting the view volume.
+			etc::size_type lights;
+			/// Size of the light index list.
+			etc::size_type assignments;
+			/// Biggest light count of a cluster.
+			etc::size_type max_cluster_lights;
+		};
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _this;
+
+	public:
+		/**
+		 * @brief Create a light grid.
+		 *
+		 * @param   width       Viewport width in pixels.
+		 * @param   height      Viewport height in pixels.
+		 * @param   tiles_x     Horizontal tile count.
+		 * @param   tiles_y     Vertical tile count.
+		 * @param   slices      Depth slice count.
+		 * @param   threads     Threads used to assign lights, the calling
+		 *                      one included. 0 picks a value from the
+		 *                      hardware.
+		 */
+		LightGrid(etc::size_type const width,
+		          etc::size_type const height,
+		          etc::size_type const tiles_x = 16,
+		          etc::size_type const tiles_y = 8,
+		          etc::size_type const slices = 24,
+		          etc::size_type const threads = 0);
+		~LightGrid();
+
+	public:
+		/// Change the viewport size.
+		void resize(etc::size_type const width, etc::size_type const height);
+
+		/**
+		 * @brief Assign @a lights to the clusters.
+		 *
+		 * @param   projection  A perspective projection with a finite far
+		 *                      plane.
+		 * @param   lights      Light spheres in view space.
+		 *
+		 * @throws if the projection is not a perspective.
+		 */
+		void update(matrix::mat4f const& projection,
+		            std::vector<Light> const& lights);
+
+	public:
+		std::vector<Cluster> const& clusters() const ETC_NOEXCEPT;
+		std::vector<uint32_t> const& indices() const ETC_NOEXCEPT;
+
+		/// Index of a cluster in clusters().
+		etc::size_type cluster(etc::size_type const x,
+		                       etc::size_type const y,
+		                       etc::size_type const slice) const ETC_NOEXCEPT;
+
+		/// Slice containing a view depth (a positive distance to the eye).
+		etc::size_type slice(float const depth) const ETC_NOEXCEPT;
+
+	public:
+		etc::size_type width() const ETC_NOEXCEPT;
+		etc::size_type height() const ETC_NOEXCEPT;
+		etc::size_type tiles_x() const ETC_NOEXCEPT;
+		etc::size_type tiles_y() const ETC_NOEXCEPT;
+		etc::size_type slices() const ETC_NOEXCEPT;
+		etc::size_type threads() const ETC_NOEXCEPT;
+
+		/// Tile size in pixels.
+		etc::size_type tile_width() const ETC_NOEXCEPT;
+		etc::size_type tile_height() const ETC_NOEXCEPT;
+
+		/// Near and far planes of the last update().
+		float near() const ETC_NOEXCEPT;
+		float far() const ETC_NOEXCEPT;
+
+		/// slice(depth) is floor(log(depth / near()) * slice_scale()).
+		float slice_scale() const ETC_NOEXCEPT;
+
+		Stats const& stats() const ETC_NOEXCEPT;
+	};
+
+}}}
+
+#endif
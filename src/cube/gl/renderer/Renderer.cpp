@@ -8,10 +8,12 @@
 #include "ShaderProgram.hpp"
 #include "State.hpp"
 #include "Texture.hpp"
+#include "TextureLoader.hpp"
 #include "VertexBuffer.hpp"
 
 #include <cube/debug.hpp>
 #include <cube/gl/renderer.hpp>
+#include <cube/gl/surface.hpp>
 #include <cube/resource/Manager.hpp>
 #include <cube/system/window.hpp>
 
@@ -39,12 +41,18 @@ namespace cube { namespace gl { namespace renderer {
 		std::vector<std::shared_ptr<State>> states;
 		ShaderGeneratorPtr shader_generator;
 		resource::Manager  resource_manager;
+		TexturePtr         placeholder_texture;
+		std::unique_ptr<TextureLoader> texture_loader;
+		std::chrono::microseconds      texture_upload_budget;
 
 		Impl(system::window::RendererContext& context)
 			: context(context)
 			, states{}
 			, shader_generator{nullptr}
 			, resource_manager{}
+			, placeholder_texture{}
+			, texture_loader{}
+			, texture_upload_budget{2000}
 		{}
 	};
 
@@ -67,6 +75,9 @@ namespace cube { namespace gl { namespace renderer {
 	void Renderer::shutdown()
 	{
 		ETC_LOG.debug("Shutting down the renderer");
+		// Pending loads are dropped, the implementation might be gone.
+		_this->texture_loader.reset();
+		_this->placeholder_texture.reset();
 		this->flush();
 	}
 
@@ -133,7 +144,11 @@ namespace cube { namespace gl { namespace renderer {
 	{ return _this->resource_manager; }
 
 	void Renderer::flush()
-	{ _this->resource_manager.flush(); }
+	{
+		if (_this->texture_loader != nullptr)
+			this->upload_textures(_this->texture_upload_budget);
+		_this->resource_manager.flush();
+	}
 
 	void Renderer::_push_state(State&& state)
 	{
@@ -212,6 +227,72 @@ namespace cube { namespace gl { namespace renderer {
 		);
 	}
 
+	TexturePtr Renderer::new_texture(PixelFormat const internal_format,
+	                                 etc::size_type const width,
+	                                 etc::size_type const height)
+	{
+		if (width == 0 || height == 0)
+			throw Exception{"Cannot create an empty texture"};
+		return _this->resource_manager.manage(
+		    _new_texture(internal_format, width, height, 0)
+		);
+	}
+
+	TexturePtr Renderer::new_texture_array(PixelFormat const internal_format,
+	                                       etc::size_type const width,
+	                                       etc::size_type const height,
+	                                       etc::size_type const layers)
+	{
+		if (width == 0 || height == 0 || layers == 0)
+			throw Exception{"Cannot create an empty texture array"};
+		return _this->resource_manager.manage(
+		    _new_texture(internal_format, width, height, layers)
+		);
+	}
+
+	TexturePtr Renderer::_upload_texture(surface::Surface const& surface)
+	{ return _new_texture(surface); }
+
+	AsyncTexturePtr
+	Renderer::new_texture_async(boost::filesystem::path const& path)
+	{
+		if (_this->texture_loader == nullptr)
+			_this->texture_loader.reset(new TextureLoader{*this});
+		return _this->texture_loader->load(path);
+	}
+
+	TexturePtr const& Renderer::placeholder_texture()
+	{
+		if (_this->placeholder_texture == nullptr)
+		{
+			static unsigned char const white[4] = {255, 255, 255, 255};
+			_this->placeholder_texture = this->new_texture(
+				surface::Surface{
+					PixelFormat::rgba8, 1, 1,
+					PixelFormat::rgba8, ContentPacking::uint8,
+					white
+				}
+			);
+		}
+		return _this->placeholder_texture;
+	}
+
+	etc::size_type
+	Renderer::upload_textures(std::chrono::microseconds const budget)
+	{
+		if (_this->texture_loader == nullptr)
+			return 0;
+		return _this->texture_loader->upload(budget);
+	}
+
+	std::chrono::microseconds
+	Renderer::texture_upload_budget() const ETC_NOEXCEPT
+	{ return _this->texture_upload_budget; }
+
+	void Renderer::texture_upload_budget(
+	    std::chrono::microseconds const budget) ETC_NOEXCEPT
+	{ _this->texture_upload_budget = budget; }
+
 	ShaderGeneratorProxy
 	Renderer::generate_shader(ShaderType const type)
 	{
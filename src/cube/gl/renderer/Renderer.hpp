@@ -14,6 +14,9 @@
 # include <etc/compiler.hpp>
 # include <etc/types.hpp>
 
+# include <wrappers/boost/filesystem.hpp>
+
+# include <chrono>
 # include <memory>
 # include <string>
 # include <vector>
@@ -37,6 +40,7 @@ namespace cube { namespace gl { namespace renderer {
 		 *      - Pop that state on destruction.                             *
 		 *********************************************************************/
 		friend class Painter;
+		friend class TextureLoader;
 
 	protected:
 		viewport::Viewport    _viewport;
@@ -59,7 +63,8 @@ namespace cube { namespace gl { namespace renderer {
 		resource::Manager& resource_manager() ETC_NOEXCEPT;
 
 		/**
-		 * Cleanup unused resources.
+		 * Upload pending asynchronous textures within the texture upload
+		 * budget, and cleanup unused resources.
 		 */
 		void flush();
 
@@ -266,10 +271,65 @@ namespace cube { namespace gl { namespace renderer {
 	public:
 		/// Create a texture from a surface.
 		TexturePtr new_texture(surface::Surface const& surface);
+
+		/// Create an empty texture.
+		TexturePtr new_texture(PixelFormat const internal_format,
+		                       etc::size_type const width,
+		                       etc::size_type const height);
+
+		/// Create an empty texture array of @a layers layers.
+		TexturePtr new_texture_array(PixelFormat const internal_format,
+		                             etc::size_type const width,
+		                             etc::size_type const height,
+		                             etc::size_type const layers);
+		/**
+		 * @brief Create a texture from an image file in background.
+		 *
+		 * The returned handle is usable immediately, it binds a placeholder
+		 * texture until the image is decoded and uploaded.
+		 *
+		 * @see AsyncTexture, TextureLoader
+		 */
+		AsyncTexturePtr new_texture_async(boost::filesystem::path const& path);
+
+		/// Texture bound by asynchronous textures while they are loading.
+		TexturePtr const& placeholder_texture();
+
+		/**
+		 * @brief Upload decoded asynchronous textures.
+		 *
+		 * Called by flush() with the texture upload budget.
+		 *
+		 * @returns the number of textures uploaded.
+		 */
+		etc::size_type upload_textures(std::chrono::microseconds const budget);
+
+		/// Time spent uploading textures at each flush().
+		std::chrono::microseconds texture_upload_budget() const ETC_NOEXCEPT;
+
+		/// Set the time spent uploading textures at each flush().
+		void texture_upload_budget(std::chrono::microseconds const budget) ETC_NOEXCEPT;
+
 	protected:
 		virtual
 		TexturePtr _new_texture(surface::Surface const& surface) = 0;
 
+		/// Create an empty texture, or a texture array when @a layers > 0.
+		virtual
+		TexturePtr _new_texture(PixelFormat const internal_format,
+		                        etc::size_type const width,
+		                        etc::size_type const height,
+		                        etc::size_type const layers) = 0;
+
+		/**
+		 * Create a texture from a decoded surface in an asynchronous load.
+		 *
+		 * Implementations may override this to stream the pixels without
+		 * stalling the pipeline, the default forwards to _new_texture().
+		 */
+		virtual
+		TexturePtr _upload_texture(surface::Surface const& surface);
+
 
 	public:
 		/**
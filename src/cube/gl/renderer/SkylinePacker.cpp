@@ -0,0 +1,317 @@
+#include "SkylinePacker.hpp"
+
+#include "Exception.hpp"
+
+#include <etc/assert.hpp>
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace cube { namespace gl { namespace renderer {
+
+	ETC_LOG_COMPONENT("cube.gl.renderer.SkylinePacker");
+
+	// The padding is added to the right and bottom of every slot, so the
+	// packed area is virtually extended by the padding on those sides: a slot
+	// touching the border does not need the extra texels.
+
+	SkylinePacker::SkylinePacker(etc::size_type const width,
+	                             etc::size_type const height,
+	                             etc::size_type const padding)
+		: _width{width}
+		, _height{height}
+		, _padding{padding}
+		, _skyline{}
+		, _free{}
+		, _used_area{0}
+	{
+		if (width == 0 || height == 0)
+			throw Exception{"Cannot pack in an empty area"};
+		this->clear();
+	}
+
+	void SkylinePacker::clear()
+	{
+		_skyline.clear();
+		_skyline.push_back(Node{0, 0, _width + _padding});
+		_free.clear();
+		_used_area = 0;
+	}
+
+	bool SkylinePacker::insert(etc::size_type const w,
+	                           etc::size_type const h,
+	                           Slot& slot)
+	{
+		if (w == 0 || h == 0)
+			throw Exception{"Cannot pack an empty rectangle"};
+		etc::size_type const pw = w + _padding;
+		etc::size_type const ph = h + _padding;
+
+		if (_insert_free(pw, ph, slot))
+			return true;
+
+		etc::size_type best_index = _skyline.size();
+		etc::size_type best_top = std::numeric_limits<etc::size_type>::max();
+		etc::size_type best_width = std::numeric_limits<etc::size_type>::max();
+		etc::size_type best_y = 0;
+		for (etc::size_type i = 0; i < _skyline.size(); ++i)
+		{
+			etc::size_type y;
+			if (!_fit(i, pw, ph, y))
+				continue;
+			if (y + ph < best_top ||
+			    (y + ph == best_top && _skyline[i].w < best_width))
+			{
+				best_index = i;
+				best_top = y + ph;
+				best_width = _skyline[i].w;
+				best_y = y;
+			}
+		}
+		if (best_index == _skyline.size())
+			return false;
+
+		etc::size_type const x = _skyline[best_index].x;
+		_insert_skyline(best_index, x, best_y, pw, ph);
+		_used_area += pw * ph;
+		slot = Slot{x, best_y, w, h};
+		return true;
+	}
+
+	void SkylinePacker::release(Slot const& slot)
+	{
+		Slot padded{slot.x, slot.y, slot.w + _padding, slot.h + _padding};
+		ETC_ASSERT_LTE(padded.w * padded.h, _used_area);
+		_used_area -= padded.w * padded.h;
+		if (_used_area == 0)
+		{
+			this->clear();
+			return;
+		}
+
+		// Merge with free neighbours sharing a whole edge, so that a
+		// released row of small images can host a bigger one.
+		bool merged = true;
+		while (merged)
+		{
+			merged = false;
+			for (auto it = _free.begin(); it != _free.end(); ++it)
+			{
+				Slot const& f = *it;
+				if (f.y == padded.y && f.h == padded.h &&
+				    (f.x + f.w == padded.x || padded.x + padded.w == f.x))
+				{
+					padded.x = std::min(f.x, padded.x);
+					padded.w += f.w;
+				}
+				else if (f.x == padded.x && f.w == padded.w &&
+				         (f.y + f.h == padded.y || padded.y + padded.h == f.y))
+				{
+					padded.y = std::min(f.y, padded.y);
+					padded.h += f.h;
+				}
+				else
+					continue;
+				_free.erase(it);
+				merged = true;
+				break;
+			}
+		}
+		_free.push_back(padded);
+	}
+
+	float SkylinePacker::occupancy() const ETC_NOEXCEPT
+	{
+		return static_cast<float>(_used_area) / static_cast<float>(
+			(_width + _padding) * (_height + _padding)
+		);
+	}
+
+	float SkylinePacker::fragmentation() const ETC_NOEXCEPT
+	{
+		etc::size_type covered = 0;
+		for (auto const& node: _skyline)
+			covered += node.w * node.y;
+		if (covered == 0)
+			return 0.0f;
+		return static_cast<float>(covered - _used_area) /
+		       static_cast<float>(covered);
+	}
+
+	bool SkylinePacker::_fit(etc::size_type const index,
+	                         etc::size_type const w,
+	                         etc::size_type const h,
+	                         etc::size_type& y) const ETC_NOEXCEPT
+	{
+		if (_skyline[index].x + w > _width + _padding)
+			return false;
+		y = 0;
+		etc::size_type remaining = w;
+		for (etc::size_type i = index; i < _skyline.size(); ++i)
+		{
+			y = std::max(y, _skyline[i].y);
+			if (y + h > _height + _padding)
+				return false;
+			if (_skyline[i].w >= remaining)
+				return true;
+			remaining -= _skyline[i].w;
+		}
+		return false;
+	}
+
+	bool SkylinePacker::_insert_free(etc::size_type const w,
+	                                 etc::size_type const h,
+	                                 Slot& slot)
+	{
+		auto best = _free.end();
+		for (auto it = _free.begin(); it != _free.end(); ++it)
+			if (it->w >= w && it->h >= h &&
+			    (best == _free.end() || it->w * it->h < best->w * best->h))
+				best = it;
+		if (best == _free.end())
+			return false;
+
+		Slot const f = *best;
+		_free.erase(best);
+		slot = Slot{f.x, f.y, w - _padding, h - _padding};
+		_used_area += w * h;
+
+		// Split the leftover along the shorter axis.
+		Slot right, bottom;
+		if (f.w - w < f.h - h)
+		{
+			right = Slot{f.x + w, f.y, f.w - w, h};
+			bottom = Slot{f.x, f.y + h, f.w, f.h - h};
+		}
+		else
+		{
+			right = Slot{f.x + w, f.y, f.w - w, f.h};
+			bottom = Slot{f.x, f.y + h, w, f.h - h};
+		}
+		if (right.w > _padding && right.h > _padding)
+			_free.push_back(right);
+		if (bottom.w > _padding && bottom.h > _padding)
+			_free.push_back(bottom);
+		return true;
+	}
+
+	void SkylinePacker::_insert_skyline(etc::size_type const index,
+	                                    etc::size_type const x,
+	                                    etc::size_type const y,
+	                                    etc::size_type const w,
+	                                    etc::size_type const h)
+	{
+		// Keep the holes left below the new node for later use.
+		for (etc::size_type i = index; i < _skyline.size(); ++i)
+		{
+			Node const& node = _skyline[i];
+			if (node.x >= x + w)
+				break;
+			etc::size_type end = std::min(node.x + node.w, x + w);
+			if (node.y < y && end - node.x > _padding)
+				_free.push_back(Slot{node.x, node.y, end - node.x, y - node.y});
+		}
+
+		_skyline.insert(_skyline.begin() + index, Node{x, y + h, w});
+		for (etc::size_type i = index + 1; i < _skyline.size();)
+		{
+			Node const& prev = _skyline[i - 1];
+			Node& node = _skyline[i];
+			if (node.x >= prev.x + prev.w)
+				break;
+			etc::size_type shrink = prev.x + prev.w - node.x;
+			if (node.w <= shrink)
+			{
+				_skyline.erase(_skyline.begin() + i);
+				continue;
+			}
+			node.x += shrink;
+			node.w -= shrink;
+			break;
+		}
+		for (etc::size_type i = 0; i + 1 < _skyline.size();)
+		{
+			if (_skyline[i].y == _skyline[i + 1].y)
+			{
+				_skyline[i].w += _skyline[i + 1].w;
+				_skyline.erase(_skyline.begin() + i + 1);
+			}
+			else
+				++i;
+		}
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(skyline_fill_exactly)
+		{
+			SkylinePacker packer{64, 64};
+			SkylinePacker::Slot slot;
+			for (int i = 0; i < 16; ++i)
+				ETC_ENFORCE(packer.insert(16, 16, slot));
+			ETC_ENFORCE(!packer.insert(1, 1, slot));
+			ETC_ENFORCE_EQ(packer.used_area(), 64u * 64u);
+			ETC_ENFORCE_EQ(packer.fragmentation(), 0.0f);
+			ETC_ENFORCE_EQ(packer.occupancy(), 1.0f);
+		}
+
+		ETC_TEST_CASE(skyline_padding)
+		{
+			SkylinePacker packer{10, 4, 2};
+			SkylinePacker::Slot a, b, c;
+			ETC_ENFORCE(packer.insert(4, 4, a));
+			ETC_ENFORCE(packer.insert(4, 4, b));
+			ETC_ENFORCE_EQ(a.x, 0u);
+			ETC_ENFORCE_EQ(b.x, 6u);
+			ETC_ENFORCE(!packer.insert(1, 1, c));
+		}
+
+		ETC_TEST_CASE(skyline_lowest_position)
+		{
+			SkylinePacker packer{8, 8};
+			SkylinePacker::Slot tall, low;
+			ETC_ENFORCE(packer.insert(4, 6, tall));
+			ETC_ENFORCE(packer.insert(4, 2, low));
+			ETC_ENFORCE_EQ(low.x, 4u);
+			ETC_ENFORCE_EQ(low.y, 0u);
+		}
+
+		ETC_TEST_CASE(skyline_release_reuse)
+		{
+			SkylinePacker packer{32, 32};
+			SkylinePacker::Slot slots[4];
+			for (auto& slot: slots)
+				ETC_ENFORCE(packer.insert(16, 16, slot));
+			SkylinePacker::Slot extra;
+			ETC_ENFORCE(!packer.insert(16, 16, extra));
+
+			packer.release(slots[1]);
+			ETC_ENFORCE_GT(packer.fragmentation(), 0.0f);
+			ETC_ENFORCE(packer.insert(8, 8, extra));
+			ETC_ENFORCE_EQ(extra.x, slots[1].x);
+			ETC_ENFORCE_EQ(extra.y, slots[1].y);
+
+			packer.release(extra);
+			ETC_ENFORCE(packer.insert(16, 16, extra));
+			ETC_ENFORCE_EQ(extra.x, slots[1].x);
+			ETC_ENFORCE_EQ(extra.y, slots[1].y);
+		}
+
+		ETC_TEST_CASE(skyline_release_all)
+		{
+			SkylinePacker packer{16, 16, 1};
+			SkylinePacker::Slot a, b;
+			ETC_ENFORCE(packer.insert(3, 7, a));
+			ETC_ENFORCE(packer.insert(5, 2, b));
+			packer.release(a);
+			packer.release(b);
+			ETC_ENFORCE_EQ(packer.used_area(), 0u);
+			ETC_ENFORCE_EQ(packer.fragmentation(), 0.0f);
+			ETC_ENFORCE(packer.insert(15, 15, a));
+		}
+
+	} // !anonymous
+
+}}}
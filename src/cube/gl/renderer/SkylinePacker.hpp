@@ -0,0 +1,105 @@
+#ifndef  CUBE_GL_RENDERER_SKYLINEPACKER_HPP
+# define CUBE_GL_RENDERER_SKYLINEPACKER_HPP
+
+# include <cube/api.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <vector>
+
+namespace cube { namespace gl { namespace renderer {
+
+	/**
+	 * @brief Pack rectangles in a fixed size area.
+	 *
+	 * The packer keeps track of the "skyline", the top edge of the allocated
+	 * rectangles, and places new rectangles at the lowest position they fit
+	 * in (bottom-left heuristic). Released rectangles are kept in a free list
+	 * and reused before growing the skyline.
+	 *
+	 * Every rectangle is separated from its neighbours by @a padding texels,
+	 * which prevents filtering from bleeding between images.
+	 */
+	class CUBE_API SkylinePacker
+	{
+	public:
+		struct Slot
+		{
+			etc::size_type x, y, w, h;
+		};
+
+	private:
+		struct Node
+		{
+			etc::size_type x, y, w;
+		};
+
+		etc::size_type    _width;
+		etc::size_type    _height;
+		etc::size_type    _padding;
+		std::vector<Node> _skyline;
+		std::vector<Slot> _free;
+		etc::size_type    _used_area;
+
+	public:
+		SkylinePacker(etc::size_type const width,
+		              etc::size_type const height,
+		              etc::size_type const padding = 0);
+
+	public:
+		/**
+		 * @brief Find room for a @a w x @a h rectangle.
+		 *
+		 * @returns false when there is not enough room left, @a slot is not
+		 *          modified in that case.
+		 */
+		bool insert(etc::size_type const w,
+		            etc::size_type const h,
+		            Slot& slot);
+
+		/// Give back a slot returned by insert().
+		void release(Slot const& slot);
+
+		/// Forget all allocations.
+		void clear();
+
+	public:
+		inline etc::size_type width() const ETC_NOEXCEPT { return _width; }
+		inline etc::size_type height() const ETC_NOEXCEPT { return _height; }
+		inline etc::size_type padding() const ETC_NOEXCEPT { return _padding; }
+
+		/// Area of the allocated slots, padding included.
+		inline
+		etc::size_type used_area() const ETC_NOEXCEPT
+		{ return _used_area; }
+
+		/// Ratio of the total area allocated.
+		float occupancy() const ETC_NOEXCEPT;
+
+		/**
+		 * @brief Ratio of the area under the skyline that is not allocated.
+		 *
+		 * This accounts for both the gaps left below the skyline and the
+		 * released slots that were not reused. 0 means perfectly packed.
+		 */
+		float fragmentation() const ETC_NOEXCEPT;
+
+	private:
+		bool _fit(etc::size_type const index,
+		          etc::size_type const w,
+		          etc::size_type const h,
+		          etc::size_type& y) const ETC_NOEXCEPT;
+		bool _insert_free(etc::size_type const w,
+		                  etc::size_type const h,
+		                  Slot& slot);
+		void _insert_skyline(etc::size_type const index,
+		                     etc::size_type const x,
+		                     etc::size_type const y,
+		                     etc::size_type const w,
+		                     etc::size_type const h);
+	};
+
+}}}
+
+#endif
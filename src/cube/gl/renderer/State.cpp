@@ -2,6 +2,7 @@
 
 #include "Exception.hpp"
 #include "Light.hpp"
+#include "LightClusters.hpp"
 #include "Painter.hpp"
 
 #include <etc/assert.hpp>
@@ -25,6 +26,7 @@ namespace cube { namespace gl { namespace renderer {
 		matrix_type                        view;
 		matrix_type                        projection;
 		LightList                          lights;
+		LightClusters const*               light_clusters;
 		etc::stack_ptr<matrix_type>        mvp;
 		etc::stack_ptr<matrix_type>        model_view;
 		etc::stack_ptr<normal_matrix_type> normal;
@@ -35,6 +37,7 @@ namespace cube { namespace gl { namespace renderer {
 			: mvp{etc::stack_ptr_no_init}
 			, model_view{etc::stack_ptr_no_init}
 			, normal{etc::stack_ptr_no_init}
+			, light_clusters{nullptr}
 			, painter{nullptr}
 		{}
 
@@ -43,6 +46,7 @@ namespace cube { namespace gl { namespace renderer {
 			, view(other.view)
 			, projection(other.projection)
 			, lights{other.lights}
+			, light_clusters{other.light_clusters}
 			, mvp{other.mvp}
 			, model_view{other.model_view}
 			, normal{other.normal}
@@ -284,6 +288,29 @@ namespace cube { namespace gl { namespace renderer {
 		throw Exception{"Light not found"};
 	}
 
+	void State::enable(LightClusters const& clusters)
+	{
+		ETC_TRACE.debug(*this, "Enable light clusters");
+		ETC_CONTRACT_CLASS_INVARIANT();
+		if (!clusters.bound())
+			throw Exception{"Cannot enable unbound light clusters"};
+		if (_this->light_clusters != nullptr)
+			throw Exception{"Light clusters are already enabled"};
+		_this->light_clusters = &clusters;
+	}
+
+	void State::disable(LightClusters const& clusters)
+	{
+		ETC_TRACE.debug(*this, "Disable light clusters");
+		ETC_CONTRACT_CLASS_INVARIANT();
+		if (_this->light_clusters != &clusters)
+			throw Exception{"Light clusters not found"};
+		_this->light_clusters = nullptr;
+	}
+
+	LightClusters const* State::light_clusters() const ETC_NOEXCEPT
+	{ return _this->light_clusters; }
+
 
 	bool State::render_state(RenderState const state) const ETC_NOEXCEPT
 	{ return _this->render_states[state]; }
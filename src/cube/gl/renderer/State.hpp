@@ -142,6 +142,16 @@ namespace cube { namespace gl { namespace renderer {
 		void enable(Light const& light);
 		void disable(Light const& light);
 
+		/**
+		 * @brief Enable or disable clustered lighting.
+		 * @note Called automatically when light clusters are bound.
+		 */
+		void enable(LightClusters const& clusters);
+		void disable(LightClusters const& clusters);
+
+		/// Enabled light clusters or nullptr.
+		LightClusters const* light_clusters() const ETC_NOEXCEPT;
+
 	public:
 		/**
 		 * @brief Enable or disable a texture.
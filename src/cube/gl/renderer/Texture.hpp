@@ -19,17 +19,22 @@ namespace cube { namespace gl { namespace renderer {
 	public:
 		etc::size_type const width;
 		etc::size_type const height;
+		/// Number of layers of a texture array, 0 for a regular texture.
+		etc::size_type const layers;
 	protected:
 		Texture(etc::size_type const width,
-		        etc::size_type const height)
+		        etc::size_type const height,
+		        etc::size_type const layers = 0)
 			: width{width}
 			, height{height}
+			, layers{layers}
 		{}
 	public:
 		virtual
 		void
 		bind_unit(etc::size_type unit, ShaderProgramParameter& param) = 0;
 
+		/// Update a part of the texture, rows of @a data are tightly packed.
 		virtual
 		void
 		set_data(unsigned int x,
@@ -40,6 +45,18 @@ namespace cube { namespace gl { namespace renderer {
 		         renderer::ContentPacking const data_packing,
 		         void const* data) = 0;
 
+		/// Same as set_data() in a layer of a texture array.
+		virtual
+		void
+		set_layer_data(unsigned int layer,
+		               unsigned int x,
+		               unsigned int y,
+		               unsigned int width,
+		               unsigned int height,
+		               renderer::PixelFormat const data_format,
+		               renderer::ContentPacking const data_packing,
+		               void const* data) = 0;
+
 		/// Set up a linear magnifier filtering.
 		virtual
 		void mag_filter(TextureFilter const filter) = 0;
@@ -0,0 +1,259 @@
+#include "TextureAtlas.hpp"
+
+#include "Exception.hpp"
+#include "Renderer.hpp"
+#include "Texture.hpp"
+
+#include <cube/gl/surface.hpp>
+
+#include <etc/assert.hpp>
+#include <etc/log.hpp>
+#include <etc/to_string.hpp>
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace cube { namespace gl { namespace renderer {
+
+	ETC_LOG_COMPONENT("cube.gl.renderer.TextureAtlas");
+
+	struct TextureAtlas::Impl
+	{
+		Renderer&                                   renderer;
+		PixelFormat const                           format;
+		etc::size_type const                        width;
+		etc::size_type const                        height;
+		Mode const                                  mode;
+		etc::size_type const                        padding;
+		etc::size_type const                        max_layers;
+		std::vector<std::unique_ptr<SkylinePacker>> packers;
+		std::vector<TexturePtr>                     textures;
+		std::unordered_map<id_type, Region>         regions;
+		id_type                                     next_id;
+
+		Impl(Renderer& renderer,
+		     PixelFormat const format,
+		     etc::size_type const width,
+		     etc::size_type const height,
+		     Mode const mode,
+		     etc::size_type const padding,
+		     etc::size_type const max_layers)
+			: renderer(renderer)
+			, format{format}
+			, width{width}
+			, height{height}
+			, mode{mode}
+			, padding{padding}
+			, max_layers{max_layers}
+			, packers{}
+			, textures{}
+			, regions{}
+			, next_id{1}
+		{}
+
+		etc::size_type add_layer()
+		{
+			if (this->packers.size() >= this->max_layers)
+				throw Exception{
+					"Texture atlas is full (" +
+					etc::to_string(this->max_layers) + " layers)"
+				};
+			if (this->mode == Mode::pages)
+				this->textures.push_back(
+					this->renderer.new_texture(
+						this->format, this->width, this->height
+					)
+				);
+			this->packers.emplace_back(
+				new SkylinePacker{this->width, this->height, this->padding}
+			);
+			ETC_LOG.debug("Add layer", this->packers.size() - 1,
+			              "to the texture atlas");
+			return this->packers.size() - 1;
+		}
+	};
+
+	TextureAtlas::TextureAtlas(Renderer& renderer,
+	                           PixelFormat const format,
+	                           etc::size_type const width,
+	                           etc::size_type const height,
+	                           Mode const mode,
+	                           etc::size_type const padding,
+	                           etc::size_type const max_layers)
+		: _this{
+			new Impl{
+				renderer, format, width, height, mode, padding, max_layers
+			}
+		}
+	{
+		ETC_TRACE_CTOR(format, width, 'x', height, "with", max_layers,
+		               "layers");
+		if (max_layers == 0)
+			throw Exception{"A texture atlas needs at least one layer"};
+		if (mode == Mode::array)
+			_this->textures.push_back(
+				renderer.new_texture_array(format, width, height, max_layers)
+			);
+	}
+
+	TextureAtlas::~TextureAtlas()
+	{ ETC_TRACE_DTOR(); }
+
+	TextureAtlas::id_type
+	TextureAtlas::insert(etc::size_type const width,
+	                     etc::size_type const height,
+	                     PixelFormat const data_format,
+	                     ContentPacking const data_packing,
+	                     void const* data)
+	{
+		if (width > _this->width || height > _this->height)
+			throw Exception{
+				"Cannot insert an image of " + etc::to_string(width) + "x" +
+				etc::to_string(height) + " in a texture atlas of " +
+				etc::to_string(_this->width) + "x" +
+				etc::to_string(_this->height)
+			};
+
+		Region region;
+		region.layer = 0;
+		while (region.layer < _this->packers.size() &&
+		       !_this->packers[region.layer]->insert(width, height, region.slot))
+			region.layer += 1;
+		if (region.layer == _this->packers.size())
+		{
+			region.layer = _this->add_layer();
+			if (!_this->packers[region.layer]->insert(width, height, region.slot))
+				throw Exception{"Couldn't insert in an empty atlas layer"};
+		}
+
+		auto& slot = region.slot;
+		try
+		{
+			if (_this->mode == Mode::pages)
+				_this->textures[region.layer]->set_data(
+					slot.x, slot.y, slot.w, slot.h,
+					data_format, data_packing, data
+				);
+			else
+				_this->textures[0]->set_layer_data(
+					region.layer,
+					slot.x, slot.y, slot.w, slot.h,
+					data_format, data_packing, data
+				);
+		}
+		catch (...)
+		{
+			_this->packers[region.layer]->release(slot);
+			throw;
+		}
+
+		float w = static_cast<float>(_this->width);
+		float h = static_cast<float>(_this->height);
+		region.uv_min = vector::vec2f(slot.x / w, slot.y / h);
+		region.uv_max = vector::vec2f((slot.x + slot.w) / w,
+		                              (slot.y + slot.h) / h);
+		id_type id = _this->next_id++;
+		_this->regions.emplace(id, region);
+		ETC_TRACE.debug("Inserted image", id, "of", width, 'x', height,
+		                "in layer", region.layer, "at", slot.x, slot.y);
+		return id;
+	}
+
+	TextureAtlas::id_type
+	TextureAtlas::insert(surface::Surface const& surface)
+	{
+		etc::size_type bpp = surface.bytes_per_pixel();
+		etc::size_type row = surface.width() * bpp;
+		etc::size_type pitch = surface.pitch();
+		std::vector<unsigned char> packed;
+		void const* data = surface.pixels();
+		if (pitch != row)
+		{
+			packed.resize(row * surface.height());
+			auto src = static_cast<unsigned char const*>(surface.pixels());
+			for (etc::size_type y = 0; y < surface.height(); ++y)
+				std::memcpy(&packed[y * row], src + y * pitch, row);
+			data = packed.data();
+		}
+		return this->insert(
+			surface.width(),
+			surface.height(),
+			surface.pixel_format(),
+			ContentPacking::uint8,
+			data
+		);
+	}
+
+	void TextureAtlas::erase(id_type const id)
+	{
+		auto it = _this->regions.find(id);
+		if (it == _this->regions.end())
+			throw Exception{"Unknown atlas region " + etc::to_string(id)};
+		_this->packers[it->second.layer]->release(it->second.slot);
+		_this->regions.erase(it);
+	}
+
+	TextureAtlas::Region const&
+	TextureAtlas::region(id_type const id) const
+	{
+		auto it = _this->regions.find(id);
+		if (it == _this->regions.end())
+			throw Exception{"Unknown atlas region " + etc::to_string(id)};
+		return it->second;
+	}
+
+	vector::vec2f
+	TextureAtlas::remap(id_type const id, vector::vec2f const& uv) const
+	{
+		auto const& r = this->region(id);
+		return r.uv_min + uv * (r.uv_max - r.uv_min);
+	}
+
+	TexturePtr const&
+	TextureAtlas::texture(etc::size_type const layer) const
+	{
+		if (layer >= _this->packers.size() &&
+		    !(_this->mode == Mode::array && layer < _this->max_layers))
+			throw Exception{"Invalid atlas layer " + etc::to_string(layer)};
+		if (_this->mode == Mode::array)
+			return _this->textures[0];
+		return _this->textures[layer];
+	}
+
+	TextureAtlas::Mode TextureAtlas::mode() const ETC_NOEXCEPT
+	{ return _this->mode; }
+
+	etc::size_type TextureAtlas::width() const ETC_NOEXCEPT
+	{ return _this->width; }
+
+	etc::size_type TextureAtlas::height() const ETC_NOEXCEPT
+	{ return _this->height; }
+
+	etc::size_type TextureAtlas::layers() const ETC_NOEXCEPT
+	{ return _this->packers.size(); }
+
+	etc::size_type TextureAtlas::size() const ETC_NOEXCEPT
+	{ return _this->regions.size(); }
+
+	float TextureAtlas::occupancy() const ETC_NOEXCEPT
+	{
+		if (_this->packers.empty())
+			return 0.0f;
+		float res = 0.0f;
+		for (auto const& packer: _this->packers)
+			res += packer->occupancy();
+		return res / _this->packers.size();
+	}
+
+	float TextureAtlas::fragmentation() const ETC_NOEXCEPT
+	{
+		if (_this->packers.empty())
+			return 0.0f;
+		float res = 0.0f;
+		for (auto const& packer: _this->packers)
+			res += packer->fragmentation();
+		return res / _this->packers.size();
+	}
+
+}}}
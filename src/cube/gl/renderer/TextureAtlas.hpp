@@ -0,0 +1,126 @@
+#ifndef  CUBE_GL_RENDERER_TEXTUREATLAS_HPP
+# define CUBE_GL_RENDERER_TEXTUREATLAS_HPP
+
+# include "fwd.hpp"
+# include "SkylinePacker.hpp"
+
+# include <cube/gl/fwd.hpp>
+# include <cube/gl/vector.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <memory>
+
+namespace cube { namespace gl { namespace renderer {
+
+	/**
+	 * @brief Pack small images into a few big textures.
+	 *
+	 * Every inserted image gets a region in one of the atlas layers. In
+	 * Mode::pages, each layer is a separate 2D texture created on demand. In
+	 * Mode::array, all layers live in one texture array (sampled with a
+	 * sampler2DArray), so that drawing from any layer needs no texture
+	 * switch at all.
+	 *
+	 * Texture coordinates in [0, 1] of an inserted image are mapped to the
+	 * atlas with remap().
+	 */
+	class CUBE_API TextureAtlas
+	{
+	public:
+		enum class Mode
+		{
+			pages,
+			array,
+		};
+
+		typedef etc::size_type id_type;
+
+		struct Region
+		{
+			/// Page index or texture array layer.
+			etc::size_type      layer;
+			/// Texels occupied by the image.
+			SkylinePacker::Slot slot;
+			/// Texture coordinates of the image corners.
+			vector::vec2f       uv_min;
+			vector::vec2f       uv_max;
+		};
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _this;
+
+	public:
+		/**
+		 * @brief Create an atlas.
+		 *
+		 * @param   renderer        Renderer used to create the textures.
+		 * @param   format          Internal format of the textures.
+		 * @param   width           Width of a layer.
+		 * @param   height          Height of a layer.
+		 * @param   mode            Separate textures or one texture array.
+		 * @param   padding         Texels left between two images.
+		 * @param   max_layers      Maximum number of layers. A texture array
+		 *                          is allocated with all its layers.
+		 */
+		TextureAtlas(Renderer& renderer,
+		             PixelFormat const format,
+		             etc::size_type const width,
+		             etc::size_type const height,
+		             Mode const mode = Mode::pages,
+		             etc::size_type const padding = 1,
+		             etc::size_type const max_layers = 8);
+		~TextureAtlas();
+
+	public:
+		/**
+		 * @brief Insert an image.
+		 *
+		 * @throws if the image is bigger than a layer or if all layers are
+		 *         full.
+		 */
+		id_type insert(etc::size_type const width,
+		               etc::size_type const height,
+		               PixelFormat const data_format,
+		               ContentPacking const data_packing,
+		               void const* data);
+
+		/// Insert the content of a surface.
+		id_type insert(surface::Surface const& surface);
+
+		/// Release the region of an image, its texels can be reused.
+		void erase(id_type const id);
+
+		/// Region of an image.
+		Region const& region(id_type const id) const;
+
+		/// Map texture coordinates of an image to the atlas.
+		vector::vec2f remap(id_type const id, vector::vec2f const& uv) const;
+
+		/// Texture of a layer (the same texture for all layers of an array).
+		TexturePtr const& texture(etc::size_type const layer) const;
+
+	public:
+		Mode mode() const ETC_NOEXCEPT;
+		etc::size_type width() const ETC_NOEXCEPT;
+		etc::size_type height() const ETC_NOEXCEPT;
+
+		/// Number of layers in use.
+		etc::size_type layers() const ETC_NOEXCEPT;
+
+		/// Number of images in the atlas.
+		etc::size_type size() const ETC_NOEXCEPT;
+
+		/// Ratio of the allocated layers area used by images.
+		float occupancy() const ETC_NOEXCEPT;
+
+		/// Ratio of unused area below the skylines of all layers.
+		/// @see SkylinePacker::fragmentation()
+		float fragmentation() const ETC_NOEXCEPT;
+	};
+
+}}}
+
+#endif
@@ -0,0 +1,216 @@
+#include "TextureLoader.hpp"
+
+#include "AsyncTexture.hpp"
+#include "Exception.hpp"
+#include "Renderer.hpp"
+#include "Texture.hpp"
+
+#include <cube/debug.hpp>
+#include <cube/gl/surface.hpp>
+#include <cube/resource/Manager.hpp>
+
+#include <etc/assert.hpp>
+#include <etc/log.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cube { namespace gl { namespace renderer {
+
+	ETC_LOG_COMPONENT("cube.gl.renderer.TextureLoader");
+
+	namespace {
+
+		etc::size_type default_worker_count()
+		{
+			etc::size_type count = std::thread::hardware_concurrency();
+			// Keep one core for the render thread, and do not flood the disk.
+			return std::min<etc::size_type>(std::max<etc::size_type>(
+				count > 1 ? count - 1 : 1, 1), 4);
+		}
+
+	}
+
+	struct TextureLoader::Impl
+	{
+		struct Job
+		{
+			std::weak_ptr<AsyncTexture>       handle;
+			boost::filesystem::path           path;
+			std::unique_ptr<surface::Surface> surface;
+			std::string                       error;
+		};
+		typedef std::unique_ptr<Job> JobPtr;
+
+		Renderer&                renderer;
+		mutable std::mutex       mutex;
+		std::condition_variable  condition;
+		std::deque<JobPtr>       queued;
+		std::deque<JobPtr>       decoded;
+		etc::size_type           decoding;
+		bool                     running;
+		std::vector<std::thread> threads;
+
+		Impl(Renderer& renderer)
+			: renderer(renderer)
+			, mutex{}
+			, condition{}
+			, queued{}
+			, decoded{}
+			, decoding{0}
+			, running{true}
+			, threads{}
+		{}
+
+		void worker()
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			while (true)
+			{
+				this->condition.wait(lock, [&] {
+					return !this->running || !this->queued.empty();
+				});
+				if (!this->running)
+					return;
+				JobPtr job = std::move(this->queued.front());
+				this->queued.pop_front();
+				auto handle = job->handle.lock();
+				if (handle == nullptr)
+				{
+					ETC_LOG.debug("Drop cancelled load of", job->path);
+					continue;
+				}
+				this->decoding += 1;
+				lock.unlock();
+				try
+				{
+					job->surface.reset(new surface::Surface{job->path});
+					handle->_set_status(AsyncTexture::Status::decoded);
+				}
+				catch (std::exception const& err)
+				{ job->error = err.what(); }
+				// Release the handle outside of the lock, it might be the
+				// last reference.
+				handle.reset();
+				lock.lock();
+				this->decoding -= 1;
+				this->decoded.emplace_back(std::move(job));
+			}
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> guard(this->mutex);
+				this->running = false;
+			}
+			this->condition.notify_all();
+			for (auto& thread: this->threads)
+				if (thread.joinable())
+					thread.join();
+			this->threads.clear();
+		}
+	};
+
+	TextureLoader::TextureLoader(Renderer& renderer,
+	                             etc::size_type const workers)
+		: _this{new Impl{renderer}}
+	{
+		etc::size_type count = workers == 0 ? default_worker_count() : workers;
+		ETC_TRACE_CTOR("with", count, "workers");
+		try
+		{
+			for (etc::size_type i = 0; i < count; ++i)
+				_this->threads.emplace_back([this] { _this->worker(); });
+		}
+		catch (...)
+		{
+			_this->stop();
+			throw;
+		}
+	}
+
+	TextureLoader::~TextureLoader()
+	{
+		ETC_TRACE_DTOR();
+		_this->stop();
+	}
+
+	AsyncTexturePtr
+	TextureLoader::load(boost::filesystem::path const& path)
+	{
+		AsyncTexturePtr handle{
+			new AsyncTexture{path, _this->renderer.placeholder_texture()}
+		};
+		Impl::JobPtr job{new Impl::Job};
+		job->handle = handle;
+		job->path = path;
+		{
+			std::lock_guard<std::mutex> guard(_this->mutex);
+			_this->queued.emplace_back(std::move(job));
+		}
+		_this->condition.notify_one();
+		return handle;
+	}
+
+	etc::size_type TextureLoader::upload(duration_type const budget)
+	{
+		CUBE_DEBUG_PERFORMANCE_SECTION("cube.TextureLoader");
+		typedef std::chrono::steady_clock clock_type;
+		auto const start = clock_type::now();
+		etc::size_type uploaded = 0;
+		while (true)
+		{
+			Impl::JobPtr job;
+			{
+				std::lock_guard<std::mutex> guard(_this->mutex);
+				if (_this->decoded.empty())
+					break;
+				job = std::move(_this->decoded.front());
+				_this->decoded.pop_front();
+			}
+			auto handle = job->handle.lock();
+			if (handle == nullptr)
+				continue;
+			if (job->surface == nullptr)
+			{
+				handle->_set_error(std::move(job->error));
+				continue;
+			}
+			try
+			{
+				handle->_set_texture(
+					_this->renderer.resource_manager().manage(
+						_this->renderer._upload_texture(*job->surface)
+					)
+				);
+				uploaded += 1;
+			}
+			catch (Exception const& err)
+			{ handle->_set_error(err.what()); }
+
+			if (clock_type::now() - start >= budget)
+				break;
+		}
+		if (uploaded > 0)
+			ETC_LOG.debug("Uploaded", uploaded, "textures in",
+			              std::chrono::duration_cast<duration_type>(
+			                  clock_type::now() - start
+			              ).count(), "us");
+		return uploaded;
+	}
+
+	etc::size_type TextureLoader::pending() const
+	{
+		std::lock_guard<std::mutex> guard(_this->mutex);
+		return _this->queued.size() + _this->decoding + _this->decoded.size();
+	}
+
+	etc::size_type TextureLoader::workers() const ETC_NOEXCEPT
+	{ return _this->threads.size(); }
+
+}}}
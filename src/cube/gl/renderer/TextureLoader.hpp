@@ -0,0 +1,70 @@
+#ifndef  CUBE_GL_RENDERER_TEXTURELOADER_HPP
+# define CUBE_GL_RENDERER_TEXTURELOADER_HPP
+
+# include "fwd.hpp"
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <wrappers/boost/filesystem.hpp>
+
+# include <chrono>
+# include <memory>
+
+namespace cube { namespace gl { namespace renderer {
+
+	/**
+	 * @brief Decode images in background and upload them in small steps.
+	 *
+	 * Images are decoded by a pool of worker threads. The resulting surfaces
+	 * are then uploaded from the render thread by upload(), which stops as
+	 * soon as the given time budget is spent, so that a burst of texture
+	 * loads never stalls a frame.
+	 */
+	class CUBE_API TextureLoader
+	{
+	public:
+		typedef std::chrono::microseconds duration_type;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _this;
+
+	public:
+		/**
+		 * @brief Start the decoding threads.
+		 *
+		 * @param   renderer    Renderer used to create the textures.
+		 * @param   workers     Number of decoding threads, 0 to guess one
+		 *                      from the hardware concurrency.
+		 */
+		explicit
+		TextureLoader(Renderer& renderer, etc::size_type const workers = 0);
+
+		/// Stop the workers, pending loads are dropped.
+		~TextureLoader();
+
+	public:
+		/// Queue an image for decoding and return its handle.
+		AsyncTexturePtr load(boost::filesystem::path const& path);
+
+		/**
+		 * @brief Upload decoded images until @a budget is spent.
+		 *
+		 * At least one texture is uploaded when one is available, whatever
+		 * the budget. Must be called from the render thread.
+		 *
+		 * @returns the number of textures that became ready.
+		 */
+		etc::size_type upload(duration_type const budget);
+
+		/// Number of images queued, being decoded or waiting for upload.
+		etc::size_type pending() const;
+
+		/// Number of decoding threads.
+		etc::size_type workers() const ETC_NOEXCEPT;
+	};
+
+}}}
+
+#endif
@@ -1,6 +1,7 @@
 # -*- encoding: utf8 -*-
 
 from ._renderer import *
+from .AsyncTexture import AsyncTexture
 from .Bindable import Bindable
 from .constants import *
 from .Drawable import Drawable
@@ -118,6 +118,7 @@ namespace cube { namespace gl { namespace renderer {
 		sampler1d, sampler2d, sampler3d,
 		samplerCube,
 		sampler1DShadow, sampler2DShadow,
+		sampler2DArray,
 
 		_max_value
 	};
@@ -7,6 +7,7 @@
 
 namespace cube { namespace gl { namespace renderer {
 
+	class AsyncTexture;
 	class Bindable;
 	class Drawable;
 
@@ -17,6 +18,8 @@ namespace cube { namespace gl { namespace renderer {
 	typedef LightInfo<LightKind::spot>        SpotLightInfo;
 	typedef LightInfo<LightKind::custom>      CustomLightInfo;
 	typedef std::unique_ptr<CustomLightInfo>  CustomLightInfoPtr;
+	class LightClusters;
+	class LightGrid;
 
 	class Painter;
 	class Renderer;
@@ -29,12 +32,15 @@ namespace cube { namespace gl { namespace renderer {
 	class ShaderProgramParameter;
 	class ShaderRoutine;
 	class Texture;
+	class TextureLoader;
 	class VertexBuffer;
 	class VertexBufferAttribute;
 	struct State;
 
 
+	typedef std::shared_ptr<AsyncTexture>           AsyncTexturePtr;
 	typedef std::shared_ptr<Light>                  LightPtr;
+	typedef std::shared_ptr<LightClusters>          LightClustersPtr;
 	typedef std::shared_ptr<RenderTarget>           RenderTargetPtr;
 	typedef std::shared_ptr<ShaderProgram>          ShaderProgramPtr;
 	typedef std::shared_ptr<ShaderRoutine>          ShaderRoutinePtr;
@@ -0,0 +1,67 @@
+#include "PixelBufferPool.hpp"
+
+#include <etc/log.hpp>
+#include <etc/scope_exit.hpp>
+
+#include <cstring>
+
+namespace cube { namespace gl { namespace renderer { namespace opengl {
+
+	ETC_LOG_COMPONENT("cube.gl.renderer.opengl.PixelBufferPool");
+
+	PixelBufferPool::PixelBufferPool(etc::size_type const count)
+		: _buffers(count == 0 ? 1 : count, Buffer{0, 0})
+		, _next{0}
+	{
+		ETC_TRACE_CTOR("with", _buffers.size(), "buffers");
+		for (auto& buffer: _buffers)
+		{
+			try { gl::GenBuffers(1, &buffer.id); }
+			catch (...)
+			{
+				for (auto& b: _buffers)
+					if (b.id != 0)
+						gl::DeleteBuffers<gl::no_throw>(1, &b.id);
+				throw;
+			}
+		}
+	}
+
+	PixelBufferPool::~PixelBufferPool()
+	{
+		ETC_TRACE_DTOR();
+		for (auto& buffer: _buffers)
+			gl::DeleteBuffers<gl::no_throw>(1, &buffer.id);
+	}
+
+	void PixelBufferPool::stream(void const* data,
+	                             etc::size_type const size,
+	                             std::function<void()> const& upload)
+	{
+		Buffer& buffer = _buffers[_next];
+		_next = (_next + 1) % _buffers.size();
+
+		gl::BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+		ETC_SCOPE_EXIT{
+			gl::BindBuffer<gl::no_throw>(GL_PIXEL_UNPACK_BUFFER, 0);
+		};
+
+		// Orphan the old storage (or grow it), the driver keeps the previous
+		// one alive until pending transfers are done.
+		if (buffer.size < size)
+			buffer.size = size;
+		gl::BufferData(
+			GL_PIXEL_UNPACK_BUFFER, buffer.size, nullptr, GL_STREAM_DRAW
+		);
+
+		void* ptr = gl::MapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+		if (ptr == nullptr)
+			throw Exception{"Couldn't map the pixel buffer"};
+		std::memcpy(ptr, data, size);
+		if (gl::UnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+			throw Exception{"Pixel buffer content lost while mapped"};
+
+		upload();
+	}
+
+}}}}
@@ -0,0 +1,55 @@
+#ifndef  CUBE_GL_RENDERER_OPENGL_PIXELBUFFERPOOL_HPP
+# define CUBE_GL_RENDERER_OPENGL_PIXELBUFFERPOOL_HPP
+
+# include "_opengl.hpp"
+
+# include <etc/types.hpp>
+
+# include <functional>
+# include <vector>
+
+namespace cube { namespace gl { namespace renderer { namespace opengl {
+
+	/**
+	 * @brief Ring of pixel unpack buffers used to stream texture data.
+	 *
+	 * Each upload goes to the next buffer of the ring, whose storage is
+	 * orphaned first: the driver can still read the previous content while
+	 * we fill a fresh one, and the texture transfer is done by the GPU
+	 * instead of blocking the render thread.
+	 */
+	class PixelBufferPool
+	{
+	private:
+		struct Buffer
+		{
+			GLuint         id;
+			etc::size_type size;
+		};
+		std::vector<Buffer> _buffers;
+		etc::size_type      _next;
+
+	public:
+		explicit
+		PixelBufferPool(etc::size_type const count = 4);
+		~PixelBufferPool();
+
+		PixelBufferPool(PixelBufferPool const&) = delete;
+		PixelBufferPool& operator =(PixelBufferPool const&) = delete;
+
+	public:
+		/**
+		 * @brief Copy @a size bytes of @a data into a buffer.
+		 *
+		 * The buffer is bound to GL_PIXEL_UNPACK_BUFFER while @a upload is
+		 * called, so that pixel transfers in it read from the buffer (with
+		 * a null data pointer meaning offset 0).
+		 */
+		void stream(void const* data,
+		            etc::size_type const size,
+		            std::function<void()> const& upload);
+	};
+
+}}}}
+
+#endif
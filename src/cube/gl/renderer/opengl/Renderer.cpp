@@ -1,4 +1,5 @@
 #include "Renderer.hpp"
+#include "PixelBufferPool.hpp"
 #include "VertexBuffer.hpp"
 #include "Shader.hpp"
 #include "ShaderProgram.hpp"
@@ -95,6 +96,7 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 	{
 		ETC_TRACE.debug(*this, "Shutting down");
 		renderer::Renderer::shutdown();
+		_pixel_buffers.reset();
 	}
 
 	renderer::RendererType const&
@@ -193,6 +195,23 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		return TexturePtr{new Texture{surface}};
 	}
 
+	TexturePtr GLRenderer::_new_texture(PixelFormat const internal_format,
+	                                    etc::size_type const width,
+	                                    etc::size_type const height,
+	                                    etc::size_type const layers)
+	{
+		return TexturePtr{
+			new Texture{internal_format, width, height, layers}
+		};
+	}
+
+	TexturePtr GLRenderer::_upload_texture(surface::Surface const& surface)
+	{
+		if (_pixel_buffers == nullptr)
+			_pixel_buffers.reset(new PixelBufferPool);
+		return TexturePtr{new Texture{surface, *_pixel_buffers}};
+	}
+
 	void GLRenderer::clear(cube::gl::renderer::BufferBit flags)
 	{
 		using namespace cube::gl::renderer;
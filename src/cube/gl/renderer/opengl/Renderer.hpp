@@ -6,12 +6,14 @@
 namespace cube { namespace gl { namespace renderer { namespace opengl {
 
 	struct RendererType;
+	class PixelBufferPool;
 
 	class GLRenderer
 		: public renderer::Renderer
 	{
 	private:
-		std::unique_ptr<RendererType> _description;
+		std::unique_ptr<RendererType>    _description;
+		std::unique_ptr<PixelBufferPool> _pixel_buffers;
 
 	public:
 		GLRenderer(system::window::RendererContext& context);
@@ -41,6 +43,14 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 
 		TexturePtr _new_texture(surface::Surface const& surface) override;
 
+		TexturePtr _new_texture(PixelFormat const internal_format,
+		                        etc::size_type const width,
+		                        etc::size_type const height,
+		                        etc::size_type const layers) override;
+
+		/// Stream the pixels through a pixel unpack buffer.
+		TexturePtr _upload_texture(surface::Surface const& surface) override;
+
 		void draw_elements(renderer::DrawMode mode,
 		                   unsigned int count,
 		                   cube::gl::renderer::ContentType type,
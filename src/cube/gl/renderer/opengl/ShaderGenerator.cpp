@@ -74,6 +74,7 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 				"samplerCube",
 				"sampler1DShadow",
 				"sampler2DShadow",
+				"sampler2DArray",
 			};
 			return names[static_cast<int>(type)];
 		}
@@ -304,7 +305,17 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 
 #define CR "\n"
 		std::stringstream ss;
-		ss << _this->version_source() << CR CR;
+		ss << _this->version_source() << CR;
+		if (_this->glsl_version < 130 &&
+		    std::any_of(
+		        proxy.parameters.begin(),
+		        proxy.parameters.end(),
+		        [] (Proxy::Parameter const& param) {
+		            return param.type == ShaderParameterType::sampler2DArray;
+		        }
+		    ))
+			ss << "#extension GL_EXT_texture_array : enable" << CR;
+		ss << CR;
 
 		ss << "// Parameters" << CR;
 		for (auto const& param: proxy.parameters)
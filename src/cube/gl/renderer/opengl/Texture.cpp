@@ -1,6 +1,7 @@
 #include "Texture.hpp"
 
 #include "Exception.hpp"
+#include "PixelBufferPool.hpp"
 #include "../ShaderProgram.hpp"
 
 #include <cube/gl/surface.hpp>
@@ -9,13 +10,60 @@
 #include <etc/scope_exit.hpp>
 #include <etc/to_string.hpp>
 
+#include <algorithm>
+
 namespace cube { namespace gl { namespace renderer { namespace opengl {
 
 	ETC_LOG_COMPONENT("cube.gl.renderer.opengl.Texture");
 
+	namespace {
+
+		// Unpack rows of @a pitch bytes holding @a width pixels, until
+		// destroyed.
+		struct UnpackRows
+		{
+			UnpackRows(etc::size_type const pitch,
+			           etc::size_type const width,
+			           etc::size_type const bpp)
+			{
+				auto padded = [&] (etc::size_type const alignment) {
+					return (width * bpp + alignment - 1) / alignment * alignment;
+				};
+				GLint alignment = 8;
+				while (alignment > 1 && padded(alignment) != pitch)
+					alignment /= 2;
+				if (padded(alignment) != pitch)
+				{
+					if (pitch % bpp != 0)
+						throw Exception{
+							"Cannot unpack rows of " + std::to_string(pitch) + " bytes"
+						};
+					gl::PixelStorei(GL_UNPACK_ROW_LENGTH, pitch / bpp);
+				}
+				gl::PixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+			}
+
+			~UnpackRows()
+			{
+				gl::PixelStorei<gl::no_throw>(GL_UNPACK_ALIGNMENT, 4);
+				gl::PixelStorei<gl::no_throw>(GL_UNPACK_ROW_LENGTH, 0);
+			}
+		};
+
+	} // !anonymous
+
 	Texture::Texture(surface::Surface const& surface)
+		: Texture{surface, static_cast<PixelBufferPool*>(nullptr)}
+	{}
+
+	Texture::Texture(surface::Surface const& surface, PixelBufferPool& pool)
+		: Texture{surface, &pool}
+	{}
+
+	Texture::Texture(surface::Surface const& surface, PixelBufferPool* pool)
 		: Super{surface.width(), surface.height()}
 		, _id(0)
+		, _target{GL_TEXTURE_2D}
 		, _unit(-1)
 		, _has_mipmaps{false}
 	{
@@ -81,6 +129,7 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 			};
 		}
 
+		UnpackRows unpack_rows{surface.pitch(), surface.width(), bpp};
 		gl::TexImage2D(
 			GL_TEXTURE_2D,
 			0,
@@ -90,8 +139,23 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 			0,
 			format,
 			type,
-			surface.pixels()
+			pool == nullptr ? surface.pixels() : nullptr
 		);
+		if (pool != nullptr)
+		{
+			pool->stream(
+				surface.pixels(),
+				surface.pitch() * surface.height(),
+				[&] {
+					gl::TexSubImage2D(
+						GL_TEXTURE_2D, 0,
+						0, 0, surface.width(), surface.height(),
+						format, type,
+						nullptr
+					);
+				}
+			);
+		}
 
 		gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -106,10 +170,10 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		switch (filter)
 		{
 		case TextureFilter::nearest:
-			gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			gl::TexParameteri(_target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 			break;
 		case TextureFilter::linear:
-			gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			gl::TexParameteri(_target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 			break;
 		default:
 			throw Exception{"Unknown filter value"};
@@ -122,10 +186,10 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		switch (filter)
 		{
 		case TextureFilter::nearest:
-			gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			gl::TexParameteri(_target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 			break;
 		case TextureFilter::linear:
-			gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			gl::TexParameteri(_target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 			break;
 		default:
 			throw Exception{"Unknown filter value"};
@@ -141,14 +205,14 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		{
 		case TextureFilter::nearest:
 			gl::TexParameteri(
-				GL_TEXTURE_2D,
+				_target,
 				GL_TEXTURE_MIN_FILTER,
 				GL_NEAREST_MIPMAP_NEAREST
 			);
 			break;
 		case TextureFilter::linear:
 			gl::TexParameteri(
-				GL_TEXTURE_2D,
+				_target,
 				GL_TEXTURE_MIN_FILTER,
 				GL_LINEAR_MIPMAP_NEAREST
 			);
@@ -167,14 +231,14 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		{
 		case TextureFilter::nearest:
 			gl::TexParameteri(
-				GL_TEXTURE_2D,
+				_target,
 				GL_TEXTURE_MIN_FILTER,
 				GL_NEAREST_MIPMAP_LINEAR
 			);
 			break;
 		case TextureFilter::linear:
 			gl::TexParameteri(
-				GL_TEXTURE_2D,
+				_target,
 				GL_TEXTURE_MIN_FILTER,
 				GL_LINEAR_MIPMAP_LINEAR
 			);
@@ -188,37 +252,66 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 	{
 		// XXX levels not used
 		Guard guard(*this);
-		gl::GenerateMipmap(GL_TEXTURE_2D);
+		gl::GenerateMipmap(_target);
 		_has_mipmaps = true;
 	}
 
-	//Texture::Texture(renderer::PixelFormat const internal_format,
-	//                 unsigned int width,
-	//                 unsigned int height,
-	//                 renderer::PixelFormat const data_format,
-	//                 renderer::ContentPacking const data_packing,
-	//                 void const* data)
-	//	: _surface(nullptr)
-	//	, _id(0)
-	//	, _unit(-1)
-	//{
-	//	ETC_TRACE_CTOR("from data");
-	//	gl::GenTextures(1, &_id);
-	//	gl::BindTexture(GL_TEXTURE_2D, _id);
-	//	gl::TexImage2D(
-	//		GL_TEXTURE_2D,
-	//		0,                  // level
-	//		gl::get_pixel_format(internal_format),                // 1, 2, 3, 4
-	//		width,
-	//		height,
-	//		0,                  // border
-	//		gl::get_pixel_format(data_format),
-	//		gl::get_content_packing(data_packing),
-	//		data
-	//	);
-	//	gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	//	gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	//}
+	Texture::Texture(renderer::PixelFormat const internal_format,
+	                 etc::size_type const width,
+	                 etc::size_type const height,
+	                 etc::size_type const layers)
+		: Super{width, height, layers}
+		, _id(0)
+		, _target{layers == 0 ? GL_TEXTURE_2D : GL_TEXTURE_2D_ARRAY}
+		, _unit(-1)
+		, _has_mipmaps{false}
+	{
+		ETC_TRACE_CTOR("empty", internal_format, width, 'x', height,
+		               "with", layers, "layers");
+		gl::GenTextures(1, &_id);
+		auto cleanup = etc::scope_exit([&] {
+			gl::DeleteTextures<gl::no_throw>(1, &_id);
+		});
+		Guard bind_guard(*this);
+
+		// The data format has to be valid even without data.
+		GLenum format = GL_RGBA;
+		if (internal_format == PixelFormat::depth_component)
+			format = GL_DEPTH_COMPONENT;
+		else if (internal_format == PixelFormat::depth_stencil)
+			format = GL_DEPTH_STENCIL;
+
+		if (_target == GL_TEXTURE_2D)
+			gl::TexImage2D(
+				_target,
+				0,
+				gl::get_pixel_format(internal_format),
+				width,
+				height,
+				0,
+				format,
+				GL_UNSIGNED_BYTE,
+				nullptr
+			);
+		else
+			gl::TexImage3D(
+				_target,
+				0,
+				gl::get_pixel_format(internal_format),
+				width,
+				height,
+				layers,
+				0,
+				format,
+				GL_UNSIGNED_BYTE,
+				nullptr
+			);
+		gl::TexParameteri(_target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		gl::TexParameteri(_target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		gl::TexParameteri(_target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		gl::TexParameteri(_target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		cleanup.dismiss();
+	}
 
 	Texture::~Texture()
 	{
@@ -230,13 +323,14 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 	void Texture::_bind()
 	{
 		ETC_TRACE.debug("Bind texture", _id);
-		gl::Enable(GL_TEXTURE_2D);
-		gl::BindTexture(GL_TEXTURE_2D, _id);
+		if (_target == GL_TEXTURE_2D)
+			gl::Enable(GL_TEXTURE_2D);
+		gl::BindTexture(_target, _id);
 	}
 
 	void Texture::_unbind() ETC_NOEXCEPT
 	{
-		gl::BindTexture<gl::no_throw>(GL_TEXTURE_2D, 0);
+		gl::BindTexture<gl::no_throw>(_target, 0);
 	}
 
 	void
@@ -257,9 +351,24 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 	                  renderer::PixelFormat const data_format,
 	                  renderer::ContentPacking const data_packing,
 	                  void const* data)
+	{
+		this->set_layer_data(
+			0, x, y, width, height, data_format, data_packing, data
+		);
+	}
+
+	void
+	Texture::set_layer_data(unsigned int layer,
+	                        unsigned int x,
+	                        unsigned int y,
+	                        unsigned int width,
+	                        unsigned int height,
+	                        renderer::PixelFormat const data_format,
+	                        renderer::ContentPacking const data_packing,
+	                        void const* data)
 	{
 		ETC_TRACE.debug(
-			"Set data of texture", _id,
+			"Set data of texture", _id, "layer", layer,
 			"at", x, y, "of size", width, height,
 			data_format, '=', gl::get_pixel_format(data_format),
 			data_packing,'=', gl::get_content_packing(data_packing)
@@ -268,17 +377,33 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 			return;
 		if (width + x > this->width || height + y > this->height)
 			throw Exception{"Trying to write outside of the texture"};
+		if (layer >= std::max<etc::size_type>(this->layers, 1))
+			throw Exception{"Trying to write outside of the texture layers"};
 
 		Guard guard(*this);
-		gl::TexSubImage2D(GL_TEXTURE_2D, 0,
-		                  x, y, width, height,
-		                  gl::get_pixel_format(data_format),
-		                  gl::get_content_packing(data_packing),
-		                  data);
+		// Rows are tightly packed.
+		gl::PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		ETC_SCOPE_EXIT{
+			gl::PixelStorei<gl::no_throw>(GL_UNPACK_ALIGNMENT, 4);
+		};
+		if (_target == GL_TEXTURE_2D)
+			gl::TexSubImage2D(_target, 0,
+			                  x, y, width, height,
+			                  gl::get_pixel_format(data_format),
+			                  gl::get_content_packing(data_packing),
+			                  data);
+		else
+			gl::TexSubImage3D(_target, 0,
+			                  x, y, layer, width, height, 1,
+			                  gl::get_pixel_format(data_format),
+			                  gl::get_content_packing(data_packing),
+			                  data);
 	}
 
 	void Texture::save_bmp(boost::filesystem::path const& p)
 	{
+		if (_target != GL_TEXTURE_2D)
+			throw Exception{"Cannot save a texture array as a bitmap"};
 		Guard guard(*this);
 		static GLenum const tex_kind = GL_TEXTURE_2D;
 		int width, height, fmt, red_size, green_size, blue_size, alpha_size;
@@ -9,6 +9,8 @@
 
 namespace cube { namespace gl { namespace renderer { namespace opengl {
 
+	class PixelBufferPool;
+
 	class Texture
 		: public renderer::Texture
 	{
@@ -16,13 +18,26 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		typedef renderer::Texture Super;
 	private:
 		GLuint          _id;
+		GLenum          _target;
 		etc::size_type  _unit;
 		bool            _has_mipmaps;
 
 	public:
 		Texture(surface::Surface const& surface);
+
+		/// Stream the surface pixels through a pixel buffer of @a pool.
+		Texture(surface::Surface const& surface, PixelBufferPool& pool);
+
+		/// Create an empty texture, or a texture array when @a layers > 0.
+		Texture(renderer::PixelFormat const internal_format,
+		        etc::size_type const width,
+		        etc::size_type const height,
+		        etc::size_type const layers = 0);
 		~Texture();
 
+	private:
+		Texture(surface::Surface const& surface, PixelBufferPool* pool);
+
 	public:
 		void
 		bind_unit(etc::size_type unit,
@@ -36,6 +51,16 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		         renderer::PixelFormat const data_format,
 		         renderer::ContentPacking const data_packing,
 		         void const* data) override;
+
+		void
+		set_layer_data(unsigned int layer,
+		               unsigned int x,
+		               unsigned int y,
+		               unsigned int width,
+		               unsigned int height,
+		               renderer::PixelFormat const data_format,
+		               renderer::ContentPacking const data_packing,
+		               void const* data) override;
 		void mag_filter(TextureFilter const filter) override;
 		void min_filter(TextureFilter const filter) override;
 		void min_filter_bilinear(TextureFilter const filter) override;
@@ -125,12 +125,15 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		_CUBE_GL_OPENGL_WRAP(LinkProgram);
 		_CUBE_GL_OPENGL_WRAP(LoadIdentity);
 		_CUBE_GL_OPENGL_WRAP(NormalPointer);
+		_CUBE_GL_OPENGL_WRAP(PixelStorei);
 		_CUBE_GL_OPENGL_WRAP(ShaderSource);
 		_CUBE_GL_OPENGL_WRAP(TexCoordPointer);
 		_CUBE_GL_OPENGL_WRAP(TexImage2D);
+		_CUBE_GL_OPENGL_WRAP(TexImage3D);
 		_CUBE_GL_OPENGL_WRAP(TexParameteri);
 		//_CUBE_GL_OPENGL_WRAP(TexStorage2D);
 		_CUBE_GL_OPENGL_WRAP(TexSubImage2D);
+		_CUBE_GL_OPENGL_WRAP(TexSubImage3D);
 		_CUBE_GL_OPENGL_WRAP(Uniform1f);
 		_CUBE_GL_OPENGL_WRAP(Uniform1i);
 		_CUBE_GL_OPENGL_WRAP(Uniform3fv);
@@ -151,6 +154,8 @@ namespace cube { namespace gl { namespace renderer { namespace opengl {
 		_CUBE_GL_OPENGL_WRAP_RET(CreateShader, GLuint);
 		_CUBE_GL_OPENGL_WRAP_RET(GetUniformLocation, GLint);
 		_CUBE_GL_OPENGL_WRAP_RET(GetFragDataLocation, GLint);
+		_CUBE_GL_OPENGL_WRAP_RET(MapBuffer, void*);
+		_CUBE_GL_OPENGL_WRAP_RET(UnmapBuffer, GLboolean);
 
 # undef _CUBE_GL_OPENGL_WRAP
 # undef _CUBE_GL_OPENGL_WRAP_RET
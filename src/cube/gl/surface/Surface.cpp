@@ -163,6 +163,9 @@ namespace cube { namespace gl { namespace surface {
 	void const* Surface::pixels() const ETC_NOEXCEPT
 	{ return _this->surface->pixels; }
 
+	etc::size_type Surface::pitch() const ETC_NOEXCEPT
+	{ return _this->surface->pitch; }
+
 	PixelFormat Surface::pixel_format() const ETC_NOEXCEPT
 	{ return _this->pixel_format; }
 
@@ -2,5 +2,6 @@
 # define CUBE_GL_TEXT_HPP
 
 # include "text/Text.hpp"
+# include "text/TextBatch.hpp"
 
 #endif
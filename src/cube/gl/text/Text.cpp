@@ -11,24 +11,25 @@
 
 namespace cube { namespace gl { namespace text {
 
+	// Vertices drawn with one glyph page.
+	struct Text::Part
+	{
+		font::Font::TextPart  range;
+		material::MaterialPtr material;
+		renderer::BindablePtr material_view;
+	};
+
 	template<typename CharType>
 	Text::Text(font::Font& font,
 	           std::basic_string<CharType> const& str)
 		: _font(font)
-		, _size(str.size())
-		, _vertices{_font.generate_text(str)}
-		, _material{new material::Material}
-		, _material_view{nullptr}
+		, _str(str)
+		, _evictions{0}
+		, _vertices{}
+		, _parts{}
+		, _color{new color::Color3f("white")}
 	{
-		_material->add_texture(
-		    _font.texture(),
-		    material::TextureType::opacity,
-		    material::TextureMapping::uv,
-		    material::StackOperation::add,
-		    material::TextureMapMode::wrap,
-		    1.0// material::BlendMode::basic
-		);
-		_material->ambient(color::Color3f("white"));
+		_generate();
 	}
 
 	template
@@ -47,22 +48,62 @@ namespace cube { namespace gl { namespace text {
 	Text::~Text()
 	{}
 
+	void Text::_generate()
+	{
+		_evictions = _font.evictions();
+		std::vector<font::Font::TextPart> ranges;
+		_vertices = _font.generate_text(_str, &ranges);
+		_parts.clear();
+		for (auto const& range: ranges)
+		{
+			material::MaterialPtr material{new material::Material};
+			material->add_texture(
+			    _font.texture(range.page),
+			    (_font.render_mode() == font::Font::RenderMode::distance_field
+			     ? material::TextureType::distance_field
+			     : material::TextureType::opacity),
+			    material::TextureMapping::uv,
+			    material::StackOperation::add,
+			    material::TextureMapMode::wrap,
+			    1.0// material::BlendMode::basic
+			);
+			material->ambient(*_color);
+			_parts.push_back(Part{range, std::move(material), nullptr});
+		}
+	}
+
 	void Text::draw(renderer::Painter& painter)
 	{
-		if (_material_view == nullptr)
-			_material_view = _material->bindable(_font.renderer());
+		// Glyph pages used by this text might have been reused.
+		if (_evictions != _font.evictions())
+			_generate();
+		if (_vertices == nullptr)
+			return;
+		for (auto& part: _parts)
+		{
+			if (part.material_view == nullptr)
+				part.material_view = part.material->bindable(_font.renderer());
 
-		painter.with(*_material_view)
-			->draw_arrays(renderer::DrawMode::quads, *_vertices);
+			painter.with(*part.material_view)->draw_arrays(
+				renderer::DrawMode::quads,
+				*_vertices,
+				part.range.first,
+				part.range.count
+			);
+		}
 	}
 
 	color::Color3f const& Text::color() const
-	{ return _material->ambient(); }
+	{ return *_color; }
 
 	void Text::color(color::Color3f const& color)
 	{
-		_material->ambient(color);
-		_material_view = nullptr; // XXX not needed ?
+		*_color = color;
+		for (auto& part: _parts)
+		{
+			part.material->ambient(color);
+			part.material_view = nullptr; // XXX not needed ?
+		}
 	}
 
 }}}
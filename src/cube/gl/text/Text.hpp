@@ -10,7 +10,9 @@
 
 # include <boost/noncopyable.hpp>
 
+# include <memory>
 # include <string>
+# include <vector>
 
 namespace cube { namespace gl { namespace text {
 
@@ -18,11 +20,14 @@ namespace cube { namespace gl { namespace text {
 		: private boost::noncopyable
 	{
 	private:
+		struct Part;
+
 		font::Font&               _font;
-		etc::size_type            _size;
+		std::string               _str;
+		etc::size_type            _evictions;
 		renderer::VertexBufferPtr _vertices;
-		material::MaterialPtr     _material;
-		renderer::BindablePtr     _material_view;
+		std::vector<Part>         _parts;
+		std::unique_ptr<color::Color3f> _color;
 
 	public:
 		template<typename CharType>
@@ -38,6 +43,9 @@ namespace cube { namespace gl { namespace text {
 
 		void color(color::Color3f const& color);
 		color::Color3f const& color() const;
+
+	private:
+		void _generate();
 	};
 
 }}}
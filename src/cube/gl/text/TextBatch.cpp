@@ -0,0 +1,251 @@
+#include "TextBatch.hpp"
+
+#include <cube/gl/color.hpp>
+#include <cube/gl/font.hpp>
+#include <cube/gl/material.hpp>
+#include <cube/gl/renderer/Painter.hpp>
+#include <cube/gl/renderer/Renderer.hpp>
+#include <cube/gl/renderer/VertexBuffer.hpp>
+#include <cube/gl/vector.hpp>
+
+#include <etc/log.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace cube { namespace gl { namespace text {
+
+	ETC_LOG_COMPONENT("cube.gl.text.TextBatch");
+
+	namespace {
+
+		struct Entry
+		{
+			std::string         str;
+			vector::Vector2f    position;
+			color::Color4f      color;
+
+			bool operator ==(Entry const& other) const
+			{
+				return this->str == other.str
+					&& this->position == other.position
+					&& this->color == other.color;
+			}
+		};
+
+		// Indices drawn with one glyph page.
+		struct Range
+		{
+			etc::size_type      page;
+			etc::size_type      first;
+			etc::size_type      count;
+		};
+
+	}
+
+	struct TextBatch::Impl
+	{
+		font::Font&                         font;
+		std::vector<Entry>                  entries;
+		std::vector<Entry>                  built_entries;
+		bool                                dirty;
+		etc::size_type                      evictions;
+		renderer::VertexBufferPtr           vertices;
+		renderer::VertexBufferPtr           indices;
+		std::vector<Range>                  ranges;
+		std::vector<material::MaterialPtr>  materials;
+		std::vector<renderer::BindablePtr>  material_views;
+
+		Impl(font::Font& font)
+			: font(font)
+			, entries{}
+			, built_entries{}
+			, dirty{false}
+			, evictions{font.evictions()}
+			, vertices{}
+			, indices{}
+			, ranges{}
+			, materials{}
+			, material_views{}
+		{}
+
+		void build()
+		{
+			this->dirty = false;
+			this->built_entries = this->entries;
+			this->vertices.reset();
+			this->indices.reset();
+			this->ranges.clear();
+			if (this->entries.empty())
+				return;
+
+			// Quads grouped by page.
+			struct Bucket
+			{
+				std::vector<vector::Vector2f> vertices;
+				std::vector<vector::Vector2f> tex_coords;
+				std::vector<color::Color4f>   colors;
+			};
+			std::vector<Bucket> buckets;
+			for (auto const& entry: this->entries)
+			{
+				auto layout = this->font.layout(entry.str);
+				for (auto const& part: layout->parts)
+				{
+					if (part.page >= buckets.size())
+						buckets.resize(part.page + 1);
+					auto& bucket = buckets[part.page];
+					for (etc::size_type i = part.first;
+					     i < part.first + part.count; ++i)
+					{
+						bucket.vertices.push_back(
+							layout->vertices[i] + entry.position
+						);
+						bucket.tex_coords.push_back(layout->tex_coords[i]);
+						bucket.colors.push_back(entry.color);
+					}
+				}
+			}
+			// Layouts generated above might have evicted pages used by
+			// previous entries.
+			this->evictions = this->font.evictions();
+
+			std::vector<vector::Vector2f> vertices;
+			std::vector<vector::Vector2f> tex_coords;
+			std::vector<color::Color4f> colors;
+			std::vector<uint32_t> indices;
+			for (etc::size_type page = 0; page < buckets.size(); ++page)
+			{
+				auto const& bucket = buckets[page];
+				if (bucket.vertices.empty())
+					continue;
+				this->ranges.push_back(Range{page, indices.size(), 0});
+				for (etc::size_type i = 0; i < bucket.vertices.size(); i += 4)
+				{
+					uint32_t base = static_cast<uint32_t>(vertices.size() + i);
+					for (uint32_t idx: {0, 1, 2, 0, 2, 3})
+						indices.push_back(base + idx);
+				}
+				this->ranges.back().count = indices.size() - this->ranges.back().first;
+				vertices.insert(vertices.end(),
+				                bucket.vertices.begin(), bucket.vertices.end());
+				tex_coords.insert(tex_coords.end(),
+				                  bucket.tex_coords.begin(), bucket.tex_coords.end());
+				colors.insert(colors.end(),
+				              bucket.colors.begin(), bucket.colors.end());
+			}
+			if (vertices.empty())
+				return;
+
+			auto& renderer = this->font.renderer();
+			this->vertices = renderer.new_vertex_buffer(
+				renderer::make_vertex_buffer_attribute(
+					renderer::ContentKind::vertex,
+					vertices,
+					renderer::ContentHint::stream_content
+				),
+				renderer::make_vertex_buffer_attribute(
+					renderer::ContentKind::tex_coord0,
+					tex_coords,
+					renderer::ContentHint::stream_content
+				),
+				renderer::make_vertex_buffer_attribute(
+					renderer::ContentKind::color0,
+					colors,
+					renderer::ContentHint::stream_content
+				)
+			);
+			this->indices = renderer.new_index_buffer(
+				renderer::make_vertex_buffer_attribute(
+					renderer::ContentKind::index,
+					indices,
+					renderer::ContentHint::stream_content
+				)
+			);
+			ETC_LOG.debug("Built", this->entries.size(), "strings in",
+			              this->ranges.size(), "draw calls");
+		}
+
+		renderer::Bindable& material_view(etc::size_type const page)
+		{
+			if (page >= this->materials.size())
+			{
+				this->materials.resize(page + 1);
+				this->material_views.resize(page + 1);
+			}
+			if (this->materials[page] == nullptr)
+			{
+				material::MaterialPtr material{new material::Material};
+				material->add_texture(
+				    this->font.texture(page),
+				    (this->font.render_mode() == font::Font::RenderMode::distance_field
+				     ? material::TextureType::distance_field
+				     : material::TextureType::opacity),
+				    material::TextureMapping::uv,
+				    material::StackOperation::add,
+				    material::TextureMapMode::wrap,
+				    1.0
+				);
+				material->add_color(
+					renderer::ShaderParameterType::vec4,
+					material::StackOperation::add
+				);
+				material->ambient(color::Color3f("black"));
+				this->materials[page] = std::move(material);
+			}
+			if (this->material_views[page] == nullptr)
+				this->material_views[page] =
+					this->materials[page]->bindable(this->font.renderer());
+			return *this->material_views[page];
+		}
+	};
+
+	TextBatch::TextBatch(font::Font& font)
+		: _this{new Impl{font}}
+	{}
+
+	TextBatch::~TextBatch()
+	{}
+
+	void TextBatch::add(std::string const& str,
+	                    vector::Vector2f const& position,
+	                    color::Color3f const& color)
+	{
+		_this->entries.push_back(
+			Entry{str, position, color::Color4f(color.r, color.g, color.b, 1)}
+		);
+		_this->dirty = true;
+	}
+
+	void TextBatch::clear()
+	{
+		if (_this->entries.empty())
+			return;
+		_this->entries.clear();
+		_this->dirty = true;
+	}
+
+	etc::size_type TextBatch::size() const ETC_NOEXCEPT
+	{ return _this->entries.size(); }
+
+	void TextBatch::draw(renderer::Painter& painter)
+	{
+		// Labels are usually added again every frame.
+		if (_this->dirty && _this->entries == _this->built_entries)
+			_this->dirty = false;
+		// Glyph pages used by the batch might have been reused.
+		if (_this->dirty || _this->evictions != _this->font.evictions())
+			_this->build();
+		if (_this->vertices == nullptr)
+			return;
+		for (auto const& range: _this->ranges)
+			painter.with(_this->material_view(range.page), *_this->vertices)
+				->draw_elements(
+					renderer::DrawMode::triangles,
+					*_this->indices,
+					range.first,
+					range.count
+				);
+	}
+
+}}}
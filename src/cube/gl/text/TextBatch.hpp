@@ -0,0 +1,55 @@
+#ifndef  CUBE_GL_TEXT_TEXTBATCH_HPP
+# define CUBE_GL_TEXT_TEXTBATCH_HPP
+
+# include <cube/gl/fwd.hpp>
+
+# include <cube/api.hpp>
+# include <cube/gl/renderer/fwd.hpp>
+
+# include <etc/types.hpp>
+
+# include <boost/noncopyable.hpp>
+
+# include <memory>
+# include <string>
+
+namespace cube { namespace gl { namespace text {
+
+	/**
+	 * @brief Draw many strings of the same font at once.
+	 *
+	 * Strings are appended to one vertex stream, grouped by glyph page, and
+	 * drawn with one indexed draw call per page (usually one in total).
+	 * Layouts come from the font cache, so adding the same labels every
+	 * frame is cheap, and buffers are only rebuilt when the content changed.
+	 */
+	class CUBE_API TextBatch
+		: private boost::noncopyable
+	{
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _this;
+
+	public:
+		explicit
+		TextBatch(font::Font& font);
+		~TextBatch();
+
+	public:
+		/// Append a string with its top left corner at @a position.
+		void add(std::string const& str,
+		         vector::Vector2f const& position,
+		         color::Color3f const& color);
+
+		/// Remove all strings.
+		void clear();
+
+		/// Number of strings.
+		etc::size_type size() const ETC_NOEXCEPT;
+
+		void draw(renderer::Painter& painter);
+	};
+
+}}}
+
+#endif
@@ -1,2 +1,2 @@
 from .Text import *
-
+from .TextBatch import *
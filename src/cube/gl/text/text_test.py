@@ -24,3 +24,10 @@ class _(PainterSetup, Case):
         text.color = gl.Color3f("yellow")
         text.draw(painter)
 
+    @painter_test(gl.mode_2d)
+    def test_batch(self, painter):
+        batch = gl.TextBatch(self.font)
+        batch.add("lol", gl.vec2f(0, 0), gl.Color3f("yellow"))
+        batch.add("lol2", gl.vec2f(0, 50), gl.Color3f("red"))
+        self.assertEqual(len(batch), 2)
+        batch.draw(painter)
@@ -5,6 +5,7 @@
 #include <cube/exception.hpp>
 #include <cube/gl/renderer/VertexBuffer.hpp>
 #include <cube/gl/renderer/Texture.hpp>
+#include <cube/gl/renderer/TextureAtlas.hpp>
 #include <cube/gl/color.hpp>
 #include <cube/gl/material.hpp>
 #include <cube/gl/surface.hpp>
@@ -17,6 +18,7 @@
 #include <etc/memory.hpp>
 
 #include <unordered_map>
+#include <vector>
 
 namespace cube { namespace gui { namespace window {
 
@@ -79,14 +81,40 @@ namespace cube { namespace gui { namespace window {
 
 		typedef std::unique_ptr<Geometry> GeometryPtr;
 
+		// Images that fit in this size are packed in the atlas.
+		int const atlas_image_max_size = 256;
+		etc::size_type const atlas_size = 1024;
+
+		struct TextureEntry
+		{
+			gl::renderer::TexturePtr                texture;
+			// 0 when the texture is not in the atlas.
+			gl::renderer::TextureAtlas::id_type     atlas_id;
+			// Pixels of atlas images, kept until a geometry repeats them.
+			std::vector<Rocket::Core::byte>         pixels;
+			Rocket::Core::Vector2i                  size;
+			// Texture of an atlas image, for the geometries repeating it.
+			gl::renderer::TexturePtr                repeated;
+		};
+
+		// Texture coordinates outside [0, 1] rely on GL_REPEAT.
+		bool repeats(std::vector<gl::vector::vec2f> const& tex_coord)
+		{
+			for (auto const& uv: tex_coord)
+				if (uv.x < 0 || uv.x > 1 || uv.y < 0 || uv.y > 1)
+					return true;
+			return false;
+		}
+
 	}
 
 	struct RocketRenderInterface::Impl
 	{
 		std::unordered_map<
 			Rocket::Core::TextureHandle,
-			gl::renderer::TexturePtr
+			TextureEntry
 		> textures;
+		std::unique_ptr<gl::renderer::TextureAtlas> atlas;
 		std::unordered_map<
 			Rocket::Core::CompiledGeometryHandle,
 			GeometryPtr
@@ -110,6 +138,24 @@ namespace cube { namespace gui { namespace window {
 		gl::renderer::ShaderProgram& shader(bool with_texture)
 		{ return (with_texture ? *_shader_with_texture : *_shader); }
 
+		gl::renderer::TexturePtr new_texture(Rocket::Core::byte const* pixels,
+		                                     Rocket::Core::Vector2i const& size)
+		{
+			gl::surface::Surface s(
+				gl::renderer::PixelFormat::rgba8,
+				size.x,
+				size.y,
+				gl::renderer::PixelFormat::rgba8,
+				gl::renderer::ContentPacking::uint32_8_8_8_8,
+				pixels
+			);
+			auto texture = this->renderer.new_texture(s);
+			texture->generate_mipmap();
+			texture->min_filter(gl::renderer::TextureFilter::linear);
+			texture->mag_filter(gl::renderer::TextureFilter::linear);
+			return texture;
+		}
+
 	private:
 		gl::renderer::ShaderProgramPtr _make_shader(bool with_texture)
 		{
@@ -195,8 +241,12 @@ namespace cube { namespace gui { namespace window {
 		using gl::renderer::ContentKind;
 
 		gl::renderer::Texture* texture = nullptr;
+		TextureEntry* entry = nullptr;
 		if (texture_handle)
-			texture = _this->textures[texture_handle].get();
+		{
+			entry = &_this->textures[texture_handle];
+			texture = entry->texture.get();
+		}
 
 		ETC_LOG.debug("Rendering", num_indices, "indices and",
 		              num_vertices, "vertices",
@@ -220,11 +270,24 @@ namespace cube { namespace gui { namespace window {
 			for (int i = 0; i < num_vertices; ++i)
 			{
 				auto const& v = vertices[i];
-				tex_coord[i] = gl::vector::vec2f(
-					v.tex_coord.x ,//* texture->width,
-					v.tex_coord.y //* texture->height
-				);
+				tex_coord[i] = gl::vector::vec2f(v.tex_coord.x, v.tex_coord.y);
+			}
+			if (entry->atlas_id != 0 && repeats(tex_coord))
+			{
+				// Repeated images would sample their atlas neighbours.
+				if (entry->repeated == nullptr)
+				{
+					entry->repeated = _this->new_texture(
+						entry->pixels.data(),
+						entry->size
+					);
+					std::vector<Rocket::Core::byte>().swap(entry->pixels);
+				}
+				texture = entry->repeated.get();
 			}
+			else if (entry->atlas_id != 0)
+				for (auto& uv: tex_coord)
+					uv = _this->atlas->remap(entry->atlas_id, uv);
 		}
 		auto vbattrs = gl::renderer::make_vertex_buffer_attributes(
 			gl::renderer::make_vertex_buffer_attribute(
@@ -330,22 +393,43 @@ namespace cube { namespace gui { namespace window {
 	{
 		ETC_TRACE.debug("Generating texture of", size.x, 'x', size.y);
 		try {
-			gl::surface::Surface s(
-				gl::renderer::PixelFormat::rgba8,
-				size.x,
-				size.y,
-				gl::renderer::PixelFormat::rgba8,
-				gl::renderer::ContentPacking::uint32_8_8_8_8,
-				source
-			);
-			auto texture = _this->renderer.new_texture(s);
-			texture->min_filter(gl::renderer::TextureFilter::linear);
-			texture->mag_filter(gl::renderer::TextureFilter::linear);
-			texture->generate_mipmap();
+			TextureEntry entry{nullptr, 0, {}, size, nullptr};
+			if (size.x <= atlas_image_max_size && size.y <= atlas_image_max_size)
+			{
+				gl::surface::Surface s(
+					gl::renderer::PixelFormat::rgba8,
+					size.x,
+					size.y,
+					gl::renderer::PixelFormat::rgba8,
+					gl::renderer::ContentPacking::uint32_8_8_8_8,
+					source
+				);
+				if (_this->atlas == nullptr)
+					_this->atlas.reset(
+						new gl::renderer::TextureAtlas{
+							_this->renderer,
+							gl::renderer::PixelFormat::rgba8,
+							atlas_size,
+							atlas_size
+						}
+					);
+				entry.atlas_id = _this->atlas->insert(s);
+				entry.texture = _this->atlas->texture(
+					_this->atlas->region(entry.atlas_id).layer
+				);
+				entry.pixels.assign(source, source + size.x * size.y * 4);
+				entry.texture->min_filter(gl::renderer::TextureFilter::linear);
+				entry.texture->mag_filter(gl::renderer::TextureFilter::linear);
+				ETC_LOG.debug("Packed texture in atlas, occupancy:",
+				              _this->atlas->occupancy(), "fragmentation:",
+				              _this->atlas->fragmentation());
+			}
+			else
+				entry.texture = _this->new_texture(source, size);
 			handle = _this->textures.size() + 1;
 			while (_this->textures.find(handle) != _this->textures.end())
 				handle += 1;
-			_this->textures[handle] = texture;
+			_this->textures[handle] = std::move(entry);
 			ETC_LOG.debug("Generated texture at index", handle);
 		} catch (...) {
 			ETC_LOG.error(
@@ -357,6 +441,17 @@ namespace cube { namespace gui { namespace window {
 		return true;
 	}
 
+	void
+	RocketRenderInterface::ReleaseTexture(Rocket::Core::TextureHandle handle)
+	{
+		auto it = _this->textures.find(handle);
+		if (it == _this->textures.end())
+			return;
+		if (it->second.atlas_id != 0)
+			_this->atlas->erase(it->second.atlas_id);
+		_this->textures.erase(it);
+	}
+
 	gl::renderer::Painter& RocketRenderInterface::_current_painter()
 	{
 		ETC_ASSERT_NEQ(_this->painter, nullptr);
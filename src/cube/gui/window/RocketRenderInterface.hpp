@@ -39,6 +39,7 @@ namespace cube { namespace gui { namespace window {
 		bool GenerateTexture(Rocket::Core::TextureHandle& texture_handle,
 		                     Rocket::Core::byte const* source,
 		                     Rocket::Core::Vector2i const& size) override;
+		void ReleaseTexture(Rocket::Core::TextureHandle texture_handle) override;
 	private:
 		gl::renderer::Painter& _current_painter();
 	public:
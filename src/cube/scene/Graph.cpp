@@ -12,6 +12,7 @@
 #include <etc/types.hpp>
 #include <etc/scope_exit.hpp>
 
+#include <chrono>
 #include <unordered_set>
 
 namespace cube { namespace scene {
@@ -22,11 +23,13 @@ namespace cube { namespace scene {
 
 	ETC_LOG_COMPONENT("cube.scene.Graph");
 
+	Graph::Impl::index_type const Graph::Impl::none;
+
 	///////////////////////////////////////////////////////////////////////////
 	// Graph
 
 	Graph::Graph()
-		: _this{new Impl}
+		: _this{new Impl{*this}}
 	{
 		ETC_TRACE_CTOR();
 		_this->root = &this->emplace<Node>("root");
@@ -34,17 +37,17 @@ namespace cube { namespace scene {
 
 	Graph::Graph(Graph&& other)
 		: _this{std::move(other._this)}
-	{}
+	{ _this->transforms._graph_moved(*this); }
 
 	Graph::Graph(std::unique_ptr<Node> node)
-		: _this{new Impl}
+		: _this{new Impl{*this}}
 	{
 		ETC_TRACE_CTOR();
 		_this->root = &this->insert(std::move(node));
 	}
 
 	Graph::Graph(Node& node, node_deleter_type deleter)
-		: _this{new Impl}
+		: _this{new Impl{*this}}
 	{
 		ETC_TRACE_CTOR();
 		_this->root = &this->insert(node, std::move(deleter));
@@ -53,12 +56,14 @@ namespace cube { namespace scene {
 	Graph::~Graph()
 	{
 		ETC_TRACE_DTOR();
-		for (auto& it: _this->nodes)
+		_this->transforms.invalidate();
+		for (Impl::index_type i = 0; i < _this->capacity(); ++i)
 		{
-			node::Node* n = it.first;
-			auto id = it.second;
+			Node* n = _this->nodes[i];
+			if (n == nullptr)
+				continue;
 			n->detach(*this);
-			_this->vertex_node_deleter_map[id](n);
+			_this->deleters[i](n);
 		}
 		_this.reset();
 		ETC_LOG.debug(*this, "All nodes free'd");
@@ -68,7 +73,10 @@ namespace cube { namespace scene {
 	{ return *_this->root; }
 
 	size_t Graph::size() const ETC_NOEXCEPT
-	{ return boost::num_vertices(_this->graph); }
+	{ return _this->size; }
+
+	Transforms& Graph::transforms() ETC_NOEXCEPT
+	{ return _this->transforms; }
 
 	Node& Graph::_insert(std::unique_ptr<Node> node)
 	{
@@ -83,23 +91,16 @@ namespace cube { namespace scene {
 	{
 		ETC_TRACE.debug("Insert node ", node);
 
-		// Insert in the graph.
-		auto const id = boost::add_vertex(_this->graph);
-		auto remove_vertex = etc::scope_exit([&] {
-			boost::remove_vertex(id, _this->graph);
-			_this->nodes.erase(&node);
+		Handle const handle = _this->allocate(node, std::move(deleter));
+		auto release_slot = etc::scope_exit([&] {
+			_this->release(handle.index);
 		});
 
-		// Release the pointer and insert it in the graph.
-
-		boost::put(_this->vertex_node_map, id, &node);
-		boost::put(_this->vertex_node_deleter_map, id, deleter);
-		_this->nodes.insert(std::make_pair(&node, id));
-
 		node.attach(*this);
+		node._set_handle(handle);
 
 		// Every thing went well, release the guard.
-		remove_vertex.dismiss();
+		release_slot.dismiss();
 
 		_this->call_hooks(Event::insert, node);
 		return node;
@@ -108,27 +109,14 @@ namespace cube { namespace scene {
 	std::shared_ptr<Node> Graph::remove(Node& node)
 	{
 		ETC_LOG.debug("Remove node", node, "from the graph");
-		auto it = _this->nodes.find(&node);
-		if (it == _this->nodes.end())
-			throw Exception{
-				etc::to_string("The node", node, "does not belong to", *this)
-			};
+		auto const idx = _this->index(*this, node);
 
-		auto id = it->second;
-		{
-			Impl::adjacency_iterator it, end;
-			boost::tie(it, end) = boost::adjacent_vertices(id, _this->graph);
-			for (; it != end; ++it)
-			{
-				Node* child = boost::get(_this->vertex_node_map, *it);
-				this->remove(*child);
-			}
-		}
-		auto deleter = boost::get(_this->vertex_node_deleter_map, id);
-		boost::clear_vertex(id, _this->graph);
-		boost::remove_vertex(id, _this->graph);
+		_this->transforms.invalidate();
+		while (_this->first_children[idx] != Impl::none)
+			this->remove(*_this->nodes[_this->first_children[idx]]);
+		_this->unlink(idx);
+		auto deleter = _this->release(idx);
 		node.detach(*this);
-		_this->nodes.erase(it);
 
 		_this->call_hooks(Event::remove, node);
 		return std::shared_ptr<Node>{&node, deleter};
@@ -137,32 +125,39 @@ namespace cube { namespace scene {
 	void Graph::connect(Node& from, Node& to)
 	{
 		ETC_TRACE.debug("Connect", from, "to", to);
-		auto from_id = _this->nodes.at(&from);
-		auto to_id = _this->nodes.at(&to);
-		boost::add_edge(from_id, to_id, _this->graph);
+		auto const from_idx = _this->index(*this, from);
+		auto const to_idx = _this->index(*this, to);
+		if (_this->parents[to_idx] != Impl::none)
+			throw Exception{
+				etc::to_string("The node", to, "already has a parent")
+			};
+		for (auto idx = from_idx; idx != Impl::none; idx = _this->parents[idx])
+			if (idx == to_idx)
+				throw Exception{
+					etc::to_string("Connecting", from, "to", to,
+					               "would create a cycle")
+				};
+		_this->link(from_idx, to_idx);
+		_this->transforms.invalidate();
 	}
 
 	std::vector<Node*> Graph::children(Node& node)
 	{
 		std::vector<Node*> res;
-		Impl::out_edge_iterator it, end;
-		boost::tie(it, end) = boost::out_edges(
-			_this->nodes.at(&node),
-			_this->graph
-		);
-		for (; it != end; ++it)
-			res.push_back(
-				_this->vertex_node_map[boost::target(*it, _this->graph)]
-			);
+		auto const idx = _this->index(*this, node);
+		for (auto child = _this->first_children[idx];
+		     child != Impl::none;
+		     child = _this->next_siblings[child])
+			res.push_back(_this->nodes[child]);
 		return res;
 	}
 
 	void Graph::traverse(Visitor<Node>& visitor)
 	{
-		Impl::vertex_iterator it, end;
-		boost::tie(it, end) = boost::vertices(_this->graph);
-		for (; it != end; ++it)
-			visitor.visit(*_this->vertex_node_map[*it]);
+		// Slots are visited in memory order.
+		for (Impl::index_type i = 0; i < _this->capacity(); ++i)
+			if (Node* n = _this->nodes[i])
+				visitor.visit(*n);
 	}
 
 	namespace {
@@ -255,6 +250,95 @@ namespace cube { namespace scene {
 			ETC_ENFORCE_EQ(g.children(g.root()).size(), 1u);
 		}
 
+		struct OrderVisitor
+			: public visit::DefaultDepthFirstVisitor
+		{
+			std::string discovered;
+			std::string finished;
+			void discover_vertex(Node& n) { discovered += n.name(); }
+			void finish_vertex(Node& n) { finished += n.name(); }
+		};
+
+		ETC_TEST_CASE(depth_first_order)
+		{
+			Graph g;
+			g.root().name("r");
+			auto& a = g.root().emplace<Node>("a");
+			a.emplace<Node>("b");
+			a.emplace<Node>("c");
+			g.root().emplace<Node>("d");
+			g.emplace<Node>("e"); // without parent
+			OrderVisitor v;
+			visit::depth_first_search(g, v);
+			ETC_ENFORCE_EQ(v.discovered, "rabcde");
+			ETC_ENFORCE_EQ(v.finished, "bcadre");
+		}
+
+		ETC_TEST_CASE(remove_reuse_slot)
+		{
+			Graph g;
+			auto& a = g.root().emplace<Node>("a");
+			auto& b = a.emplace<Node>("b");
+			auto old_handle = b.handle();
+			g.remove(a);
+			ETC_ENFORCE_EQ(g.size(), 1u);
+			ETC_ENFORCE_EQ(g.children(g.root()).size(), 0u);
+
+			auto& c = g.root().emplace<Node>("c");
+			ETC_ENFORCE(c.handle() != old_handle);
+			ETC_ENFORCE_EQ(g.children(g.root()).size(), 1u);
+			ETC_ENFORCE_EQ(g.children(g.root())[0], &c);
+		}
+
+		ETC_TEST_CASE(connect_errors)
+		{
+			Graph g;
+			auto& a = g.root().emplace<Node>("a");
+			auto& b = a.emplace<Node>("b");
+			ETC_TEST_THROW_TYPE({ g.connect(g.root(), b); }, Exception);
+			ETC_TEST_THROW_TYPE({ g.connect(b, a); }, Exception);
+			Graph other;
+			ETC_TEST_THROW_TYPE({ g.connect(other.root(), a); }, Exception);
+		}
+
+		struct CountVisitor
+			: public visit::DefaultBreadthFirstVisitor
+		{
+			size_t count = 0;
+			void discover_vertex(Node&) { count += 1; }
+		};
+
+		ETC_BENCHMARK_CASE(traversal_100k)
+		{
+			typedef std::chrono::steady_clock clock_type;
+			size_t const size = 100000;
+			Graph g;
+			std::vector<Node*> nodes{&g.root()};
+			nodes.reserve(size);
+			for (size_t i = 0; nodes.size() < size; ++i)
+				nodes.push_back(&nodes[i / 10]->emplace<Node>("node"));
+			ETC_ENFORCE_EQ(g.size(), size);
+
+			auto start = clock_type::now();
+			CountVisitor dfs;
+			visit::depth_first_search(g, dfs);
+			auto dfs_time = clock_type::now() - start;
+			ETC_ENFORCE_EQ(dfs.count, size);
+
+			start = clock_type::now();
+			CountVisitor bfs;
+			visit::breadth_first_search(g, bfs);
+			auto bfs_time = clock_type::now() - start;
+			ETC_ENFORCE_EQ(bfs.count, size);
+
+			using std::chrono::microseconds;
+			using std::chrono::duration_cast;
+			ETC_LOG.info("Traversal of", size, "nodes: dfs in",
+			             duration_cast<microseconds>(dfs_time).count(),
+			             "us, bfs in",
+			             duration_cast<microseconds>(bfs_time).count(), "us");
+		}
+
 	} // !anonymous
 
 }} // !cube::scene
@@ -17,7 +17,9 @@ namespace cube { namespace scene {
 	/**
 	 * Generic graph.
 	 *
-	 * Stores any kind of object in nodes
+	 * Stores any kind of object in nodes. Nodes are organized as a forest:
+	 * each node has at most one parent, and the ones without parent are
+	 * visited after the root by depth_first_search().
 	 */
 	class CUBE_API Graph
 	{
@@ -28,9 +30,10 @@ namespace cube { namespace scene {
 		typedef std::unique_ptr<visitor_type> visitor_ptr_type;
 		enum class Event { insert, update, remove, _max_value };
 
-	private:
-		// Pimpl.
+	public:
+		// Pimpl, exposed to the traversal algorithms.
 		struct Impl;
+	private:
 		std::unique_ptr<Impl> _this;
 	public:
 		Impl& impl() const ETC_NOEXCEPT { return *_this; }
@@ -49,6 +52,9 @@ namespace cube { namespace scene {
 		/// Number of nodes (>= 1).
 		size_t size() const ETC_NOEXCEPT;
 
+		/// World matrices of the Transform nodes.
+		Transforms& transforms() ETC_NOEXCEPT;
+
 		/// Insert a node into the graph.
 		template<typename T>
 		T& insert(std::unique_ptr<T> node)
@@ -85,7 +91,14 @@ namespace cube { namespace scene {
 			);
 		}
 
-		/// Add a link between nodes `from` and `to`.
+		/**
+		 * Add a link between nodes `from` and `to`.
+		 *
+		 * Nodes have a single parent: a node cannot be shared between
+		 * several parents anymore, insert one node per parent instead.
+		 *
+		 * @throws if `to` already has a parent or is an ancestor of `from`.
+		 */
 		void connect(Node& from, Node& to);
 
 		/// Remove a node and returns it.
@@ -2,90 +2,163 @@
 # define CUBE_SCENE_GRAPHIMPL_HPP
 
 # include "Graph.hpp"
+# include "Handle.hpp"
+# include "Transforms.hpp"
 # include "node/Node.hpp"
 
 # include <etc/enum.hpp>
 # include <etc/log.hpp>
+# include <etc/to_string.hpp>
 
 # include <cube/exception.hpp>
 
-# include <boost/graph/adjacency_list.hpp>
-# include <boost/graph/graph_traits.hpp>
-
 # include <memory>
 # include <type_traits>
-# include <map>
-
-namespace cube { namespace scene {
-
-	struct vertex_list_containerS {}; // tag
-
-}}
-
-namespace boost {
-
-}
+# include <vector>
 
 namespace cube { namespace scene {
 
+	/**
+	 * Nodes are stored in slots, the links between them are kept in
+	 * parallel arrays indexed by slot (parent, first and last child, next
+	 * and previous sibling). Removed slots go to a free list and are reused
+	 * with a new generation.
+	 */
 	struct Graph::Impl
 	{
 		ETC_LOG_COMPONENT("cube.scene.GraphImpl");
 
-		struct vertex_node_t { typedef boost::vertex_property_tag kind; };
-		struct vertex_node_deleter_t { typedef boost::vertex_property_tag kind; };
-
-		typedef
-			boost::adjacency_list<
-				// The selector for the container used to represent the
-				// edge-list for each of the vertices.
-				  boost::vecS
-				// The selector for the container used to represent the
-				// vertex-list of the graph.
-				, boost::setS
-				, boost::directedS
-				// for specifying vertex internal property storage.
-				, boost::property<boost::vertex_index_t, uint32_t
-				, boost::property<boost::vertex_color_t, boost::default_color_type
-				, boost::property<vertex_node_t, node::Node*
-				, boost::property<vertex_node_deleter_t, std::function<void(Node*)
-				>>>>> // end of vertex properties
-				// for specifying edge internal property storage.
-				, boost::no_property
-			>
-			graph_type;
-
-		typedef boost::graph_traits<graph_type> graph_traits;
-		typedef graph_traits::vertex_descriptor vertex_descriptor_type;
-		typedef graph_traits::adjacency_iterator adjacency_iterator;
-		typedef graph_traits::out_edge_iterator out_edge_iterator;
-		typedef graph_traits::in_edge_iterator in_edge_iterator;
-		typedef graph_traits::vertex_iterator vertex_iterator;
-		typedef boost::property_map<graph_type, boost::vertex_index_t>::type vertex_index_map_type;
-		typedef boost::property_map<graph_type, boost::vertex_color_t>::type vertex_color_map_type;
-		typedef boost::property_map<graph_type, vertex_node_t>::type vertex_node_map_type;
-		typedef boost::property_map<graph_type, vertex_node_deleter_t>::type vertex_node_deleter_map_type;
+		typedef Handle::index_type index_type;
+		typedef Handle::generation_type generation_type;
 		typedef etc::enum_map<Graph::Event, std::vector<Graph::visitor_ptr_type>> hook_map_type;
-		std::map<node::Node*, vertex_descriptor_type> nodes;
 
-		graph_type graph;
+		static index_type const none = Handle::invalid_index;
+
+		std::vector<Node*>             nodes;
+		std::vector<node_deleter_type> deleters;
+		std::vector<generation_type>   generations;
+		std::vector<index_type>        parents;
+		std::vector<index_type>        first_children;
+		std::vector<index_type>        last_children;
+		std::vector<index_type>        next_siblings;
+		std::vector<index_type>        previous_siblings;
+		std::vector<index_type>        free_slots;
+		size_t                         size;
+
 		Node* root;
 		hook_map_type hook_map;
-		vertex_index_map_type vertex_index_map;
-		vertex_color_map_type vertex_color_map;
-		vertex_node_map_type vertex_node_map;
-		vertex_node_deleter_map_type vertex_node_deleter_map;
-
-		Impl()
-			: graph()
+		Transforms transforms;
+
+		Impl(Graph& self)
+			: nodes{}
+			, deleters{}
+			, generations{}
+			, parents{}
+			, first_children{}
+			, last_children{}
+			, next_siblings{}
+			, previous_siblings{}
+			, free_slots{}
+			, size{0}
 			, root{nullptr}
 			, hook_map()
-			, vertex_index_map(boost::get(boost::vertex_index_t(), this->graph))
-			, vertex_color_map(boost::get(boost::vertex_color_t(), this->graph))
-			, vertex_node_map(boost::get(vertex_node_t(), this->graph))
-			, vertex_node_deleter_map(boost::get(vertex_node_deleter_t(), this->graph))
+			, transforms{self}
 		{}
 
+		/// Number of slots, used or not.
+		inline
+		index_type capacity() const ETC_NOEXCEPT
+		{ return static_cast<index_type>(this->nodes.size()); }
+
+		/// Slot of a node of this graph, throws otherwise.
+		index_type index(Graph const& graph, Node const& node) const
+		{
+			Handle const& h = node.handle();
+			if (!node.attached() || &node.graph() != &graph ||
+			    h.index >= this->capacity() ||
+			    this->generations[h.index] != h.generation ||
+			    this->nodes[h.index] != &node)
+				throw exception::Exception{
+					etc::to_string("The node", node, "does not belong to", graph)
+				};
+			return h.index;
+		}
+
+		Handle allocate(Node& node, node_deleter_type deleter)
+		{
+			index_type idx;
+			if (!this->free_slots.empty())
+			{
+				idx = this->free_slots.back();
+				this->free_slots.pop_back();
+			}
+			else
+			{
+				idx = this->capacity();
+				this->nodes.push_back(nullptr);
+				this->deleters.emplace_back();
+				this->generations.push_back(0);
+				this->parents.push_back(none);
+				this->first_children.push_back(none);
+				this->last_children.push_back(none);
+				this->next_siblings.push_back(none);
+				this->previous_siblings.push_back(none);
+			}
+			this->nodes[idx] = &node;
+			this->deleters[idx] = std::move(deleter);
+			this->size += 1;
+			return Handle{idx, this->generations[idx]};
+		}
+
+		node_deleter_type release(index_type const idx)
+		{
+			node_deleter_type deleter = std::move(this->deleters[idx]);
+			this->nodes[idx] = nullptr;
+			this->deleters[idx] = nullptr;
+			this->generations[idx] += 1;
+			this->parents[idx] = none;
+			this->first_children[idx] = none;
+			this->last_children[idx] = none;
+			this->next_siblings[idx] = none;
+			this->previous_siblings[idx] = none;
+			this->free_slots.push_back(idx);
+			this->size -= 1;
+			return deleter;
+		}
+
+		void link(index_type const parent, index_type const child) ETC_NOEXCEPT
+		{
+			this->parents[child] = parent;
+			index_type const last = this->last_children[parent];
+			this->previous_siblings[child] = last;
+			this->next_siblings[child] = none;
+			if (last == none)
+				this->first_children[parent] = child;
+			else
+				this->next_siblings[last] = child;
+			this->last_children[parent] = child;
+		}
+
+		void unlink(index_type const child) ETC_NOEXCEPT
+		{
+			index_type const parent = this->parents[child];
+			if (parent == none)
+				return;
+			index_type const prev = this->previous_siblings[child];
+			index_type const next = this->next_siblings[child];
+			if (prev == none)
+				this->first_children[parent] = next;
+			else
+				this->next_siblings[prev] = next;
+			if (next == none)
+				this->last_children[parent] = prev;
+			else
+				this->previous_siblings[next] = prev;
+			this->parents[child] = none;
+			this->previous_siblings[child] = none;
+			this->next_siblings[child] = none;
+		}
+
 		void call_hooks(Graph::Event const ev, Node& n) ETC_NOEXCEPT
 		{
 			try {
@@ -0,0 +1,54 @@
+#ifndef  CUBE_SCENE_HANDLE_HPP
+# define CUBE_SCENE_HANDLE_HPP
+
+# include <etc/compiler.hpp>
+
+# include <cstdint>
+# include <limits>
+
+namespace cube { namespace scene {
+
+	/**
+	 * @brief Generational index of a node in a graph.
+	 *
+	 * Slots of removed nodes are reused, the generation is incremented
+	 * every time so that stale handles are detected.
+	 */
+	struct Handle
+	{
+		typedef uint32_t index_type;
+		typedef uint32_t generation_type;
+
+		static index_type const invalid_index =
+			std::numeric_limits<index_type>::max();
+
+		index_type      index;
+		generation_type generation;
+
+		Handle() ETC_NOEXCEPT
+			: index{invalid_index}
+			, generation{0}
+		{}
+
+		Handle(index_type const index,
+		       generation_type const generation) ETC_NOEXCEPT
+			: index{index}
+			, generation{generation}
+		{}
+
+		inline
+		bool valid() const ETC_NOEXCEPT
+		{ return index != invalid_index; }
+
+		inline
+		bool operator ==(Handle const& other) const ETC_NOEXCEPT
+		{ return index == other.index && generation == other.generation; }
+
+		inline
+		bool operator !=(Handle const& other) const ETC_NOEXCEPT
+		{ return !(*this == other); }
+	};
+
+}}
+
+#endif
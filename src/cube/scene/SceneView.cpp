@@ -3,19 +3,33 @@
 #include "node/ContentNode.hpp"
 #include "Graph.hpp"
 #include "Scene.hpp"
+#include "Transforms.hpp"
 #include "node/Transform.hpp"
 #include "node/MultipleVisitor.hpp"
 #include "node/Light.hpp"
-#include "visit/depth_first_search.hpp"
 
+#include <cube/debug.hpp>
+#include <cube/exception.hpp>
+#include <cube/gl/bounds.hpp>
 #include <cube/gl/renderer/Light.hpp>
+#include <cube/gl/renderer/LightClusters.hpp>
 #include <cube/gl/renderer/Painter.hpp>
+#include <cube/gl/renderer/ShaderProgram.hpp>
 #include <cube/gl/renderer/State.hpp>
+#include <cube/gl/renderer/Texture.hpp>
 #include <cube/gl/material.hpp>
+#include <cube/gl/material/Bindable.hpp>
+#include <cube/gl/matrix.hpp>
 #include <cube/gl/mesh.hpp>
+#include <cube/gl/occlusion.hpp>
 
 #include <etc/log.hpp>
 
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+
+using cube::gl::bounds::AABBf;
 using cube::gl::material::MaterialPtr;
 using cube::gl::mesh::MeshPtr;
 using cube::gl::renderer::BindablePtr;
@@ -26,15 +40,162 @@ namespace cube { namespace scene {
 
 	ETC_LOG_COMPONENT("cube.scene.SceneView");
 
+	namespace {
+
+		typedef gl::matrix::mat4f matrix_type;
+
+		etc::size_type const no_binding = static_cast<etc::size_type>(-1);
+
+		/// Model matrix of the nodes below a Transform.
+		struct ModelMatrix
+		{
+			Transforms&       transforms;
+			matrix_type const root;
+			bool const        root_is_identity;
+
+			ModelMatrix(Transforms& transforms, matrix_type const& root)
+				: transforms(transforms)
+				, root(root)
+				, root_is_identity{root == matrix_type(1)}
+			{}
+
+			matrix_type operator ()(node::Transform const& node) const
+			{
+				if (root_is_identity)
+					return transforms.world(node);
+				matrix_type res;
+				gl::matrix::multiply(root, transforms.world(node), res);
+				return res;
+			}
+		};
+
+		/// World space bounds of a subtree.
+		struct SubtreeBounds
+		{
+			AABBf          box;
+			/// Meshes and drawables in the subtree.
+			etc::size_type drawables;
+
+			SubtreeBounds()
+				: box{}
+				, drawables{0}
+			{}
+		};
+
+		/// A material bindable with its sort keys, cached per material node.
+		struct MaterialBinding
+		{
+			BindablePtr                        bindable;
+			gl::material::Bindable*            material;
+			gl::renderer::ShaderProgram const* program;
+			etc::size_type                     textures;
+			bool                               transparent;
+		};
+
+		/// A bindable entered while collecting. Bindings form a tree, each
+		/// draw item refers to the innermost one.
+		struct Binding
+		{
+			BindablePtr                        bindable;
+			etc::size_type                     parent;
+			/// Set when the bindable is a material.
+			gl::material::Bindable*            material;
+			/// Keys of the innermost material of the chain.
+			gl::renderer::ShaderProgram const* program;
+			etc::size_type                     textures;
+			bool                               transparent;
+		};
+
+		struct DrawItem
+		{
+			matrix_type    model;
+			etc::size_type binding;
+			DrawablePtr    drawable;
+		};
+
+		/**
+		 * Draw order: opaque items grouped by shader program, texture set,
+		 * bindings and drawable. Transparent items keep their collection
+		 * order, after the opaque ones.
+		 */
+		struct DrawOrder
+		{
+			std::vector<Binding> const& bindings;
+
+			bool operator ()(DrawItem const& lhs, DrawItem const& rhs) const
+			{
+				auto const& l = bindings_of(lhs);
+				auto const& r = bindings_of(rhs);
+				if (l.transparent || r.transparent)
+					return !l.transparent && r.transparent;
+				return std::make_tuple(l.program, l.textures, lhs.binding,
+				                       lhs.drawable.get()) <
+				       std::make_tuple(r.program, r.textures, rhs.binding,
+				                       rhs.drawable.get());
+			}
+
+			Binding const& bindings_of(DrawItem const& item) const
+			{
+				static Binding const none{nullptr, no_binding, nullptr, nullptr,
+				                          0, false};
+				return item.binding == no_binding ? none
+				                                  : bindings[item.binding];
+			}
+		};
+
+	} // !anonymous
+
 	struct SceneView::Impl
 	{
 		ScenePtr scene;
-		std::map<node::Node*, BindablePtr> bindables;
+		std::map<node::Node*, MaterialBinding> bindables;
 		std::map<node::Node*, DrawablePtr> drawables;
+		std::map<node::Node*, AABBf> mesh_bounds;
+		std::map<std::vector<gl::renderer::Texture const*>, etc::size_type>
+			texture_sets;
+		gl::occlusion::CullerPtr occlusion_culler;
+		gl::renderer::LightClustersPtr light_clusters;
+		/// Triangle indices of the occluder meshes.
+		std::map<node::Node*, std::vector<uint32_t>> occluders;
+
+		// Rebuilt every frame.
+		std::unordered_map<node::Node*, SubtreeBounds> bounds;
+		std::vector<Binding> bindings;
+		std::vector<DrawItem> items;
+		Stats stats;
 
 		Impl(ScenePtr scene)
 			: scene{std::move(scene)}
+			, stats{0, 0, 0, 0}
 		{}
+
+		MaterialBinding new_binding(gl::material::Material& material,
+		                            gl::renderer::Renderer& renderer)
+		{
+			MaterialBinding res{
+				material.bindable(renderer),
+				nullptr,
+				nullptr,
+				0,
+				material.opacity() < 1.0f,
+			};
+			res.material = dynamic_cast<gl::material::Bindable*>(
+				res.bindable.get()
+			);
+			if (res.material != nullptr)
+				res.program = res.material->_shader_program.get();
+			std::vector<gl::renderer::Texture const*> textures;
+			for (auto const& channel: material.textures())
+			{
+				textures.push_back(channel.texture.get());
+				if (channel.type == gl::material::TextureType::opacity)
+					res.transparent = true;
+			}
+			res.textures = this->texture_sets.emplace(
+				std::move(textures), this->texture_sets.size()
+			).first->second;
+			return res;
+		}
 	};
 
 	SceneView::SceneView(ScenePtr scene)
@@ -44,6 +205,36 @@ namespace cube { namespace scene {
 	SceneView::~SceneView()
 	{ ETC_TRACE_DTOR(); }
 
+	SceneView::Stats const& SceneView::stats() const ETC_NOEXCEPT
+	{ return _this->stats; }
+
+	void SceneView::occlusion_culler(gl::occlusion::CullerPtr culler)
+	{ _this->occlusion_culler = std::move(culler); }
+
+	gl::occlusion::CullerPtr const&
+	SceneView::occlusion_culler() const ETC_NOEXCEPT
+	{ return _this->occlusion_culler; }
+
+	void SceneView::light_clusters(gl::renderer::LightClustersPtr clusters)
+	{ _this->light_clusters = std::move(clusters); }
+
+	gl::renderer::LightClustersPtr const&
+	SceneView::light_clusters() const ETC_NOEXCEPT
+	{ return _this->light_clusters; }
+
+	void SceneView::add_occluder(node::Node& node)
+	{
+		auto mesh_node = dynamic_cast<node::ContentNode<MeshPtr>*>(&node);
+		if (mesh_node == nullptr)
+			throw exception::Exception{
+				"The occluder " + etc::to_string(node) + " is not a mesh"
+			};
+		_this->occluders[&node] = mesh_node->value()->triangles();
+	}
+
+	void SceneView::remove_occluder(node::Node& node)
+	{ _this->occluders.erase(&node); }
+
 	namespace {
 
 		using node::MultipleVisitor;
@@ -52,14 +243,122 @@ namespace cube { namespace scene {
 		using node::Node;
 		using node::Light;
 
-		struct DirectDraw
+		/**
+		 * Compute the world bounds of every subtree, and update lights
+		 * position on the way (they must be up to date even when they are
+		 * culled). Occluders are added to the culler, if any.
+		 */
+		struct BoundsPass
+			: public MultipleVisitor<
+			    Transform
+			  , ContentNode<DrawablePtr>
+			  , ContentNode<MeshPtr>
+			  , Light
+			>
+		{
+			ETC_LOG_COMPONENT("cube.scene.SceneView");
+			typedef MultipleVisitor<
+			    Transform
+			  , ContentNode<DrawablePtr>
+			  , ContentNode<MeshPtr>
+			  , Light
+			> super_type;
+
+			SceneView::Impl& _impl;
+			ModelMatrix const& _model_of;
+			matrix_type const _view;
+			gl::occlusion::Culler* _culler;
+			matrix_type _model;
+			SubtreeBounds _current;
+
+			BoundsPass(SceneView::Impl& impl,
+			           ModelMatrix const& model_of,
+			           matrix_type const& view,
+			           gl::occlusion::Culler* culler)
+				: _impl(impl)
+				, _model_of(model_of)
+				, _view(view)
+				, _culler(culler)
+				, _model(model_of.root)
+				, _current{}
+			{}
+
+			SubtreeBounds run(Graph& graph, Node& node)
+			{
+				matrix_type const model = _model;
+				_current = SubtreeBounds{};
+				this->visit(node);
+				SubtreeBounds res = _current;
+				for (Node* child: graph.children(node))
+				{
+					auto child_bounds = this->run(graph, *child);
+					res.box.extend(child_bounds.box);
+					res.drawables += child_bounds.drawables;
+				}
+				_model = model;
+				_impl.bounds[&node] = res;
+				return res;
+			}
+
+			bool visit(Transform& node) override
+			{
+				_model = _model_of(node);
+				return true;
+			}
+
+			bool visit(ContentNode<DrawablePtr>&) override
+			{
+				// Arbitrary drawables cannot be bounded.
+				_current.box = AABBf::infinite();
+				_current.drawables = 1;
+				return true;
+			}
+
+			bool visit(ContentNode<MeshPtr>& node) override
+			{
+				auto it = _impl.mesh_bounds.find(&node);
+				if (it == _impl.mesh_bounds.end())
+					it = _impl.mesh_bounds.emplace(
+						&node, node.value()->bounds()
+					).first;
+				_current.box = it->second.transform(_model);
+				_current.drawables = 1;
+				if (_culler != nullptr)
+				{
+					auto occluder = _impl.occluders.find(&node);
+					if (occluder != _impl.occluders.end())
+						_culler->add_occluder(
+							node.value()->vertice(),
+							occluder->second,
+							_model
+						);
+				}
+				return true;
+			}
+
+			bool visit(Light& node) override
+			{
+				gl::vector::vec3f pos(
+					_view * _model * gl::vector::vec4f(0, 0, 0, 1)
+				);
+				node.value().point().position = pos;
+				ETC_LOG.debug("Set", node, "pos to", pos);
+				return true;
+			}
+			using super_type::visit;
+		};
+
+		/**
+		 * Walk the subtrees intersecting the view volume and collect the
+		 * bindings and draw items.
+		 */
+		struct CollectPass
 			: public MultipleVisitor<
 			    Transform
 			  , ContentNode<BindablePtr>
 			  , ContentNode<DrawablePtr>
 			  , ContentNode<MaterialPtr>
 			  , ContentNode<MeshPtr>
-			  , Light
 			>
 		{
 			ETC_LOG_COMPONENT("cube.scene.SceneView");
@@ -69,141 +368,301 @@ namespace cube { namespace scene {
 			  , ContentNode<DrawablePtr>
 			  , ContentNode<MaterialPtr>
 			  , ContentNode<MeshPtr>
-			  , Light
 			> super_type;
 
 			SceneView::Impl& _impl;
 			gl::renderer::Painter& _painter;
-			std::shared_ptr<gl::renderer::State> _state;
-			std::vector<gl::renderer::Painter::Proxy<1>> _proxies;
-			bool enter;
+			ModelMatrix const& _model_of;
+			gl::bounds::ClipPlanes<float> const _planes;
+			bool const _cull;
+			gl::occlusion::Culler const* _culler;
+			bool const _debug;
+			matrix_type _model;
+			etc::size_type _binding;
 			std::map<std::string, etc::size_type> visited;
 
-			DirectDraw(SceneView::Impl& impl, gl::renderer::Painter& painter)
+			CollectPass(SceneView::Impl& impl,
+			            gl::renderer::Painter& painter,
+			            ModelMatrix const& model_of,
+			            matrix_type const& view_projection,
+			            bool const cull,
+			            gl::occlusion::Culler const* culler)
 				: _impl(impl)
 				, _painter(painter)
-				, _state{}
-				, _proxies{}
-				, enter{true}
+				, _model_of(model_of)
+				, _planes{view_projection}
+				, _cull{cull}
+				, _culler{culler}
+				, _debug{ETC_LOG_ENABLED(debug)}
+				, _model(model_of.root)
+				, _binding{no_binding}
 			{}
 
-			bool visit(Transform& node) override
+			void run(Graph& graph, Node& node, bool inside)
 			{
-				if (this->enter)
-				{
-					this->visited[node.name()] += 1;
-					ETC_TRACE.debug("Push transform node", node);
-					_painter.push_state().lock()->model(node.value());
-				}
-				else
+				if (_cull)
 				{
-					ETC_TRACE.debug("Pop transform node", node);
-					_painter.pop_state();
+					auto const& bounds = _impl.bounds[&node];
+					if (!inside)
+					{
+						switch (_planes.test(bounds.box))
+						{
+						case gl::bounds::Containment::outside:
+							ETC_LOG.debug("Cull", node, "with",
+							              bounds.drawables, "drawables");
+							_impl.stats.culled += bounds.drawables;
+							return;
+						case gl::bounds::Containment::inside:
+							// No need to test the children.
+							inside = true;
+							break;
+						case gl::bounds::Containment::intersects:
+							break;
+						}
+					}
+					if (_culler != nullptr && bounds.drawables > 0 &&
+					    !_culler->visible(bounds.box))
+					{
+						ETC_LOG.debug("Occlude", node, "with",
+						              bounds.drawables, "drawables");
+						_impl.stats.occluded += bounds.drawables;
+						return;
+					}
 				}
-				return true;
+				matrix_type const model = _model;
+				etc::size_type const binding = _binding;
+				this->visit(node);
+				for (Node* child: graph.children(node))
+					this->run(graph, *child, inside);
+				_model = model;
+				_binding = binding;
 			}
 
-			bool visit(ContentNode<DrawablePtr>& node) override
+			void _visited(Node const& node)
 			{
-				if (this->enter)
-				{
+				if (_debug)
 					this->visited[node.name()] += 1;
-					ETC_TRACE.debug("Draw node", node);
-					_painter.draw(node.value());
-				}
-				return true;
 			}
 
-			void _visit_bindable(BindablePtr& b)
+			void _push_binding(BindablePtr const& bindable)
 			{
-				if (this->enter)
+				// Other bindables inherit the keys of the enclosing material.
+				Binding binding{bindable, _binding, nullptr, nullptr, 0, false};
+				if (_binding != no_binding)
 				{
-					_proxies.emplace_back(_painter.with(*b));
+					auto const& parent = _impl.bindings[_binding];
+					binding.program = parent.program;
+					binding.textures = parent.textures;
+					binding.transparent = parent.transparent;
 				}
-				else
-					_proxies.pop_back();
+				_impl.bindings.push_back(std::move(binding));
+				_binding = _impl.bindings.size() - 1;
+			}
+
+			void _push_binding(MaterialBinding const& material)
+			{
+				_impl.bindings.push_back(Binding{
+					material.bindable,
+					_binding,
+					material.material,
+					material.program,
+					material.textures,
+					material.transparent,
+				});
+				_binding = _impl.bindings.size() - 1;
+			}
+
+			void _push_item(DrawablePtr const& drawable)
+			{
+				_impl.items.push_back(DrawItem{_model, _binding, drawable});
+				_impl.stats.drawn += 1;
+			}
+
+			bool visit(Transform& node) override
+			{
+				_visited(node);
+				_model = _model_of(node);
+				return true;
 			}
 
 			bool visit(ContentNode<BindablePtr>& node) override
 			{
-				this->visited[node.name()] += 1;
-				_visit_bindable(node.value());
+				_visited(node);
+				_push_binding(node.value());
 				return true;
 			}
 
-			bool visit(Light& node)
+			bool visit(ContentNode<DrawablePtr>& node) override
 			{
-				gl::vector::vec3f pos(
-					  _painter.state().lock()->model_view()
-					* gl::vector::vec4f(0, 0, 0, 1)
-				);
-				node.value().point().position = pos;
-				ETC_LOG.debug("Set", node, "pos to", pos);
+				_visited(node);
+				_push_item(node.value());
 				return true;
 			}
 
-			bool visit(ContentNode<MaterialPtr>& node)
+			bool visit(ContentNode<MaterialPtr>& node) override
 			{
 				auto it = _impl.bindables.find(&node);
 				if (it == _impl.bindables.end())
-				{
-					auto ptr = node.value()->bindable(_painter.renderer());
-					_visit_bindable((_impl.bindables[&node] = ptr));
-				}
-				else
-					_visit_bindable(it->second);
-
+					it = _impl.bindables.emplace(
+						&node,
+						_impl.new_binding(*node.value(), _painter.renderer())
+					).first;
+				_push_binding(it->second);
 				return true;
 			}
 
-			bool visit(ContentNode<MeshPtr>& node)
+			bool visit(ContentNode<MeshPtr>& node) override
 			{
 				auto it = _impl.drawables.find(&node);
 				if (it == _impl.drawables.end())
 				{
-					this->visited[node.name()] += 1;
-					auto ptr = node.value()->drawable(_painter.renderer());
-					_painter.draw((_impl.drawables[&node] = ptr));
+					_visited(node);
+					it = _impl.drawables.emplace(
+						&node, node.value()->drawable(_painter.renderer())
+					).first;
 				}
-				else
-					_painter.draw(it->second);
+				_push_item(it->second);
 				return true;
 			}
 			using super_type::visit;
 		};
 
-		struct DFSVisitor
-			: public visit::DefaultDepthFirstVisitor
-		{
-			DirectDraw draw;
-			DFSVisitor(SceneView::Impl& impl, gl::renderer::Painter& painter)
-				: draw{impl, painter}
-			{}
-
-			void discover_vertex(Node& n)
-			{ draw.enter = true; draw.visit(n); }
-			void finish_vertex(Node& n)
-			{ draw.enter = false; draw.visit(n); }
-		};
-
 	} // !anonymous
 
 	void SceneView::_draw(gl::renderer::Painter& painter)
 	{
 		ETC_TRACE.debug(*this, "Drawing scene");
 		std::vector<gl::renderer::Painter::Proxy<1>> bounds;
-		ETC_LOG.debug("Binding", _this->scene->lights().size(), "lights");
-		for (gl::renderer::LightPtr const& light: _this->scene->lights())
+		auto const& clusters = _this->light_clusters;
+		if (clusters == nullptr)
 		{
-			gl::renderer::Light* ptr = light.get();
-			bounds.emplace_back(painter.with(*ptr));
+			ETC_LOG.debug("Binding", _this->scene->lights().size(), "lights");
+			for (gl::renderer::LightPtr const& light: _this->scene->lights())
+			{
+				gl::renderer::Light* ptr = light.get();
+				bounds.emplace_back(painter.with(*ptr));
+			}
+		}
+
+		auto state = painter.state().lock();
+		Graph& graph = _this->scene->graph();
+		_this->bounds.clear();
+		_this->bindings.clear();
+		_this->items.clear();
+		_this->stats = Stats{0, 0, 0, 0};
+
+		graph.transforms().update();
+		ModelMatrix model_of{graph.transforms(), state->model()};
+		matrix_type const view_projection = state->projection() * state->view();
+		bool const cull = state->mode != gl::renderer::Mode::none;
+		gl::occlusion::Culler* culler = nullptr;
+		if (cull && _this->occlusion_culler != nullptr)
+		{
+			culler = _this->occlusion_culler.get();
+			culler->clear(view_projection);
+		}
+
+		{
+			BoundsPass pass{*_this, model_of, state->view(), culler};
+			pass.run(graph, graph.root());
+		}
+		if (culler != nullptr)
+			culler->rasterize();
+
+		if (clusters != nullptr)
+		{
+			// Light positions were just updated by the bounds pass.
+			gl::renderer::LightClusters::LightList lights;
+			for (gl::renderer::LightPtr const& light: _this->scene->lights())
+				lights.emplace_back(*light);
+			clusters->update(state->projection(), lights);
+			bounds.emplace_back(painter.with(*clusters));
+		}
+
+		{
+			CollectPass pass{
+				*_this,
+				painter,
+				model_of,
+				view_projection,
+				cull,
+				culler
+			};
+			pass.run(graph, graph.root(), false);
+			if (pass._debug)
+			{
+				std::string msg;
+				for (auto const& pair: pass.visited)
+					msg += "\n- " + pair.first + ": " +
+					       std::to_string(pair.second);
+				ETC_LOG.debug("Visited nodes:", msg);
+			}
+		}
+
+		std::stable_sort(_this->items.begin(), _this->items.end(),
+		                 DrawOrder{_this->bindings});
+
+		ETC_LOG.debug("Drawing", _this->stats.drawn, "items,",
+		              _this->stats.culled, "culled,",
+		              _this->stats.occluded, "occluded");
+		CUBE_DEBUG_COUNTER("cube.scene.SceneView.drawn", _this->stats.drawn);
+		CUBE_DEBUG_COUNTER("cube.scene.SceneView.culled", _this->stats.culled);
+		CUBE_DEBUG_COUNTER("cube.scene.SceneView.occluded",
+		                   _this->stats.occluded);
+
+		// Only rebind what changed between two consecutive items. All
+		// bindables are bound with the same state, the model matrix of a
+		// material is updated in place when only the model changes.
+		auto frame_state = painter.push_state().lock();
+		std::vector<etc::size_type> bound;
+		std::vector<gl::renderer::Painter::Proxy<1>> proxies;
+		std::vector<etc::size_type> chain;
+		for (auto& item: _this->items)
+		{
+			chain.clear();
+			for (auto idx = item.binding; idx != no_binding;
+			     idx = _this->bindings[idx].parent)
+				chain.push_back(idx);
+			std::reverse(chain.begin(), chain.end());
+
+			etc::size_type common = 0;
+			while (common < bound.size() && common < chain.size() &&
+			       bound[common] == chain[common])
+				common += 1;
+
+			if (frame_state->model() != item.model)
+			{
+				frame_state->model(item.model);
+				// Bindables might have used the previous matrices, unless
+				// the same material is kept.
+				gl::material::Bindable* material = nullptr;
+				if (common == chain.size() && common == bound.size() &&
+				    common > 0)
+					material = _this->bindings[chain.back()].material;
+				if (material != nullptr)
+					material->update_matrices();
+				else
+					common = 0;
+			}
+
+			while (bound.size() > common)
+			{
+				proxies.pop_back();
+				bound.pop_back();
+			}
+			for (etc::size_type i = common; i < chain.size(); ++i)
+			{
+				auto& binding = _this->bindings[chain[i]];
+				proxies.emplace_back(painter.with(*binding.bindable));
+				bound.push_back(chain[i]);
+				_this->stats.bindings += 1;
+			}
+			painter.draw(item.drawable);
 		}
-		DFSVisitor v{*_this, painter};
-		visit::depth_first_search(_this->scene->graph(), v);
-		std::string msg;
-		for (auto const& pair: v.draw.visited)
-			msg += "\n- " + pair.first + ": " + std::to_string(pair.second);
-		ETC_LOG.debug("Visited nodes:", msg);
+		proxies.clear();
+		painter.pop_state();
+		CUBE_DEBUG_COUNTER("cube.scene.SceneView.bindings",
+		                   _this->stats.bindings);
 	}
 
 }}
@@ -3,21 +3,74 @@
 
 # include "fwd.hpp"
 
+# include <cube/gl/fwd.hpp>
 # include <cube/gl/renderer/Drawable.hpp>
 
+# include <etc/types.hpp>
+
 namespace cube { namespace scene {
 
+	/**
+	 * @brief Draw a scene.
+	 *
+	 * Every frame, the bounds of each subtree are computed in world space,
+	 * subtrees outside of the view volume are skipped, and the visible
+	 * meshes and drawables are collected in a flat list. The list is sorted
+	 * by shader program, texture set and drawable so that consecutive items
+	 * share most of their bindings.
+	 *
+	 * When an occlusion culler is set, the meshes registered as occluders
+	 * are rasterized in it, and subtrees hidden behind them are skipped too.
+	 *
+	 * When light clusters are set, point lights are assigned to them instead
+	 * of being bound one by one, which lifts the per material light limit.
+	 */
 	class SceneView
 		: public gl::renderer::Drawable
 	{
 	public:
 		struct Impl;
+
+		/// Statistics of the last frame.
+		struct Stats
+		{
+			/// Drawn meshes and drawables.
+			etc::size_type drawn;
+			/// Meshes and drawables skipped by frustum culling.
+			etc::size_type culled;
+			/// Meshes and drawables skipped by occlusion culling.
+			etc::size_type occluded;
+			/// Bindables bound while drawing.
+			etc::size_type bindings;
+		};
+
 	private:
 		std::unique_ptr<Impl> _this;
 	public:
 		SceneView(ScenePtr scene);
 		~SceneView();
 
+	public:
+		Stats const& stats() const ETC_NOEXCEPT;
+
+		/// Set the occlusion culler, nullptr disables occlusion culling.
+		void occlusion_culler(gl::occlusion::CullerPtr culler);
+		gl::occlusion::CullerPtr const& occlusion_culler() const ETC_NOEXCEPT;
+
+		/**
+		 * @brief Rasterize the mesh of @a node in the occlusion culler.
+		 *
+		 * Occluders should be few, big and simple meshes.
+		 *
+		 * @throws if @a node does not hold a mesh.
+		 */
+		void add_occluder(node::Node& node);
+		void remove_occluder(node::Node& node);
+
+		/// Set the light clusters, nullptr binds every light to the materials.
+		void light_clusters(gl::renderer::LightClustersPtr clusters);
+		gl::renderer::LightClustersPtr const& light_clusters() const ETC_NOEXCEPT;
+
 	public:
 		void _draw(gl::renderer::Painter& painter) override;
 	};
@@ -25,4 +78,3 @@ namespace cube { namespace scene {
 }}
 
 #endif
-
@@ -0,0 +1,191 @@
+#include "Transforms.hpp"
+
+#include "Graph.hpp"
+#include "node/Node.hpp"
+#include "node/Transform.hpp"
+
+#include <cube/debug.hpp>
+
+#include <etc/assert.hpp>
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <unordered_set>
+
+namespace cube { namespace scene {
+
+	ETC_LOG_COMPONENT("cube.scene.Transforms");
+
+	Transforms::slot_type const Transforms::no_slot;
+
+	Transforms::Transforms(Graph& graph)
+		: _graph{&graph}
+		, _nodes{}
+		, _parents{}
+		, _locals{}
+		, _worlds{}
+		, _dirty{}
+		, _any_dirty{false}
+		, _stale{true}
+	{}
+
+	Transforms::~Transforms()
+	{ this->invalidate(); }
+
+	void Transforms::invalidate() ETC_NOEXCEPT
+	{
+		for (auto node: _nodes)
+			node->_unlink();
+		_nodes.clear();
+		_parents.clear();
+		_locals.clear();
+		_worlds.clear();
+		_dirty.clear();
+		_stale = true;
+	}
+
+	void Transforms::_rebuild()
+	{
+		ETC_TRACE.debug("Rebuild the transforms layout");
+		this->invalidate();
+
+		// Breadth first walk, so that a parent slot always comes before its
+		// children.
+		std::deque<std::pair<node::Node*, slot_type>> queue;
+		std::unordered_set<node::Node*> seen;
+		queue.emplace_back(&_graph->root(), no_slot);
+		seen.insert(&_graph->root());
+		while (!queue.empty())
+		{
+			node::Node* node = queue.front().first;
+			slot_type slot = queue.front().second;
+			queue.pop_front();
+			if (auto transform = dynamic_cast<node::Transform*>(node))
+			{
+				_nodes.push_back(transform);
+				_parents.push_back(slot);
+				_locals.push_back(transform->value());
+				_worlds.push_back(transform->value());
+				_dirty.push_back(1);
+				slot = _nodes.size() - 1;
+				transform->_link(*this, slot);
+			}
+			for (node::Node* child: _graph->children(*node))
+				if (seen.insert(child).second)
+					queue.emplace_back(child, slot);
+		}
+		_any_dirty = !_nodes.empty();
+		_stale = false;
+	}
+
+	etc::size_type Transforms::update()
+	{
+		if (_stale)
+			this->_rebuild();
+		if (!_any_dirty)
+			return 0;
+		etc::size_type updated = 0;
+		for (slot_type i = 0, size = _nodes.size(); i < size; ++i)
+		{
+			slot_type const parent = _parents[i];
+			if (parent != no_slot && _dirty[parent])
+				_dirty[i] = 1;
+			if (!_dirty[i])
+				continue;
+			if (parent == no_slot)
+				_worlds[i] = _locals[i];
+			else
+				gl::matrix::multiply(_worlds[parent], _locals[i], _worlds[i]);
+			updated += 1;
+		}
+		std::fill(_dirty.begin(), _dirty.end(), 0);
+		_any_dirty = false;
+		ETC_TRACE.debug("Updated", updated, "world matrices out of",
+		                _nodes.size());
+		CUBE_DEBUG_COUNTER("cube.scene.Transforms.updated", updated);
+		return updated;
+	}
+
+	Transforms::matrix_type const&
+	Transforms::world(node::Transform const& node) const ETC_NOEXCEPT
+	{
+		if (node._transforms != this || _stale)
+			return node.value();
+		return _worlds[node._slot];
+	}
+
+	void Transforms::_set_local(slot_type const slot,
+	                            matrix_type const& local) ETC_NOEXCEPT
+	{
+		ETC_ASSERT_LT(slot, _locals.size());
+		_locals[slot] = local;
+		_dirty[slot] = 1;
+		_any_dirty = true;
+	}
+
+	namespace {
+
+		using node::Node;
+		using node::Transform;
+		typedef gl::vector::vec3f vec3;
+
+		bool equal(Transforms::matrix_type const& a,
+		           Transforms::matrix_type const& b)
+		{
+			for (int i = 0; i < 4; ++i)
+				for (int j = 0; j < 4; ++j)
+					if (std::abs(a[i][j] - b[i][j]) > 1e-5f)
+						return false;
+			return true;
+		}
+
+		ETC_TEST_CASE(transforms_hierarchy)
+		{
+			Graph g;
+			auto id = Transforms::matrix_type(1);
+			auto& parent = g.root().emplace<Transform>("parent", id);
+			auto& group = parent.emplace<Node>("group");
+			auto& child = group.emplace<Transform>("child", id);
+			auto& other = g.root().emplace<Transform>("other", id);
+
+			auto& transforms = g.transforms();
+			ETC_ENFORCE_EQ(transforms.update(), 3u);
+			ETC_ENFORCE_EQ(transforms.size(), 3u);
+			ETC_ENFORCE_EQ(transforms.update(), 0u);
+
+			parent.translate(vec3(1, 0, 0));
+			child.translate(vec3(0, 2, 0));
+			ETC_ENFORCE_EQ(transforms.update(), 2u);
+			ETC_ENFORCE(equal(transforms.world(child),
+			                  parent.value() * child.value()));
+			ETC_ENFORCE(equal(transforms.world(other), id));
+
+			child.translate(vec3(0, 0, 3));
+			ETC_ENFORCE_EQ(transforms.update(), 1u);
+			ETC_ENFORCE(equal(transforms.world(child),
+			                  parent.value() * child.value()));
+		}
+
+		ETC_TEST_CASE(transforms_structure_change)
+		{
+			Graph g;
+			auto id = Transforms::matrix_type(1);
+			auto& parent = g.root().emplace<Transform>("parent", id);
+			parent.translate(vec3(1, 0, 0));
+			ETC_ENFORCE_EQ(g.transforms().update(), 1u);
+
+			auto& child = parent.emplace<Transform>("child", id);
+			ETC_ENFORCE_EQ(g.transforms().update(), 2u);
+			ETC_ENFORCE(equal(g.transforms().world(child), parent.value()));
+
+			g.remove(child);
+			ETC_ENFORCE_EQ(g.transforms().update(), 1u);
+			ETC_ENFORCE_EQ(g.transforms().size(), 1u);
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,93 @@
+#ifndef  CUBE_SCENE_TRANSFORMS_HPP
+# define CUBE_SCENE_TRANSFORMS_HPP
+
+# include "fwd.hpp"
+
+# include <cube/api.hpp>
+# include <cube/gl/matrix.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <cstdint>
+# include <vector>
+
+namespace cube { namespace scene {
+
+	/**
+	 * @brief World matrices of the Transform nodes of a graph.
+	 *
+	 * The world matrix of a Transform is the world matrix of its closest
+	 * Transform ancestor multiplied by its own value. Local and world
+	 * matrices are stored in arrays sorted by depth, so that parents are
+	 * always updated before their children in a single linear pass.
+	 *
+	 * Modifying a Transform flags it as dirty, and only the dirty Transforms
+	 * and their descendants are recomputed by update(). Changing the graph
+	 * structure rebuilds the arrays on the next update.
+	 *
+	 * @note A Transform reachable through several paths uses the first one
+	 *       found in breadth first order.
+	 */
+	class CUBE_API Transforms
+	{
+	public:
+		typedef gl::matrix::mat4f matrix_type;
+		typedef etc::size_type    slot_type;
+		static slot_type const    no_slot = static_cast<slot_type>(-1);
+
+	private:
+		Graph*                    _graph;
+		std::vector<node::Transform*> _nodes;
+		std::vector<slot_type>    _parents;
+		std::vector<matrix_type>  _locals;
+		std::vector<matrix_type>  _worlds;
+		std::vector<uint8_t>      _dirty;
+		bool                      _any_dirty;
+		bool                      _stale;
+
+	public:
+		explicit Transforms(Graph& graph);
+		~Transforms();
+
+	public:
+		/**
+		 * @brief Recompute world matrices of the modified Transforms.
+		 *
+		 * @returns the number of world matrices recomputed.
+		 */
+		etc::size_type update();
+
+		/**
+		 * @brief World matrix of a Transform.
+		 *
+		 * Only valid after an update(). A Transform not reachable from the
+		 * root has its value as world matrix.
+		 */
+		matrix_type const& world(node::Transform const& node) const ETC_NOEXCEPT;
+
+		/// Number of Transform nodes reachable from the root.
+		inline
+		etc::size_type size() const ETC_NOEXCEPT
+		{ return _nodes.size(); }
+
+		/// Forget the current layout, it is rebuilt on the next update.
+		void invalidate() ETC_NOEXCEPT;
+
+	private:
+		void _rebuild();
+
+	private:
+		friend class Graph;
+		friend class node::Transform;
+		inline
+		void _graph_moved(Graph& graph) ETC_NOEXCEPT
+		{ _graph = &graph; }
+
+		void _set_local(slot_type const slot,
+		                matrix_type const& local) ETC_NOEXCEPT;
+	};
+
+}}
+
+#endif
@@ -15,6 +15,7 @@ namespace cube { namespace scene {
 	typedef std::shared_ptr<SceneView> SceneViewPtr;
 
 	class Graph;
+	class Transforms;
 
 }}
 
@@ -20,6 +20,7 @@ namespace cube { namespace scene { namespace node {
 	Node::Node(std::string name)
 		: _name{std::move(name)}
 		, _graph{nullptr}
+		, _handle{}
 	{ ETC_TRACE_CTOR(name); }
 
 	Node::~Node()
@@ -45,6 +46,7 @@ namespace cube { namespace scene { namespace node {
 		ETC_LOG.debug("Detach", *this, "from", g);
 		ETC_ASSERT_EQ(_graph, &g);
 		_graph = nullptr;
+		_handle = Handle{};
 	}
 
 	Node& Node::_insert_child(std::unique_ptr<Node> node)
@@ -6,6 +6,7 @@
 
 # include <cube/api.hpp>
 # include <cube/scene/fwd.hpp>
+# include <cube/scene/Handle.hpp>
 
 # include <etc/cast.hpp>
 # include <etc/memory.hpp>
@@ -31,6 +32,8 @@ namespace cube { namespace scene { namespace node {
 	protected:
 		std::string _name;
 		Graph*      _graph;
+	private:
+		Handle      _handle;
 
 	public:
 		/// Construct a Node with a name.
@@ -59,6 +62,9 @@ namespace cube { namespace scene { namespace node {
 		/// Detach a node from its graph. id() and graph() methods will throw.
 		void detach(Graph& g);
 
+		/// Slot of the node in its graph.
+		Handle const& handle() const ETC_NOEXCEPT { return _handle; }
+
 		template<typename NodeType, typename... Args>
 		NodeType& emplace(Args&&... args)
 		{
@@ -74,6 +80,10 @@ namespace cube { namespace scene { namespace node {
 	private:
 		Node& _insert_child(std::unique_ptr<Node> node);
 
+		friend class cube::scene::Graph;
+		void _set_handle(Handle const& handle) ETC_NOEXCEPT
+		{ _handle = handle; }
+
 	public:
 		using Visitable<Node>::visit;
 
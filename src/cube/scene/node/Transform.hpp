@@ -3,6 +3,8 @@
 
 # include "Node.hpp"
 
+# include <cube/scene/Transforms.hpp>
+
 # include <cube/gl/matrix.hpp>
 # include <cube/gl/vector.hpp>
 # include <cube/units/angle.hpp>
@@ -19,26 +21,63 @@ namespace cube { namespace scene { namespace node {
 
 	private:
 		matrix_type _transformation;
+		// Set when the graph transforms track this node.
+		Transforms* _transforms;
+		Transforms::slot_type _slot;
 
 	public:
 		explicit Transform(std::string name,
 		                   matrix_type const& transformation)
 			: Node{std::move(name)}
 			, _transformation(transformation)
+			, _transforms{nullptr}
+			, _slot{Transforms::no_slot}
 		{}
 
 	public:
+		/// Transformation relative to the closest Transform ancestor.
 		inline
 		matrix_type const& value() const { return _transformation; }
 
 		void value(matrix_type const& mat)
-		{ _transformation = mat; }
+		{ _transformation = mat; _changed(); }
 
 		void translate(vector_type const& v)
-		{ _transformation = gl::matrix::translate(_transformation, v); }
+		{
+			_transformation = gl::matrix::translate(_transformation, v);
+			_changed();
+		}
 
 		void rotate(units::Angle angle, vector_type const& v)
-		{ _transformation = gl::matrix::rotate(_transformation, angle, v); }
+		{
+			_transformation = gl::matrix::rotate(_transformation, angle, v);
+			_changed();
+		}
+
+	private:
+		friend class cube::scene::Transforms;
+
+		inline
+		void _changed() ETC_NOEXCEPT
+		{
+			if (_transforms != nullptr)
+				_transforms->_set_local(_slot, _transformation);
+		}
+
+		inline
+		void _link(Transforms& transforms,
+		           Transforms::slot_type const slot) ETC_NOEXCEPT
+		{
+			_transforms = &transforms;
+			_slot = slot;
+		}
+
+		inline
+		void _unlink() ETC_NOEXCEPT
+		{
+			_transforms = nullptr;
+			_slot = Transforms::no_slot;
+		}
 
 	public:
 		using Visitable<Transform>::visit;
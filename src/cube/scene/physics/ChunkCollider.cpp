@@ -0,0 +1,488 @@
+#include "ChunkCollider.hpp"
+#include "EngineImpl.hpp"
+
+#include <cube/debug.hpp>
+#include <cube/exception.hpp>
+#include <cube/gl/matrix.hpp>
+#include <cube/scene/node/Transform.hpp>
+
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace cube { namespace scene { namespace physics {
+
+	ETC_LOG_COMPONENT("cube.scene.physics.ChunkCollider");
+
+	using exception::Exception;
+
+	namespace {
+
+		etc::size_type const size = ChunkCollider::chunk_size;
+
+		inline
+		etc::size_type voxel_index(etc::size_type const x,
+		                           etc::size_type const y,
+		                           etc::size_type const z) ETC_NOEXCEPT
+		{ return x + size * (z + size * y); }
+
+	} // !anonymous
+
+	ChunkCollider::ChunkData::ChunkData() ETC_NOEXCEPT
+		: kind{Kind::empty}
+		, heights{}
+		, voxels{}
+	{}
+
+	ChunkCollider::Config::Config() ETC_NOEXCEPT
+		: radius{1}
+		, max_chunks{256}
+	{}
+
+	struct ChunkCollider::Impl
+	{
+		struct Entry
+		{
+			// Referenced by the heightfield shape.
+			std::vector<float>                 heights;
+			std::unique_ptr<btCollisionShape>  shape;
+			std::unique_ptr<btCollisionObject> object;
+			etc::size_type                     boxes;
+			etc::size_type                     memory;
+			etc::size_type                     last_used;
+		};
+
+		typedef std::tuple<int, int, int> box_key;
+
+		Engine::Impl&                              engine;
+		provider_type                              provider;
+		Config const                               config;
+		std::unordered_map<coord_type, Entry>      chunks;
+		// Children of the voxel compounds, shared by all chunks.
+		std::map<box_key, std::unique_ptr<btBoxShape>> box_shapes;
+		ChunkData                                  data;
+		etc::size_type                             frame;
+		Stats                                      stats;
+
+		Impl(Engine::Impl& engine,
+		     provider_type provider,
+		     Config const& config)
+			: engine(engine)
+			, provider{std::move(provider)}
+			, config(config)
+			, chunks{}
+			, box_shapes{}
+			, data{}
+			, frame{0}
+			, stats{0, 0, 0, 0, 0}
+		{}
+
+		btBoxShape& box_shape(int w, int h, int d)
+		{
+			auto& res = this->box_shapes[box_key{w, h, d}];
+			if (res == nullptr)
+				res.reset(new btBoxShape{btVector3{w / 2.0f, h / 2.0f, d / 2.0f}});
+			return *res;
+		}
+
+		void build(coord_type const& coord, ChunkData& data)
+		{
+			Entry entry;
+			entry.boxes = 0;
+			entry.memory = sizeof(Entry);
+			entry.last_used = this->frame;
+			btTransform transform;
+			transform.setIdentity();
+			btVector3 origin{
+				static_cast<btScalar>(coord.x * static_cast<int>(size)),
+				static_cast<btScalar>(coord.y * static_cast<int>(size)),
+				static_cast<btScalar>(coord.z * static_cast<int>(size)),
+			};
+			transform.setOrigin(origin);
+
+			if (data.kind == ChunkData::Kind::heightfield)
+			{
+				if (data.heights.size() != (size + 1) * (size + 1))
+					throw Exception{"Invalid heightfield size"};
+				entry.heights = std::move(data.heights);
+				auto range = std::minmax_element(entry.heights.begin(),
+				                                 entry.heights.end());
+				float min = *range.first, max = *range.second;
+				entry.shape.reset(
+					new btHeightfieldTerrainShape{
+						static_cast<int>(size + 1),
+						static_cast<int>(size + 1),
+						entry.heights.data(),
+						1.0f,
+						min,
+						max,
+						1,
+						PHY_FLOAT,
+						false,
+					}
+				);
+				// Heightfields are centered on their bounding box.
+				transform.setOrigin(
+					origin + btVector3{size / 2.0f, (min + max) / 2, size / 2.0f}
+				);
+				entry.memory += entry.heights.size() * sizeof(float) +
+				                sizeof(btHeightfieldTerrainShape);
+			}
+			else if (data.kind == ChunkData::Kind::voxels)
+			{
+				if (data.voxels.size() != size * size * size)
+					throw Exception{"Invalid voxels size"};
+				auto boxes = ChunkCollider::merge(data.voxels);
+				if (!boxes.empty())
+				{
+					auto compound = new btCompoundShape{
+						true, static_cast<int>(boxes.size())
+					};
+					entry.shape.reset(compound);
+					for (auto const& box: boxes)
+					{
+						btTransform child;
+						child.setIdentity();
+						child.setOrigin(btVector3{
+							box.x + box.width / 2.0f,
+							box.y + box.height / 2.0f,
+							box.z + box.depth / 2.0f,
+						});
+						compound->addChildShape(
+							child,
+							&this->box_shape(box.width, box.height, box.depth)
+						);
+					}
+					entry.boxes = boxes.size();
+					// A child and its node in the compound tree.
+					entry.memory += sizeof(btCompoundShape) + boxes.size() *
+						(sizeof(btCompoundShapeChild) + 2 * sizeof(btDbvtNode));
+				}
+			}
+
+			if (entry.shape != nullptr)
+			{
+				entry.object.reset(new btCollisionObject);
+				entry.object->setCollisionShape(entry.shape.get());
+				entry.object->setWorldTransform(transform);
+				this->engine.world->addCollisionObject(entry.object.get());
+				entry.memory += sizeof(btCollisionObject);
+			}
+			this->stats.boxes += entry.boxes;
+			this->stats.memory += entry.memory;
+			this->chunks.emplace(coord, std::move(entry));
+		}
+
+		void evict(std::unordered_map<coord_type, Entry>::iterator it)
+		{
+			Entry& entry = it->second;
+			if (entry.object != nullptr)
+				this->engine.world->removeCollisionObject(entry.object.get());
+			this->stats.boxes -= entry.boxes;
+			this->stats.memory -= entry.memory;
+			this->stats.evicted += 1;
+			this->chunks.erase(it);
+		}
+	};
+
+	ChunkCollider::ChunkCollider(Engine& engine,
+	                             provider_type provider,
+	                             Config const& config)
+		: _this{new Impl{*engine._this, std::move(provider), config}}
+	{
+		ETC_TRACE_CTOR();
+		if (_this->provider == nullptr)
+			throw Exception{"A chunk collider needs a provider"};
+		_this->engine.colliders.push_back(this);
+	}
+
+	ChunkCollider::~ChunkCollider()
+	{
+		ETC_TRACE_DTOR();
+		auto& colliders = _this->engine.colliders;
+		colliders.erase(std::find(colliders.begin(), colliders.end(), this));
+		while (!_this->chunks.empty())
+			_this->evict(_this->chunks.begin());
+	}
+
+	void ChunkCollider::update()
+	{
+		CUBE_DEBUG_PERFORMANCE_SECTION("cube.scene.physics.ChunkCollider");
+		_this->frame += 1;
+		_this->stats.built = 0;
+		_this->stats.evicted = 0;
+
+		std::unordered_set<coord_type> centers;
+		for (auto slot: _this->engine.dynamic)
+		{
+			auto const& o = _this->engine.bodies[slot].current.getOrigin();
+			centers.insert(chunk_of(gl::vector::vec3f{o.getX(), o.getY(), o.getZ()}));
+		}
+
+		// Build the chunks around the bodies, keep a margin of one chunk
+		// before evicting them so that a body moving on a chunk border
+		// does not rebuild them over and over.
+		int const radius = static_cast<int>(_this->config.radius);
+		std::unordered_set<coord_type> keep;
+		for (auto const& center: centers)
+			for (int y = -radius - 1; y <= radius + 1; ++y)
+				for (int z = -radius - 1; z <= radius + 1; ++z)
+					for (int x = -radius - 1; x <= radius + 1; ++x)
+					{
+						coord_type coord = center + coord_type{x, y, z};
+						bool border = std::abs(x) > radius ||
+						              std::abs(y) > radius ||
+						              std::abs(z) > radius;
+						auto it = _this->chunks.find(coord);
+						if (it != _this->chunks.end())
+						{
+							keep.insert(coord);
+							if (!border)
+								it->second.last_used = _this->frame;
+							continue;
+						}
+						if (border)
+							continue;
+						auto& data = _this->data;
+						data.kind = ChunkData::Kind::empty;
+						data.heights.clear();
+						data.voxels.clear();
+						if (!_this->provider(coord, data))
+							continue;
+						_this->build(coord, data);
+						_this->stats.built += 1;
+						keep.insert(coord);
+					}
+
+		for (auto it = _this->chunks.begin(); it != _this->chunks.end();)
+		{
+			if (keep.count(it->first) == 0)
+			{
+				auto next = std::next(it);
+				_this->evict(it);
+				it = next;
+			}
+			else
+				++it;
+		}
+
+		// Over the limit, evict the least recently needed chunks.
+		if (_this->chunks.size() > _this->config.max_chunks)
+		{
+			std::vector<std::pair<etc::size_type, coord_type>> order;
+			for (auto const& pair: _this->chunks)
+				if (pair.second.last_used != _this->frame)
+					order.emplace_back(pair.second.last_used, pair.first);
+			std::sort(order.begin(), order.end(),
+			          [] (std::pair<etc::size_type, coord_type> const& lhs,
+			              std::pair<etc::size_type, coord_type> const& rhs) {
+				return lhs.first < rhs.first;
+			});
+			for (auto const& pair: order)
+			{
+				if (_this->chunks.size() <= _this->config.max_chunks)
+					break;
+				_this->evict(_this->chunks.find(pair.second));
+			}
+		}
+
+		_this->stats.chunks = _this->chunks.size();
+		if (_this->stats.built > 0 || _this->stats.evicted > 0)
+			ETC_LOG.debug("Built", _this->stats.built, "and evicted",
+			              _this->stats.evicted, "chunks,",
+			              _this->stats.chunks, "cached using",
+			              _this->stats.memory, "bytes");
+		CUBE_DEBUG_COUNTER("cube.scene.physics.ChunkCollider.chunks",
+		                   _this->stats.chunks);
+	}
+
+	void ChunkCollider::invalidate(coord_type const& chunk)
+	{
+		auto it = _this->chunks.find(chunk);
+		if (it != _this->chunks.end())
+			_this->evict(it);
+		_this->stats.chunks = _this->chunks.size();
+	}
+
+	bool ChunkCollider::has_chunk(coord_type const& chunk) const ETC_NOEXCEPT
+	{ return _this->chunks.count(chunk) != 0; }
+
+	ChunkCollider::Stats const& ChunkCollider::stats() const ETC_NOEXCEPT
+	{ return _this->stats; }
+
+	ChunkCollider::coord_type
+	ChunkCollider::chunk_of(gl::vector::vec3f const& position) ETC_NOEXCEPT
+	{
+		return coord_type{
+			static_cast<int32_t>(std::floor(position.x / size)),
+			static_cast<int32_t>(std::floor(position.y / size)),
+			static_cast<int32_t>(std::floor(position.z / size)),
+		};
+	}
+
+	std::vector<ChunkCollider::Box>
+	ChunkCollider::merge(std::vector<uint8_t> const& voxels)
+	{
+		if (voxels.size() != size * size * size)
+			throw Exception{"Invalid voxels size"};
+		std::vector<Box> res;
+		std::vector<uint8_t> used(voxels.size(), 0);
+		auto free = [&] (etc::size_type x, etc::size_type y, etc::size_type z) {
+			auto idx = voxel_index(x, y, z);
+			return voxels[idx] != 0 && used[idx] == 0;
+		};
+		// Grow every box along x, then z, then y.
+		for (etc::size_type y = 0; y < size; ++y)
+			for (etc::size_type z = 0; z < size; ++z)
+				for (etc::size_type x = 0; x < size; ++x)
+				{
+					if (!free(x, y, z))
+						continue;
+					etc::size_type w = 1, d = 1, h = 1;
+					while (x + w < size && free(x + w, y, z))
+						w += 1;
+					auto row_free = [&] (etc::size_type y_, etc::size_type z_) {
+						for (etc::size_type i = x; i < x + w; ++i)
+							if (!free(i, y_, z_))
+								return false;
+						return true;
+					};
+					while (z + d < size && row_free(y, z + d))
+						d += 1;
+					auto layer_free = [&] (etc::size_type y_) {
+						for (etc::size_type j = z; j < z + d; ++j)
+							if (!row_free(y_, j))
+								return false;
+						return true;
+					};
+					while (y + h < size && layer_free(y + h))
+						h += 1;
+					for (etc::size_type k = y; k < y + h; ++k)
+						for (etc::size_type j = z; j < z + d; ++j)
+							for (etc::size_type i = x; i < x + w; ++i)
+								used[voxel_index(i, k, j)] = 1;
+					res.push_back(Box{
+						static_cast<uint8_t>(x),
+						static_cast<uint8_t>(y),
+						static_cast<uint8_t>(z),
+						static_cast<uint8_t>(w),
+						static_cast<uint8_t>(h),
+						static_cast<uint8_t>(d),
+					});
+				}
+		return res;
+	}
+
+	namespace {
+
+		typedef ChunkCollider::ChunkData ChunkData;
+		typedef ChunkCollider::coord_type coord_type;
+
+		std::vector<uint8_t> covered(std::vector<ChunkCollider::Box> const& boxes)
+		{
+			std::vector<uint8_t> res(size * size * size, 0);
+			for (auto const& b: boxes)
+				for (etc::size_type y = b.y; y < b.y + b.height; ++y)
+					for (etc::size_type z = b.z; z < b.z + b.depth; ++z)
+						for (etc::size_type x = b.x; x < b.x + b.width; ++x)
+							res[voxel_index(x, y, z)] += 1;
+			return res;
+		}
+
+		ETC_TEST_CASE(chunk_merge_voxels)
+		{
+			std::vector<uint8_t> voxels(size * size * size, 0);
+			ETC_ENFORCE_EQ(ChunkCollider::merge(voxels).size(), 0u);
+			std::fill(voxels.begin(), voxels.end(), 1);
+			ETC_ENFORCE_EQ(ChunkCollider::merge(voxels).size(), 1u);
+
+			// Random voxels are covered exactly once.
+			std::mt19937 gen{7};
+			for (auto& v: voxels)
+				v = (gen() % 3) != 0;
+			auto boxes = ChunkCollider::merge(voxels);
+			ETC_ENFORCE(covered(boxes) == voxels);
+			ETC_ENFORCE_LT(boxes.size(), 2000u);
+		}
+
+		ETC_TEST_CASE(chunk_lazy_build)
+		{
+			Engine engine;
+			etc::size_type requests = 0;
+			// Flat ground below y = 0.
+			ChunkCollider collider{
+				engine,
+				[&] (coord_type const& coord, ChunkData& data) {
+					requests += 1;
+					if (coord.y == -1)
+					{
+						data.kind = ChunkData::Kind::heightfield;
+						data.heights.assign((size + 1) * (size + 1), size);
+					}
+					return true;
+				}
+			};
+			node::Transform ball{
+				"ball",
+				gl::matrix::translate(node::Transform::matrix_type(),
+				                      gl::vector::vec3f(8, 2, 8))
+			};
+			engine.add_body(ball, Shape::sphere(0.5f), 1);
+			for (int i = 0; i < 180; ++i)
+				engine.update(1.0f / 60.0f);
+			ETC_ENFORCE_EQ(collider.stats().chunks, 27u);
+			ETC_ENFORCE_EQ(requests, 27u);
+			ETC_ENFORCE(collider.has_chunk(coord_type{0, -1, 0}));
+			ETC_ENFORCE(!collider.has_chunk(coord_type{5, 0, 0}));
+			// The ball rests on the ground.
+			ETC_ENFORCE_LT(std::fabs(ball.value()[3][1] - 0.5f), 0.05f);
+		}
+
+		ETC_TEST_CASE(chunk_eviction)
+		{
+			Engine engine;
+			ChunkCollider::Config config;
+			config.radius = 0;
+			config.max_chunks = 4;
+			ChunkCollider collider{
+				engine,
+				[] (coord_type const&, ChunkData& data) {
+					data.kind = ChunkData::Kind::voxels;
+					data.voxels.assign(size * size * size, 0);
+					data.voxels[0] = 1;
+					return true;
+				},
+				config
+			};
+			engine.gravity({0, 0, 0});
+			// Away from the solid voxel of the chunks.
+			node::Transform body{
+				"body",
+				gl::matrix::translate(node::Transform::matrix_type(),
+				                      gl::vector::vec3f(0, 8, 8))
+			};
+			auto handle = engine.add_body(body, Shape::sphere(0.5f), 1);
+			engine.velocity(handle, {size * 10.0f, 0, 0});
+			engine.update(1.0f / 60.0f);
+			ETC_ENFORCE_EQ(collider.stats().chunks, 1u);
+			for (int i = 0; i < 120; ++i)
+			{
+				engine.update(1.0f / 60.0f);
+				ETC_ENFORCE_LTE(collider.stats().chunks, 2u);
+			}
+			ETC_ENFORCE_EQ(collider.stats().boxes, collider.stats().chunks);
+			ETC_ENFORCE(!collider.has_chunk(coord_type{0, 0, 0}));
+		}
+
+	} // !anonymous
+
+}}}
@@ -0,0 +1,136 @@
+#ifndef  CUBE_SCENE_PHYSICS_CHUNKCOLLIDER_HPP
+# define CUBE_SCENE_PHYSICS_CHUNKCOLLIDER_HPP
+
+# include "fwd.hpp"
+
+# include <cube/api.hpp>
+# include <cube/gl/vector.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <cstdint>
+# include <functional>
+# include <memory>
+# include <vector>
+
+namespace cube { namespace scene { namespace physics {
+
+	/**
+	 * @brief Static collision shapes of the world chunks.
+	 *
+	 * Chunks are cubes of chunk_size units, the chunk (x, y, z) spanning
+	 * from (x, y, z) * chunk_size. Their collision shapes are built straight
+	 * from the chunk data given by a provider: a heightfield for terrain, or
+	 * a compound of boxes for voxels, neighbour solid voxels being merged
+	 * into as few boxes as possible.
+	 *
+	 * Shapes are only built for the chunks around dynamic bodies, when the
+	 * engine is about to step. They are cached, and evicted once every body
+	 * is far from them, or when the cache is full, so that memory depends on
+	 * where the bodies are, not on the size of the world.
+	 */
+	class CUBE_API ChunkCollider
+	{
+	public:
+		static etc::size_type const chunk_size = 16;
+		typedef gl::vector::vec3i coord_type;
+
+		/// Collision data of a chunk.
+		struct ChunkData
+		{
+			enum class Kind
+			{
+				empty,
+				heightfield,
+				voxels,
+			};
+
+			Kind kind;
+			/// (chunk_size + 1)^2 heights above the chunk bottom, x first.
+			std::vector<float> heights;
+			/// chunk_size^3 flags, non zero for solid voxels, x first then z
+			/// then y.
+			std::vector<uint8_t> voxels;
+
+			ChunkData() ETC_NOEXCEPT;
+		};
+
+		/**
+		 * @brief Fill the collision data of a chunk.
+		 *
+		 * Returns false when the chunk is not available yet, it is asked
+		 * again on the next update.
+		 */
+		typedef std::function<bool(coord_type const&, ChunkData&)> provider_type;
+
+		struct Config
+		{
+			/// Chunks kept around the chunk of a body, in each direction.
+			etc::size_type radius;
+			/// Maximum cached chunks, chunks close to bodies excepted.
+			etc::size_type max_chunks;
+
+			Config() ETC_NOEXCEPT;
+		};
+
+		struct Stats
+		{
+			/// Cached chunks.
+			etc::size_type chunks;
+			/// Chunks built and evicted by the last update.
+			etc::size_type built;
+			etc::size_type evicted;
+			/// Boxes of the cached voxel chunks.
+			etc::size_type boxes;
+			/// Approximate memory used by the cached shapes, in bytes.
+			etc::size_type memory;
+		};
+
+		/// A box of voxels.
+		struct Box
+		{
+			uint8_t x, y, z;
+			uint8_t width, height, depth;
+		};
+
+	public:
+		struct Impl;
+
+	private:
+		std::unique_ptr<Impl> _this;
+
+	public:
+		/// Register the collider in @a engine, which must outlive it.
+		ChunkCollider(Engine& engine,
+		              provider_type provider,
+		              Config const& config = Config{});
+		~ChunkCollider();
+
+	public:
+		/**
+		 * @brief Build the chunks close to the bodies and evict the others.
+		 *
+		 * Called by the engine before stepping.
+		 */
+		void update();
+
+		/// Forget a chunk, for example because its data changed.
+		void invalidate(coord_type const& chunk);
+
+		bool has_chunk(coord_type const& chunk) const ETC_NOEXCEPT;
+
+		Stats const& stats() const ETC_NOEXCEPT;
+
+		/// Chunk containing a position.
+		static
+		coord_type chunk_of(gl::vector::vec3f const& position) ETC_NOEXCEPT;
+
+		/// Merge the solid voxels of a chunk into boxes.
+		static
+		std::vector<Box> merge(std::vector<uint8_t> const& voxels);
+	};
+
+}}}
+
+#endif
@@ -1,17 +1,61 @@
 #include "EngineImpl.hpp"
+#include "ChunkCollider.hpp"
+
+#include <cube/debug.hpp>
+#include <cube/exception.hpp>
+#include <cube/gl/matrix.hpp>
+#include <cube/scene/node/Transform.hpp>
+
+#include <etc/log.hpp>
+#include <etc/sys/environ.hpp>
+#include <etc/test.hpp>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cmath>
 
 namespace cube { namespace scene { namespace physics {
 
+	ETC_LOG_COMPONENT("cube.scene.physics.Engine");
+
+	using exception::Exception;
+
 	static gl::vector::vec3f default_gravity{0.0f, -9.81f, 0.0f};
 
-	Engine::Engine()
-		: _this{new Impl}
+	Shape Shape::box(gl::vector::vec3f const& half_extents)
+	{ return Shape{Kind::box, half_extents}; }
+
+	Shape Shape::sphere(float const radius)
+	{ return Shape{Kind::sphere, gl::vector::vec3f{radius, 0, 0}}; }
+
+	Shape Shape::capsule(float const radius, float const height)
+	{ return Shape{Kind::capsule, gl::vector::vec3f{radius, height / 2, 0}}; }
+
+	Engine::Config::Config() ETC_NOEXCEPT
+		: timestep{1.0f / 60.0f}
+		, max_steps{5}
+		, threads{0}
+		, broadphase{Broadphase::dbvt}
+		, world_min{-1024, -1024, -1024}
+		, world_max{1024, 1024, 1024}
+		, grid_cell_size{4}
+		, solver_iterations{10}
+	{}
+
+	Engine::Engine(Config const& config)
+		: _this{new Impl{config}}
 	{
+		ETC_TRACE_CTOR();
+		if (!(config.timestep > 0))
+			throw Exception{"The physics timestep must be positive"};
+		if (config.solver_iterations == 0)
+			throw Exception{"The solver needs at least one iteration"};
 		this->gravity(default_gravity);
 	}
 
 	Engine::~Engine()
-	{}
+	{ ETC_TRACE_DTOR(); }
 
 	Engine& Engine::gravity(gl::vector::vec3f const& acceleration)
 	{
@@ -25,4 +69,286 @@ namespace cube { namespace scene { namespace physics {
 		return gl::vector::vec3f{g.getX(), g.getY(), g.getZ()};
 	}
 
+	Engine::Config const& Engine::config() const ETC_NOEXCEPT
+	{ return _this->config; }
+
+	etc::size_type Engine::threads() const ETC_NOEXCEPT
+	{ return _this->threads; }
+
+	Handle Engine::add_body(node::Transform& node,
+	                        Shape const& shape,
+	                        float const mass)
+	{
+		if (mass < 0)
+			throw Exception{"A body cannot have a negative mass"};
+		btCollisionShape& collision_shape = _this->shape(shape);
+		btVector3 inertia{0, 0, 0};
+		if (mass > 0)
+			collision_shape.calculateLocalInertia(mass, inertia);
+		btRigidBody::btRigidBodyConstructionInfo info{
+			mass, nullptr, &collision_shape, inertia
+		};
+		info.m_startWorldTransform.setFromOpenGLMatrix(
+			glm::value_ptr(node.value())
+		);
+
+		Handle::index_type slot;
+		if (_this->free_slots.empty())
+		{
+			slot = static_cast<Handle::index_type>(_this->bodies.size());
+			_this->bodies.emplace_back();
+			_this->bodies.back().generation = 0;
+			_this->moved_flags.push_back(0);
+		}
+		else
+		{
+			slot = _this->free_slots.back();
+			_this->free_slots.pop_back();
+		}
+		Impl::Body& body = _this->bodies[slot];
+		body.body.reset(new btRigidBody{info});
+		body.node = &node;
+		body.previous = body.current = info.m_startWorldTransform;
+		body.awake = false;
+		body.dynamic_index = _this->dynamic.size();
+		if (mass > 0)
+			_this->dynamic.push_back(slot);
+		_this->world->addRigidBody(body.body.get());
+		ETC_TRACE.debug("Add body", slot, "to", node, "with a mass of", mass);
+		return Handle{slot, body.generation};
+	}
+
+	void Engine::remove_body(Handle const handle)
+	{
+		Impl::Body& body = _this->body(handle);
+		_this->world->removeRigidBody(body.body.get());
+		if (body.body->getInvMass() > 0)
+		{
+			// Swap with the last dynamic body.
+			auto last = _this->dynamic.back();
+			_this->dynamic[body.dynamic_index] = last;
+			_this->bodies[last].dynamic_index = body.dynamic_index;
+			_this->dynamic.pop_back();
+		}
+		if (_this->moved_flags[handle.index])
+		{
+			_this->moved.erase(
+				std::find(_this->moved.begin(), _this->moved.end(), handle.index)
+			);
+			_this->moved_flags[handle.index] = 0;
+		}
+		body.body.reset();
+		body.node = nullptr;
+		body.generation += 1;
+		_this->free_slots.push_back(handle.index);
+	}
+
+	bool Engine::has_body(Handle const handle) const ETC_NOEXCEPT
+	{
+		return handle.index < _this->bodies.size() &&
+		       _this->bodies[handle.index].body != nullptr &&
+		       _this->bodies[handle.index].generation == handle.generation;
+	}
+
+	etc::size_type Engine::bodies() const ETC_NOEXCEPT
+	{ return _this->bodies.size() - _this->free_slots.size(); }
+
+	gl::vector::vec3f Engine::velocity(Handle const handle) const
+	{
+		auto const& v = _this->body(handle).body->getLinearVelocity();
+		return gl::vector::vec3f{v.getX(), v.getY(), v.getZ()};
+	}
+
+	void Engine::velocity(Handle const handle, gl::vector::vec3f const& value)
+	{
+		auto& body = *_this->body(handle).body;
+		body.setLinearVelocity(btVector3{value.x, value.y, value.z});
+		body.activate();
+	}
+
+	void Engine::apply_impulse(Handle const handle,
+	                           gl::vector::vec3f const& impulse)
+	{
+		auto& body = *_this->body(handle).body;
+		body.applyCentralImpulse(btVector3{impulse.x, impulse.y, impulse.z});
+		body.activate();
+	}
+
+	etc::size_type Engine::update(float const elapsed)
+	{
+		float const timestep = _this->config.timestep;
+		_this->accumulator += elapsed;
+		if (_this->accumulator >= timestep)
+			for (auto collider: _this->colliders)
+				collider->update();
+		etc::size_type steps = 0;
+		while (_this->accumulator >= timestep && steps < _this->config.max_steps)
+		{
+			_this->step();
+			_this->accumulator -= timestep;
+			steps += 1;
+		}
+		if (_this->accumulator >= timestep)
+		{
+			ETC_LOG.debug("Drop", _this->accumulator - std::fmod(_this->accumulator, timestep),
+			              "seconds of simulation");
+			_this->accumulator = std::fmod(_this->accumulator, timestep);
+		}
+		_this->stats.steps = steps;
+		_this->write_back();
+		return steps;
+	}
+
+	float Engine::interpolation() const ETC_NOEXCEPT
+	{ return _this->accumulator / _this->config.timestep; }
+
+	Engine::Stats const& Engine::stats() const ETC_NOEXCEPT
+	{ return _this->stats; }
+
+	namespace {
+
+		typedef node::Transform::matrix_type matrix_type;
+
+		matrix_type at(float x, float y, float z)
+		{ return gl::matrix::translate(matrix_type(), gl::vector::vec3f(x, y, z)); }
+
+		float height(node::Transform const& node)
+		{ return node.value()[3][1]; }
+
+		ETC_TEST_CASE(physics_falling_body)
+		{
+			Engine engine;
+			node::Transform ground{"ground", at(0, -1, 0)};
+			node::Transform ball{"ball", at(0, 10, 0)};
+			engine.add_body(ground, Shape::box({50, 1, 50}), 0);
+			auto handle = engine.add_body(ball, Shape::sphere(0.5f), 1);
+			ETC_ENFORCE_EQ(engine.bodies(), 2u);
+
+			// One second of free fall.
+			engine.update(1.0f);
+			ETC_ENFORCE_EQ(engine.stats().steps, engine.config().max_steps);
+			for (int i = 0; i < 55; ++i)
+				engine.update(1.0f / 60.0f);
+			ETC_ENFORCE_LT(engine.velocity(handle).y, -5.0f);
+			ETC_ENFORCE_LT(height(ball), 10.0f);
+
+			for (int i = 0; i < 600; ++i)
+				engine.update(1.0f / 60.0f);
+			// Resting on the ground.
+			ETC_ENFORCE_LT(std::fabs(height(ball) - 0.5f), 0.05f);
+			ETC_ENFORCE_EQ(height(ground), -1.0f);
+		}
+
+		ETC_TEST_CASE(physics_broadphases)
+		{
+			for (auto kind: {Engine::Broadphase::dbvt,
+			                 Engine::Broadphase::axis_sweep,
+			                 Engine::Broadphase::grid})
+			{
+				Engine::Config config;
+				config.broadphase = kind;
+				config.solver_iterations = 4;
+				Engine engine{config};
+				node::Transform ground{"ground", at(0, -1, 0)};
+				node::Transform a{"a", at(0, 2, 0)}, b{"b", at(0.2f, 4, 0)};
+				engine.add_body(ground, Shape::box({50, 1, 50}), 0);
+				engine.add_body(a, Shape::box({.5f, .5f, .5f}), 1);
+				engine.add_body(b, Shape::box({.5f, .5f, .5f}), 1);
+				auto& performance = debug::Performance::instance();
+				auto contacts = performance.counter("cube.scene.physics.Engine.contacts");
+				for (int i = 0; i < 180; ++i)
+					engine.update(1.0f / 60.0f);
+				// Stacked on the ground.
+				ETC_ENFORCE_LT(std::fabs(height(a) - 0.5f), 0.05f);
+				ETC_ENFORCE_LT(std::fabs(height(b) - 1.5f), 0.05f);
+				ETC_ENFORCE_EQ(engine.stats().pairs, 3u);
+				ETC_ENFORCE_GTE(engine.stats().contacts, 8u);
+				ETC_ENFORCE_GT(performance.counter("cube.scene.physics.Engine.contacts"),
+				               contacts);
+			}
+		}
+
+		ETC_TEST_CASE(physics_fixed_step)
+		{
+			Engine engine;
+			node::Transform ball{"ball", at(0, 0, 0)};
+			engine.add_body(ball, Shape::sphere(1), 1);
+			float step = engine.config().timestep;
+
+			ETC_ENFORCE_EQ(engine.update(step / 2), 0u);
+			ETC_ENFORCE_EQ(height(ball), 0.0f);
+			ETC_ENFORCE_LT(std::fabs(engine.interpolation() - 0.5f), 1e-4f);
+			ETC_ENFORCE_EQ(engine.update(step / 2), 1u);
+			ETC_ENFORCE_LT(engine.interpolation(), 1e-3f);
+
+			// The node is interpolated between the last two steps.
+			ETC_ENFORCE_EQ(engine.update(step), 1u);
+			float h0 = height(ball);
+			ETC_ENFORCE_EQ(engine.update(step / 2), 0u);
+			float h1 = height(ball);
+			ETC_ENFORCE_LT(h1, h0);
+		}
+
+		ETC_TEST_CASE(physics_remove_body)
+		{
+			Engine engine;
+			node::Transform a{"a", at(0, 0, 0)}, b{"b", at(5, 0, 0)};
+			auto ha = engine.add_body(a, Shape::box({1, 1, 1}), 1);
+			auto hb = engine.add_body(b, Shape::box({1, 1, 1}), 1);
+			engine.update(0.1f);
+			engine.remove_body(ha);
+			ETC_ENFORCE(!engine.has_body(ha));
+			ETC_ENFORCE(engine.has_body(hb));
+			ETC_TEST_THROW_TYPE({ engine.remove_body(ha); }, Exception);
+			auto hc = engine.add_body(a, Shape::box({1, 1, 1}), 1);
+			ETC_ENFORCE_EQ(hc.index, ha.index);
+			ETC_ENFORCE(hc != ha);
+			float before = height(b);
+			engine.update(0.1f);
+			ETC_ENFORCE_LT(height(b), before);
+			ETC_ENFORCE_EQ(engine.bodies(), 2u);
+		}
+
+		ETC_BENCHMARK_CASE(physics_benchmark)
+		{
+			Engine::Config config;
+			auto broadphase = etc::sys::environ::get("CUBE_PHYSICS_BROADPHASE", "");
+			if (broadphase == "axis_sweep")
+				config.broadphase = Engine::Broadphase::axis_sweep;
+			else if (broadphase == "grid")
+				config.broadphase = Engine::Broadphase::grid;
+			Engine engine{config};
+			node::Transform ground{"ground", at(0, -1, 0)};
+			engine.add_body(ground, Shape::box({100, 1, 100}), 0);
+			// 20 x 20 columns of 25 boxes.
+			std::vector<std::unique_ptr<node::Transform>> boxes;
+			for (int x = 0; x < 20; ++x)
+				for (int z = 0; z < 20; ++z)
+					for (int y = 0; y < 25; ++y)
+					{
+						boxes.emplace_back(
+							new node::Transform{
+								"box",
+								at(x * 2.0f - 20, y * 1.0f + 0.5f, z * 2.0f - 20)
+							}
+						);
+						engine.add_body(*boxes.back(), Shape::box({.5f, .5f, .5f}), 1);
+					}
+			auto start = std::chrono::high_resolution_clock::now();
+			etc::size_type steps = 0;
+			for (int i = 0; i < 60; ++i)
+				steps += engine.update(engine.config().timestep);
+			auto end = std::chrono::high_resolution_clock::now();
+			ETC_LOG.info(
+				"Stepped", boxes.size(), "boxes", steps, "times with",
+				engine.threads(), "threads in",
+				std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(),
+				"ms"
+			);
+			// The stacks stand.
+			ETC_ENFORCE_GT(height(*boxes.back()), 20.0f);
+		}
+
+	} // !anonymous
+
 }}}
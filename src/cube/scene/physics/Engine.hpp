@@ -1,27 +1,162 @@
 #ifndef  CUBE_SCENE_PHYSICS_ENGINE_HPP
 # define CUBE_SCENE_PHYSICS_ENGINE_HPP
 
+# include "fwd.hpp"
+
+# include <cube/api.hpp>
 # include <cube/gl/vector.hpp>
+# include <cube/scene/Handle.hpp>
+# include <cube/scene/node/fwd.hpp>
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
 
 # include <memory>
 
 namespace cube { namespace scene { namespace physics {
 
-	class Engine
+	/// Collision shape of a body, centered on its origin.
+	struct CUBE_API Shape
 	{
-	private:
+		enum class Kind
+		{
+			box,
+			sphere,
+			capsule,
+		};
+
+		Kind              kind;
+		/// Half extents of a box, radius and half height (x, y) of a
+		/// capsule along the y axis, or radius (x) of a sphere.
+		gl::vector::vec3f extents;
+
+		static Shape box(gl::vector::vec3f const& half_extents);
+		static Shape sphere(float const radius);
+		static Shape capsule(float const radius, float const height);
+	};
+
+	/**
+	 * @brief Rigid body simulation.
+	 *
+	 * Bodies are attached to Transform nodes. The world is stepped at a fixed
+	 * timestep: update() accumulates the elapsed time and runs as many steps
+	 * as needed. Transforms of the bodies moved by these steps are then
+	 * written back to their nodes in one pass, interpolated between the last
+	 * two steps by the remaining accumulated time.
+	 *
+	 * The Transform of a body holds its world position and rotation: it
+	 * should not have a Transform ancestor, nor any scaling.
+	 *
+	 * Each step is profiled in the "cube.scene.physics.Engine.step" section
+	 * of cube::debug::Performance, split in broadphase, narrowphase and
+	 * solver sections. The overlapping pairs and contact points of every
+	 * step are added to the "cube.scene.physics.Engine.pairs" and
+	 * "cube.scene.physics.Engine.contacts" counters.
+	 */
+	class CUBE_API Engine
+	{
+	public:
+		/// Broad collision detection algorithms.
+		enum class Broadphase
+		{
+			/// Dynamic bounding volume trees, the default.
+			dbvt,
+			/// Sweep and prune on the three axis, bounded by the world
+			/// bounds.
+			axis_sweep,
+			/// Uniform grid, see GridBroadphase.
+			grid,
+		};
+
+		struct Config
+		{
+			/// Duration of a simulation step in seconds.
+			float          timestep;
+			/// Maximum steps run by one update(), the remaining time is
+			/// dropped.
+			etc::size_type max_steps;
+			/// Threads used by the collision dispatcher and the solver, 0
+			/// picks a value from the hardware.
+			etc::size_type threads;
+			Broadphase     broadphase;
+			/// Bounds of the axis sweep broadphase.
+			gl::vector::vec3f world_min;
+			gl::vector::vec3f world_max;
+			/// Cell size of the grid broadphase.
+			float          grid_cell_size;
+			/// Iterations of the constraint solver per step.
+			etc::size_type solver_iterations;
+
+			Config() ETC_NOEXCEPT;
+		};
+
+		/// Statistics of the last update().
+		struct Stats
+		{
+			/// Simulation steps run.
+			etc::size_type steps;
+			/// Transforms written back.
+			etc::size_type moved;
+			/// Overlapping pairs and contact points after the last step.
+			etc::size_type pairs;
+			etc::size_type contacts;
+		};
+
+	public:
 		struct Impl;
 
 	private:
 		std::unique_ptr<Impl> _this;
+		friend class ChunkCollider;
 
 	public:
-		Engine();
+		Engine(Config const& config = Config{});
 		~Engine();
 
 	public:
 		Engine& gravity(gl::vector::vec3f const& acceleration);
 		gl::vector::vec3f gravity() const ETC_NOEXCEPT;
+
+		Config const& config() const ETC_NOEXCEPT;
+
+		/// Worker threads really used, 1 when Bullet is not thread safe.
+		etc::size_type threads() const ETC_NOEXCEPT;
+
+	public:
+		/**
+		 * @brief Add a body attached to @a node.
+		 *
+		 * The body starts at the current value of @a node. A null @a mass
+		 * makes a static body. The node must outlive the body.
+		 */
+		Handle add_body(node::Transform& node,
+		                Shape const& shape,
+		                float const mass);
+
+		/// Remove a body, the node is left where it is.
+		void remove_body(Handle const body);
+
+		bool has_body(Handle const body) const ETC_NOEXCEPT;
+
+		/// Number of bodies.
+		etc::size_type bodies() const ETC_NOEXCEPT;
+
+		gl::vector::vec3f velocity(Handle const body) const;
+		void velocity(Handle const body, gl::vector::vec3f const& value);
+		void apply_impulse(Handle const body, gl::vector::vec3f const& impulse);
+
+	public:
+		/**
+		 * @brief Advance the simulation by @a elapsed seconds.
+		 *
+		 * @returns the number of steps run.
+		 */
+		etc::size_type update(float const elapsed);
+
+		/// Fraction of a step accumulated but not simulated yet.
+		float interpolation() const ETC_NOEXCEPT;
+
+		Stats const& stats() const ETC_NOEXCEPT;
 	};
 
 }}}
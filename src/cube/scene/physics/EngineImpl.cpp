@@ -1,23 +1,279 @@
 #include "EngineImpl.hpp"
+#include "GridBroadphase.hpp"
+
+#include <cube/debug.hpp>
+#include <cube/exception.hpp>
+#include <cube/scene/node/Transform.hpp>
+
+#include <etc/log.hpp>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
 
 namespace cube { namespace scene { namespace physics {
 
-	Engine::Impl::Impl()
-		: broadphase{new btDbvtBroadphase()}
-		, collision_configuration{new btDefaultCollisionConfiguration()}
-		, collision_dispatcher{new btCollisionDispatcher(collision_configuration.get())}
-		, constraint_solver{new btSequentialImpulseConstraintSolver}
-		, world{
-			new btDiscreteDynamicsWorld{
-				collision_dispatcher.get(),
-				broadphase.get(),
-				constraint_solver.get(),
-				collision_configuration.get(),
+	ETC_LOG_COMPONENT("cube.scene.physics.Engine");
+
+	using exception::Exception;
+
+	namespace {
+
+		etc::size_type default_threads()
+		{
+			etc::size_type count = std::thread::hardware_concurrency();
+			return std::max<etc::size_type>(1, count);
+		}
+
+# ifdef CUBE_SCENE_PHYSICS_THREADS
+		/// Bullet uses one global task scheduler.
+		btITaskScheduler& task_scheduler(etc::size_type const threads)
+		{
+			static btITaskScheduler* scheduler = nullptr;
+			if (scheduler == nullptr)
+			{
+				scheduler = btCreateDefaultTaskScheduler();
+				if (scheduler == nullptr)
+					scheduler = btGetSequentialTaskScheduler();
+				btSetTaskScheduler(scheduler);
+			}
+			int count = std::min<int>(
+				static_cast<int>(threads), scheduler->getMaxNumThreads()
+			);
+			if (count > scheduler->getNumThreads())
+				scheduler->setNumThreads(count);
+			return *scheduler;
+		}
+# endif
+
+		btBroadphaseInterface* make_broadphase(Engine::Config const& config)
+		{
+			switch (config.broadphase)
+			{
+			case Engine::Broadphase::dbvt:
+				return new btDbvtBroadphase;
+			case Engine::Broadphase::axis_sweep:
+				if (!(config.world_min.x < config.world_max.x &&
+				      config.world_min.y < config.world_max.y &&
+				      config.world_min.z < config.world_max.z))
+					throw Exception{"Invalid world bounds"};
+				return new bt32BitAxisSweep3{
+					btVector3{config.world_min.x, config.world_min.y, config.world_min.z},
+					btVector3{config.world_max.x, config.world_max.y, config.world_max.z},
+				};
+			case Engine::Broadphase::grid:
+				return new GridBroadphase{config.grid_cell_size};
 			}
+			throw Exception{"Unknown broadphase"};
 		}
-	{}
+
+		/// Profile the collision detection and the solver.
+		template<typename World>
+		struct Profiled
+			: public World
+		{
+			template<typename... Args>
+			Profiled(Args&&... args)
+				: World(std::forward<Args>(args)...)
+			{}
+
+			// Same as Bullet, split in sections.
+			void performDiscreteCollisionDetection() override
+			{
+				{
+					CUBE_DEBUG_PERFORMANCE_SECTION("cube.scene.physics.Engine.broadphase");
+					this->updateAabbs();
+					this->computeOverlappingPairs();
+				}
+				CUBE_DEBUG_PERFORMANCE_SECTION("cube.scene.physics.Engine.narrowphase");
+				btDispatcher* dispatcher = this->getDispatcher();
+				if (dispatcher != nullptr)
+					dispatcher->dispatchAllCollisionPairs(
+						this->getBroadphase()->getOverlappingPairCache(),
+						this->getDispatchInfo(),
+						dispatcher
+					);
+			}
+
+		protected:
+			void solveConstraints(btContactSolverInfo& info) override
+			{
+				CUBE_DEBUG_PERFORMANCE_SECTION("cube.scene.physics.Engine.solver");
+				World::solveConstraints(info);
+			}
+		};
+
+	} // !anonymous
+
+	Engine::Impl::Impl(Config const& config)
+		: config(config)
+		, threads{config.threads == 0 ? default_threads() : config.threads}
+		, broadphase{make_broadphase(config)}
+		, collision_configuration{new btDefaultCollisionConfiguration()}
+		, accumulator{0}
+		, stats{0, 0, 0, 0}
+	{
+# ifdef CUBE_SCENE_PHYSICS_THREADS
+		this->threads = task_scheduler(this->threads).getNumThreads();
+		this->collision_dispatcher.reset(
+			new btCollisionDispatcherMt(this->collision_configuration.get())
+		);
+		this->solver_pool.reset(
+			new btConstraintSolverPoolMt(static_cast<int>(this->threads))
+		);
+		this->constraint_solver.reset(new btSequentialImpulseConstraintSolverMt);
+		this->world.reset(
+			new Profiled<btDiscreteDynamicsWorldMt>{
+				this->collision_dispatcher.get(),
+				this->broadphase.get(),
+				this->solver_pool.get(),
+				this->constraint_solver.get(),
+				this->collision_configuration.get(),
+			}
+		);
+# else
+		this->threads = 1;
+		this->collision_dispatcher.reset(
+			new btCollisionDispatcher(this->collision_configuration.get())
+		);
+		this->constraint_solver.reset(new btSequentialImpulseConstraintSolver);
+		this->world.reset(
+			new Profiled<btDiscreteDynamicsWorld>{
+				this->collision_dispatcher.get(),
+				this->broadphase.get(),
+				this->constraint_solver.get(),
+				this->collision_configuration.get(),
+			}
+		);
+# endif
+		this->world->getSolverInfo().m_numIterations =
+			static_cast<int>(config.solver_iterations);
+		ETC_LOG.debug("Physics engine with", this->threads, "threads");
+	}
 
 	Engine::Impl::~Impl()
-	{}
+	{
+		for (auto& body: this->bodies)
+			if (body.body != nullptr)
+				this->world->removeRigidBody(body.body.get());
+	}
+
+	Engine::Impl::Body& Engine::Impl::body(Handle const handle)
+	{
+		if (handle.index >= this->bodies.size() ||
+		    this->bodies[handle.index].body == nullptr ||
+		    this->bodies[handle.index].generation != handle.generation)
+			throw Exception{"Invalid body handle"};
+		return this->bodies[handle.index];
+	}
+
+	Engine::Impl::Body const& Engine::Impl::body(Handle const handle) const
+	{ return const_cast<Impl*>(this)->body(handle); }
+
+	btCollisionShape& Engine::Impl::shape(Shape const& shape)
+	{
+		// Bodies with the same shape share it.
+		shape_key key{
+			static_cast<int>(shape.kind),
+			shape.extents.x, shape.extents.y, shape.extents.z
+		};
+		auto it = this->shapes.find(key);
+		if (it != this->shapes.end())
+			return *it->second;
+		btCollisionShape* res = nullptr;
+		switch (shape.kind)
+		{
+		case Shape::Kind::box:
+			res = new btBoxShape{
+				btVector3{shape.extents.x, shape.extents.y, shape.extents.z}
+			};
+			break;
+		case Shape::Kind::sphere:
+			res = new btSphereShape{shape.extents.x};
+			break;
+		case Shape::Kind::capsule:
+			res = new btCapsuleShape{shape.extents.x, 2 * shape.extents.y};
+			break;
+		default:
+			throw Exception{"Unknown shape kind"};
+		}
+		this->shapes.emplace(key, std::unique_ptr<btCollisionShape>{res});
+		return *res;
+	}
+
+	void Engine::Impl::step()
+	{
+		{
+			CUBE_DEBUG_PERFORMANCE_SECTION("cube.scene.physics.Engine.step");
+			// No sub steps: the accumulator is handled by the engine.
+			this->world->stepSimulation(this->config.timestep, 0);
+		}
+		this->stats.pairs = static_cast<etc::size_type>(
+			this->broadphase->getOverlappingPairCache()->getNumOverlappingPairs()
+		);
+		this->stats.contacts = 0;
+		int manifolds = this->collision_dispatcher->getNumManifolds();
+		for (int i = 0; i < manifolds; ++i)
+			this->stats.contacts += static_cast<etc::size_type>(
+				this->collision_dispatcher->getManifoldByIndexInternal(i)->getNumContacts()
+			);
+		CUBE_DEBUG_COUNTER("cube.scene.physics.Engine.pairs", this->stats.pairs);
+		CUBE_DEBUG_COUNTER("cube.scene.physics.Engine.contacts", this->stats.contacts);
+		// Bodies are read directly, motion states would cost a virtual
+		// call per body.
+		for (auto slot: this->dynamic)
+		{
+			Body& body = this->bodies[slot];
+			bool active = body.body->isActive();
+			if (!active && !body.awake)
+				continue;
+			body.previous = body.current;
+			body.current = body.body->getWorldTransform();
+			body.awake = active;
+			// A body falling asleep is written once more, at rest.
+			if (!active)
+				body.previous = body.current;
+			if (!this->moved_flags[slot])
+			{
+				this->moved_flags[slot] = 1;
+				this->moved.push_back(slot);
+			}
+		}
+	}
+
+	void Engine::Impl::write_back()
+	{
+		float const alpha = this->accumulator / this->config.timestep;
+		node::Transform::matrix_type matrix;
+		for (auto slot: this->moved)
+		{
+			Body& body = this->bodies[slot];
+			btTransform transform{
+				body.previous.getRotation().slerp(body.current.getRotation(), alpha),
+				body.previous.getOrigin().lerp(body.current.getOrigin(), alpha),
+			};
+			transform.getOpenGLMatrix(glm::value_ptr(matrix));
+			body.node->value(matrix);
+		}
+		this->stats.moved = this->moved.size();
+		// Awake bodies are interpolated again by the next update, even
+		// without any step.
+		this->moved.erase(
+			std::remove_if(
+				this->moved.begin(),
+				this->moved.end(),
+				[&] (Handle::index_type slot) {
+					if (this->bodies[slot].awake)
+						return false;
+					this->moved_flags[slot] = 0;
+					return true;
+				}
+			),
+			this->moved.end()
+		);
+		CUBE_DEBUG_COUNTER("cube.scene.physics.Engine.moved", this->stats.moved);
+	}
 
 }}}
@@ -5,18 +5,75 @@
 
 #include <btBulletDynamicsCommon.h>
 
+// The multithreaded world needs a Bullet built with BT_THREADSAFE.
+# if defined(BT_THREADSAFE) && BT_BULLET_VERSION >= 288
+#  define CUBE_SCENE_PHYSICS_THREADS 1
+#  include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#  include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#  include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#  include <LinearMath/btThreads.h>
+# endif
+
+# include <map>
+# include <tuple>
+# include <vector>
+
 namespace cube { namespace scene { namespace physics {
 
 	struct Engine::Impl
 	{
+		struct Body
+		{
+			std::unique_ptr<btRigidBody> body;
+			node::Transform*             node;
+			Handle::generation_type      generation;
+			/// Transforms after the last two steps.
+			btTransform                  previous;
+			btTransform                  current;
+			/// Moved during the last step.
+			bool                         awake;
+			/// Position in the dynamic list.
+			etc::size_type               dynamic_index;
+		};
+
+		typedef std::tuple<int, float, float, float> shape_key;
+
+		Config const config;
+		etc::size_type threads;
 		std::unique_ptr<btBroadphaseInterface> broadphase;
 		std::unique_ptr<btDefaultCollisionConfiguration> collision_configuration;
 		std::unique_ptr<btCollisionDispatcher> collision_dispatcher;
-		std::unique_ptr<btSequentialImpulseConstraintSolver> constraint_solver;
+# ifdef CUBE_SCENE_PHYSICS_THREADS
+		std::unique_ptr<btConstraintSolverPoolMt> solver_pool;
+# endif
+		std::unique_ptr<btConstraintSolver> constraint_solver;
 		std::unique_ptr<btDiscreteDynamicsWorld> world;
 
-		Impl();
+		std::map<shape_key, std::unique_ptr<btCollisionShape>> shapes;
+		std::vector<Body> bodies;
+		std::vector<Handle::index_type> free_slots;
+		/// Slots of the bodies with a mass.
+		std::vector<Handle::index_type> dynamic;
+		/// Slots of the bodies to write back.
+		std::vector<Handle::index_type> moved;
+		std::vector<uint8_t> moved_flags;
+		/// Static colliders updated before stepping.
+		std::vector<ChunkCollider*> colliders;
+		float accumulator;
+		Stats stats;
+
+		Impl(Config const& config);
 		~Impl();
+
+		Body& body(Handle const handle);
+		Body const& body(Handle const handle) const;
+		btCollisionShape& shape(Shape const& shape);
+
+		/// Run one fixed step and record the moved bodies.
+		void step();
+
+		/// Write back the moved bodies to their nodes.
+		void write_back();
 	};
 
 }}}
@@ -0,0 +1,304 @@
+#include "GridBroadphase.hpp"
+
+#include <cube/exception.hpp>
+
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace cube { namespace scene { namespace physics {
+
+	ETC_LOG_COMPONENT("cube.scene.physics.GridBroadphase");
+
+	using exception::Exception;
+
+	namespace {
+
+		// Cells coordinates are stored on 21 bits.
+		int32_t const cell_bias = 1 << 20;
+
+		inline
+		int32_t cell_of(btScalar const value, float const cell_size) ETC_NOEXCEPT
+		{
+			auto res = static_cast<int32_t>(std::floor(value / cell_size));
+			return std::min(std::max(res, -cell_bias), cell_bias - 1);
+		}
+
+		inline
+		uint64_t cell_key(int32_t const x,
+		                  int32_t const y,
+		                  int32_t const z) ETC_NOEXCEPT
+		{
+			return (static_cast<uint64_t>(x + cell_bias) << 42) |
+			       (static_cast<uint64_t>(y + cell_bias) << 21) |
+			       static_cast<uint64_t>(z + cell_bias);
+		}
+
+		inline
+		bool overlap(btBroadphaseProxy const& lhs,
+		             btBroadphaseProxy const& rhs) ETC_NOEXCEPT
+		{
+			return lhs.m_aabbMin.getX() <= rhs.m_aabbMax.getX() &&
+			       rhs.m_aabbMin.getX() <= lhs.m_aabbMax.getX() &&
+			       lhs.m_aabbMin.getY() <= rhs.m_aabbMax.getY() &&
+			       rhs.m_aabbMin.getY() <= lhs.m_aabbMax.getY() &&
+			       lhs.m_aabbMin.getZ() <= rhs.m_aabbMax.getZ() &&
+			       rhs.m_aabbMin.getZ() <= lhs.m_aabbMax.getZ();
+		}
+
+		/// Remove the pairs that do not overlap anymore.
+		struct RemoveSeparated
+			: public btOverlapCallback
+		{
+			bool processOverlap(btBroadphasePair& pair) override
+			{ return !overlap(*pair.m_pProxy0, *pair.m_pProxy1); }
+		};
+
+	} // !anonymous
+
+	GridBroadphase::GridBroadphase(float const cell_size)
+		: _cell_size{cell_size}
+		, _proxies{}
+		, _pairs{new btHashedOverlappingPairCache}
+		, _cells{}
+		, _large{}
+		, _next_id{1}
+	{
+		if (!(cell_size > 0))
+			throw Exception{"The grid cell size must be positive"};
+	}
+
+	GridBroadphase::~GridBroadphase()
+	{}
+
+	btBroadphaseProxy*
+	GridBroadphase::createProxy(btVector3 const& aabb_min,
+	                            btVector3 const& aabb_max,
+	                            int,
+	                            void* user_pointer,
+	                            filter_type group,
+	                            filter_type mask,
+	                            btDispatcher*
+# if BT_BULLET_VERSION < 287
+	                            , void*
+# endif
+	                            )
+	{
+		std::unique_ptr<Proxy> proxy{new Proxy};
+		proxy->m_clientObject = user_pointer;
+		proxy->m_collisionFilterGroup = group;
+		proxy->m_collisionFilterMask = mask;
+		proxy->m_aabbMin = aabb_min;
+		proxy->m_aabbMax = aabb_max;
+		proxy->m_uniqueId = _next_id++;
+		proxy->index = static_cast<uint32_t>(_proxies.size());
+		_proxies.push_back(std::move(proxy));
+		return _proxies.back().get();
+	}
+
+	void GridBroadphase::destroyProxy(btBroadphaseProxy* proxy_,
+	                                  btDispatcher* dispatcher)
+	{
+		Proxy* proxy = static_cast<Proxy*>(proxy_);
+		_pairs->removeOverlappingPairsContainingProxy(proxy, dispatcher);
+		uint32_t index = proxy->index;
+		std::swap(_proxies[index], _proxies.back());
+		_proxies[index]->index = index;
+		_proxies.pop_back();
+	}
+
+	void GridBroadphase::setAabb(btBroadphaseProxy* proxy,
+	                             btVector3 const& aabb_min,
+	                             btVector3 const& aabb_max,
+	                             btDispatcher*)
+	{
+		proxy->m_aabbMin = aabb_min;
+		proxy->m_aabbMax = aabb_max;
+	}
+
+	void GridBroadphase::getAabb(btBroadphaseProxy* proxy,
+	                             btVector3& aabb_min,
+	                             btVector3& aabb_max) const
+	{
+		aabb_min = proxy->m_aabbMin;
+		aabb_max = proxy->m_aabbMax;
+	}
+
+	void GridBroadphase::rayTest(btVector3 const&,
+	                             btVector3 const&,
+	                             btBroadphaseRayCallback& callback,
+	                             btVector3 const&,
+	                             btVector3 const&)
+	{
+		for (auto& proxy: _proxies)
+			callback.process(proxy.get());
+	}
+
+	void GridBroadphase::aabbTest(btVector3 const& aabb_min,
+	                              btVector3 const& aabb_max,
+	                              btBroadphaseAabbCallback& callback)
+	{
+		btBroadphaseProxy box;
+		box.m_aabbMin = aabb_min;
+		box.m_aabbMax = aabb_max;
+		for (auto& proxy: _proxies)
+			if (overlap(box, *proxy))
+				callback.process(proxy.get());
+	}
+
+	void GridBroadphase::calculateOverlappingPairs(btDispatcher* dispatcher)
+	{
+		float const size = _cell_size;
+		_cells.clear();
+		_large.clear();
+		for (auto& proxy_: _proxies)
+		{
+			Proxy& proxy = *proxy_;
+			int32_t min[3] = {
+				cell_of(proxy.m_aabbMin.getX(), size),
+				cell_of(proxy.m_aabbMin.getY(), size),
+				cell_of(proxy.m_aabbMin.getZ(), size),
+			};
+			int32_t max[3] = {
+				cell_of(proxy.m_aabbMax.getX(), size),
+				cell_of(proxy.m_aabbMax.getY(), size),
+				cell_of(proxy.m_aabbMax.getZ(), size),
+			};
+			std::copy(min, min + 3, proxy.cell);
+			uint64_t cells = uint64_t(max[0] - min[0] + 1) *
+			                 uint64_t(max[1] - min[1] + 1) *
+			                 uint64_t(max[2] - min[2] + 1);
+			if (cells > max_proxy_cells)
+			{
+				_large.push_back(proxy.index);
+				continue;
+			}
+			for (int32_t x = min[0]; x <= max[0]; ++x)
+				for (int32_t y = min[1]; y <= max[1]; ++y)
+					for (int32_t z = min[2]; z <= max[2]; ++z)
+						_cells.emplace_back(cell_key(x, y, z), proxy.index);
+		}
+		std::sort(_cells.begin(), _cells.end());
+
+		for (auto begin = _cells.begin(), end = _cells.end(); begin != end;)
+		{
+			auto last = begin;
+			while (last != end && last->first == begin->first)
+				++last;
+			for (auto it = begin; it != last; ++it)
+			{
+				Proxy* lhs = _proxies[it->second].get();
+				for (auto other = std::next(it); other != last; ++other)
+				{
+					Proxy* rhs = _proxies[other->second].get();
+					if (!overlap(*lhs, *rhs))
+						continue;
+					// Only report the pair in the first cell both cover.
+					uint64_t first = cell_key(
+						std::max(lhs->cell[0], rhs->cell[0]),
+						std::max(lhs->cell[1], rhs->cell[1]),
+						std::max(lhs->cell[2], rhs->cell[2])
+					);
+					if (first == begin->first)
+						_pairs->addOverlappingPair(lhs, rhs);
+				}
+			}
+			begin = last;
+		}
+
+		for (auto index: _large)
+		{
+			Proxy* lhs = _proxies[index].get();
+			for (auto& rhs: _proxies)
+			{
+				if (rhs.get() == lhs || !overlap(*lhs, *rhs))
+					continue;
+				// Pairs of large proxies are found twice.
+				if (rhs->index < index &&
+				    std::find(_large.begin(), _large.end(), rhs->index) != _large.end())
+					continue;
+				_pairs->addOverlappingPair(lhs, rhs.get());
+			}
+		}
+
+		RemoveSeparated remove;
+		_pairs->processAllOverlappingPairs(&remove, dispatcher);
+	}
+
+	btOverlappingPairCache* GridBroadphase::getOverlappingPairCache()
+	{ return _pairs.get(); }
+
+	btOverlappingPairCache const* GridBroadphase::getOverlappingPairCache() const
+	{ return _pairs.get(); }
+
+	void GridBroadphase::getBroadphaseAabb(btVector3& aabb_min,
+	                                       btVector3& aabb_max) const
+	{
+		aabb_min.setValue(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+		aabb_max.setValue(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+	}
+
+	void GridBroadphase::printStats()
+	{
+		ETC_LOG.info("Grid of", _cell_size, "units with", _proxies.size(),
+		             "proxies,", _large.size(), "large, in", _cells.size(),
+		             "bins and", _pairs->getNumOverlappingPairs(), "pairs");
+	}
+
+	namespace {
+
+		btBroadphaseProxy* add(GridBroadphase& grid,
+		                       btVector3 const& min,
+		                       btVector3 const& max)
+		{
+			return grid.createProxy(
+				min, max, 0, nullptr,
+				btBroadphaseProxy::DefaultFilter,
+				btBroadphaseProxy::AllFilter,
+				nullptr
+# if BT_BULLET_VERSION < 287
+				, nullptr
+# endif
+			);
+		}
+
+		ETC_TEST_CASE(grid_broadphase_pairs)
+		{
+			GridBroadphase grid{4};
+			auto a = add(grid, {0, 0, 0}, {1, 1, 1});
+			auto b = add(grid, {0.5f, 0, 0.5f}, {5, 5, 5});
+			auto c = add(grid, {10, 10, 10}, {11, 11, 11});
+			// A ground covering far more cells than allowed.
+			add(grid, {-1000, -1, -1000}, {1000, 0, 1000});
+			grid.calculateOverlappingPairs(nullptr);
+			auto pairs = grid.getOverlappingPairCache();
+			// a-b, a-ground and b-ground, each reported once.
+			ETC_ENFORCE_EQ(pairs->getNumOverlappingPairs(), 3);
+			ETC_ENFORCE(pairs->findPair(a, b) != nullptr);
+			ETC_ENFORCE(pairs->findPair(a, c) == nullptr);
+
+			grid.setAabb(b, {20, 20, 20}, {21, 21, 21}, nullptr);
+			grid.setAabb(c, {20, 20, 20}, {22, 22, 22}, nullptr);
+			grid.calculateOverlappingPairs(nullptr);
+			ETC_ENFORCE_EQ(pairs->getNumOverlappingPairs(), 2);
+			ETC_ENFORCE(pairs->findPair(b, c) != nullptr);
+
+			grid.destroyProxy(b, nullptr);
+			ETC_ENFORCE_EQ(pairs->getNumOverlappingPairs(), 1);
+		}
+
+		ETC_TEST_CASE(grid_broadphase_negative_cells)
+		{
+			GridBroadphase grid{1};
+			auto a = add(grid, {-2.5f, -2.5f, -2.5f}, {-0.5f, -0.5f, -0.5f});
+			auto b = add(grid, {-1, -1, -1}, {0.5f, 0.5f, 0.5f});
+			grid.calculateOverlappingPairs(nullptr);
+			ETC_ENFORCE_EQ(grid.getOverlappingPairCache()->getNumOverlappingPairs(), 1);
+			ETC_ENFORCE(grid.getOverlappingPairCache()->findPair(a, b) != nullptr);
+		}
+
+	} // !anonymous
+
+}}}
@@ -0,0 +1,107 @@
+#ifndef  CUBE_SCENE_PHYSICS_GRIDBROADPHASE_HPP
+# define CUBE_SCENE_PHYSICS_GRIDBROADPHASE_HPP
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+#include <btBulletDynamicsCommon.h>
+
+# include <cstdint>
+# include <memory>
+# include <utility>
+# include <vector>
+
+namespace cube { namespace scene { namespace physics {
+
+	/**
+	 * @brief Broadphase over a uniform grid.
+	 *
+	 * Proxies are binned every step in the cells their bounding box covers,
+	 * and pairs are searched in each cell. Cells are not stored: the bins
+	 * are sorted by cell, so the cost only depends on the number of
+	 * proxies, wherever they are in the world.
+	 *
+	 * Using a divisor of the chunk size for the cells keeps the shapes of
+	 * the world chunks aligned on them. Proxies covering too many cells,
+	 * like a large ground, are tested against all the others.
+	 */
+	class GridBroadphase
+		: public btBroadphaseInterface
+	{
+	public:
+# if BT_BULLET_VERSION >= 287
+		typedef int filter_type;
+# else
+		typedef short int filter_type;
+# endif
+
+		struct Proxy
+			: public btBroadphaseProxy
+		{
+			/// Position in the proxy list.
+			uint32_t index;
+			/// First cell covered during the last step.
+			int32_t  cell[3];
+		};
+
+		/// Proxies covering more cells are tested against all the others.
+		static etc::size_type const max_proxy_cells = 512;
+
+	private:
+		float const                                   _cell_size;
+		std::vector<std::unique_ptr<Proxy>>           _proxies;
+		std::unique_ptr<btOverlappingPairCache>       _pairs;
+		/// Cell key and proxy index, sorted by cell.
+		std::vector<std::pair<uint64_t, uint32_t>>    _cells;
+		std::vector<uint32_t>                         _large;
+		int                                           _next_id;
+
+	public:
+		explicit
+		GridBroadphase(float const cell_size);
+		~GridBroadphase();
+
+		float cell_size() const ETC_NOEXCEPT
+		{ return _cell_size; }
+
+	public:
+		btBroadphaseProxy* createProxy(btVector3 const& aabb_min,
+		                               btVector3 const& aabb_max,
+		                               int shape_type,
+		                               void* user_pointer,
+		                               filter_type group,
+		                               filter_type mask,
+		                               btDispatcher* dispatcher
+# if BT_BULLET_VERSION < 287
+		                               , void* multi_sap_proxy
+# endif
+		                               ) override;
+		void destroyProxy(btBroadphaseProxy* proxy,
+		                  btDispatcher* dispatcher) override;
+		void setAabb(btBroadphaseProxy* proxy,
+		             btVector3 const& aabb_min,
+		             btVector3 const& aabb_max,
+		             btDispatcher* dispatcher) override;
+		void getAabb(btBroadphaseProxy* proxy,
+		             btVector3& aabb_min,
+		             btVector3& aabb_max) const override;
+		/// Rays and boxes are checked against every proxy.
+		void rayTest(btVector3 const& from,
+		             btVector3 const& to,
+		             btBroadphaseRayCallback& callback,
+		             btVector3 const& aabb_min = btVector3(0, 0, 0),
+		             btVector3 const& aabb_max = btVector3(0, 0, 0)) override;
+		void aabbTest(btVector3 const& aabb_min,
+		              btVector3 const& aabb_max,
+		              btBroadphaseAabbCallback& callback) override;
+		void calculateOverlappingPairs(btDispatcher* dispatcher) override;
+		btOverlappingPairCache* getOverlappingPairCache() override;
+		btOverlappingPairCache const* getOverlappingPairCache() const override;
+		void getBroadphaseAabb(btVector3& aabb_min,
+		                       btVector3& aabb_max) const override;
+		void printStats() override;
+	};
+
+}}}
+
+#endif
@@ -3,7 +3,9 @@
 
 namespace cube { namespace scene { namespace physics {
 
+	class ChunkCollider;
 	class Engine;
+	struct Shape;
 
 }}}
 
@@ -3,9 +3,10 @@
 
 # include <cube/scene/GraphImpl.hpp>
 
-# include <boost/graph/breadth_first_search.hpp>
 # include <boost/concept/assert.hpp>
 
+# include <vector>
+
 namespace cube { namespace scene { namespace visit {
 
 	namespace detail {
@@ -20,43 +21,10 @@ namespace cube { namespace scene { namespace visit {
 				_visitor.discover_vertex(*node);
 				_visitor.examine_vertex(*node);
 				_visitor.finish_vertex(*node);
-				//vis.examine_edge(e, g);
-				//vis.tree_edge(e, g);
-				//vis.non_tree_edge(e, g);
-				//vis.gray_target(e, g);
-				//vis.black_target(e, g);
 			}
 			Visitor _visitor;
 		};
 
-		template<typename Visitor>
-		struct BreadthFirstVisitorWrapper
-			: public boost::default_bfs_visitor
-		{
-			typedef boost::default_bfs_visitor super_type;
-			Visitor& _visitor;
-			Graph& _graph;
-			BreadthFirstVisitorWrapper(Graph& graph, Visitor& visitor)
-				: _visitor(visitor)
-				, _graph(graph)
-			{}
-			BreadthFirstVisitorWrapper(BreadthFirstVisitorWrapper const& other)
-				: super_type(other)
-				, _visitor(other._visitor)
-				, _graph(other._graph)
-			{}
-# define _CUBE_SCENE_VISIT_BFS_FORWARD(__name)                                \
-			template<typename V, typename G>                                  \
-			inline void __name ## _vertex(V vertex, G const&)                 \
-			{ _visitor.__name ## _vertex(*_graph.impl().vertex_node_map[vertex]); }\
-/**/
-			_CUBE_SCENE_VISIT_BFS_FORWARD(discover);
-			_CUBE_SCENE_VISIT_BFS_FORWARD(initialize);
-			_CUBE_SCENE_VISIT_BFS_FORWARD(examine);
-			_CUBE_SCENE_VISIT_BFS_FORWARD(finish);
-# undef _CUBE_SCENE_VISIT_BFS_FORWARD
-		};
-
 	} // !detail
 
 	struct DefaultBreadthFirstVisitor
@@ -71,15 +39,32 @@ namespace cube { namespace scene { namespace visit {
 	void breadth_first_search(Graph& graph, Visitor&& v)
 	{
 		BOOST_CONCEPT_ASSERT(( detail::BreadthFirstVisitorConcept<Visitor> ));
-		detail::BreadthFirstVisitorWrapper<Visitor> wrapped(graph, v);
+		typedef Graph::Impl impl_type;
+		auto& impl = graph.impl();
+		for (impl_type::index_type i = 0; i < impl.capacity(); ++i)
+			if (impl.nodes[i] != nullptr)
+				v.initialize_vertex(*impl.nodes[i]);
 
-		boost::breadth_first_search(
-			graph.impl().graph,
-			graph.impl().nodes.at(&graph.root()),
-			boost::visitor(wrapped)
-				.vertex_index_map(graph.impl().vertex_index_map)
-				.color_map(graph.impl().vertex_color_map)
-		);
+		// The queue is a plain vector, nodes are appended as they are
+		// discovered and examined in order.
+		std::vector<impl_type::index_type> queue;
+		queue.reserve(impl.size);
+		auto const root = graph.root().handle().index;
+		v.discover_vertex(*impl.nodes[root]);
+		queue.push_back(root);
+		for (size_t head = 0; head < queue.size(); ++head)
+		{
+			auto const idx = queue[head];
+			v.examine_vertex(*impl.nodes[idx]);
+			for (auto child = impl.first_children[idx];
+			     child != impl_type::none;
+			     child = impl.next_siblings[child])
+			{
+				v.discover_vertex(*impl.nodes[child]);
+				queue.push_back(child);
+			}
+			v.finish_vertex(*impl.nodes[idx]);
+		}
 	}
 
 }}}
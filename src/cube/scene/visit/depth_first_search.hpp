@@ -3,9 +3,11 @@
 
 # include <cube/scene/GraphImpl.hpp>
 
-# include <boost/graph/depth_first_search.hpp>
 # include <boost/concept/assert.hpp>
 
+# include <utility>
+# include <vector>
+
 namespace cube { namespace scene { namespace visit {
 
 	namespace detail {
@@ -15,34 +17,35 @@ namespace cube { namespace scene { namespace visit {
 		{
 		};
 
+		typedef std::vector<
+			std::pair<Graph::Impl::index_type, Graph::Impl::index_type>
+		> dfs_stack_type;
+
 		template<typename Visitor>
-		struct DepthFirstVisitorWrapper
-			: public boost::default_dfs_visitor
+		void depth_first_visit(Graph::Impl& impl,
+		                       Graph::Impl::index_type const start,
+		                       Visitor& v,
+		                       dfs_stack_type& stack)
 		{
-			typedef boost::default_dfs_visitor super_type;
-			Visitor& _visitor;
-			Graph& _graph;
-			DepthFirstVisitorWrapper(Graph& graph, Visitor& visitor)
-				: _visitor(visitor)
-				, _graph(graph)
-			{}
+			// Every discovered node is stacked with its next child to visit.
+			v.discover_vertex(*impl.nodes[start]);
+			stack.emplace_back(start, impl.first_children[start]);
+			while (!stack.empty())
+			{
+				auto& top = stack.back();
+				auto const child = top.second;
+				if (child == Graph::Impl::none)
+				{
+					v.finish_vertex(*impl.nodes[top.first]);
+					stack.pop_back();
+					continue;
+				}
+				top.second = impl.next_siblings[child];
+				v.discover_vertex(*impl.nodes[child]);
+				stack.emplace_back(child, impl.first_children[child]);
+			}
+		}
 
-			DepthFirstVisitorWrapper(DepthFirstVisitorWrapper const& other)
-				: super_type(other)
-				, _visitor(other._visitor)
-				, _graph(other._graph)
-			{}
-# define _CUBE_SCENE_VISIT_DFS_FORWARD(__name)                                \
-			template<typename V, typename G>                                  \
-			inline void __name ## _vertex(V vertex, G const&)                 \
-			{ _visitor.__name ## _vertex(*_graph.impl().vertex_node_map[vertex]); }\
-/**/
-			_CUBE_SCENE_VISIT_DFS_FORWARD(discover);
-			_CUBE_SCENE_VISIT_DFS_FORWARD(initialize);
-			//_CUBE_SCENE_VISIT_DFS_FORWARD(examine);
-			_CUBE_SCENE_VISIT_DFS_FORWARD(finish);
-# undef _CUBE_SCENE_VISIT_DFS_FORWARD
-		};
 	}
 
 	struct DefaultDepthFirstVisitor
@@ -57,14 +60,18 @@ namespace cube { namespace scene { namespace visit {
 	void depth_first_search(Graph& graph, Visitor&& v)
 	{
 		BOOST_CONCEPT_ASSERT(( detail::DepthFirstSearchVisitorConcept<Visitor> ));
-		auto& graph_impl = graph.impl().graph;
-		detail::DepthFirstVisitorWrapper<Visitor> wrapped(graph, v);
-		boost::depth_first_search(
-			graph_impl,
-			boost::visitor(wrapped)
-				.root_vertex(graph.impl().nodes.at(&graph.root()))
-				.color_map(graph.impl().vertex_color_map)
-		);
+		auto& impl = graph.impl();
+		for (Graph::Impl::index_type i = 0; i < impl.capacity(); ++i)
+			if (impl.nodes[i] != nullptr)
+				v.initialize_vertex(*impl.nodes[i]);
+		detail::dfs_stack_type stack;
+		auto const root = graph.root().handle().index;
+		detail::depth_first_visit(impl, root, v, stack);
+		// Then the trees without parent, in memory order.
+		for (Graph::Impl::index_type i = 0; i < impl.capacity(); ++i)
+			if (i != root && impl.nodes[i] != nullptr &&
+			    impl.parents[i] == Graph::Impl::none)
+				detail::depth_first_visit(impl, i, v, stack);
 	}
 
 }}}
@@ -1,7 +1,9 @@
 #include "tree.hpp"
 
 #include <cube/debug.hpp>
+#include <cube/gl/bounds.hpp>
 #include <cube/gl/frustum.hpp>
+#include <cube/gl/occlusion.hpp>
 #include <cube/gl/sphere.hpp>
 
 #include <etc/log.hpp>
@@ -21,12 +23,14 @@ namespace cubeapp { namespace world { namespace tree {
 	std::vector<Node<size_type>>
 	find_nodes(Tree<size_type> const& tree,
 	           cube::gl::vector::Vector3d const& pos,
-	           cube::gl::frustum::Frustumd const& frustum) ETC_NOEXCEPT
+	           cube::gl::frustum::Frustumd const& frustum,
+	           cube::gl::occlusion::Culler const* occlusion) ETC_NOEXCEPT
 	{
 		CUBE_DEBUG_PERFORMANCE_SECTION("app.WorldTree");
 		std::vector<Node<size_type>> res;
 		typedef typename Tree<size_type>::vector_type vector_type;
 		etc::size_type i = 0;
+		etc::size_type occluded = 0;
 		tree.visit(
 			[&] (unsigned int level,
 			     vector_type const& origin,
@@ -48,6 +52,23 @@ namespace cubeapp { namespace world { namespace tree {
 				};
 				if (!frustum.intersects(s))
 					return VisitorAction::stop;
+				if (occlusion != nullptr)
+				{
+					cube::gl::vector::Vector3d min{
+						origin.x - pos.x, origin.y - pos.y, origin.z - pos.z
+					};
+					cube::gl::bounds::AABBf box{
+						cube::gl::vector::vec3f(min),
+						cube::gl::vector::vec3f(
+							min + cube::gl::vector::Vector3d(size)
+						)
+					};
+					if (!occlusion->visible(box))
+					{
+						occluded += 1;
+						return VisitorAction::stop;
+					}
+				}
 				if (s.radius * 2 < glm::length(s.center))
 				{
 					if (level < 9)
@@ -64,7 +85,8 @@ namespace cubeapp { namespace world { namespace tree {
 			ETC_LOG.warn("Some nodes are ignored (too much iterations)");
 		if (res.size() >= MAX_NODES)
 			ETC_LOG.warn("Some nodes are ignored (too much results)");
-		ETC_LOG.debug("Found", res.size(), "nodes in", i, "iterations");
+		ETC_LOG.debug("Found", res.size(), "nodes in", i, "iterations,",
+		              occluded, "occluded");
 		return res;
 	}
 
@@ -100,7 +122,8 @@ namespace cubeapp { namespace world { namespace tree {
 	CUBEAPP_API std::vector<Node<int64_t>>
 	find_nodes(Tree<int64_t> const& tree,
 	           cube::gl::vector::Vector3d const& pos,
-	           cube::gl::frustum::Frustumd const& frustum) ETC_NOEXCEPT;
+	           cube::gl::frustum::Frustumd const& frustum,
+	           cube::gl::occlusion::Culler const* occlusion) ETC_NOEXCEPT;
 
 	template
 	CUBEAPP_API
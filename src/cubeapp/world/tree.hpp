@@ -149,12 +149,20 @@ namespace cubeapp { namespace world { namespace tree {
 		{ return this->size == other.size && other.origin == this->origin; }
 	};
 
+	/**
+	 * @brief Find the nodes to draw around @a pos.
+	 *
+	 * When @a occlusion is given, nodes hidden in its depth buffer are
+	 * skipped with their children. Its view projection matrix must be
+	 * relative to @a pos.
+	 */
 	template<typename size_type>
 	CUBEAPP_API
 	std::vector<Node<size_type>>
 	find_nodes(Tree<size_type> const& tree,
 	           cube::gl::vector::Vector3d const& pos,
-	           cube::gl::frustum::Frustumd const& frustum) ETC_NOEXCEPT;
+	           cube::gl::frustum::Frustumd const& frustum,
+	           cube::gl::occlusion::Culler const* occlusion = nullptr) ETC_NOEXCEPT;
 
 	template<typename size_type>
 	CUBEAPP_API
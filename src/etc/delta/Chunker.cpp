@@ -0,0 +1,155 @@
+#include "Chunker.hpp"
+#include "Sha256.hpp"
+
+#include <etc/exception.hpp>
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace etc { namespace delta {
+
+	using exception::Exception;
+
+	namespace {
+
+		// Random values for every byte, they must never change as the
+		// manifests of the releases depend on them.
+		struct Gear
+		{
+			uint64_t values[256];
+
+			Gear()
+			{
+				uint64_t seed = 0x8c0be8c0be8c0be8ull;
+				for (auto& value: values)
+				{
+					// splitmix64
+					uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+					z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+					z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+					value = z ^ (z >> 31);
+				}
+			}
+		};
+
+		Gear const gear;
+
+		// Bits of the hash depend on the last 64 bytes for the highest ones,
+		// masks use them first.
+		uint64_t high_mask(unsigned const bits)
+		{ return bits == 0 ? 0 : ~uint64_t(0) << (64 - bits); }
+
+	} // !anonymous
+
+	Chunker::Chunker(size_t const min_size,
+	                 size_t const average_size,
+	                 size_t const max_size)
+		: _min_size{min_size}
+		, _average_size{average_size}
+		, _max_size{max_size}
+	{
+		if (min_size == 0 || min_size > average_size || average_size > max_size)
+			throw Exception{"Invalid chunk sizes"};
+		unsigned bits = 0;
+		while ((size_t(1) << bits) < average_size)
+			bits += 1;
+		if ((size_t(1) << bits) != average_size)
+			throw Exception{"The average chunk size must be a power of two"};
+		_small_mask = high_mask(std::min(bits + 2, 64u));
+		_large_mask = high_mask(bits > 2 ? bits - 2 : 0);
+	}
+
+	size_t Chunker::cut(char const* data, size_t const size) const
+	{
+		if (size <= _min_size)
+			return size;
+		auto bytes = reinterpret_cast<unsigned char const*>(data);
+		size_t const end = std::min(size, _max_size);
+		size_t const normal = std::min(end, _average_size);
+		uint64_t hash = 0;
+		size_t i = _min_size;
+		for (; i < normal; ++i)
+		{
+			hash = (hash << 1) + gear.values[bytes[i]];
+			if (!(hash & _small_mask))
+				return i + 1;
+		}
+		for (; i < end; ++i)
+		{
+			hash = (hash << 1) + gear.values[bytes[i]];
+			if (!(hash & _large_mask))
+				return i + 1;
+		}
+		return end;
+	}
+
+	namespace {
+
+		std::string random_data(size_t const size, uint32_t seed)
+		{
+			std::string res(size, '\0');
+			for (auto& c: res)
+			{
+				seed = seed * 1664525 + 1013904223;
+				c = static_cast<char>(seed >> 24);
+			}
+			return res;
+		}
+
+		std::vector<std::string> chunk_digests(Chunker const& chunker,
+		                                       std::string const& data)
+		{
+			std::vector<std::string> res;
+			for (size_t pos = 0; pos < data.size();)
+			{
+				size_t const size = chunker.cut(data.data() + pos, data.size() - pos);
+				res.push_back(Sha256::digest(data.data() + pos, size));
+				pos += size;
+			}
+			return res;
+		}
+
+		ETC_TEST_CASE(sizes)
+		{
+			Chunker chunker;
+			std::string const data = random_data(4 * 1024 * 1024, 42);
+			size_t count = 0;
+			for (size_t pos = 0; pos < data.size(); count += 1)
+			{
+				size_t const size = chunker.cut(data.data() + pos, data.size() - pos);
+				pos += size;
+				ETC_ENFORCE_LTE(size, chunker.max_size());
+				if (pos < data.size())
+					ETC_ENFORCE_GTE(size, chunker.min_size());
+			}
+			// About the average size.
+			ETC_ENFORCE_GTE(count, 32u);
+			ETC_ENFORCE_LTE(count, 128u);
+			ETC_TEST_THROW_TYPE({ Chunker(1024, 3000, 8192); }, Exception);
+			ETC_TEST_THROW_TYPE({ Chunker(4096, 2048, 8192); }, Exception);
+		}
+
+		ETC_TEST_CASE(insertion)
+		{
+			Chunker chunker;
+			std::string const data = random_data(4 * 1024 * 1024, 7);
+			std::string edited = data;
+			edited.insert(1234567, "inserted bytes");
+			edited.erase(3000000, 100);
+			auto const before = chunk_digests(chunker, data);
+			auto const after = chunk_digests(chunker, edited);
+			std::set<std::string> known(before.begin(), before.end());
+			size_t changed = 0;
+			for (auto const& digest: after)
+				if (!known.count(digest))
+					changed += 1;
+			// Only the chunks around each edit are new.
+			ETC_ENFORCE_LTE(changed, 4u);
+		}
+
+	} // !anonymous
+
+}}
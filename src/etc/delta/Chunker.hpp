@@ -0,0 +1,51 @@
+#ifndef  ETC_DELTA_CHUNKER_HPP
+# define ETC_DELTA_CHUNKER_HPP
+
+# include <etc/api.hpp>
+# include <etc/compiler.hpp>
+
+# include <cstddef>
+# include <cstdint>
+
+namespace etc { namespace delta {
+
+	/**
+	 * @brief Content defined chunking, with a gear rolling hash.
+	 *
+	 * Chunk boundaries depend on the last bytes read only, so that inserting
+	 * or removing bytes changes the chunks around the edit, not the later
+	 * ones. Boundaries are harder to find before the average size and easier
+	 * after it, which keeps most chunks close to the average (FastCDC).
+	 */
+	class ETC_API Chunker
+	{
+	private:
+		size_t   _min_size;
+		size_t   _average_size;
+		size_t   _max_size;
+		uint64_t _small_mask;
+		uint64_t _large_mask;
+
+	public:
+		/// The average size is a power of two between the other sizes.
+		Chunker(size_t const min_size = 16 * 1024,
+		        size_t const average_size = 64 * 1024,
+		        size_t const max_size = 256 * 1024);
+
+	public:
+		/**
+		 * @brief Size of the chunk starting at @a data.
+		 *
+		 * At least max_size() bytes must be available, unless @a size bytes
+		 * are all that is left.
+		 */
+		size_t cut(char const* data, size_t const size) const;
+
+		size_t min_size() const ETC_NOEXCEPT { return _min_size; }
+		size_t average_size() const ETC_NOEXCEPT { return _average_size; }
+		size_t max_size() const ETC_NOEXCEPT { return _max_size; }
+	};
+
+}}
+
+#endif
@@ -0,0 +1,290 @@
+#include "Manifest.hpp"
+#include "Sha256.hpp"
+
+#include <etc/exception.hpp>
+#include <etc/log.hpp>
+#include <etc/scope_exit.hpp>
+#include <etc/temp/default_directory.hpp>
+#include <etc/test.hpp>
+
+#include <wrappers/boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+namespace etc { namespace delta {
+
+	ETC_LOG_COMPONENT("etc.delta.Manifest");
+
+	using exception::Exception;
+
+	namespace {
+
+		char const* const magic = "8cube-manifest 1";
+
+		Manifest::File hash_file(fs::path const& path,
+		                         std::string relative_path,
+		                         Chunker const& chunker)
+		{
+			Manifest::File res;
+			res.path = std::move(relative_path);
+			res.size = 0;
+			std::ifstream in{path.string(), std::ios::in | std::ios::binary};
+			if (!in)
+				throw Exception{"Couldn't open " + path.string()};
+			Sha256 file_hasher;
+			// Chunks are cut with at least max_size() bytes buffered, unless
+			// the end of the file is reached.
+			std::vector<char> buffer(4 * chunker.max_size());
+			size_t begin = 0;
+			size_t end = 0;
+			bool eof = false;
+			while (true)
+			{
+				if (!eof && end - begin < chunker.max_size())
+				{
+					std::memmove(&buffer[0], &buffer[begin], end - begin);
+					end -= begin;
+					begin = 0;
+					in.read(&buffer[end], buffer.size() - end);
+					file_hasher.update(&buffer[end], in.gcount());
+					end += in.gcount();
+					eof = !in;
+				}
+				if (begin == end)
+					break;
+				size_t const size = chunker.cut(&buffer[begin], end - begin);
+				res.chunks.push_back(
+					Manifest::Chunk{size, Sha256::digest(&buffer[begin], size)}
+				);
+				res.size += size;
+				begin += size;
+			}
+			res.digest = file_hasher.finish();
+			res.executable =
+				(fs::status(path).permissions() & fs::owner_exe) != 0;
+			return res;
+		}
+
+		bool is_digest(std::string const& str)
+		{
+			return str.size() == 64 && std::all_of(
+				str.begin(), str.end(),
+				[] (char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'); }
+			);
+		}
+
+	} // !anonymous
+
+	Manifest Manifest::scan(std::string const& directory,
+	                        Chunker const& chunker)
+	{
+		ETC_TRACE.debug("Scanning", directory);
+		fs::path const root{directory};
+		if (!fs::is_directory(root))
+			throw Exception{"Not a directory: " + directory};
+		Manifest res;
+		for (fs::recursive_directory_iterator it{root}, end; it != end; ++it)
+		{
+			if (!fs::is_regular_file(it->status()))
+				continue;
+			std::string relative;
+			for (fs::path p = it->path(); p != root; p = p.parent_path())
+				relative = relative.empty() ? p.filename().string()
+				                            : p.filename().string() + "/" + relative;
+			res.files.push_back(hash_file(it->path(), std::move(relative), chunker));
+		}
+		std::sort(
+			res.files.begin(),
+			res.files.end(),
+			[] (File const& lhs, File const& rhs) { return lhs.path < rhs.path; }
+		);
+		ETC_LOG.debug("Scanned", res.files.size(), "files of", res.size(),
+		              "bytes in", directory);
+		return res;
+	}
+
+	Manifest Manifest::load(std::istream& in)
+	{
+		std::string line;
+		if (!std::getline(in, line) || line != magic)
+			throw Exception{"Not a manifest"};
+		Manifest res;
+		while (std::getline(in, line))
+		{
+			if (line.empty())
+				continue;
+			std::istringstream ss{line};
+			std::string kind, digest;
+			uint64_t size;
+			ss >> kind >> size >> digest;
+			if (!ss || !is_digest(digest))
+				throw Exception{"Invalid manifest line: " + line};
+			if (kind == "chunk")
+			{
+				if (res.files.empty())
+					throw Exception{"Chunk without file in the manifest"};
+				res.files.back().chunks.push_back(Chunk{size, std::move(digest)});
+				continue;
+			}
+			std::string flags;
+			ss >> flags;
+			ss.get();
+			std::string path;
+			std::getline(ss, path);
+			if (kind != "file" || (flags != "x" && flags != "-") || path.empty())
+				throw Exception{"Invalid manifest line: " + line};
+			if (!res.files.empty() && !(res.files.back().path < path))
+				throw Exception{"Manifest files are not sorted: " + path};
+			res.files.push_back(
+				File{std::move(path), size, std::move(digest), flags == "x", {}}
+			);
+		}
+		for (auto const& file: res.files)
+		{
+			uint64_t size = 0;
+			for (auto const& chunk: file.chunks)
+				size += chunk.size;
+			if (size != file.size)
+				throw Exception{"Chunks do not match the size of " + file.path};
+		}
+		return res;
+	}
+
+	Manifest Manifest::load(std::string const& path)
+	{
+		std::ifstream in{path};
+		if (!in)
+			throw Exception{"Couldn't open " + path};
+		return load(in);
+	}
+
+	void Manifest::save(std::ostream& out) const
+	{
+		out << magic << '\n';
+		for (auto const& file: this->files)
+		{
+			out << "file " << file.size << ' ' << file.digest << ' '
+			    << (file.executable ? "x " : "- ") << file.path << '\n';
+			for (auto const& chunk: file.chunks)
+				out << "chunk " << chunk.size << ' ' << chunk.digest << '\n';
+		}
+	}
+
+	void Manifest::save(std::string const& path) const
+	{
+		std::ofstream out{path};
+		this->save(out);
+		out.close();
+		if (!out)
+			throw Exception{"Couldn't write " + path};
+	}
+
+	Manifest::File const* Manifest::find(std::string const& path) const
+	{
+		auto it = std::lower_bound(
+			this->files.begin(),
+			this->files.end(),
+			path,
+			[] (File const& file, std::string const& path) { return file.path < path; }
+		);
+		if (it == this->files.end() || it->path != path)
+			return nullptr;
+		return &*it;
+	}
+
+	uint64_t Manifest::size() const
+	{
+		uint64_t res = 0;
+		for (auto const& file: this->files)
+			res += file.size;
+		return res;
+	}
+
+	bool operator ==(Manifest::File const& lhs, Manifest::File const& rhs)
+	{
+		return lhs.path == rhs.path && lhs.size == rhs.size &&
+		       lhs.digest == rhs.digest && lhs.executable == rhs.executable &&
+		       lhs.chunks.size() == rhs.chunks.size() &&
+		       std::equal(
+		           lhs.chunks.begin(), lhs.chunks.end(), rhs.chunks.begin(),
+		           [] (Manifest::Chunk const& l, Manifest::Chunk const& r) {
+		               return l.size == r.size && l.digest == r.digest;
+		           }
+		       );
+	}
+
+	bool operator ==(Manifest const& lhs, Manifest const& rhs)
+	{ return lhs.files == rhs.files; }
+
+	namespace {
+
+		ETC_TEST_CASE(scan)
+		{
+			fs::path const dir = fs::path(temp::default_directory()) /
+				fs::unique_path("%%%%-%%%%-%%%%");
+			auto guard = etc::scope_exit([&] { fs::remove_all(dir); });
+			fs::create_directories(dir / "sub dir");
+			std::string content;
+			for (int i = 0; i < 1024 * 1024; ++i)
+				content.push_back(static_cast<char>(i * i % 251));
+			std::ofstream{(dir / "big").string(), std::ios::binary} << content;
+			std::ofstream{(dir / "sub dir" / "small").string()} << "abc";
+			std::ofstream{(dir / "empty").string()};
+			fs::permissions(dir / "big", fs::add_perms | fs::owner_exe);
+
+			Manifest manifest = Manifest::scan(dir.string());
+			ETC_TEST_EQ(manifest.files.size(), 3u);
+			ETC_TEST_EQ(manifest.size(), content.size() + 3);
+			auto big = manifest.find("big");
+			ETC_ENFORCE(big != nullptr);
+			ETC_TEST_EQ(big->digest, Sha256::digest(content.data(), content.size()));
+			ETC_ENFORCE_GT(big->chunks.size(), 4u);
+#ifndef _WIN32
+			ETC_ENFORCE(big->executable);
+#endif
+			auto small = manifest.find("sub dir/small");
+			ETC_ENFORCE(small != nullptr);
+			ETC_ENFORCE(!small->executable);
+			ETC_TEST_EQ(small->chunks.size(), 1u);
+			ETC_TEST_EQ(small->chunks[0].digest, Sha256::digest("abc", 3));
+			ETC_TEST_EQ(manifest.find("empty")->chunks.size(), 0u);
+			ETC_ENFORCE(manifest.find("missing") == nullptr);
+
+			std::stringstream ss;
+			manifest.save(ss);
+			ETC_ENFORCE(Manifest::load(ss) == manifest);
+		}
+
+		ETC_TEST_CASE(invalid)
+		{
+			auto load = [] (std::string const& str) {
+				std::istringstream in{str};
+				return Manifest::load(in);
+			};
+			std::string const digest(64, 'a');
+			ETC_TEST_EQ(load(std::string(magic) + "\n").files.size(), 0u);
+			ETC_TEST_THROW_TYPE({ load("not a manifest\n"); }, Exception);
+			ETC_TEST_THROW_TYPE({
+				load(std::string(magic) + "\nchunk 3 " + digest + "\n");
+			}, Exception);
+			ETC_TEST_THROW_TYPE({
+				load(std::string(magic) + "\nfile 3 abc - a\n");
+			}, Exception);
+			ETC_TEST_THROW_TYPE({
+				load(std::string(magic) + "\nfile 4 " + digest + " - a\n"
+				     "chunk 3 " + digest + "\n");
+			}, Exception);
+			ETC_TEST_THROW_TYPE({
+				load(std::string(magic) + "\nfile 0 " + digest + " - b\n"
+				     "file 0 " + digest + " - a\n");
+			}, Exception);
+		}
+
+	} // !anonymous
+
+}}
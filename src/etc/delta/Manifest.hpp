@@ -0,0 +1,76 @@
+#ifndef  ETC_DELTA_MANIFEST_HPP
+# define ETC_DELTA_MANIFEST_HPP
+
+# include "Chunker.hpp"
+
+# include <etc/api.hpp>
+
+# include <cstdint>
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+namespace etc { namespace delta {
+
+	/**
+	 * @brief Content hashes of the files of a directory.
+	 *
+	 * Every file is listed with its SHA-256 digest and the digests of its
+	 * chunks, paths being relative and separated by '/'. Manifests are saved
+	 * as text:
+	 *
+	 * ------------------------------------------------------------------------
+	 * 8cube-manifest 1
+	 * file <size> <digest> <x|-> <path>
+	 * chunk <size> <digest>
+	 * ...
+	 * ------------------------------------------------------------------------
+	 */
+	class ETC_API Manifest
+	{
+	public:
+		struct Chunk
+		{
+			uint64_t    size;
+			std::string digest;
+		};
+
+		struct File
+		{
+			std::string        path;
+			uint64_t           size;
+			std::string        digest;
+			bool               executable;
+			std::vector<Chunk> chunks;
+		};
+
+	public:
+		/// Files sorted by path.
+		std::vector<File> files;
+
+	public:
+		/// Hash the files below @a directory.
+		static Manifest scan(std::string const& directory,
+		                     Chunker const& chunker = Chunker{});
+
+		static Manifest load(std::istream& in);
+		static Manifest load(std::string const& path);
+		void save(std::ostream& out) const;
+		void save(std::string const& path) const;
+
+		/// File at @a path, or nullptr.
+		File const* find(std::string const& path) const;
+
+		/// Total size of the files.
+		uint64_t size() const;
+	};
+
+	ETC_API
+	bool operator ==(Manifest::File const& lhs, Manifest::File const& rhs);
+
+	ETC_API
+	bool operator ==(Manifest const& lhs, Manifest const& rhs);
+
+}}
+
+#endif
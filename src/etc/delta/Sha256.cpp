@@ -0,0 +1,177 @@
+#include "Sha256.hpp"
+
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace etc { namespace delta {
+
+	namespace {
+
+		uint32_t const constants[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+			0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+			0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+			0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+			0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+			0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+			0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+			0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+			0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+		};
+
+		inline uint32_t rotr(uint32_t const x, unsigned const n)
+		{ return (x >> n) | (x << (32 - n)); }
+
+	} // !anonymous
+
+	Sha256::Sha256()
+	{ _reset(); }
+
+	void Sha256::update(char const* data, size_t const size)
+	{
+		auto in = reinterpret_cast<unsigned char const*>(data);
+		auto end = in + size;
+		_total_size += size;
+		if (_block_size > 0)
+		{
+			size_t const len = std::min<size_t>(64 - _block_size, size);
+			std::memcpy(_block + _block_size, in, len);
+			_block_size += len;
+			in += len;
+			if (_block_size < 64)
+				return;
+			_transform(_block);
+			_block_size = 0;
+		}
+		for (; end - in >= 64; in += 64)
+			_transform(in);
+		std::memcpy(_block, in, end - in);
+		_block_size = end - in;
+	}
+
+	std::string Sha256::finish()
+	{
+		uint64_t const bits = _total_size * 8;
+		_block[_block_size++] = 0x80;
+		if (_block_size > 56)
+		{
+			std::memset(_block + _block_size, 0, 64 - _block_size);
+			_transform(_block);
+			_block_size = 0;
+		}
+		std::memset(_block + _block_size, 0, 56 - _block_size);
+		for (int i = 0; i < 8; ++i)
+			_block[56 + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+		_transform(_block);
+
+		static char const hex[] = "0123456789abcdef";
+		std::string res(64, '0');
+		for (int i = 0; i < 32; ++i)
+		{
+			unsigned char const byte = _state[i / 4] >> (24 - 8 * (i % 4));
+			res[2 * i] = hex[byte >> 4];
+			res[2 * i + 1] = hex[byte & 0xf];
+		}
+		_reset();
+		return res;
+	}
+
+	std::string Sha256::digest(char const* data, size_t const size)
+	{
+		Sha256 hasher;
+		hasher.update(data, size);
+		return hasher.finish();
+	}
+
+	void Sha256::_reset()
+	{
+		_state[0] = 0x6a09e667;
+		_state[1] = 0xbb67ae85;
+		_state[2] = 0x3c6ef372;
+		_state[3] = 0xa54ff53a;
+		_state[4] = 0x510e527f;
+		_state[5] = 0x9b05688c;
+		_state[6] = 0x1f83d9ab;
+		_state[7] = 0x5be0cd19;
+		_block_size = 0;
+		_total_size = 0;
+	}
+
+	void Sha256::_transform(unsigned char const* block)
+	{
+		uint32_t w[64];
+		for (int i = 0; i < 16; ++i)
+			w[i] = (uint32_t(block[4 * i]) << 24) |
+			       (uint32_t(block[4 * i + 1]) << 16) |
+			       (uint32_t(block[4 * i + 2]) << 8) |
+			       uint32_t(block[4 * i + 3]);
+		for (int i = 16; i < 64; ++i)
+		{
+			uint32_t const s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			uint32_t const s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+		uint32_t a = _state[0], b = _state[1], c = _state[2], d = _state[3],
+		         e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+		for (int i = 0; i < 64; ++i)
+		{
+			uint32_t const s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+			uint32_t const ch = (e & f) ^ (~e & g);
+			uint32_t const t1 = h + s1 + ch + constants[i] + w[i];
+			uint32_t const s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+			uint32_t const maj = (a & b) ^ (a & c) ^ (b & c);
+			uint32_t const t2 = s0 + maj;
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+		_state[0] += a; _state[1] += b; _state[2] += c; _state[3] += d;
+		_state[4] += e; _state[5] += f; _state[6] += g; _state[7] += h;
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(vectors)
+		{
+			ETC_TEST_EQ(
+				Sha256::digest("", 0),
+				"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"
+			);
+			ETC_TEST_EQ(
+				Sha256::digest("abc", 3),
+				"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"
+			);
+			std::string const two_blocks =
+				"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+			ETC_TEST_EQ(
+				Sha256::digest(two_blocks.data(), two_blocks.size()),
+				"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"
+			);
+		}
+
+		ETC_TEST_CASE(incremental)
+		{
+			std::string data;
+			for (int i = 0; i < 1000; ++i)
+				data.push_back(static_cast<char>(i * 31 % 256));
+			std::string const expected = Sha256::digest(data.data(), data.size());
+			Sha256 hasher;
+			for (size_t i = 0, step = 1; i < data.size(); i += step, step += 7)
+				hasher.update(data.data() + i, std::min(step, data.size() - i));
+			ETC_TEST_EQ(hasher.finish(), expected);
+			// The hasher is reusable.
+			hasher.update(data.data(), data.size());
+			ETC_TEST_EQ(hasher.finish(), expected);
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,40 @@
+#ifndef  ETC_DELTA_SHA256_HPP
+# define ETC_DELTA_SHA256_HPP
+
+# include <etc/api.hpp>
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+
+namespace etc { namespace delta {
+
+	/// Incremental SHA-256, digests are given in lower case hexadecimal.
+	class ETC_API Sha256
+	{
+	private:
+		uint32_t      _state[8];
+		unsigned char _block[64];
+		size_t        _block_size;
+		uint64_t      _total_size;
+
+	public:
+		Sha256();
+
+	public:
+		void update(char const* data, size_t const size);
+
+		/// Digest of the data given so far, the hasher is reset.
+		std::string finish();
+
+		/// Digest of @a size bytes at @a data.
+		static std::string digest(char const* data, size_t const size);
+
+	private:
+		void _reset();
+		void _transform(unsigned char const* block);
+	};
+
+}}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef  ETC_DELTA_FWD_HPP
+# define ETC_DELTA_FWD_HPP
+
+namespace etc { namespace delta {
+
+	class Sha256;
+	class Chunker;
+	class Manifest;
+	struct UpdateStats;
+
+}}
+
+#endif
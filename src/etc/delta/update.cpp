@@ -0,0 +1,362 @@
+#include "update.hpp"
+#include "Sha256.hpp"
+
+#include <etc/exception.hpp>
+#include <etc/log.hpp>
+#include <etc/scope_exit.hpp>
+#include <etc/temp/default_directory.hpp>
+#include <etc/test.hpp>
+
+#include <wrappers/boost/filesystem.hpp>
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#ifdef __linux__
+# include <fcntl.h>
+# include <linux/fs.h>
+# include <sys/ioctl.h>
+# include <unistd.h>
+#endif
+
+namespace fs = boost::filesystem;
+
+namespace etc { namespace delta {
+
+	ETC_LOG_COMPONENT("etc.delta.update");
+
+	using exception::Exception;
+
+	namespace {
+
+		// Where a chunk can be read locally.
+		struct Location
+		{
+			fs::path path;
+			uint64_t offset;
+		};
+
+		fs::path file_path(fs::path const& root, std::string const& path)
+		{
+			// Manifest paths are always relative and use '/'.
+			if (path.empty() || path[0] == '/' ||
+			    path.find('\\') != std::string::npos)
+				throw Exception{"Invalid path in the manifest: " + path};
+			fs::path res = root;
+			std::string::size_type begin = 0;
+			while (begin <= path.size())
+			{
+				auto end = path.find('/', begin);
+				if (end == std::string::npos)
+					end = path.size();
+				std::string const part = path.substr(begin, end - begin);
+				if (part.empty() || part == "." || part == "..")
+					throw Exception{"Invalid path in the manifest: " + path};
+				res /= part;
+				begin = end + 1;
+			}
+			return res;
+		}
+
+		/// Share the content of @a from, unless it is already there.
+		bool clone_file(fs::path const& from, fs::path const& to)
+		{
+#if defined(__linux__) && defined(FICLONE)
+			int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+			if (in < 0)
+				return false;
+			auto in_guard = etc::scope_exit([&] { ::close(in); });
+			int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+			if (out < 0)
+				return false;
+			bool const done = ::ioctl(out, FICLONE, in) == 0;
+			::close(out);
+			if (!done)
+				::unlink(to.c_str());
+			return done;
+#else
+			(void) from;
+			(void) to;
+			return false;
+#endif
+		}
+
+		class Assembler
+		{
+		private:
+			std::map<std::string, Location> _chunks;
+			fs::path                         _source_path;
+			std::ifstream                    _source;
+			std::vector<char>                _buffer;
+
+		public:
+			void add(Manifest::File const& file, fs::path const& path)
+			{
+				uint64_t offset = 0;
+				for (auto const& chunk: file.chunks)
+				{
+					_chunks.insert(std::make_pair(chunk.digest, Location{path, offset}));
+					offset += chunk.size;
+				}
+			}
+
+			/// Copy @a chunk in @a out when it is found locally.
+			bool copy(Manifest::Chunk const& chunk, std::ostream& out)
+			{
+				auto it = _chunks.find(chunk.digest);
+				if (it == _chunks.end())
+					return false;
+				Location const& location = it->second;
+				if (_source_path != location.path)
+				{
+					_source.close();
+					_source.clear();
+					_source.open(location.path.string(), std::ios::in | std::ios::binary);
+					_source_path = location.path;
+				}
+				_buffer.resize(chunk.size);
+				_source.seekg(location.offset);
+				if (chunk.size > 0)
+					_source.read(&_buffer[0], chunk.size);
+				if (!_source ||
+				    Sha256::digest(_buffer.data(), _buffer.size()) != chunk.digest)
+				{
+					// The previous release was altered.
+					ETC_LOG.warn("Ignore the altered chunk", chunk.digest,
+					             "of", location.path);
+					_source.clear();
+					_chunks.erase(it);
+					return false;
+				}
+				out.write(_buffer.data(), _buffer.size());
+				return true;
+			}
+		};
+
+	} // !anonymous
+
+	UpdateStats update(Manifest const& previous,
+	                   std::string const& previous_directory,
+	                   Manifest const& manifest,
+	                   std::string const& directory,
+	                   fetcher_type const& fetch)
+	{
+		ETC_TRACE.debug("Update", previous_directory, "to", directory);
+		fs::path const source_root{previous_directory};
+		fs::path const target_root{directory};
+		fs::path const partial_root{directory + ".partial"};
+		if (fs::exists(target_root))
+			throw Exception{"The release " + directory + " already exists"};
+		fs::remove_all(partial_root);
+		fs::create_directories(partial_root);
+		auto partial_guard = etc::scope_exit([&] {
+			boost::system::error_code ec;
+			fs::remove_all(partial_root, ec);
+		});
+
+		// Previous files by content.
+		std::map<std::string, Manifest::File const*> previous_files;
+		Assembler assembler;
+		if (!previous_directory.empty())
+			for (auto const& file: previous.files)
+			{
+				previous_files.insert(std::make_pair(file.digest, &file));
+				assembler.add(file, file_path(source_root, file.path));
+			}
+
+		UpdateStats stats{0, 0, 0};
+		for (auto const& file: manifest.files)
+		{
+			fs::path const path = file_path(partial_root, file.path);
+			fs::create_directories(path.parent_path());
+
+			auto it = previous_files.find(file.digest);
+			if (it != previous_files.end() && it->second->size == file.size)
+			{
+				fs::path const source = file_path(source_root, it->second->path);
+				boost::system::error_code ec;
+				if (fs::file_size(source, ec) == file.size && !ec)
+				{
+					bool linked = clone_file(source, path);
+					// Hard links share the permissions too.
+					if (!linked && it->second->executable == file.executable)
+					{
+						fs::create_hard_link(source, path, ec);
+						linked = !ec;
+					}
+					if (linked)
+					{
+						ETC_LOG.debug("Reuse", source, "for", file.path);
+						stats.linked_files += 1;
+						stats.reused_bytes += file.size;
+						if (file.executable)
+							fs::permissions(path, fs::add_perms | fs::owner_exe |
+							                      fs::group_exe | fs::others_exe);
+						assembler.add(file, path);
+						continue;
+					}
+				}
+			}
+
+			std::ofstream out{path.string(), std::ios::out | std::ios::binary};
+			if (!out)
+				throw Exception{"Couldn't create " + path.string()};
+			for (auto const& chunk: file.chunks)
+			{
+				if (assembler.copy(chunk, out))
+				{
+					stats.reused_bytes += chunk.size;
+					continue;
+				}
+				std::string const data = fetch(chunk);
+				if (data.size() != chunk.size ||
+				    Sha256::digest(data.data(), data.size()) != chunk.digest)
+					throw Exception{
+						"Invalid content of the chunk " + chunk.digest +
+						" of " + file.path
+					};
+				out.write(data.data(), data.size());
+				stats.fetched_bytes += data.size();
+			}
+			out.close();
+			if (!out)
+				throw Exception{"Couldn't write " + path.string()};
+			if (file.executable)
+				fs::permissions(path, fs::add_perms | fs::owner_exe |
+				                      fs::group_exe | fs::others_exe);
+			// Later files can reuse the chunks of this one.
+			assembler.add(file, path);
+		}
+
+		fs::rename(partial_root, target_root);
+		partial_guard.dismiss();
+		ETC_LOG.info("Updated to", directory, ":", stats.linked_files,
+		             "files linked,", stats.reused_bytes, "bytes reused and",
+		             stats.fetched_bytes, "bytes fetched");
+		return stats;
+	}
+
+	namespace {
+
+		std::string random_data(size_t const size, uint32_t seed)
+		{
+			std::string res(size, '\0');
+			for (auto& c: res)
+			{
+				seed = seed * 1664525 + 1013904223;
+				c = static_cast<char>(seed >> 24);
+			}
+			return res;
+		}
+
+		std::string read_file(fs::path const& path)
+		{
+			std::ifstream in{path.string(), std::ios::in | std::ios::binary};
+			return std::string{
+				std::istreambuf_iterator<char>(in),
+				std::istreambuf_iterator<char>()
+			};
+		}
+
+		void write_file(fs::path const& path, std::string const& content)
+		{
+			fs::create_directories(path.parent_path());
+			std::ofstream{path.string(), std::ios::out | std::ios::binary} << content;
+		}
+
+		ETC_TEST_CASE(delta)
+		{
+			fs::path const root = fs::path(temp::default_directory()) /
+				fs::unique_path("%%%%-%%%%-%%%%");
+			auto guard = etc::scope_exit([&] { fs::remove_all(root); });
+			fs::path const v1 = root / "1.0", v2 = root / "2.0", v3 = root / "3.0";
+
+			std::string const library = random_data(3 * 1024 * 1024, 1);
+			std::string const data = random_data(1024 * 1024, 2);
+			write_file(v1 / "lib" / "libcube.so", library);
+			write_file(v1 / "share" / "data", data);
+			write_file(v1 / "removed", "removed");
+			write_file(v1 / "bin" / "8cube", "binary");
+			fs::permissions(v1 / "bin" / "8cube", fs::add_perms | fs::owner_exe);
+			Manifest const previous = Manifest::scan(v1.string());
+
+			// The library is patched, a file moves and another one is added.
+			std::string patched = library;
+			patched.replace(1000000, 5, "patch");
+			patched.insert(2000000, "new bytes");
+			std::string const added = library.substr(500000, 1500000) + "added";
+			write_file(v2 / "lib" / "libcube.so", patched);
+			write_file(v2 / "share" / "moved", data);
+			write_file(v2 / "share" / "added", added);
+			write_file(v2 / "bin" / "8cube", "binary");
+			fs::permissions(v2 / "bin" / "8cube", fs::add_perms | fs::owner_exe);
+			Manifest const manifest = Manifest::scan(v2.string());
+
+			std::map<std::string, std::string> server;
+			for (auto const& file: manifest.files)
+			{
+				std::string const content = read_file(v2 / file.path);
+				uint64_t offset = 0;
+				for (auto const& chunk: file.chunks)
+				{
+					server[chunk.digest] = content.substr(offset, chunk.size);
+					offset += chunk.size;
+				}
+			}
+			uint64_t fetched = 0;
+			auto fetch = [&] (Manifest::Chunk const& chunk) {
+				fetched += chunk.size;
+				return server.at(chunk.digest);
+			};
+
+			UpdateStats stats = update(previous, v1.string(), manifest, v3.string(), fetch);
+			ETC_TEST_EQ(stats.linked_files, 2u);
+			ETC_TEST_EQ(stats.fetched_bytes, fetched);
+			ETC_TEST_EQ(stats.reused_bytes + stats.fetched_bytes, manifest.size());
+			// Only the chunks around the edits, and the end of the new file.
+			ETC_ENFORCE_LT(fetched, 5u * Chunker{}.max_size());
+			ETC_ENFORCE(Manifest::scan(v3.string()) == manifest);
+			ETC_ENFORCE(!fs::exists(v3.string() + ".partial"));
+			ETC_ENFORCE(read_file(v1 / "lib" / "libcube.so") == library);
+
+			// Already there.
+			ETC_TEST_THROW_TYPE({
+				update(previous, v1.string(), manifest, v3.string(), fetch);
+			}, Exception);
+
+			// From scratch, with an invalid chunk.
+			fs::path const v4 = root / "4.0";
+			bool corrupt = false;
+			auto bad_fetch = [&] (Manifest::Chunk const& chunk) {
+				std::string res = server.at(chunk.digest);
+				if (!corrupt)
+				{
+					corrupt = true;
+					res[0] ^= 1;
+				}
+				return res;
+			};
+			ETC_TEST_THROW_TYPE({
+				update(Manifest{}, "", manifest, v4.string(), bad_fetch);
+			}, Exception);
+			ETC_ENFORCE(!fs::exists(v4));
+			ETC_ENFORCE(!fs::exists(v4.string() + ".partial"));
+			stats = update(Manifest{}, "", manifest, v4.string(), bad_fetch);
+			ETC_TEST_EQ(stats.linked_files, 0u);
+			// The new file shares chunks with the library.
+			ETC_ENFORCE_GT(stats.reused_bytes, 0u);
+			ETC_ENFORCE(Manifest::scan(v4.string()) == manifest);
+
+			// Paths escaping the release are refused.
+			Manifest evil;
+			evil.files.push_back(Manifest::File{"../evil", 0, Sha256::digest("", 0), false, {}});
+			ETC_TEST_THROW_TYPE({
+				update(Manifest{}, "", evil, (root / "5.0").string(), fetch);
+			}, Exception);
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,48 @@
+#ifndef  ETC_DELTA_UPDATE_HPP
+# define ETC_DELTA_UPDATE_HPP
+
+# include "Manifest.hpp"
+
+# include <etc/api.hpp>
+
+# include <cstdint>
+# include <functional>
+# include <string>
+
+namespace etc { namespace delta {
+
+	struct UpdateStats
+	{
+		/// Files shared with the previous release.
+		uint64_t linked_files;
+		/// Bytes shared with or copied from the previous release.
+		uint64_t reused_bytes;
+		/// Bytes of the fetched chunks.
+		uint64_t fetched_bytes;
+	};
+
+	/// Return the content of a chunk.
+	typedef std::function<std::string(Manifest::Chunk const&)> fetcher_type;
+
+	/**
+	 * @brief Build the release described by @a manifest in @a directory.
+	 *
+	 * The files of @a previous found in @a previous_directory are reused:
+	 * identical files are cloned or hard linked, and the chunks of changed
+	 * files are copied when the previous release has them. Only the missing
+	 * chunks are given to @a fetch. Every chunk is checked against its
+	 * digest.
+	 *
+	 * The release is assembled in "<directory>.partial", renamed to
+	 * @a directory once complete, which must not exist.
+	 */
+	ETC_API
+	UpdateStats update(Manifest const& previous,
+	                   std::string const& previous_directory,
+	                   Manifest const& manifest,
+	                   std::string const& directory,
+	                   fetcher_type const& fetch);
+
+}}
+
+#endif
@@ -1,11 +1,26 @@
 #include "ClientImpl.hpp"
 #include "ResponseImpl.hpp"
 #include "Request.hpp"
+#include "Server.hpp"
 
 #include <etc/exception.hpp>
 #include <etc/scheduler/Scheduler.hpp>
+#include <etc/scheduler/TaskGroup.hpp>
 #include <etc/sys/environ.hpp>
+#include <etc/temp/File.hpp>
 #include <etc/test.hpp>
+#include <etc/to_string.hpp>
+
+#include <wrappers/boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace etc { namespace http {
 
@@ -13,6 +28,39 @@ namespace etc { namespace http {
 
 	using exception::Exception;
 
+	namespace {
+
+		/// Chunks already downloaded into @a path, according to its progress
+		/// file, when it matches the download.
+		std::set<etc::size_type> load_progress(std::string const& path,
+		                                       std::string const& progress_path,
+		                                       uint64_t const size,
+		                                       etc::size_type const chunk_size)
+		{
+			std::set<etc::size_type> res;
+			std::ifstream in{progress_path};
+			uint64_t expected_size;
+			etc::size_type expected_chunk_size;
+			if (!(in >> expected_size >> expected_chunk_size) ||
+			    expected_size != size || expected_chunk_size != chunk_size)
+				return res;
+			boost::system::error_code ec;
+			if (boost::filesystem::file_size(path, ec) != size || ec)
+				return res;
+			std::string line;
+			std::getline(in, line);
+			while (std::getline(in, line))
+			{
+				// The last line may have been interrupted.
+				if (in.eof())
+					break;
+				res.insert(std::strtoull(line.c_str(), nullptr, 10));
+			}
+			return res;
+		}
+
+	} // !anonymous
+
 	Client::Client(std::string server,
 	               uint16_t port,
 	               scheduler::Scheduler* sched)
@@ -35,6 +83,133 @@ namespace etc { namespace http {
 		return Response{res};
 	}
 
+	etc::size_type Client::download(Request req,
+	                                std::string const& path,
+	                                etc::size_type const connections,
+	                                etc::size_type const chunk_size)
+	{
+		if (connections == 0 || chunk_size == 0)
+			throw Exception{"Invalid download parameters"};
+		req.method(Method::get);
+
+		uint64_t size = 0;
+		bool ranges = false;
+		{
+			Request head{req};
+			head.method(Method::head);
+			Response res = this->fire(std::move(head));
+			if (res.code() != ResponseCode::ok)
+				throw Exception{
+					"Couldn't download " + req.url() + ": " +
+					etc::to_string(res.code())
+				};
+			auto const& headers = res.headers();
+			auto it = headers.find("accept-ranges");
+			ranges = (it != headers.end() &&
+			          it->second.find("bytes") != std::string::npos);
+			it = headers.find("content-length");
+			if (it == headers.end() || it->second.empty() ||
+			    it->second.find_first_not_of("0123456789") != std::string::npos)
+				ranges = false;
+			else
+				size = std::strtoull(it->second.c_str(), nullptr, 10);
+			// Let the connection go back to the pool.
+			res.read();
+		}
+
+		if (!ranges)
+		{
+			ETC_LOG.info("Downloading", req.url(), "in one piece");
+			std::ofstream out{path, std::ios::binary | std::ios::trunc};
+			if (!out)
+				throw Exception{"Couldn't open " + path};
+			Response res = this->fire(std::move(req));
+			if (res.code() != ResponseCode::ok)
+				throw Exception{
+					"Couldn't download " + path + ": " + etc::to_string(res.code())
+				};
+			return res.read_to(out);
+		}
+
+		std::string progress_path = path + ".progress";
+		etc::size_type chunks = (size + chunk_size - 1) / chunk_size;
+		auto done = load_progress(path, progress_path, size, chunk_size);
+		if (done.empty())
+		{
+			{
+				std::ofstream out{path, std::ios::binary | std::ios::trunc};
+				if (!out)
+					throw Exception{"Couldn't open " + path};
+			}
+			boost::filesystem::resize_file(path, size);
+			std::ofstream progress{progress_path, std::ios::trunc};
+			progress << size << ' ' << chunk_size << std::endl;
+		}
+		else
+			ETC_LOG.info("Resuming the download of", path, "with", done.size(),
+			             "chunks of", chunks, "done");
+
+		std::vector<etc::size_type> todo;
+		for (etc::size_type i = 0; i < chunks; ++i)
+			if (done.count(i) == 0)
+				todo.push_back(i);
+		ETC_LOG.info("Downloading", chunks - done.size(), "chunks of",
+		             req.url(), "on", std::min(connections, todo.size()),
+		             "connections");
+
+		std::ofstream progress{progress_path, std::ios::app};
+		std::mutex progress_mutex;
+		std::atomic<etc::size_type> next{0};
+		std::atomic<bool> failed{false};
+		scheduler::TaskGroup group{_this->sched};
+		for (etc::size_type i = 0; i < std::min(connections, todo.size()); ++i)
+			group.spawn("download " + path, [&] {
+				try
+				{
+					std::fstream file{
+						path, std::ios::in | std::ios::out | std::ios::binary
+					};
+					if (!file)
+						throw Exception{"Couldn't open " + path};
+					while (!failed)
+					{
+						etc::size_type const i = next++;
+						if (i >= todo.size())
+							break;
+						etc::size_type index = todo[i];
+						uint64_t begin = index * chunk_size;
+						uint64_t end = std::min<uint64_t>(begin + chunk_size, size);
+						std::string range = "bytes=" + std::to_string(begin) +
+						                    "-" + std::to_string(end - 1);
+						Request chunk{req};
+						chunk.header("Range", range);
+						Response res = this->fire(std::move(chunk));
+						if (res.code() != ResponseCode::partial_content)
+							throw Exception{
+								"Couldn't download " + range + " of " + req.url() +
+								": " + etc::to_string(res.code())
+							};
+						file.seekp(begin);
+						if (res.read_to(file) != end - begin)
+							throw Exception{"Incomplete " + range + " of " + req.url()};
+						if (!file.flush())
+							throw Exception{"Couldn't write " + path};
+						std::lock_guard<std::mutex> lock(progress_mutex);
+						progress << index << std::endl;
+					}
+				}
+				catch (...)
+				{
+					failed = true;
+					throw;
+				}
+			});
+		group.wait();
+		progress.close();
+		boost::filesystem::remove(progress_path);
+		return size;
+	}
+
 	std::string const& Client::server() const ETC_NOEXCEPT
 	{ return _this->server; }
 
@@ -60,6 +235,15 @@ namespace etc { namespace http {
 			);
 		}
 
+		ETC_TEST_CASE(ctor_multi_threaded_scheduler)
+		{
+			scheduler::Scheduler s{2};
+			ETC_TEST_THROW(
+				{ Client c("http://example.org", 80, &s); },
+				exception::Exception, "HTTP clients need a single-threaded scheduler"
+			);
+		}
+
 		ETC_TEST_CASE_SETUP(HttpServer)
 		{
 			// XXX
@@ -90,6 +274,164 @@ namespace etc { namespace http {
 			                         "http://test.8cube.io");
 		}
 
+		// Run @a client while a server setup by @a setup serves in the
+		// current scheduler.
+		void with_server(std::function<void(Server&)> setup,
+		                 std::function<void(std::string const&)> client)
+		{
+			Server server;
+			setup(server);
+			server.bind("127.0.0.1", 0);
+			std::string url = "http://127.0.0.1:" +
+			                  std::to_string(server.endpoint().port);
+			scheduler::TaskGroup group;
+			group.spawn("server", [&] { server.serve(); });
+			try { client(url); }
+			catch (...)
+			{
+				server.stop();
+				group.wait();
+				throw;
+			}
+			server.stop();
+			group.wait();
+		}
+
+		std::string read_file(std::string const& path)
+		{
+			std::ifstream in{path, std::ios::binary};
+			return std::string{
+				std::istreambuf_iterator<char>(in),
+				std::istreambuf_iterator<char>()
+			};
+		}
+
+		ETC_HTTP_TEST_CASE(keep_alive)
+		{
+			with_server(
+				[] (Server& server) {
+					server.route("/", [] (Request const& req, Server::Reply& reply) {
+						reply.send("pong " + req.url());
+					});
+				},
+				[] (std::string const& url) {
+					Client client{url};
+					for (int i = 0; i < 5; ++i)
+					{
+						Response res = client.fire(Request().url("/ping"));
+						ETC_TEST_EQ(res.code(), ResponseCode::ok);
+						ETC_TEST_EQ(res.headers().at("content-length"), "10");
+						ETC_TEST_EQ(res.read(), "pong /ping");
+						long connects = -1;
+						::curl_easy_getinfo(res.impl().easy_handle,
+						                    CURLINFO_NUM_CONNECTS,
+						                    &connects);
+						ETC_TEST_EQ(connects, i == 0 ? 1 : 0);
+					}
+				}
+			);
+		}
+
+		ETC_HTTP_TEST_CASE(stream)
+		{
+			std::string const piece(64 * 1024, 'x');
+			int const pieces = 64;
+			with_server(
+				[&] (Server& server) {
+					server.route("/", [&] (Request const&, Server::Reply& reply) {
+						for (int i = 0; i < pieces; ++i)
+							reply.write(piece);
+					});
+				},
+				[&] (std::string const& url) {
+					Client client{url};
+					Response res = client.fire(Request());
+					ETC_TEST_EQ(res.read(10), std::string(10, 'x'));
+					// The transfer is paused once enough data is buffered.
+					scheduler::current().sleep_for(std::chrono::milliseconds(100));
+					etc::size_type const max_buffered =
+						Response::Impl::max_buffered_size + CURL_MAX_WRITE_SIZE;
+					ETC_ENFORCE(res.impl().paused);
+					ETC_ENFORCE_LTE(res.impl().in_data.size(), max_buffered);
+					etc::size_type size = res.read_to(
+						[&] (char const* data, etc::size_type size) {
+							ETC_ENFORCE_LTE(size, max_buffered);
+							ETC_ENFORCE_EQ(std::string(data, size), std::string(size, 'x'));
+						}
+					);
+					ETC_TEST_EQ(size + 10, pieces * piece.size());
+				}
+			);
+		}
+
+		ETC_HTTP_TEST_CASE(download)
+		{
+			typedef etc::temp::File<std::ofstream> TempFile;
+			auto const mode = std::ios::out | std::ios::binary;
+			TempFile source{"%%%%-%%%%-%%%%.bin", mode};
+			std::string content;
+			for (int i = 0; i < 3 * 1024 * 1024 + 1234; ++i)
+				content.push_back(static_cast<char>(i * 7 % 251));
+			source.stream() << content;
+			source.stream().close();
+			TempFile target{"%%%%-%%%%-%%%%.bin", mode};
+			target.stream().close();
+			std::string const path = target.path().string();
+			etc::size_type const chunk_size = 256 * 1024;
+
+			with_server(
+				[&] (Server& server) {
+					server.serve_directory(
+						"/files", source.path().parent_path().string()
+					);
+					server.route("/plain", [&] (Request const&, Server::Reply& reply) {
+						reply.send(content);
+					});
+				},
+				[&] (std::string const& url) {
+					Client client{url};
+					Request req = Request().url(
+						"/files/" + source.path().filename().string()
+					);
+					ETC_TEST_EQ(client.download(req, path, 4, chunk_size),
+					            content.size());
+					ETC_ENFORCE(read_file(path) == content);
+					ETC_ENFORCE(!boost::filesystem::exists(path + ".progress"));
+
+					// Resume with every chunk but the third one done, the
+					// fifth one is not downloaded again.
+					{
+						std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+						file.seekp(2 * chunk_size);
+						file << std::string(100, '\0');
+						file.seekp(4 * chunk_size);
+						file << std::string(100, '\0');
+						std::ofstream progress{path + ".progress"};
+						progress << content.size() << ' ' << chunk_size << '\n';
+						for (int i = 0; i < 13; ++i)
+							if (i != 2)
+								progress << i << '\n';
+						// Interrupted line.
+						progress << "2";
+					}
+					ETC_TEST_EQ(client.download(req, path, 4, chunk_size),
+					            content.size());
+					std::string expected = content;
+					std::fill_n(expected.begin() + 4 * chunk_size, 100, '\0');
+					ETC_ENFORCE(read_file(path) == expected);
+
+					// Without ranges.
+					ETC_TEST_EQ(client.download(Request().url("/plain"), path),
+					            content.size());
+					ETC_ENFORCE(read_file(path) == content);
+
+					ETC_TEST_THROW_TYPE({
+						client.download(Request().url("/files/missing"), path);
+					}, Exception);
+				}
+			);
+		}
+
 		/*ETC_HTTP_TEST_CASE(get)
 		{
 			Client c(test_url());
@@ -14,6 +14,8 @@ namespace etc { namespace http {
 	class ETC_API Client
 	{
 	public:
+		/// Requests are run by @a sched, or the current scheduler, which must
+		/// have a single thread.
 		Client(std::string server,
 		       uint16_t port = 80,
 		       scheduler::Scheduler* sched = nullptr);
@@ -22,8 +24,24 @@ namespace etc { namespace http {
 		std::string const& server() const ETC_NOEXCEPT;
 		uint16_t port() const ETC_NOEXCEPT;
 
+		/// Start a request, connections to the server are reused.
 		Response fire(Request req);
 
+		/**
+		 * @brief Download @a req into the file @a path.
+		 *
+		 * When the server supports ranges, the file is fetched by chunks of
+		 * @a chunk_size bytes over up to @a connections connections. The
+		 * chunks done are recorded in "<path>.progress", removed at the end,
+		 * so that an interrupted download resumes where it stopped.
+		 *
+		 * Returns the size of the file.
+		 */
+		etc::size_type download(Request req,
+		                        std::string const& path,
+		                        etc::size_type const connections = 4,
+		                        etc::size_type const chunk_size = 4 * 1024 * 1024);
+
 	public:
 		struct Impl;
 	private:
@@ -26,6 +26,12 @@ namespace etc { namespace http {
 		auto handle_guard = etc::scope_exit([this] {
 			::curl_multi_cleanup(this->multi_handle);
 		});
+		// The multi handle and its sockets are driven by whichever context
+		// is running, they cannot be shared between workers.
+		if (sched.thread_count() > 1)
+			throw exception::Exception{
+				"HTTP clients need a single-threaded scheduler"
+			};
 
 		_setopt(CURLMOPT_SOCKETFUNCTION, &_socket_callback);
 		_setopt(CURLMOPT_SOCKETDATA, this);
@@ -33,6 +39,9 @@ namespace etc { namespace http {
 		_setopt(CURLMOPT_TIMERFUNCTION, &_timer_callback);
 		_setopt(CURLMOPT_TIMERDATA, this);
 
+		// Idle connections kept alive for the next requests.
+		_setopt(CURLMOPT_MAXCONNECTS, 16L);
+
 		handle_guard.dismiss();
 	}
 
@@ -43,7 +52,8 @@ namespace etc { namespace http {
 		while (this->responses.size())
 		{
 			ETC_LOG.debug(*this, "Cancelling 1 response of", this->responses.size(), "left");
-			this->remove_handle(this->responses.begin()->first);
+			this->remove_handle(this->responses.begin()->first,
+			                    CURLE_ABORTED_BY_CALLBACK);
 		}
 		ETC_LOG.debug(this->timers.size(), "timers to cancel");
 		while (this->timers.size())
@@ -88,24 +98,7 @@ namespace etc { namespace http {
 		//});
 	}
 
-	void Client::Impl::setup_handle(CURL* easy_handle, curl_socket_t fd)
-	{
-		if (this->sockets.find(easy_handle) == this->sockets.end())
-		{
-			ETC_TRACE.debug(*this, "Setup easy handle", easy_handle, "with fd", fd);
-			this->sockets.insert(std::make_pair(
-				easy_handle,
-				boost::asio::ip::tcp::socket(
-					this->sched.impl().service,
-					boost::asio::ip::tcp::v4(),
-					fd
-				)
-			));
-			ETC_ASSERT_EQ(this->sockets.at(easy_handle).native_handle(), fd);
-		}
-	}
-
-	void Client::Impl::remove_handle(CURL* easy_handle)
+	void Client::Impl::remove_handle(CURL* easy_handle, CURLcode const result)
 	{
 		auto res_it = this->responses.find(easy_handle);
 		if (res_it != this->responses.end())
@@ -115,14 +108,7 @@ namespace etc { namespace http {
 			if (res != nullptr)
 			{
 				ETC_TRACE.debug(*this, "Removing", *res, "of easy handle", easy_handle);
-				res->running = false;
-				// Waking up the context as long as needed.
-				while (res->context != nullptr)
-				{
-					ETC_LOG.debug(*this, "waking up the context of the response");
-					this->sched.impl().wakeup(*res->context);
-					ETC_LOG.debug(*this, "woke up the context of the response");
-				}
+				res->finish(result);
 			}
 			else
 			{
@@ -130,18 +116,26 @@ namespace etc { namespace http {
 			}
 		}
 
-		auto socket_it = this->sockets.find(easy_handle);
-		if (socket_it != this->sockets.end())
+	}
+
+	void Client::Impl::watch(curl_socket_t fd, int action)
+	{
+		auto it = this->sockets.find(fd);
+		if (it == this->sockets.end())
 		{
-			ETC_TRACE.debug(*this, "Removing the socket of easy handle", easy_handle);
-			this->sockets.erase(socket_it);
+			ETC_LOG.warn(*this, "Ignore the unknown socket", fd);
+			return;
 		}
+		auto const& watch = it->second;
+		watch->action = action;
+		if ((action & CURL_POLL_IN) && !watch->reading)
+			this->setup_read_check(watch);
+		if ((action & CURL_POLL_OUT) && !watch->writing)
+			this->setup_write_check(watch);
 	}
 
-
 	static void on_event(Client::Impl& self,
-	                     std::shared_ptr<Response::Impl> response,
-	                     CURL* easy_handle,
+	                     std::shared_ptr<Client::Impl::Watch> watch,
 	                     int action,
 	                     boost::system::error_code const& ec,
 	                     size_t)
@@ -149,57 +143,54 @@ namespace etc { namespace http {
 		std::string op = (
 		    (action == CURL_CSELECT_IN ? "READ" :
 		    (action == CURL_CSELECT_OUT ? "WRITE" : "INVALID")));
-		if (ec)
+		if (action == CURL_CSELECT_IN)
+			watch->reading = false;
+		else
+			watch->writing = false;
+		if (ec == boost::asio::error::operation_aborted ||
+		    !watch->socket.is_open())
 		{
-			ETC_LOG.error(self, "Couldn't check", op, "op on", easy_handle, ec);
+			ETC_LOG.debug(self, "Cancelled", op, "check");
 			return;
 		}
-		else if (self.sockets.find(easy_handle) == self.sockets.end())
+		curl_socket_t fd = watch->socket.native_handle();
+		if (ec)
 		{
-			ETC_LOG.error(self, "Ignore readines of", op, "op on",
-			              easy_handle, "since it has been removed");
-			return;
+			ETC_LOG.error(self, "Couldn't check", op, "op on", fd, ec);
+			action |= CURL_CSELECT_ERR;
 		}
-		else if (!response->running)
+		else if (!(watch->action & (action == CURL_CSELECT_IN ? CURL_POLL_IN
+		                                                      : CURL_POLL_OUT)))
 		{
-			ETC_LOG.error(self, "Ignoring", op, "event since the response of",
-			              easy_handle, "has been stopped");
+			ETC_LOG.debug(self, "Ignore readiness of", op, "op on", fd);
 			return;
 		}
 
-		ETC_TRACE.debug(self, "Detected readiness of", op, " op on", easy_handle);
-		int running_handles;
+		ETC_TRACE.debug(self, "Detected readiness of", op, " op on", fd);
 		::curl_multi_socket_action(
 			self.multi_handle,
-			self.sockets.at(easy_handle).native_handle(),
+			fd,
 			action,
-			&running_handles
+			&self.running_handles
 		);
-		ETC_LOG.debug(self, "Still", running_handles, "after", op, "op");
+		ETC_LOG.debug(self, "Still", self.running_handles, "after", op, "op");
 		self._check_multi_info();
-		ETC_LOG.debug(self, "Still", running_handles, "after checking info");
-		if (self.sockets.find(easy_handle) != self.sockets.end())
-		{
-			if (action == CURL_CSELECT_IN)
-				self.setup_read_check(easy_handle);
-			else if (action == CURL_CSELECT_OUT)
-				self.setup_write_check(easy_handle);
-			else
-				ETC_ERROR("Wrong action value");
-		}
+		// Wait again if cURL still wants to.
+		if (watch->socket.is_open())
+			self.watch(fd, watch->action);
 	}
 
-	void Client::Impl::setup_read_check(CURL* easy_handle)
+	void Client::Impl::setup_read_check(std::shared_ptr<Watch> const& watch)
 	{
-		ETC_TRACE.debug(*this, "Wait for readiness of read op on easy handle", easy_handle);
-		boost::asio::async_read(
-			this->sockets.at(easy_handle),
+		ETC_TRACE.debug(*this, "Wait for readiness of read op on",
+		                watch->socket.native_handle());
+		watch->reading = true;
+		watch->socket.async_read_some(
 			boost::asio::null_buffers(),
 			std::bind(
 				&on_event,
 				std::ref(*this),
-				this->responses.at(easy_handle),
-				easy_handle,
+				watch,
 				CURL_CSELECT_IN,
 				std::placeholders::_1,
 				std::placeholders::_2
@@ -207,17 +198,17 @@ namespace etc { namespace http {
 		);
 	}
 
-	void Client::Impl::setup_write_check(CURL* easy_handle)
+	void Client::Impl::setup_write_check(std::shared_ptr<Watch> const& watch)
 	{
-		ETC_TRACE.debug(*this, "Wait for readiness of write op on easy handle", easy_handle);
-		boost::asio::async_write(
-			this->sockets.at(easy_handle),
+		ETC_TRACE.debug(*this, "Wait for readiness of write op on",
+		                watch->socket.native_handle());
+		watch->writing = true;
+		watch->socket.async_write_some(
 			boost::asio::null_buffers(),
 			std::bind(
 				&on_event,
 				std::ref(*this),
-				this->responses.at(easy_handle),
-				easy_handle,
+				watch,
 				CURL_CSELECT_OUT,
 				std::placeholders::_1,
 				std::placeholders::_2
@@ -235,7 +226,7 @@ namespace etc { namespace http {
 			              "with code", msg->data.result, "and data",
 			              msg->data.whatever);
 			if (msg->msg == CURLMSG_DONE)
-				this->remove_handle(msg->easy_handle);
+				this->remove_handle(msg->easy_handle, msg->data.result);
 		}
 	}
 
@@ -253,53 +244,52 @@ namespace etc { namespace http {
 			(action == CURL_POLL_INOUT ? "INOUT" :
 			(action == CURL_POLL_REMOVE ? "REMOVE" : "UNKNOWN")))))
 		);
-		ETC_TRACE.debug(self, "Setup socket of easy handle", easy_handle,
+		ETC_TRACE.debug(self, "Setup socket", s, "of easy handle", easy_handle,
 		                "for", action_string);
-		switch (action)
-		{
-		case CURL_POLL_NONE: // register, not interested in readiness (yet)
-			self->setup_handle(easy_handle, s);
-			break;
-
-		case CURL_POLL_IN: // register, interested in read readiness
-			self->setup_handle(easy_handle, s);
-			self->setup_read_check(easy_handle);
-			break;
-
-		case CURL_POLL_OUT: // register, interested in write readiness
-			self->setup_handle(easy_handle, s);
-			self->setup_write_check(easy_handle);
-			break;
-
-		case CURL_POLL_INOUT: //register, interested in both read and write readiness
-			self->setup_handle(easy_handle, s);
-			self->setup_read_check(easy_handle);
-			self->setup_write_check(easy_handle);
-			break;
-
-		case CURL_POLL_REMOVE: // unregister
-			if (auto res =
-					[=] () -> boost::asio::ip::tcp::socket* {
-						try { return &self->sockets.at(easy_handle); }
-						catch (...) { return nullptr; }
-					}())
-			{
-				ETC_LOG.debug(self, "Shutting down socket of easy handle",
-				              easy_handle);
-				boost::system::error_code ec;
-				//res->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
-				res->cancel();
-				//res->set_option
-				self->sockets.erase(easy_handle);
-			}
-			break;
+		self->watch(s, action);
+		return 0;
+	}
 
-		default:
-			// XXX
-			break;
+	curl_socket_t
+	Client::Impl::_open_socket_callback(void* clientp,
+	                                    curlsocktype purpose,
+	                                    struct curl_sockaddr* address)
+	{
+		auto self = (Impl*) clientp;
+		if (purpose != CURLSOCKTYPE_IPCXN || address->socktype != SOCK_STREAM)
+			return CURL_SOCKET_BAD;
+		auto watch = std::make_shared<Watch>(self->sched.impl().service);
+		boost::system::error_code ec;
+		watch->socket.open(
+			address->family == AF_INET6 ? boost::asio::ip::tcp::v6()
+			                            : boost::asio::ip::tcp::v4(),
+			ec
+		);
+		if (ec)
+		{
+			ETC_LOG.error(*self, "Couldn't open a socket:", ec.message());
+			return CURL_SOCKET_BAD;
 		}
+		curl_socket_t fd = watch->socket.native_handle();
+		ETC_LOG.debug(*self, "Opened socket", fd);
+		self->sockets[fd] = std::move(watch);
+		return fd;
+	}
 
-		return 0;
+	int Client::Impl::_close_socket_callback(void* clientp, curl_socket_t fd)
+	{
+		auto self = (Impl*) clientp;
+		auto it = self->sockets.find(fd);
+		if (it == self->sockets.end())
+		{
+			ETC_LOG.warn(*self, "Cannot close the unknown socket", fd);
+			return 1;
+		}
+		ETC_LOG.debug(*self, "Closing socket", fd);
+		boost::system::error_code ec;
+		it->second->socket.close(ec);
+		self->sockets.erase(it);
+		return ec ? 1 : 0;
 	}
 
 	int Client::Impl::_timer_callback(CURLM* multi /* multi handle */ ,
@@ -307,10 +297,9 @@ namespace etc { namespace http {
 	                                  void* userp /* TIMERDATA */ )
 	{
 		auto self = (Impl*) userp;
-		if (timeout_ms <= 0)
+		if (timeout_ms < 0)
 		{
-			ETC_LOG.warn(*self, "Ignore setup timer for multi handle",
-			             multi, "with", timeout_ms, "ms");
+			ETC_LOG.debug(*self, "Ignore timer removal for multi handle", multi);
 			return 0;
 		}
 
@@ -326,7 +315,12 @@ namespace etc { namespace http {
 			[=] (boost::system::error_code const& ec) {
 				auto cpy = timer;
 				self->timers.erase(cpy.get());
-				if (ec)
+				if (ec == boost::asio::error::operation_aborted)
+				{
+					ETC_LOG.debug("Timer cancelled");
+					return;
+				}
+				else if (ec)
 				{
 					ETC_LOG.error("Timer got an error", ec, ec.message());
 					return;
@@ -9,6 +9,8 @@
 
 # include <curl/curl.h>
 
+# include <boost/asio/deadline_timer.hpp>
+# include <boost/asio/io_service.hpp>
 # include <boost/asio/ip/tcp.hpp>
 
 # include <map>
@@ -20,11 +22,31 @@ namespace etc { namespace http {
 	{
 		ETC_LOG_COMPONENT("etc.http.ClientImpl");
 
+		/// A connection opened for cURL, and the readiness it waits for.
+		struct Watch
+		{
+			boost::asio::ip::tcp::socket socket;
+			/// Last CURL_POLL_* action requested.
+			int action;
+			/// Pending readiness checks.
+			bool reading;
+			bool writing;
+
+			explicit
+			Watch(boost::asio::io_service& service)
+				: socket{service}
+				, action{CURL_POLL_NONE}
+				, reading{false}
+				, writing{false}
+			{}
+		};
+
 		std::string const server;
 		uint16_t const port;
 		scheduler::Scheduler& sched;
 		CURLM* multi_handle;
-		std::map<CURL*, boost::asio::ip::tcp::socket> sockets;
+		/// Connections open, kept alive by cURL between transfers.
+		std::map<curl_socket_t, std::shared_ptr<Watch>> sockets;
 		std::map<CURL*, std::shared_ptr<Response::Impl>> responses;
 		std::set<boost::asio::deadline_timer*> timers;
 		int running_handles;
@@ -35,11 +57,14 @@ namespace etc { namespace http {
 
 		void add_handle(std::shared_ptr<Response::Impl>& response);
 
-		void setup_handle(CURL* easy_handle, curl_socket_t fd);
-		void remove_handle(CURL* easy_handle);
+		/// Forget the handle of a transfer done with @a result.
+		void remove_handle(CURL* easy_handle, CURLcode const result);
 
-		void setup_read_check(CURL* easy_handle);
-		void setup_write_check(CURL* easy_handle);
+		/// Wait for the readiness of @a fd requested by @a action.
+		void watch(curl_socket_t fd, int action);
+
+		void setup_read_check(std::shared_ptr<Watch> const& watch);
+		void setup_write_check(std::shared_ptr<Watch> const& watch);
 
 		void _check_multi_info();
 
@@ -50,6 +75,14 @@ namespace etc { namespace http {
 		                     void *userp,    /* private callback pointer */
 		                     void *socketp);
 
+		static
+		curl_socket_t _open_socket_callback(void* clientp,
+		                                    curlsocktype purpose,
+		                                    struct curl_sockaddr* address);
+
+		static
+		int _close_socket_callback(void* clientp, curl_socket_t fd);
+
 		static
 		int _timer_callback(CURLM* multi /* multi handle */ ,
 		                    long timeout_ms /* timeout in milliseconds */ ,
@@ -9,6 +9,8 @@
 #include <boost/iostreams/concepts.hpp>
 #include <boost/iostreams/stream.hpp>
 
+#include <ostream>
+
 #ifdef min
 # undef min
 #endif
@@ -31,26 +33,19 @@ namespace etc { namespace http {
 	ResponseCode Response::code()
 	{
 		ETC_TRACE.debug(*this, "Fetching response code");
-
-		// XXX curl_easy_getinfo does not work for transfer in-progress ...
-		while (true)
+		_this->wait_for([&] { return _this->headers_done; });
+		if (!_this->headers_done)
 		{
-			long http_code;
-			CURLcode ret = curl_easy_getinfo(_this->easy_handle,
-			                                  CURLINFO_RESPONSE_CODE,
-			                                  &http_code);
-			if (ret == CURLE_OK && http_code != 0)
-			{
-				ETC_LOG.debug("Got response code", http_code);
-				return (ResponseCode) http_code;
-			}
-			if (!_this->running)
-				throw exception::Exception{"Couldn't retreive HTTP code"};
-
-			ETC_LOG.debug(*this, "Couldn't get the response code, yield");
-			// Try again while we're running, let curl do its job.
-			_this->client.impl().sched.context().yield();
+			_this->check();
+			throw exception::Exception{"Couldn't retreive HTTP code"};
 		}
+		return _this->code;
+	}
+
+	Response::headers_map const& Response::headers()
+	{
+		this->code();
+		return _this->headers;
 	}
 
 	std::string Response::read(size_t size)
@@ -60,41 +55,24 @@ namespace etc { namespace http {
 			size == 0 ? "until the end": "up to " + std::to_string(size) + "bytes"
 		);
 		std::string res;
-		auto& ctx = scheduler::current().context();
-		if (_this->context != nullptr)
-			throw exception::Exception{"Somedy already reading this response"};
-		_this->context = &ctx;
-		ETC_SCOPE_EXIT{ _this->context = nullptr; };
-		while (true)
-		{
-			if (_this->in_data.empty())
-			{
-				ETC_TRACE.debug("Nothing to read, going to sleep");
-				scheduler::current().impl().freeze(ctx);
-				ctx.yield();
-			}
-			if (size != 0)
-			{
-				size_t to_copy = std::min(_this->in_data.size(), size - res.size());
-				ETC_LOG.debug(*this, "Copying", to_copy, "bytes");
-				res.append(_this->in_data.substr(0, to_copy));
-				_this->in_data = _this->in_data.substr(to_copy, std::string::npos);
-			}
-			else
-			{
-				ETC_LOG.debug(*this, "Copying", _this->in_data.size(), "bytes");
-				res.append(_this->in_data);
-				_this->in_data.clear();
-			}
-			if (_this->running == false || (size != 0 && res.size() == size))
-			{
-				ETC_LOG.debug("Read terminated with", res.size(), "bytes");
-				break;
-			}
-		}
+		_this->read(size, [&] (char const* data, etc::size_type size) {
+			res.append(data, size);
+		});
+		ETC_LOG.debug("Read terminated with", res.size(), "bytes");
 		return res;
 	}
 
+	etc::size_type Response::read_to(sink_type const& sink)
+	{ return _this->read(0, sink); }
+
+	etc::size_type Response::read_to(std::ostream& out)
+	{
+		return _this->read(0, [&] (char const* data, etc::size_type size) {
+			if (!out.write(data, size))
+				throw exception::Exception{"Couldn't write the response body"};
+		});
+	}
+
 	//namespace {
 
 	//	struct ResponseBody
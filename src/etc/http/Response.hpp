@@ -3,8 +3,12 @@
 
 # include "fwd.hpp"
 
-# include <memory>
+# include <etc/types.hpp>
+
+# include <functional>
 # include <iosfwd>
+# include <map>
+# include <memory>
 
 namespace etc { namespace http {
 
@@ -12,6 +16,8 @@ namespace etc { namespace http {
 	{
 	public:
 		struct Impl;
+		typedef std::map<std::string, std::string> headers_map;
+		typedef std::function<void(char const*, etc::size_type)> sink_type;
 
 	public:
 		Response(std::shared_ptr<Impl> impl);
@@ -20,7 +26,22 @@ namespace etc { namespace http {
 
 	public:
 		ResponseCode code();
+
+		/// Headers of the response, with lower case names.
+		headers_map const& headers();
+
 		std::string read(size_t size = 0);
+
+		/**
+		 * @brief Give the body to @a sink as it arrives.
+		 *
+		 * Only a bounded amount of data is buffered, the transfer is paused
+		 * while the reader lags behind. Returns the size of the body.
+		 */
+		etc::size_type read_to(sink_type const& sink);
+
+		/// Write the body into @a out.
+		etc::size_type read_to(std::ostream& out);
 		//std::istream& body();
 
 	private:
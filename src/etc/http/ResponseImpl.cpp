@@ -6,15 +6,29 @@
 #include <etc/scheduler/SchedulerImpl.hpp>
 #include <etc/scope_exit.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
 namespace etc { namespace http {
 
 	ETC_LOG_COMPONENT("etc.http.Response");
 
+	etc::size_type const Response::Impl::max_buffered_size;
+
 	Response::Impl::Impl(Client& client, Request request)
 		: client(client)
 		, request(std::move(request))
 		, easy_handle{::curl_easy_init()}
+		, header_list{nullptr}
 		, running{true}
+		, paused{false}
+		, waiting{false}
+		, result{CURLE_OK}
+		, code{ResponseCode::_max_value}
+		, headers{}
+		, headers_done{false}
+		, in_data{}
 		, context{nullptr}
 	{
 		ETC_TRACE_CTOR();
@@ -25,11 +39,18 @@ namespace etc { namespace http {
 		_setopt(CURLOPT_DEBUGFUNCTION, &_debug_callback);
 		_setopt(CURLOPT_DEBUGDATA, this);
 		_setopt(CURLOPT_NOSIGNAL, 1);
-		_setopt(CURLOPT_TIMEOUT, 10);
+		// Large downloads may take long, only give up on stalled ones.
+		_setopt(CURLOPT_CONNECTTIMEOUT, 10);
+		_setopt(CURLOPT_LOW_SPEED_LIMIT, 1);
+		_setopt(CURLOPT_LOW_SPEED_TIME, 30);
+		_setopt(CURLOPT_TCP_KEEPALIVE, 1);
 
 		// Prevent a throwing constructor to let the easy handle alive.
 		auto handle_guard = etc::scope_exit(
-			[this] { ::curl_easy_cleanup(this->easy_handle); }
+			[this] {
+				::curl_slist_free_all(this->header_list);
+				::curl_easy_cleanup(this->easy_handle);
+			}
 		);
 
 		ETC_LOG.debug(*this, "Set HTTP method to", this->request.method());
@@ -95,18 +116,16 @@ namespace etc { namespace http {
 			_setopt(CURLOPT_URL, uri.c_str());
 		}
 
-		// headers
+		// headers, the list is used until the end of the transfer
 		{
-			struct curl_slist* headers = nullptr;
-			// XXX Should we keep the list alive ?
-			ETC_SCOPE_EXIT{ ::curl_slist_free_all(headers); };
 			for (auto header: this->request.headers())
 			{
 				auto line = header.first + ": " + header.second;
 				ETC_LOG.debug(*this, "Add header", line);
-				headers = ::curl_slist_append(headers, line.c_str());
+				this->header_list = ::curl_slist_append(this->header_list,
+				                                        line.c_str());
 			}
-			_setopt(CURLOPT_HTTPHEADER, headers);
+			_setopt(CURLOPT_HTTPHEADER, this->header_list);
 		}
 
 		// Callbacks
@@ -114,6 +133,11 @@ namespace etc { namespace http {
 		_setopt(CURLOPT_WRITEDATA, this);
 		_setopt(CURLOPT_HEADERFUNCTION, &_header_callback);
 		_setopt(CURLOPT_HEADERDATA, this);
+		// Connections are owned by the client, and reused.
+		_setopt(CURLOPT_OPENSOCKETFUNCTION, &Client::Impl::_open_socket_callback);
+		_setopt(CURLOPT_OPENSOCKETDATA, &this->client.impl());
+		_setopt(CURLOPT_CLOSESOCKETFUNCTION, &Client::Impl::_close_socket_callback);
+		_setopt(CURLOPT_CLOSESOCKETDATA, &this->client.impl());
 		if (::curl_multi_add_handle(this->client.impl().multi_handle,
 		                            this->easy_handle) != CURLM_OK)
 			throw exception::Exception{"Couldn't register the easy handle"};
@@ -126,6 +150,72 @@ namespace etc { namespace http {
 		ETC_TRACE.debug(*this, "Removing easy handle", easy_handle, "from cURL");
 		::curl_multi_remove_handle(this->client.impl().multi_handle, easy_handle);
 		::curl_easy_cleanup(this->easy_handle);
+		::curl_slist_free_all(this->header_list);
+	}
+
+	void Response::Impl::notify()
+	{
+		if (!this->waiting)
+			return;
+		this->waiting = false;
+		this->client.impl().sched.impl().wakeup(*this->context);
+	}
+
+	void Response::Impl::finish(CURLcode const result)
+	{
+		ETC_LOG.debug(*this, "Transfer done:", ::curl_easy_strerror(result));
+		this->running = false;
+		this->result = result;
+		this->notify();
+	}
+
+	etc::size_type Response::Impl::read(etc::size_type const limit,
+	                                    sink_type const& sink)
+	{
+		etc::size_type res = 0;
+		while (limit == 0 || res < limit)
+		{
+			this->wait_for([&] { return !this->in_data.empty(); });
+			if (this->in_data.empty())
+			{
+				this->check();
+				break;
+			}
+			etc::size_type size = this->in_data.size();
+			if (limit != 0)
+				size = std::min(size, limit - res);
+			ETC_LOG.debug(*this, "Copying", size, "bytes");
+			sink(this->in_data.data(), size);
+			this->in_data.erase(0, size);
+			res += size;
+			this->_resume();
+		}
+		return res;
+	}
+
+	void Response::Impl::check() const
+	{
+		if (this->result != CURLE_OK)
+			throw exception::Exception{
+				"HTTP transfer failed: " +
+				std::string{::curl_easy_strerror(this->result)}
+			};
+	}
+
+	void Response::Impl::_freeze_and_yield()
+	{
+		auto& sched = this->client.impl().sched.impl();
+		sched.freeze(*this->context);
+		this->context->yield();
+	}
+
+	void Response::Impl::_resume()
+	{
+		if (!this->paused || this->in_data.size() >= max_buffered_size)
+			return;
+		ETC_LOG.debug(*this, "Resume the transfer");
+		this->paused = false;
+		::curl_easy_pause(this->easy_handle, CURLPAUSE_CONT);
 	}
 
 	size_t Response::Impl::_header_callback(void* data,
@@ -135,7 +225,43 @@ namespace etc { namespace http {
 	{
 		Impl& self = *(Impl*) userdata;
 		ETC_LOG.debug(self, "Received", chunk_size * count, "bytes of headers");
-		// XXX Parse response code here
+		std::string line{static_cast<char const*>(data), chunk_size * count};
+		while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+			line.pop_back();
+		if (line.compare(0, 5, "HTTP/") == 0)
+		{
+			// A new response (after an interim one).
+			self.headers.clear();
+			self.headers_done = false;
+			auto space = line.find(' ');
+			self.code = static_cast<ResponseCode>(
+				space == std::string::npos ? 0 : std::atoi(line.c_str() + space + 1)
+			);
+		}
+		else if (line.empty())
+		{
+			if (static_cast<int>(self.code) >= 200)
+			{
+				self.headers_done = true;
+				self.notify();
+			}
+		}
+		else
+		{
+			auto colon = line.find(':');
+			if (colon != std::string::npos)
+			{
+				std::string name = line.substr(0, colon);
+				for (char& c: name)
+					c = std::tolower(static_cast<unsigned char>(c));
+				auto begin = line.find_first_not_of(" \t", colon + 1);
+				std::string value = (
+					begin == std::string::npos ? "" : line.substr(begin)
+				);
+				std::string& header = self.headers[name];
+				header = header.empty() ? value : header + ", " + value;
+			}
+		}
 		return chunk_size * count;
 	}
 
@@ -146,15 +272,15 @@ namespace etc { namespace http {
 	{
 		Impl& self = *(Impl*) userdata;
 		ETC_TRACE.debug(self, "Got", count * chunk_size, "bytes");
-		if (self.context != nullptr)
-		{
-			self.in_data.append(data, chunk_size * count);
-			self.client.impl().sched.impl().wakeup(*self.context);
-		}
-		else
+		if (self.in_data.size() >= max_buffered_size)
 		{
-			ETC_LOG.warn(self, "Nobody is awaiting for data, dropping it");
+			// Delivered again once resumed.
+			ETC_LOG.debug(self, "Pause the transfer");
+			self.paused = true;
+			return CURL_WRITEFUNC_PAUSE;
 		}
+		self.in_data.append(data, chunk_size * count);
+		self.notify();
 		return chunk_size * count; // bytes actually taken care of.
 	}
 
@@ -6,7 +6,8 @@
 # include "Response.hpp"
 
 # include <etc/exception.hpp>
-# include <etc/scheduler/fwd.hpp>
+# include <etc/scheduler.hpp>
+# include <etc/scope_exit.hpp>
 
 # include <curl/curl.h>
 
@@ -14,16 +15,63 @@ namespace etc { namespace http {
 
 	struct Response::Impl
 	{
+		/// Bytes buffered before pausing the transfer.
+		static etc::size_type const max_buffered_size = 1024 * 1024;
+
 		Client& client;
 		Request request;
 		CURL* easy_handle;
+		struct curl_slist* header_list;
 		bool running;
+		/// The transfer waits for the reader to consume in_data.
+		bool paused;
+		/// The reader context is frozen until new data or the end.
+		bool waiting;
+		CURLcode result;
+		ResponseCode code;
+		headers_map headers;
+		bool headers_done;
 		std::string in_data;
 		scheduler::Context* context;
 
 		Impl(Client& client, Request request);
 		~Impl();
 
+		/// Yield until @a ready returns true or the transfer ends.
+		template<typename Predicate>
+		void wait_for(Predicate ready)
+		{
+			if (this->context != nullptr)
+				throw exception::Exception{"Somebody is already reading this response"};
+			this->context = &scheduler::current().context();
+			ETC_SCOPE_EXIT{ this->context = nullptr; };
+			while (this->running && !ready())
+			{
+				this->waiting = true;
+				this->_freeze_and_yield();
+				this->waiting = false;
+			}
+		}
+
+		/// Wake up the waiting reader.
+		void notify();
+
+		/// Mark the transfer as done with @a result.
+		void finish(CURLcode const result);
+
+		/// Give @a limit bytes (or everything when 0) to @a sink as they
+		/// arrive, returns the number of bytes read.
+		etc::size_type read(etc::size_type const limit,
+		                    sink_type const& sink);
+
+		/// Throw if the transfer failed.
+		void check() const;
+
+	private:
+		void _freeze_and_yield();
+		void _resume();
+
+	public:
 		static
 		size_t _header_callback(void* data,
 		                        size_t chunk_size,
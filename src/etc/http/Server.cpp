@@ -0,0 +1,1200 @@
+#include "Server.hpp"
+
+#include <etc/exception.hpp>
+#include <etc/log.hpp>
+#include <etc/network/Buffer.hpp>
+#include <etc/network/Exception.hpp>
+#include <etc/network/Socket.hpp>
+#include <etc/scheduler/Context.hpp>
+#include <etc/scheduler/TaskGroup.hpp>
+#include <etc/temp/File.hpp>
+#include <etc/test.hpp>
+
+#include <wrappers/boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace etc { namespace http {
+
+	ETC_LOG_COMPONENT("etc.http.Server");
+
+	using exception::Exception;
+
+	namespace {
+
+		// Longest accepted request head.
+		etc::size_type const max_head_size = 64 * 1024;
+
+		// Longest accepted request body.
+		etc::size_type const max_body_size = 16 * 1024 * 1024;
+
+		// Replies of a pipeline buffered before being written.
+		etc::size_type const max_pipeline_output = 64 * 1024;
+
+		enum { reply_pending, reply_chunked, reply_done };
+
+		/// Malformed or unsupported request, answered before closing.
+		class RequestError
+			: public Exception
+		{
+		public:
+			ResponseCode const code;
+
+		public:
+			RequestError(ResponseCode const code, std::string const& msg)
+				: Exception{msg}
+				, code{code}
+			{}
+		};
+
+		std::string lower(std::string str)
+		{
+			for (char& c: str)
+				c = std::tolower(static_cast<unsigned char>(c));
+			return str;
+		}
+
+		std::string trim(std::string const& str)
+		{
+			auto begin = str.find_first_not_of(" \t");
+			if (begin == std::string::npos)
+				return std::string{};
+			auto end = str.find_last_not_of(" \t");
+			return str.substr(begin, end - begin + 1);
+		}
+
+		bool parse_number(std::string const& str, uint64_t& res)
+		{
+			if (str.empty() || str.size() > 18 ||
+			    str.find_first_not_of("0123456789") != std::string::npos)
+				return false;
+			res = std::strtoull(str.c_str(), nullptr, 10);
+			return true;
+		}
+
+		int hex_digit(char const c)
+		{
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+			return -1;
+		}
+
+		/// Decode the %XX escapes, and the '+' of a query.
+		std::string url_decode(std::string const& str, bool const query)
+		{
+			std::string res;
+			res.reserve(str.size());
+			for (etc::size_type i = 0; i < str.size(); ++i)
+			{
+				if (str[i] == '%')
+				{
+					int high = i + 2 < str.size() ? hex_digit(str[i + 1]) : -1;
+					int low = high >= 0 ? hex_digit(str[i + 2]) : -1;
+					if (low < 0)
+						throw RequestError{
+							ResponseCode::bad_request, "Invalid escape in " + str
+						};
+					res.push_back(static_cast<char>(high * 16 + low));
+					i += 2;
+				}
+				else if (query && str[i] == '+')
+					res.push_back(' ');
+				else
+					res.push_back(str[i]);
+			}
+			return res;
+		}
+
+		void parse_query(std::string const& query,
+		                 Request::parameters_map& parameters)
+		{
+			etc::size_type begin = 0;
+			while (begin <= query.size())
+			{
+				auto end = std::min(query.find('&', begin), query.size());
+				std::string item = query.substr(begin, end - begin);
+				if (!item.empty())
+				{
+					auto eq = item.find('=');
+					std::string value;
+					if (eq != std::string::npos)
+						value = url_decode(item.substr(eq + 1), true);
+					parameters[url_decode(item.substr(0, eq), true)] = value;
+				}
+				begin = end + 1;
+			}
+		}
+
+		Method parse_method(std::string const& str)
+		{
+			if (str == "GET") return Method::get;
+			if (str == "HEAD") return Method::head;
+			if (str == "POST") return Method::post;
+			if (str == "PUT") return Method::put;
+			if (str == "DELETE") return Method::delete_;
+			throw RequestError{
+				ResponseCode::not_implemented, "Unsupported method " + str
+			};
+		}
+
+		/// Normalized route prefix, starting with a '/' and without a
+		/// trailing one.
+		std::string route_prefix(std::string prefix)
+		{
+			if (prefix.empty() || prefix[0] != '/')
+				prefix = "/" + prefix;
+			while (prefix.size() > 1 && prefix.back() == '/')
+				prefix.pop_back();
+			return prefix;
+		}
+
+		std::string content_type(std::string const& extension)
+		{
+			std::string ext = lower(extension);
+			if (ext == ".html" || ext == ".htm") return "text/html";
+			if (ext == ".css") return "text/css";
+			if (ext == ".js") return "application/javascript";
+			if (ext == ".json") return "application/json";
+			if (ext == ".txt") return "text/plain";
+			if (ext == ".xml") return "application/xml";
+			if (ext == ".png") return "image/png";
+			if (ext == ".jpg" || ext == ".jpeg") return "image/jpeg";
+			if (ext == ".gif") return "image/gif";
+			if (ext == ".svg") return "image/svg+xml";
+			if (ext == ".ico") return "image/x-icon";
+			if (ext == ".wasm") return "application/wasm";
+			return "application/octet-stream";
+		}
+
+		/**
+		 * Parse a single byte range of a file of @a size bytes.
+		 *
+		 * Returns 1 when satisfiable, -1 when not, and 0 when the range is
+		 * to be ignored (other units, several ranges or invalid syntax).
+		 */
+		int parse_range(std::string const& value,
+		                uint64_t const size,
+		                uint64_t& offset,
+		                uint64_t& length)
+		{
+			if (value.compare(0, 6, "bytes=") != 0)
+				return 0;
+			std::string spec = value.substr(6);
+			auto dash = spec.find('-');
+			if (dash == std::string::npos || spec.find(',') != std::string::npos)
+				return 0;
+			std::string first = trim(spec.substr(0, dash));
+			std::string last = trim(spec.substr(dash + 1));
+			uint64_t begin, end;
+			if (first.empty())
+			{
+				// The last bytes of the file.
+				if (!parse_number(last, end))
+					return 0;
+				if (end == 0 || size == 0)
+					return -1;
+				length = std::min(end, size);
+				offset = size - length;
+				return 1;
+			}
+			if (!parse_number(first, begin))
+				return 0;
+			if (begin >= size)
+				return -1;
+			if (last.empty())
+				end = size - 1;
+			else if (!parse_number(last, end) || end < begin)
+				return 0;
+			end = std::min(end, size - 1);
+			offset = begin;
+			length = end - begin + 1;
+			return 1;
+		}
+
+	} // !anonymous
+
+	struct Server::Connection
+	{
+		network::Socket socket;
+		network::Buffer buffer;
+		/// Received bytes not handled yet.
+		std::string     input;
+		/// Replies waiting for the end of a pipeline.
+		std::string     output;
+		bool            http11;
+		bool            keep_alive;
+		/// The next request is received already.
+		bool            pipelined;
+
+		explicit
+		Connection(network::Socket socket)
+			: socket{std::move(socket)}
+			, buffer{network::BufferPool::default_pool().get(16 * 1024)}
+			, input{}
+			, output{}
+			, http11{true}
+			, keep_alive{true}
+			, pipelined{false}
+		{}
+
+		/// Read available bytes, false at the end of the stream.
+		bool read_more()
+		{
+			auto size = this->socket.read_some(
+				network::MutableBuffer{this->buffer.data(), this->buffer.size()}
+			);
+			this->input.append(this->buffer.data(), size);
+			return size > 0;
+		}
+
+		/// Read the next request, false when the peer closed the connection.
+		bool read_request(Request& request)
+		{
+			etc::size_type end, from = 0;
+			while (true)
+			{
+				// Empty lines may precede a request.
+				etc::size_type start = this->input.find_first_not_of("\r\n");
+				if (start != 0)
+				{
+					this->input.erase(0, start);
+					from = 0;
+				}
+				end = this->input.find("\r\n\r\n", from);
+				if (end != std::string::npos)
+					break;
+				if (this->input.size() > max_head_size)
+					throw RequestError{
+						ResponseCode::bad_request, "Request head too large"
+					};
+				from = std::max<etc::size_type>(this->input.size(), 3) - 3;
+				if (!this->read_more())
+					return false;
+			}
+
+			etc::size_type pos = this->input.find("\r\n");
+			std::string line = this->input.substr(0, pos);
+			auto first = line.find(' ');
+			auto last = line.rfind(' ');
+			if (first == std::string::npos || first == last)
+				throw RequestError{
+					ResponseCode::bad_request, "Invalid request line"
+				};
+			std::string version = line.substr(last + 1);
+			if (version != "HTTP/1.1" && version != "HTTP/1.0")
+				throw RequestError{
+					ResponseCode::bad_request, "Unsupported version " + version
+				};
+			request.method(parse_method(line.substr(0, first)));
+			std::string target = line.substr(first + 1, last - first - 1);
+			auto query = target.find('?');
+			request.url(url_decode(target.substr(0, query), false));
+			if (query != std::string::npos)
+				parse_query(target.substr(query + 1), request.parameters());
+
+			auto& headers = request.headers();
+			while (pos < end)
+			{
+				auto next = this->input.find("\r\n", pos + 2);
+				line = this->input.substr(pos + 2, next - pos - 2);
+				auto colon = line.find(':');
+				if (colon == std::string::npos || colon == 0)
+					throw RequestError{ResponseCode::bad_request, "Invalid header"};
+				std::string value = trim(line.substr(colon + 1));
+				std::string& header = headers[lower(line.substr(0, colon))];
+				header = header.empty() ? value : header + ", " + value;
+				pos = next;
+			}
+			this->input.erase(0, end + 4);
+
+			auto it = headers.find("connection");
+			std::string connection = it == headers.end() ? "" : lower(it->second);
+			this->http11 = (version == "HTTP/1.1");
+			if (this->http11)
+				this->keep_alive = connection.find("close") == std::string::npos;
+			else
+				this->keep_alive = connection.find("keep-alive") != std::string::npos;
+
+			if (headers.count("transfer-encoding"))
+				throw RequestError{
+					ResponseCode::not_implemented,
+					"Chunked request bodies are not supported"
+				};
+			it = headers.find("content-length");
+			if (it != headers.end())
+			{
+				uint64_t length;
+				if (!parse_number(it->second, length))
+					throw RequestError{
+						ResponseCode::bad_request, "Invalid Content-Length"
+					};
+				if (length > max_body_size)
+					throw RequestError{
+						ResponseCode::payload_too_large, "Request body too large"
+					};
+				while (this->input.size() < length)
+					if (!this->read_more())
+						return false;
+				request.body(this->input.substr(0, length));
+				this->input.erase(0, length);
+			}
+			this->pipelined = this->input.find("\r\n\r\n") != std::string::npos;
+			ETC_LOG.debug("Request", request.method(), request.url(),
+			              (this->pipelined ? "(pipelined)" : ""));
+			return true;
+		}
+
+		/// Send @a buffers, or keep them until the end of the pipeline.
+		void send(network::ConstBuffer const* buffers, etc::size_type const count)
+		{
+			etc::size_type size = 0;
+			for (etc::size_type i = 0; i < count; ++i)
+				size += buffers[i].size;
+			if (this->pipelined &&
+			    this->output.size() + size < max_pipeline_output)
+			{
+				for (etc::size_type i = 0; i < count; ++i)
+					this->output.append(
+						static_cast<char const*>(buffers[i].data),
+						buffers[i].size
+					);
+				return;
+			}
+			if (this->output.empty())
+			{
+				this->socket.write(buffers, count);
+				return;
+			}
+			std::vector<network::ConstBuffer> all;
+			all.reserve(count + 1);
+			all.push_back(network::ConstBuffer{
+				this->output.data(), this->output.size()
+			});
+			all.insert(all.end(), buffers, buffers + count);
+			this->socket.write(all.data(), all.size());
+			this->output.clear();
+		}
+
+		void flush()
+		{
+			if (this->output.empty())
+				return;
+			this->socket.write(this->output);
+			this->output.clear();
+		}
+	};
+
+	struct Server::Impl
+	{
+		struct Route
+		{
+			std::string  prefix;
+			handler_type handler;
+		};
+
+		scheduler::Scheduler& sched;
+		network::Socket       acceptor;
+		std::vector<Route>    routes;
+		clock_type::duration  keep_alive_timeout;
+		std::mutex            mutex;
+		std::set<Connection*> connections;
+		bool                  stopped;
+
+		explicit
+		Impl(scheduler::Scheduler& sched)
+			: sched(sched)
+			, acceptor{network::config_tcp_accept, &sched}
+			, routes{}
+			, keep_alive_timeout{std::chrono::seconds(30)}
+			, mutex{}
+			, connections{}
+			, stopped{false}
+		{}
+
+		/// Route with the longest prefix matching @a path.
+		Route const* find(std::string const& path) const
+		{
+			Route const* res = nullptr;
+			for (auto& route: this->routes)
+			{
+				auto const& prefix = route.prefix;
+				if (path.compare(0, prefix.size(), prefix) != 0)
+					continue;
+				if (path.size() != prefix.size() && prefix.back() != '/' &&
+				    path[prefix.size()] != '/')
+					continue;
+				if (res == nullptr || prefix.size() > res->prefix.size())
+					res = &route;
+			}
+			return res;
+		}
+
+		void dispatch(Connection& connection, Request const& request)
+		{
+			Route const* route = this->find(request.url());
+			{
+				Reply reply{connection, request};
+				if (route == nullptr)
+				{
+					reply.status(ResponseCode::not_found)
+						.header("Content-Type", "text/plain")
+						.send("Not found\n");
+					return;
+				}
+				try
+				{
+					route->handler(request, reply);
+					reply.end();
+					return;
+				}
+				catch (...)
+				{
+					ETC_LOG.error("Handler of", request.url(), "failed:",
+					              exception::string());
+					// The connection is closed when the reply is incomplete.
+					if (reply.started())
+						throw;
+				}
+			}
+			Reply reply{connection, request};
+			reply.status(ResponseCode::internal_server_error)
+				.header("Content-Type", "text/plain")
+				.send("Internal server error\n");
+		}
+
+		void serve(Connection& connection)
+		{
+			try
+			{
+				while (true)
+				{
+					Request request;
+					try
+					{
+						if (!connection.read_request(request))
+							break;
+					}
+					catch (RequestError const& err)
+					{
+						ETC_LOG.debug("Invalid request:", err.what());
+						connection.keep_alive = false;
+						connection.pipelined = false;
+						Reply reply{connection, request};
+						reply.status(err.code)
+							.header("Content-Type", "text/plain")
+							.send(std::string{reason_phrase(err.code)} + "\n");
+						break;
+					}
+					this->dispatch(connection, request);
+					if (!connection.keep_alive)
+						break;
+				}
+				connection.flush();
+			}
+			catch (network::TimeoutError const&)
+			{ ETC_LOG.debug("Closing an idle connection"); }
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				if (!this->stopped)
+					ETC_LOG.warn("Connection error:", exception::string());
+			}
+		}
+	};
+
+	Server::Server(scheduler::Scheduler* sched)
+		: _this{new Impl{sched != nullptr ? *sched : scheduler::current()}}
+	{ ETC_TRACE_CTOR(); }
+
+	Server::~Server()
+	{ ETC_TRACE_DTOR(); }
+
+	void Server::route(std::string prefix, handler_type handler)
+	{
+		prefix = route_prefix(std::move(prefix));
+		ETC_LOG.debug(*this, "Add route", prefix);
+		for (auto& route: _this->routes)
+			if (route.prefix == prefix)
+			{
+				route.handler = std::move(handler);
+				return;
+			}
+		_this->routes.push_back(Impl::Route{prefix, std::move(handler)});
+	}
+
+	void Server::serve_directory(std::string prefix, std::string directory)
+	{
+		prefix = route_prefix(std::move(prefix));
+		boost::filesystem::path root{directory};
+		this->route(prefix, [prefix, root] (Request const& request, Reply& reply) {
+			if (request.method() != Method::get && request.method() != Method::head)
+				return reply.status(ResponseCode::method_not_allowed)
+					.header("Allow", "GET, HEAD")
+					.send("");
+			boost::filesystem::path path = root;
+			std::string relative = request.url().substr(prefix.size());
+			std::istringstream segments{relative};
+			std::string segment;
+			while (std::getline(segments, segment, '/'))
+			{
+				if (segment == "..")
+					return reply.status(ResponseCode::forbidden).send("");
+				if (!segment.empty() && segment != ".")
+					path /= segment;
+			}
+			boost::system::error_code ec;
+			if (boost::filesystem::is_directory(path, ec))
+				path /= "index.html";
+			uint64_t size = 0;
+			if (boost::filesystem::is_regular_file(path, ec))
+				size = boost::filesystem::file_size(path, ec);
+			else
+				ec = boost::system::errc::make_error_code(
+					boost::system::errc::no_such_file_or_directory
+				);
+			if (ec)
+				return reply.status(ResponseCode::not_found)
+					.header("Content-Type", "text/plain")
+					.send("Not found\n");
+
+			reply.header("Accept-Ranges", "bytes")
+				.header("Content-Type", content_type(path.extension().string()));
+			uint64_t offset = 0, length = size;
+			auto it = request.headers().find("range");
+			int range = 0;
+			if (it != request.headers().end())
+				range = parse_range(it->second, size, offset, length);
+			if (range < 0)
+				return reply.status(ResponseCode::range_not_satisfiable)
+					.header("Content-Range", "bytes */" + std::to_string(size))
+					.send("");
+			if (range > 0)
+				reply.status(ResponseCode::partial_content)
+					.header(
+						"Content-Range",
+						"bytes " + std::to_string(offset) + "-" +
+						std::to_string(offset + length - 1) + "/" +
+						std::to_string(size)
+					);
+			reply.send_file(path.string(), offset, length);
+		});
+	}
+
+	void Server::keep_alive_timeout(clock_type::duration const timeout)
+	{ _this->keep_alive_timeout = timeout; }
+
+	void Server::bind(std::string const& address, uint16_t const port)
+	{
+		_this->acceptor.bind(address, port);
+		_this->acceptor.listen();
+		ETC_LOG.info(*this, "Listening on", this->endpoint());
+	}
+
+	network::Endpoint Server::endpoint() const
+	{ return _this->acceptor.local_endpoint(); }
+
+	void Server::serve()
+	{
+		auto impl = _this.get();
+		scheduler::TaskGroup group{impl->sched};
+		while (true)
+		{
+			std::shared_ptr<Connection> connection;
+			try
+			{
+				connection = std::make_shared<Connection>(impl->acceptor.accept());
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(impl->mutex);
+				if (impl->stopped)
+					break;
+				throw;
+			}
+			connection->socket.timeout(impl->keep_alive_timeout);
+			{
+				std::lock_guard<std::mutex> lock(impl->mutex);
+				if (impl->stopped)
+					break;
+				impl->connections.insert(connection.get());
+			}
+			group.spawn("http connection", [impl, connection] {
+				impl->serve(*connection);
+				std::lock_guard<std::mutex> lock(impl->mutex);
+				impl->connections.erase(connection.get());
+			});
+		}
+		group.wait();
+		ETC_LOG.info(*this, "Stopped");
+	}
+
+	void Server::stop()
+	{
+		ETC_LOG.debug(*this, "Stopping");
+		std::lock_guard<std::mutex> lock(_this->mutex);
+		_this->stopped = true;
+		_this->acceptor.close();
+		for (auto connection: _this->connections)
+			connection->socket.close();
+	}
+
+	Server::Reply::Reply(Connection& connection, Request const& request)
+		: _connection(connection)
+		, _request(request)
+		, _code{ResponseCode::ok}
+		, _headers{}
+		, _state{reply_pending}
+	{}
+
+	Server::Reply& Server::Reply::status(ResponseCode const code)
+	{
+		_code = code;
+		return *this;
+	}
+
+	Server::Reply& Server::Reply::header(std::string const& key,
+	                                     std::string value)
+	{
+		_headers[key] = std::move(value);
+		return *this;
+	}
+
+	void Server::Reply::send(std::string const& body)
+	{
+		if (_state != reply_pending)
+			throw Exception{"The reply has already been sent"};
+		_state = reply_done;
+		std::string head = this->_head(
+			"Content-Length: " + std::to_string(body.size()) + "\r\n"
+		);
+		network::ConstBuffer buffers[2] = {
+			{head.data(), head.size()},
+			{body.data(), body.size()},
+		};
+		_connection.send(buffers, _request.method() == Method::head ? 1 : 2);
+	}
+
+	void Server::Reply::send_file(std::string const& path,
+	                              uint64_t const offset,
+	                              uint64_t const size)
+	{
+		if (_state != reply_pending)
+			throw Exception{"The reply has already been sent"};
+		_state = reply_done;
+		std::string head = this->_head(
+			"Content-Length: " + std::to_string(size) + "\r\n"
+		);
+		network::ConstBuffer buffer{head.data(), head.size()};
+		_connection.send(&buffer, 1);
+		if (_request.method() == Method::head)
+			return;
+		_connection.flush();
+		_connection.socket.send_file(path, offset, size);
+	}
+
+	void Server::Reply::write(std::string const& chunk)
+	{
+		if (_state == reply_done)
+			throw Exception{"The reply has already been sent"};
+		std::string head;
+		if (_state == reply_pending)
+		{
+			_state = reply_chunked;
+			if (_connection.http11)
+				head = this->_head("Transfer-Encoding: chunked\r\n");
+			else
+			{
+				// The end of the body is the end of the connection.
+				_connection.keep_alive = false;
+				head = this->_head("");
+			}
+		}
+		if (chunk.empty() || _request.method() == Method::head)
+		{
+			if (!head.empty())
+			{
+				network::ConstBuffer buffer{head.data(), head.size()};
+				_connection.send(&buffer, 1);
+			}
+			return;
+		}
+		if (_connection.http11)
+		{
+			std::ostringstream size;
+			size << std::hex << chunk.size() << "\r\n";
+			head += size.str();
+		}
+		network::ConstBuffer buffers[3] = {
+			{head.data(), head.size()},
+			{chunk.data(), chunk.size()},
+			{"\r\n", 2},
+		};
+		_connection.send(buffers, _connection.http11 ? 3 : 2);
+	}
+
+	void Server::Reply::end()
+	{
+		if (_state == reply_pending)
+			return this->send("");
+		if (_state == reply_done)
+			return;
+		_state = reply_done;
+		if (_request.method() == Method::head || !_connection.http11)
+			return;
+		network::ConstBuffer buffer{"0\r\n\r\n", 5};
+		_connection.send(&buffer, 1);
+	}
+
+	bool Server::Reply::started() const ETC_NOEXCEPT
+	{ return _state != reply_pending; }
+
+	std::string Server::Reply::_head(std::string const& framing)
+	{
+		std::string res = "HTTP/1.1 " + std::to_string(static_cast<int>(_code)) +
+		                  " " + reason_phrase(_code) + "\r\n";
+		for (auto const& header: _headers)
+			res += header.first + ": " + header.second + "\r\n";
+		res += framing;
+		if (!_connection.keep_alive)
+			res += "Connection: close\r\n";
+		res += "\r\n";
+		return res;
+	}
+
+	namespace {
+
+		struct RawResponse
+		{
+			int                                code;
+			std::map<std::string, std::string> headers;
+			std::string                        body;
+		};
+
+		// Minimal client, to check what goes on the wire.
+		struct RawClient
+		{
+			network::Socket socket;
+			std::string     input;
+
+			explicit
+			RawClient(network::Endpoint const& endpoint)
+				: socket{}
+				, input{}
+			{ this->socket.connect(endpoint.address, endpoint.port); }
+
+			void send(std::string const& data)
+			{ this->socket.write(data); }
+
+			bool read_more()
+			{
+				char buffer[4096];
+				auto size = this->socket.read_some(
+					network::MutableBuffer{buffer, sizeof(buffer)}
+				);
+				this->input.append(buffer, size);
+				return size > 0;
+			}
+
+			void read_until(etc::size_type const size)
+			{
+				while (this->input.size() < size)
+					ETC_ENFORCE(this->read_more());
+			}
+
+			RawResponse response(bool const head = false)
+			{
+				etc::size_type end;
+				while ((end = this->input.find("\r\n\r\n")) == std::string::npos)
+					ETC_ENFORCE(this->read_more());
+				std::istringstream lines{this->input.substr(0, end + 2)};
+				this->input.erase(0, end + 4);
+				RawResponse res;
+				std::string line;
+				std::getline(lines, line);
+				ETC_ENFORCE_EQ(line.substr(0, 9), "HTTP/1.1 ");
+				res.code = std::stoi(line.substr(9, 3));
+				while (std::getline(lines, line))
+				{
+					auto colon = line.find(':');
+					res.headers[lower(line.substr(0, colon))] =
+						trim(line.substr(colon + 1, line.size() - colon - 2));
+				}
+				if (head)
+					return res;
+				if (res.headers.count("content-length"))
+				{
+					etc::size_type size = std::stoul(res.headers["content-length"]);
+					this->read_until(size);
+					res.body = this->input.substr(0, size);
+					this->input.erase(0, size);
+				}
+				else if (res.headers.count("transfer-encoding") &&
+				         res.headers["transfer-encoding"] == "chunked")
+				{
+					while (true)
+					{
+						etc::size_type pos;
+						while ((pos = this->input.find("\r\n")) == std::string::npos)
+							ETC_ENFORCE(this->read_more());
+						etc::size_type size = std::stoul(
+							this->input.substr(0, pos), nullptr, 16
+						);
+						this->input.erase(0, pos + 2);
+						this->read_until(size + 2);
+						res.body += this->input.substr(0, size);
+						this->input.erase(0, size + 2);
+						if (size == 0)
+							break;
+					}
+				}
+				else
+				{
+					while (this->read_more())
+						;
+					res.body = std::move(this->input);
+					this->input.clear();
+				}
+				return res;
+			}
+
+			RawResponse get(std::string const& url,
+			                std::string const& headers = "")
+			{
+				this->send("GET " + url + " HTTP/1.1\r\n" + headers + "\r\n");
+				return this->response();
+			}
+
+			/// Whether the server closed the connection.
+			bool closed()
+			{ return this->input.empty() && !this->read_more(); }
+		};
+
+		// Run @a client while @a server serves in the background.
+		void with_server(std::function<void(Server&)> setup,
+		                 std::function<void(network::Endpoint const&)> client)
+		{
+			scheduler::Scheduler sched;
+			sched.spawn("main", [&] (scheduler::Context&) {
+				Server server{&sched};
+				setup(server);
+				server.bind("127.0.0.1", 0);
+				scheduler::TaskGroup group{sched};
+				group.spawn("server", [&] { server.serve(); });
+				try { client(server.endpoint()); }
+				catch (...)
+				{
+					server.stop();
+					group.wait();
+					throw;
+				}
+				server.stop();
+				group.wait();
+			});
+			sched.run();
+		}
+
+		void hello(Request const& request, Server::Reply& reply)
+		{
+			auto it = request.parameters().find("name");
+			reply.header("Content-Type", "text/plain");
+			reply.send(
+				"Hello " +
+				(it == request.parameters().end() ? "you" : it->second)
+			);
+		}
+
+		ETC_TEST_CASE(routes)
+		{
+			with_server(
+				[] (Server& server) {
+					server.route("/hello/", &hello);
+					server.route("/echo", [] (Request const& req, Server::Reply& reply) {
+						std::ostringstream out;
+						out << req.method() << ' ' << req.url() << ' ' << req.body();
+						reply.send(out.str());
+					});
+					server.route("/forbidden", [] (Request const&, Server::Reply& reply) {
+						reply.status(ResponseCode::forbidden);
+					});
+					server.route("/fail", [] (Request const&, Server::Reply& reply) {
+						reply.header("X-Lost", "1");
+						throw Exception{"Handler failure"};
+					});
+				},
+				[] (network::Endpoint const& endpoint) {
+					RawClient client{endpoint};
+					auto res = client.get("/hello?name=big+world%21");
+					ETC_TEST_EQ(res.code, 200);
+					ETC_TEST_EQ(res.body, "Hello big world!");
+					ETC_TEST_EQ(res.headers["content-type"], "text/plain");
+					ETC_TEST_EQ(client.get("/hello/there").body, "Hello you");
+					ETC_TEST_EQ(client.get("/helloworld").code, 404);
+					ETC_TEST_EQ(client.get("/").code, 404);
+
+					client.send("POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody");
+					ETC_TEST_EQ(client.response().body, "Method::post /echo body");
+
+					res = client.get("/forbidden");
+					ETC_TEST_EQ(res.code, 403);
+					ETC_TEST_EQ(res.body, "");
+
+					res = client.get("/fail");
+					ETC_TEST_EQ(res.code, 500);
+					ETC_TEST_EQ(res.headers.count("x-lost"), 0u);
+					// Still usable.
+					ETC_TEST_EQ(client.get("/hello").code, 200);
+				}
+			);
+		}
+
+		ETC_TEST_CASE(keep_alive)
+		{
+			with_server(
+				[] (Server& server) { server.route("/", &hello); },
+				[] (network::Endpoint const& endpoint) {
+					{
+						RawClient client{endpoint};
+						for (int i = 0; i < 10; ++i)
+							ETC_TEST_EQ(client.get("/?name=" + std::to_string(i)).body,
+							            "Hello " + std::to_string(i));
+						auto res = client.get("/", "Connection: close\r\n");
+						ETC_TEST_EQ(res.headers["connection"], "close");
+						ETC_ENFORCE(client.closed());
+					}
+					{
+						RawClient client{endpoint};
+						client.send("GET / HTTP/1.0\r\n\r\n");
+						auto res = client.response();
+						ETC_TEST_EQ(res.body, "Hello you");
+						ETC_TEST_EQ(res.headers["connection"], "close");
+						ETC_ENFORCE(client.closed());
+					}
+					{
+						RawClient client{endpoint};
+						client.send("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+						ETC_TEST_EQ(client.response().headers.count("connection"), 0u);
+						ETC_TEST_EQ(client.get("/").code, 200);
+					}
+				}
+			);
+		}
+
+		ETC_TEST_CASE(idle_timeout)
+		{
+			with_server(
+				[] (Server& server) {
+					server.route("/", &hello);
+					server.keep_alive_timeout(std::chrono::milliseconds(20));
+				},
+				[] (network::Endpoint const& endpoint) {
+					RawClient client{endpoint};
+					ETC_TEST_EQ(client.get("/").code, 200);
+					ETC_ENFORCE(client.closed());
+				}
+			);
+		}
+
+		ETC_TEST_CASE(pipelining)
+		{
+			with_server(
+				[] (Server& server) { server.route("/", &hello); },
+				[] (network::Endpoint const& endpoint) {
+					RawClient client{endpoint};
+					std::string requests;
+					for (int i = 0; i < 20; ++i)
+						requests += "GET /?name=" + std::to_string(i) + " HTTP/1.1\r\n\r\n";
+					client.send(requests + "HEAD / HTTP/1.1\r\n\r\n");
+					for (int i = 0; i < 20; ++i)
+						ETC_TEST_EQ(client.response().body, "Hello " + std::to_string(i));
+					auto res = client.response(true);
+					ETC_TEST_EQ(res.headers["content-length"], "9");
+					ETC_TEST_EQ(client.get("/").body, "Hello you");
+				}
+			);
+		}
+
+		ETC_TEST_CASE(chunked)
+		{
+			with_server(
+				[] (Server& server) {
+					server.route("/", [] (Request const&, Server::Reply& reply) {
+						reply.write("Hello");
+						reply.write("");
+						scheduler::current().context().yield();
+						reply.write(", ");
+						reply.write(std::string(1000, 'x'));
+					});
+				},
+				[] (network::Endpoint const& endpoint) {
+					RawClient client{endpoint};
+					auto res = client.get("/");
+					ETC_TEST_EQ(res.headers["transfer-encoding"], "chunked");
+					ETC_TEST_EQ(res.body, "Hello, " + std::string(1000, 'x'));
+					client.send("HEAD / HTTP/1.1\r\n\r\n");
+					res = client.response(true);
+					ETC_TEST_EQ(res.headers["transfer-encoding"], "chunked");
+					// HTTP/1.0 clients read up to the end of the connection.
+					client.send("GET / HTTP/1.0\r\n\r\n");
+					res = client.response();
+					ETC_TEST_EQ(res.headers.count("transfer-encoding"), 0u);
+					ETC_TEST_EQ(res.body, "Hello, " + std::string(1000, 'x'));
+				}
+			);
+		}
+
+		ETC_TEST_CASE(static_files)
+		{
+			etc::temp::File<std::ofstream> file{
+				"%%%%-%%%%-%%%%.txt", std::ios::out | std::ios::binary
+			};
+			file.stream() << "0123456789";
+			file.stream().close();
+			auto directory = file.path().parent_path().string();
+			auto name = file.path().filename().string();
+			with_server(
+				[&] (Server& server) { server.serve_directory("/static", directory); },
+				[&] (network::Endpoint const& endpoint) {
+					RawClient client{endpoint};
+					auto res = client.get("/static/" + name);
+					ETC_TEST_EQ(res.code, 200);
+					ETC_TEST_EQ(res.body, "0123456789");
+					ETC_TEST_EQ(res.headers["content-type"], "text/plain");
+					ETC_TEST_EQ(res.headers["accept-ranges"], "bytes");
+
+					res = client.get("/static/" + name, "Range: bytes=2-5\r\n");
+					ETC_TEST_EQ(res.code, 206);
+					ETC_TEST_EQ(res.body, "2345");
+					ETC_TEST_EQ(res.headers["content-range"], "bytes 2-5/10");
+					ETC_TEST_EQ(client.get("/static/" + name, "Range: bytes=-3\r\n").body, "789");
+					ETC_TEST_EQ(client.get("/static/" + name, "Range: bytes=8-\r\n").body, "89");
+					ETC_TEST_EQ(client.get("/static/" + name, "Range: bytes=8-100\r\n").body, "89");
+					// Multiple ranges are ignored.
+					ETC_TEST_EQ(client.get("/static/" + name, "Range: bytes=1-2,4-5\r\n").code, 200);
+					res = client.get("/static/" + name, "Range: bytes=10-\r\n");
+					ETC_TEST_EQ(res.code, 416);
+					ETC_TEST_EQ(res.headers["content-range"], "bytes */10");
+
+					client.send("HEAD /static/" + name + " HTTP/1.1\r\n\r\n");
+					ETC_TEST_EQ(client.response(true).headers["content-length"], "10");
+					ETC_TEST_EQ(client.get("/static/../" + name).code, 403);
+					ETC_TEST_EQ(client.get("/static/missing-file").code, 404);
+					client.send("POST /static/" + name + " HTTP/1.1\r\n\r\n");
+					ETC_TEST_EQ(client.response().code, 405);
+				}
+			);
+		}
+
+		ETC_TEST_CASE(invalid_requests)
+		{
+			with_server(
+				[] (Server& server) { server.route("/", &hello); },
+				[] (network::Endpoint const& endpoint) {
+					std::vector<std::pair<std::string, int>> requests = {
+						{"GARBAGE\r\n\r\n", 400},
+						{"GET / HTTP/2.0\r\n\r\n", 400},
+						{"PATCH / HTTP/1.1\r\n\r\n", 501},
+						{"GET /%zz HTTP/1.1\r\n\r\n", 400},
+						{"GET / HTTP/1.1\r\nNo colon\r\n\r\n", 400},
+						{"POST / HTTP/1.1\r\nContent-Length: x\r\n\r\n", 400},
+						{"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 501},
+					};
+					for (auto const& request: requests)
+					{
+						RawClient client{endpoint};
+						client.send(request.first);
+						auto res = client.response();
+						ETC_TEST_EQ(res.code, request.second);
+						ETC_TEST_EQ(res.headers["connection"], "close");
+						ETC_ENFORCE(client.closed());
+					}
+				}
+			);
+		}
+
+		// Requests per second on @a clients connections, @a depth requests
+		// being sent at once.
+		double requests_per_second(int const clients, int const depth)
+		{
+			int const requests = 20000;
+			double res = 0;
+			with_server(
+				[] (Server& server) { server.route("/", &hello); },
+				[&] (network::Endpoint const& endpoint) {
+					auto start = Server::clock_type::now();
+					scheduler::TaskGroup group;
+					for (int i = 0; i < clients; ++i)
+						group.spawn("client", [&] {
+							RawClient client{endpoint};
+							std::string batch;
+							for (int j = 0; j < depth; ++j)
+								batch += "GET /?name=bench HTTP/1.1\r\n\r\n";
+							for (int j = 0; j < requests / clients; j += depth)
+							{
+								client.send(batch);
+								for (int k = 0; k < depth; ++k)
+									ETC_TEST_EQ(client.response().code, 200);
+							}
+						});
+					group.wait();
+					std::chrono::duration<double> elapsed =
+						Server::clock_type::now() - start;
+					res = requests / elapsed.count();
+				}
+			);
+			return res;
+		}
+
+		double file_throughput()
+		{
+			etc::size_type const size = 8 * 1024 * 1024;
+			int const count = 20;
+			etc::temp::File<std::ofstream> file{
+				"%%%%-%%%%-%%%%.bin", std::ios::out | std::ios::binary
+			};
+			file.stream() << std::string(size, 'x');
+			file.stream().close();
+			auto name = file.path().filename().string();
+			double res = 0;
+			with_server(
+				[&] (Server& server) {
+					server.serve_directory("/", file.path().parent_path().string());
+				},
+				[&] (network::Endpoint const& endpoint) {
+					RawClient client{endpoint};
+					auto start = Server::clock_type::now();
+					for (int i = 0; i < count; ++i)
+					{
+						client.send("GET /" + name + " HTTP/1.1\r\n\r\n");
+						auto head = client.response(true);
+						ETC_TEST_EQ(head.headers["content-length"], std::to_string(size));
+						client.read_until(size);
+						client.input.clear();
+					}
+					std::chrono::duration<double> elapsed =
+						Server::clock_type::now() - start;
+					res = size * count / elapsed.count() / (1024 * 1024);
+				}
+			);
+			return res;
+		}
+
+		ETC_BENCHMARK_CASE(benchmark)
+		{
+			ETC_LOG.info("Keep-alive requests:",
+			             requests_per_second(8, 1), "per second");
+			ETC_LOG.info("Pipelined requests:",
+			             requests_per_second(8, 16), "per second");
+			ETC_LOG.info("Static file:", file_throughput(), "MB per second");
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,125 @@
+#ifndef  ETC_HTTP_SERVER_HPP
+# define ETC_HTTP_SERVER_HPP
+
+# include "fwd.hpp"
+# include "Request.hpp"
+
+# include <etc/api.hpp>
+# include <etc/types.hpp>
+# include <etc/network/Endpoint.hpp>
+# include <etc/scheduler.hpp>
+
+# include <cstdint>
+# include <functional>
+# include <memory>
+
+namespace etc { namespace http {
+
+	/**
+	 * @brief HTTP/1.1 server, with a context per connection.
+	 *
+	 * Requests go to the handler of the longest route matching their path.
+	 * Connections are kept alive, and pipelined requests are answered in
+	 * order, their replies being written together. Header names of the
+	 * requests are lower case.
+	 *
+	 * ------------------------------------------------------------------------
+	 * Server server;
+	 * server.route("/hello", [] (Request const& req, Server::Reply& reply) {
+	 *     reply.header("Content-Type", "text/plain");
+	 *     reply.send("Hello " + req.parameters().at("name"));
+	 * });
+	 * server.serve_directory("/static", "/var/www");
+	 * server.bind("0.0.0.0", 8080);
+	 * server.serve();
+	 * ------------------------------------------------------------------------
+	 */
+	class ETC_API Server
+	{
+	public:
+		class Reply;
+		typedef std::function<void(Request const&, Reply&)> handler_type;
+		typedef scheduler::Scheduler::clock_type clock_type;
+		struct Impl;
+		struct Connection;
+
+	private:
+		std::unique_ptr<Impl> _this;
+
+	public:
+		explicit
+		Server(scheduler::Scheduler* sched = nullptr);
+		~Server();
+
+	public:
+		/// Handle the requests for @a prefix and the paths below it.
+		void route(std::string prefix, handler_type handler);
+
+		/// Serve the files of @a directory under @a prefix, with sendfile().
+		void serve_directory(std::string prefix, std::string directory);
+
+		/// Close connections idle for @a timeout, zero disables it.
+		void keep_alive_timeout(clock_type::duration const timeout);
+
+		void bind(std::string const& address, uint16_t const port);
+
+		/// Bound address, with the port picked when binding the port 0.
+		network::Endpoint endpoint() const;
+
+		/// Accept connections until stop() is called, then wait for them.
+		void serve();
+
+		/// Stop accepting connections and close the open ones.
+		void stop();
+	};
+
+	/**
+	 * @brief Response to a request.
+	 *
+	 * The response is either sent at once with send() or send_file(), or
+	 * by chunks with write() until end(). Replies left unsent by their
+	 * handler are sent empty.
+	 */
+	class ETC_API Server::Reply
+	{
+	private:
+		Connection&          _connection;
+		Request const&       _request;
+		ResponseCode         _code;
+		Request::headers_map _headers;
+		int                  _state;
+
+	public:
+		Reply(Connection& connection, Request const& request);
+		Reply(Reply const&) ETC_DELETED_FUNCTION;
+		Reply& operator =(Reply const&) ETC_DELETED_FUNCTION;
+
+	public:
+		Reply& status(ResponseCode const code);
+		Reply& header(std::string const& key, std::string value);
+
+		/// Send the response with @a body.
+		void send(std::string const& body);
+
+		/// Send @a size bytes of the file @a path from @a offset.
+		void send_file(std::string const& path,
+		               uint64_t const offset,
+		               uint64_t const size);
+
+		/// Send a chunk of the body, with the chunked transfer encoding.
+		void write(std::string const& chunk);
+
+		/// Terminate a chunked response, or send an empty one.
+		void end();
+
+		/// Whether the response started to be sent.
+		bool started() const ETC_NOEXCEPT;
+
+	private:
+		/// Status line and headers, with the @a framing header.
+		std::string _head(std::string const& framing);
+	};
+
+}}
+
+#endif
@@ -34,7 +34,15 @@ namespace etc { namespace http {
 			return out << "ResponseCode::" #__name << " (" << (int) code << ")"\
 /**/
 			CASE(ok);
+			CASE(partial_content);
+			CASE(bad_request);
+			CASE(forbidden);
 			CASE(not_found);
+			CASE(method_not_allowed);
+			CASE(payload_too_large);
+			CASE(range_not_satisfiable);
+			CASE(internal_server_error);
+			CASE(not_implemented);
 #undef CASE
 
 		case ResponseCode::_max_value:
@@ -43,4 +51,24 @@ namespace etc { namespace http {
 		}
 
 	}
+
+	char const* reason_phrase(ResponseCode const code)
+	{
+		switch (code)
+		{
+		case ResponseCode::ok: return "OK";
+		case ResponseCode::partial_content: return "Partial Content";
+		case ResponseCode::bad_request: return "Bad Request";
+		case ResponseCode::forbidden: return "Forbidden";
+		case ResponseCode::not_found: return "Not Found";
+		case ResponseCode::method_not_allowed: return "Method Not Allowed";
+		case ResponseCode::payload_too_large: return "Payload Too Large";
+		case ResponseCode::range_not_satisfiable: return "Range Not Satisfiable";
+		case ResponseCode::internal_server_error: return "Internal Server Error";
+		case ResponseCode::not_implemented: return "Not Implemented";
+		case ResponseCode::_max_value:
+		default:
+			return "Unknown";
+		}
+	}
 }}
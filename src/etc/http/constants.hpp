@@ -20,13 +20,25 @@ namespace etc { namespace http {
 	enum class ResponseCode
 	{
 		ok = 200,
+		partial_content = 206,
+		bad_request = 400,
+		forbidden = 403,
 		not_found = 404,
+		method_not_allowed = 405,
+		payload_too_large = 413,
+		range_not_satisfiable = 416,
+		internal_server_error = 500,
+		not_implemented = 501,
 
 		_max_value
 	};
 
 	ETC_API
 	std::ostream& operator <<(std::ostream& out, ResponseCode const code);
+
+	/// Reason phrase of a status line ("Not Found").
+	ETC_API
+	char const* reason_phrase(ResponseCode const code);
 }}
 
 #endif
@@ -12,6 +12,7 @@ namespace etc { namespace http {
 	class ETC_API Client;
 	class ETC_API Request;
 	class ETC_API Response;
+	class ETC_API Server;
 
 }}
 
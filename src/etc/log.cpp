@@ -56,6 +56,13 @@ namespace etc { namespace log {
 
 	} // !anonymous
 
+	bool enabled(Level const level, Component const& component) ETC_NOEXCEPT
+	{
+		if (level >= component.logger.level())
+			return true;
+		return component.enabled && level >= component.level;
+	}
+
 	Log::Log(Level const level,
 	         char const* file,
 	         size_type const line,
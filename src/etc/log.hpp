@@ -66,11 +66,20 @@
 	auto BOOST_PP_CAT(log, __LINE__) = ETC_LOG                                \
 /**/
 
+/// True when a message of level @a lvl would be logged in this component.
+# define ETC_LOG_ENABLED(lvl)                                                 \
+	::etc::log::enabled(::etc::log::Level::lvl, etc_log_component())          \
+/**/
+
 # define ETC_TRACE_CTOR(...) ETC_TRACE.debug("Create", *this)(__VA_ARGS__)
 # define ETC_TRACE_DTOR(...) ETC_TRACE.debug("Destroy", *this)(__VA_ARGS__)
 
 namespace etc { namespace log {
 
+	/// Whether messages of @a level are logged for @a component.
+	ETC_API bool enabled(Level const level,
+	                     Component const& component) ETC_NOEXCEPT;
+
 	/**
 	 * Log object should not be built directly, but with macros ETC_LOG*.
 	 */
@@ -0,0 +1,238 @@
+#include "Buffer.hpp"
+
+#include <etc/exception.hpp>
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace etc { namespace network {
+
+	ETC_LOG_COMPONENT("etc.network.Buffer");
+
+	using exception::Exception;
+
+	namespace detail {
+
+		struct Slab
+		{
+			std::atomic<etc::size_type> refs;
+			BufferPool&                 pool;
+			etc::size_type const        capacity;
+
+			Slab(BufferPool& pool, etc::size_type const capacity)
+				: refs{1}
+				, pool(pool)
+				, capacity{capacity}
+			{}
+
+			char* data() ETC_NOEXCEPT
+			{ return reinterpret_cast<char*>(this + 1); }
+
+			static Slab* make(BufferPool& pool, etc::size_type const capacity)
+			{
+				void* mem = ::operator new(sizeof(Slab) + capacity);
+				return new (mem) Slab{pool, capacity};
+			}
+
+			static void destroy(Slab* slab) ETC_NOEXCEPT
+			{
+				slab->~Slab();
+				::operator delete(slab);
+			}
+		};
+
+	} // !detail
+
+	Buffer::Buffer() ETC_NOEXCEPT
+		: _slab{nullptr}
+		, _data{nullptr}
+		, _size{0}
+	{}
+
+	Buffer::Buffer(detail::Slab* slab,
+	               char* data,
+	               etc::size_type const size) ETC_NOEXCEPT
+		: _slab{slab}
+		, _data{data}
+		, _size{size}
+	{}
+
+	Buffer::Buffer(Buffer const& other) ETC_NOEXCEPT
+		: _slab{other._slab}
+		, _data{other._data}
+		, _size{other._size}
+	{
+		if (_slab != nullptr)
+			_slab->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Buffer::Buffer(Buffer&& other) ETC_NOEXCEPT
+		: _slab{other._slab}
+		, _data{other._data}
+		, _size{other._size}
+	{
+		other._slab = nullptr;
+		other._data = nullptr;
+		other._size = 0;
+	}
+
+	Buffer& Buffer::operator =(Buffer other) ETC_NOEXCEPT
+	{
+		std::swap(_slab, other._slab);
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+		return *this;
+	}
+
+	Buffer::~Buffer()
+	{
+		if (_slab != nullptr &&
+		    _slab->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			_slab->pool._release(_slab);
+	}
+
+	Buffer Buffer::slice(etc::size_type const offset,
+	                     etc::size_type const size) const
+	{
+		if (offset > _size || size > _size - offset)
+			throw Exception{"Buffer slice out of range"};
+		Buffer res{*this};
+		res._data += offset;
+		res._size = size;
+		return res;
+	}
+
+	void Buffer::truncate(etc::size_type const size)
+	{
+		if (size > _size)
+			throw Exception{"Cannot grow a buffer"};
+		_size = size;
+	}
+
+	std::string Buffer::string() const
+	{ return std::string(_data, _size); }
+
+	BufferPool::BufferPool(etc::size_type const slab_size,
+	                       etc::size_type const max_cached)
+		: _slab_size{slab_size}
+		, _max_cached{max_cached}
+		, _mutex{}
+		, _cache{}
+		, _allocated{0}
+	{ ETC_TRACE_CTOR("with slabs of", _slab_size, "bytes"); }
+
+	BufferPool::~BufferPool()
+	{
+		ETC_TRACE_DTOR();
+		for (detail::Slab* slab: _cache)
+			detail::Slab::destroy(slab);
+	}
+
+	Buffer BufferPool::get(etc::size_type const size)
+	{
+		detail::Slab* slab = nullptr;
+		if (size <= _slab_size)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_cache.empty())
+			{
+				slab = _cache.back();
+				_cache.pop_back();
+			}
+		}
+		if (slab == nullptr)
+		{
+			slab = detail::Slab::make(*this, std::max(size, _slab_size));
+			std::lock_guard<std::mutex> lock(_mutex);
+			_allocated += 1;
+		}
+		else
+			slab->refs.store(1, std::memory_order_relaxed);
+		return Buffer{slab, slab->data(), size};
+	}
+
+	etc::size_type BufferPool::allocated()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _allocated;
+	}
+
+	etc::size_type BufferPool::cached()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _cache.size();
+	}
+
+	BufferPool& BufferPool::default_pool()
+	{
+		// Buffers may be released after the static destructors.
+		static BufferPool* pool = new BufferPool;
+		return *pool;
+	}
+
+	void BufferPool::_release(detail::Slab* slab) ETC_NOEXCEPT
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (slab->capacity == _slab_size && _cache.size() < _max_cached)
+			{
+				_cache.push_back(slab);
+				return;
+			}
+			_allocated -= 1;
+		}
+		detail::Slab::destroy(slab);
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(pool)
+		{
+			BufferPool pool{64, 2};
+			{
+				Buffer a = pool.get(10);
+				Buffer b = pool.get(64);
+				Buffer c = pool.get(100);
+				ETC_ENFORCE_EQ(a.size(), 10u);
+				ETC_ENFORCE_EQ(c.size(), 100u);
+				ETC_ENFORCE_EQ(pool.allocated(), 3u);
+			}
+			// The large slab is freed.
+			ETC_ENFORCE_EQ(pool.allocated(), 2u);
+			ETC_ENFORCE_EQ(pool.cached(), 2u);
+			for (int i = 0; i < 100; ++i)
+				pool.get(32);
+			ETC_ENFORCE_EQ(pool.allocated(), 2u);
+		}
+
+		ETC_TEST_CASE(share)
+		{
+			BufferPool pool{64};
+			Buffer copy;
+			Buffer slice;
+			{
+				Buffer buffer = pool.get(11);
+				std::memcpy(buffer.data(), "hello world", 11);
+				copy = buffer;
+				slice = buffer.slice(6, 5);
+				ETC_TEST_THROW_TYPE({ buffer.slice(6, 6); }, Exception);
+				ETC_TEST_THROW_TYPE({ buffer.truncate(12); }, Exception);
+			}
+			ETC_ENFORCE_EQ(slice.string(), "world");
+			copy.truncate(5);
+			ETC_ENFORCE_EQ(copy.string(), "hello");
+			ETC_ENFORCE_EQ(pool.cached(), 0u);
+			copy = Buffer{};
+			ETC_ENFORCE_EQ(pool.cached(), 0u);
+			slice = Buffer{};
+			ETC_ENFORCE_EQ(pool.cached(), 1u);
+		}
+
+	} // !anonymous
+
+}}
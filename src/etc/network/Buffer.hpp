@@ -0,0 +1,142 @@
+#ifndef  ETC_NETWORK_BUFFER_HPP
+# define ETC_NETWORK_BUFFER_HPP
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <mutex>
+# include <string>
+# include <vector>
+
+namespace etc { namespace network {
+
+	/// Bytes to be written.
+	struct ConstBuffer
+	{
+		void const*    data;
+		etc::size_type size;
+	};
+
+	/// Bytes to be read into.
+	struct MutableBuffer
+	{
+		void*          data;
+		etc::size_type size;
+
+		operator ConstBuffer() const ETC_NOEXCEPT
+		{ return ConstBuffer{this->data, this->size}; }
+	};
+
+	class BufferPool;
+
+	namespace detail {
+
+		/// Refcounted memory block, followed by its bytes.
+		struct Slab;
+
+	}
+
+	/**
+	 * @brief View on a slab of a BufferPool.
+	 *
+	 * Copies and slices share the slab, which goes back to its pool once
+	 * the last view is destroyed. Buffers must not outlive their pool.
+	 */
+	class Buffer
+	{
+	private:
+		detail::Slab*  _slab;
+		char*          _data;
+		etc::size_type _size;
+
+	public:
+		Buffer() ETC_NOEXCEPT;
+		Buffer(Buffer const& other) ETC_NOEXCEPT;
+		Buffer(Buffer&& other) ETC_NOEXCEPT;
+		Buffer& operator =(Buffer other) ETC_NOEXCEPT;
+		~Buffer();
+
+	public:
+		char* data() ETC_NOEXCEPT
+		{ return _data; }
+
+		char const* data() const ETC_NOEXCEPT
+		{ return _data; }
+
+		etc::size_type size() const ETC_NOEXCEPT
+		{ return _size; }
+
+		bool empty() const ETC_NOEXCEPT
+		{ return _size == 0; }
+
+		/// View on @a size bytes from @a offset, sharing the slab.
+		Buffer slice(etc::size_type const offset,
+		             etc::size_type const size) const;
+
+		/// Only keep the first @a size bytes.
+		void truncate(etc::size_type const size);
+
+		/// Copy of the bytes.
+		std::string string() const;
+
+		operator ConstBuffer() const ETC_NOEXCEPT
+		{ return ConstBuffer{_data, _size}; }
+
+		operator MutableBuffer() ETC_NOEXCEPT
+		{ return MutableBuffer{_data, _size}; }
+
+	private:
+		friend class BufferPool;
+		Buffer(detail::Slab* slab, char* data, etc::size_type const size)
+			ETC_NOEXCEPT;
+	};
+
+	/**
+	 * @brief Cache of fixed size slabs.
+	 *
+	 * Buffers up to the slab size take a whole slab, reused once released,
+	 * larger ones get a slab of their own that is freed with them. Slice
+	 * a buffer to share its slab between messages.
+	 */
+	class BufferPool
+	{
+	private:
+		etc::size_type const        _slab_size;
+		etc::size_type const        _max_cached;
+		std::mutex                  _mutex;
+		std::vector<detail::Slab*>  _cache;
+		etc::size_type              _allocated;
+
+	public:
+		explicit
+		BufferPool(etc::size_type const slab_size = 16 * 1024,
+		           etc::size_type const max_cached = 256);
+		~BufferPool();
+
+		BufferPool(BufferPool const&) ETC_DELETED_FUNCTION;
+		BufferPool& operator =(BufferPool const&) ETC_DELETED_FUNCTION;
+
+	public:
+		/// Buffer of @a size bytes, uninitialized.
+		Buffer get(etc::size_type const size);
+
+		etc::size_type slab_size() const ETC_NOEXCEPT
+		{ return _slab_size; }
+
+		/// Slabs in use or cached.
+		etc::size_type allocated();
+
+		/// Slabs ready to be reused.
+		etc::size_type cached();
+
+		/// Pool shared by the sockets, never destroyed.
+		static BufferPool& default_pool();
+
+	private:
+		friend class Buffer;
+		void _release(detail::Slab* slab) ETC_NOEXCEPT;
+	};
+
+}}
+
+#endif
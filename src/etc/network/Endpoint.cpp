@@ -0,0 +1,15 @@
+#include "Endpoint.hpp"
+
+#include <ostream>
+
+namespace etc { namespace network {
+
+	void Endpoint::print(std::ostream& out) const ETC_NOEXCEPT
+	{
+		if (this->address.find(':') != std::string::npos)
+			out << '[' << this->address << "]:" << this->port;
+		else
+			out << this->address << ':' << this->port;
+	}
+
+}}
@@ -0,0 +1,41 @@
+#ifndef  ETC_NETWORK_ENDPOINT_HPP
+# define ETC_NETWORK_ENDPOINT_HPP
+
+# include <etc/printable.hpp>
+
+# include <cstdint>
+# include <string>
+
+namespace etc { namespace network {
+
+	/// Address and port of a peer.
+	class Endpoint
+		: public Printable
+	{
+	public:
+		std::string address;
+		uint16_t    port;
+
+	public:
+		Endpoint()
+			: address{}
+			, port{0}
+		{}
+
+		Endpoint(std::string address, uint16_t const port)
+			: address{std::move(address)}
+			, port{port}
+		{}
+
+		bool operator ==(Endpoint const& other) const
+		{ return this->port == other.port && this->address == other.address; }
+
+		bool operator !=(Endpoint const& other) const
+		{ return !(*this == other); }
+
+		void print(std::ostream& out) const ETC_NOEXCEPT override;
+	};
+
+}}
+
+#endif
@@ -32,6 +32,15 @@ namespace etc { namespace network {
 
 	};
 
+	class TimeoutError
+		: public Exception
+	{
+	public:
+		explicit
+		TimeoutError(std::string msg)
+			: Exception(msg + ": Deadline reached")
+		{}
+	};
 
 }}
 
@@ -3,6 +3,7 @@
 #include "Exception.hpp"
 
 #include <etc/log.hpp>
+#include <etc/platform.hpp>
 #include <etc/scheduler/SchedulerImpl.hpp>
 #include <etc/test.hpp>
 
@@ -12,6 +13,21 @@
 #include <boost/asio/read.hpp>
 #include <boost/mpl/inherit.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#ifdef ETC_PLATFORM_LINUX
+# include <fcntl.h>
+# include <sys/sendfile.h>
+# include <sys/socket.h>
+# include <unistd.h>
+# include <cerrno>
+#else
+# include <fstream>
+#endif
+
 namespace ip = boost::asio::ip;
 
 namespace etc { namespace network {
@@ -91,72 +107,142 @@ namespace etc { namespace network {
 						self().sched.impl().wakeup(ctx);
 					}
 				);
-				self().sched.impl().freeze(ctx);
-				ctx.yield();
+				self().wait(ctx);
 			}
 		};
 
+		// Buffers passed at once to a system call.
+		etc::size_type const max_gather = 16;
+
+		// Asio buffer sequence over an array.
+		template<typename AsioBuffer>
+		struct BufferSequence
+		{
+			typedef AsioBuffer value_type;
+			typedef AsioBuffer const* const_iterator;
+
+			AsioBuffer const* first;
+			AsioBuffer const* last;
+
+			const_iterator begin() const { return first; }
+			const_iterator end() const { return last; }
+		};
+
+		// Stream buffers map onto scatter/gather I/O, the string API is
+		// built on top of them.
 		DEF_OPERATION(ReadWrite)
 		{
 			PATCH_OPERATION(ReadWrite);
 
 			Socket::buffer_type read(etc::size_type size) override
 			{
-				if (size == 0)
-					ETC_LOG.debug(self(), "Receiving bytes until connection close");
-				else
-					ETC_LOG.debug(self(), "Receiving", size, "bytes");
 				Socket::buffer_type res;
-				auto& ctx = self().sched.context();
-				std::size_t read_bytes = 0;
-				do
+				if (size > 0)
 				{
-					size_t to_read = size == 0 ? 4096 : size - read_bytes;
-					if (res.size() < read_bytes + to_read)
-						res.resize(read_bytes + to_read);
-					self().asio_socket.async_receive(
-						boost::asio::buffer(&res[read_bytes], to_read),
-						0,
-						[&] (boost::system::error_code const& ec,
-							 std::size_t bytes_transferred)
-						{
-							if (ec)
-								ctx.exception = self().make_exception(
-									ec, "Couldn't read"
-								);
-							else if (bytes_transferred == 0)
-								ctx.exception = std::make_exception_ptr(
-									Exception{"Invalid state ?"}
-								);
-							else
-							{
-								read_bytes += bytes_transferred;
-								ETC_LOG.debug(self(), "Got", bytes_transferred,
-								              "/", to_read, "bytes");
-							}
-							self().sched.impl().wakeup(ctx);
-						}
-					);
-					self().sched.impl().freeze(ctx);
-					ctx.yield();
-				} while (size == 0 || read_bytes < size);
-				ETC_LOG.debug(self(), "Finalize read of", read_bytes, "/",
-				              size == 0 ? "(until EOF)" : std::to_string(size),
-				              "bytes");
+					ETC_LOG.debug(self(), "Receiving", size, "bytes");
+					res.resize(size);
+					MutableBuffer buffer{&res[0], size};
+					res.resize(this->read_into(&buffer, 1));
+					return res;
+				}
+				ETC_LOG.debug(self(), "Receiving bytes until connection close");
+				etc::size_type read_bytes = 0;
+				while (true)
+				{
+					if (read_bytes == res.size())
+						res.resize(std::max<etc::size_type>(4096, res.size() * 2));
+					MutableBuffer buffer{&res[read_bytes], res.size() - read_bytes};
+					etc::size_type bytes = this->read_some(&buffer, 1);
+					if (bytes == 0)
+						break;
+					read_bytes += bytes;
+				}
 				res.resize(read_bytes);
 				return res;
 			}
 
 			size_t write(Socket::buffer_type const& data) override
+			{
+				ConstBuffer buffer{data.data(), data.size()};
+				return this->write_buffers(&buffer, 1);
+			}
+
+			size_t read_some(MutableBuffer const* buffers,
+			                 etc::size_type const count) override
+			{
+				boost::asio::mutable_buffer sequence[max_gather];
+				etc::size_type size = std::min(count, max_gather);
+				for (etc::size_type i = 0; i < size; ++i)
+					sequence[i] = boost::asio::mutable_buffer(buffers[i].data,
+					                                          buffers[i].size);
+				return this->_read_some(sequence, size);
+			}
+
+			size_t read_into(MutableBuffer const* buffers,
+			                 etc::size_type const count) override
+			{
+				boost::asio::mutable_buffer sequence[max_gather];
+				etc::size_type index = 0, offset = 0, res = 0;
+				while (true)
+				{
+					// Skip the filled buffers.
+					while (index < count && offset == buffers[index].size)
+					{
+						index += 1;
+						offset = 0;
+					}
+					if (index == count)
+						break;
+					etc::size_type size = std::min(count - index, max_gather);
+					for (etc::size_type i = 0; i < size; ++i)
+						sequence[i] = boost::asio::mutable_buffer(
+							buffers[index + i].data,
+							buffers[index + i].size
+						);
+					sequence[0] = sequence[0] + offset;
+					etc::size_type bytes = this->_read_some(sequence, size);
+					if (bytes == 0)
+						break;
+					res += bytes;
+					// Advance in the buffers.
+					offset += bytes;
+					while (index < count && offset > buffers[index].size)
+					{
+						offset -= buffers[index].size;
+						index += 1;
+					}
+				}
+				ETC_LOG.debug(self(), "Read", res, "bytes");
+				return res;
+			}
+
+			size_t write_buffers(ConstBuffer const* buffers,
+			                     etc::size_type const count) override
 			{
 				auto& ctx = self().sched.context();
-				size_t sent = 0;
-				while (sent < data.size())
+				boost::asio::const_buffer sequence[max_gather];
+				etc::size_type index = 0, offset = 0, res = 0;
+				while (true)
 				{
-					ETC_LOG.debug(self(), "Sending", data.size() - sent, "/",
-					              data.size(), "bytes");
+					while (index < count && offset == buffers[index].size)
+					{
+						index += 1;
+						offset = 0;
+					}
+					if (index == count)
+						break;
+					etc::size_type size = std::min(count - index, max_gather);
+					for (etc::size_type i = 0; i < size; ++i)
+						sequence[i] = boost::asio::const_buffer(
+							buffers[index + i].data,
+							buffers[index + i].size
+						);
+					sequence[0] = sequence[0] + offset;
+					etc::size_type bytes = 0;
 					self().asio_socket.async_write_some(
-						boost::asio::buffer(&data[sent], data.size() - sent),
+						BufferSequence<boost::asio::const_buffer>{
+							sequence, sequence + size
+						},
 						[&] (boost::system::error_code const& ec,
 							 std::size_t bytes_transferred)
 						{
@@ -169,18 +255,121 @@ namespace etc { namespace network {
 									Exception{"Invalid state"}
 								);
 							else
-								sent += bytes_transferred;
-							ETC_LOG.debug(self(), "Sent", bytes_transferred,
-							              "bytes" ",", data.size() - sent,
-							              "left");
+								bytes = bytes_transferred;
 							self().sched.impl().wakeup(ctx);
 						}
 					);
-					self().sched.impl().freeze(ctx);
-					ctx.yield();
+					self().wait(ctx);
+					res += bytes;
+					offset += bytes;
+					while (index < count && offset > buffers[index].size)
+					{
+						offset -= buffers[index].size;
+						index += 1;
+					}
+				}
+				ETC_LOG.debug(self(), "Wrote", res, "bytes");
+				return res;
+			}
+
+			void send_file(std::string const& path,
+			               uint64_t const offset,
+			               uint64_t const size) override
+			{
+				ETC_LOG.debug(self(), "Sending", size, "bytes of", path,
+				              "from", offset);
+#ifdef ETC_PLATFORM_LINUX
+				int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd < 0)
+					throw SystemError{
+						"Couldn't open " + path,
+						std::error_code(errno, std::system_category())
+					};
+				ETC_SCOPE_EXIT{ ::close(fd); };
+				auto& socket = self().asio_socket;
+				if (!socket.non_blocking())
+					socket.non_blocking(true);
+				off_t position = offset;
+				uint64_t left = size;
+				while (left > 0)
+				{
+					ssize_t res = ::sendfile(socket.native_handle(), fd,
+					                         &position, left);
+					if (res > 0)
+						left -= res;
+					else if (res == 0)
+						throw Exception{"Unexpected end of file " + path};
+					else if (errno == EAGAIN || errno == EWOULDBLOCK)
+						this->_wait_writable();
+					else if (errno != EINTR)
+						throw SystemError{
+							"Couldn't send " + path,
+							std::error_code(errno, std::system_category())
+						};
 				}
-				ETC_LOG.debug("Finalized write of", sent, "/", data.size());
-				return sent;
+#else
+				std::ifstream file(path, std::ios::binary);
+				if (!file.seekg(offset))
+					throw Exception{"Couldn't open " + path};
+				Buffer buffer = BufferPool::default_pool().get(
+					BufferPool::default_pool().slab_size()
+				);
+				uint64_t left = size;
+				while (left > 0)
+				{
+					etc::size_type chunk = std::min<uint64_t>(left, buffer.size());
+					if (!file.read(buffer.data(), chunk))
+						throw Exception{"Unexpected end of file " + path};
+					ConstBuffer data{buffer.data(), chunk};
+					this->write_buffers(&data, 1);
+					left -= chunk;
+				}
+#endif
+			}
+
+		private:
+			void _wait_writable()
+			{
+				auto& ctx = self().sched.context();
+				self().asio_socket.async_write_some(
+					boost::asio::null_buffers(),
+					[&] (boost::system::error_code const& ec, std::size_t) {
+						if (ec)
+							ctx.exception = self().make_exception(
+								ec, "Couldn't write"
+							);
+						self().sched.impl().wakeup(ctx);
+					}
+				);
+				self().wait(ctx);
+			}
+
+			/// Read into @a sequence, 0 at the end of the stream.
+			etc::size_type _read_some(boost::asio::mutable_buffer const* sequence,
+			                          etc::size_type const size)
+			{
+				auto& ctx = self().sched.context();
+				etc::size_type res = 0;
+				self().asio_socket.async_read_some(
+					BufferSequence<boost::asio::mutable_buffer>{
+						sequence, sequence + size
+					},
+					[&] (boost::system::error_code const& ec,
+					     std::size_t bytes_transferred)
+					{
+						if (ec == boost::asio::error::eof)
+							ETC_LOG.debug(self(), "End of stream");
+						else if (ec)
+							ctx.exception = self().make_exception(
+								ec, "Couldn't read"
+							);
+						else
+							res = bytes_transferred;
+						self().sched.impl().wakeup(ctx);
+					}
+				);
+				self().wait(ctx);
+				return res;
 			}
 		};
 
@@ -195,6 +384,277 @@ namespace etc { namespace network {
 			}
 		};
 
+		// Datagrams sent or received by a single system call.
+		etc::size_type const max_batch_size = 64;
+
+		// Datagram sockets are non-blocking: operations are tried first,
+		// and the context only waits for the socket when it would block.
+		DEF_OPERATION(Datagrams)
+		{
+			PATCH_OPERATION(Datagrams);
+
+			/// Receive a datagram from the connected peer.
+			Socket::buffer_type read(etc::size_type size) override
+			{
+				if (size != 0)
+					throw Exception{"Cannot read a size from a datagram socket"};
+				endpoint_type ep;
+				return this->_receive(&ep);
+			}
+
+			/// Send a datagram to the connected peer.
+			size_t write(Socket::buffer_type const& data) override
+			{ return this->_send(data, nullptr); }
+
+			size_t send_to(Socket::buffer_type const& data,
+			               Endpoint const& peer) override
+			{
+				endpoint_type ep = this->_endpoint(peer);
+				return this->_send(data, &ep);
+			}
+
+			Socket::buffer_type receive_from(Endpoint& peer) override
+			{
+				endpoint_type ep;
+				auto res = this->_receive(&ep);
+				peer = Endpoint{ep.address().to_string(), ep.port()};
+				return res;
+			}
+
+#ifdef ETC_PLATFORM_LINUX
+			void send_batch(std::vector<Datagram> const& datagrams) override
+			{
+				ETC_LOG.debug(self(), "Sending", datagrams.size(), "datagrams");
+				mmsghdr headers[max_batch_size];
+				iovec buffers[max_batch_size];
+				endpoint_type endpoints[max_batch_size];
+				etc::size_type sent = 0;
+				while (sent < datagrams.size())
+				{
+					etc::size_type count = std::min(datagrams.size() - sent,
+					                                max_batch_size);
+					for (etc::size_type i = 0; i < count; ++i)
+					{
+						Datagram const& datagram = datagrams[sent + i];
+						std::memset(&headers[i], 0, sizeof(headers[i]));
+						buffers[i].iov_base = const_cast<char*>(datagram.data.data());
+						buffers[i].iov_len = datagram.data.size();
+						headers[i].msg_hdr.msg_iov = &buffers[i];
+						headers[i].msg_hdr.msg_iovlen = 1;
+						if (!datagram.peer.address.empty())
+						{
+							endpoints[i] = this->_endpoint(datagram.peer);
+							headers[i].msg_hdr.msg_name = endpoints[i].data();
+							headers[i].msg_hdr.msg_namelen = endpoints[i].size();
+						}
+					}
+					this->_prepare(
+						datagrams[sent].peer.address.empty() ? nullptr : &endpoints[0]
+					);
+					int res = ::sendmmsg(self().asio_socket.native_handle(),
+					                     headers, count, MSG_DONTWAIT);
+					if (res > 0)
+						sent += res;
+					else if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+						this->_wait_ready(true);
+					else if (res < 0 && errno != EINTR)
+						throw SystemError{
+							"Couldn't send datagrams",
+							std::error_code(errno, std::system_category())
+						};
+				}
+			}
+
+			etc::size_type receive_batch(std::vector<Datagram>& datagrams,
+			                             etc::size_type const size) override
+			{
+				mmsghdr headers[max_batch_size];
+				iovec buffers[max_batch_size];
+				sockaddr_storage addresses[max_batch_size];
+				etc::size_type count = std::min(datagrams.size(), max_batch_size);
+				if (count == 0)
+					return 0;
+				for (etc::size_type i = 0; i < count; ++i)
+				{
+					Datagram& datagram = datagrams[i];
+					datagram.data.resize(size);
+					std::memset(&headers[i], 0, sizeof(headers[i]));
+					buffers[i].iov_base = &datagram.data[0];
+					buffers[i].iov_len = size;
+					headers[i].msg_hdr.msg_iov = &buffers[i];
+					headers[i].msg_hdr.msg_iovlen = 1;
+					headers[i].msg_hdr.msg_name = &addresses[i];
+					headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+				}
+				this->_prepare(nullptr);
+				int res;
+				while ((res = ::recvmmsg(self().asio_socket.native_handle(),
+				                         headers, count, MSG_DONTWAIT,
+				                         nullptr)) < 0)
+				{
+					if (errno == EAGAIN || errno == EWOULDBLOCK)
+						this->_wait_ready(false);
+					else if (errno != EINTR)
+						throw SystemError{
+							"Couldn't receive datagrams",
+							std::error_code(errno, std::system_category())
+						};
+				}
+				for (int i = 0; i < res; ++i)
+				{
+					Datagram& datagram = datagrams[i];
+					datagram.data.resize(
+						std::min<etc::size_type>(headers[i].msg_len, size)
+					);
+					endpoint_type ep;
+					std::memcpy(ep.data(), &addresses[i],
+					            headers[i].msg_hdr.msg_namelen);
+					ep.resize(headers[i].msg_hdr.msg_namelen);
+					datagram.peer = Endpoint{ep.address().to_string(), ep.port()};
+				}
+				ETC_LOG.debug(self(), "Received", res, "datagrams");
+				return res;
+			}
+#else
+			void send_batch(std::vector<Datagram> const& datagrams) override
+			{
+				for (auto& datagram: datagrams)
+				{
+					if (datagram.peer.address.empty())
+						this->write(datagram.data);
+					else
+						this->send_to(datagram.data, datagram.peer);
+				}
+			}
+
+			etc::size_type receive_batch(std::vector<Datagram>& datagrams,
+			                             etc::size_type const size) override
+			{
+				etc::size_type res = 0;
+				boost::system::error_code ec;
+				while (res < datagrams.size() &&
+				       (res == 0 || self().asio_socket.available(ec) > 0))
+				{
+					Datagram& datagram = datagrams[res++];
+					datagram.data = this->receive_from(datagram.peer);
+					if (datagram.data.size() > size)
+						datagram.data.resize(size);
+				}
+				return res;
+			}
+#endif
+
+		private:
+			endpoint_type _endpoint(Endpoint const& peer)
+			{ return endpoint_type{self().make_address(peer.address), peer.port}; }
+
+			/// Open the socket for @a ep if needed, in non-blocking mode.
+			void _prepare(endpoint_type const* ep)
+			{
+				auto& socket = self().asio_socket;
+				if (!socket.is_open())
+				{
+					if (ep == nullptr)
+						throw Exception{"Socket is neither bound nor connected"};
+					self().open_for(ep->address());
+				}
+				if (!socket.non_blocking())
+					socket.non_blocking(true);
+			}
+
+			/// Wait until the socket is readable, or writable.
+			void _wait_ready(bool const writable)
+			{
+				auto& ctx = self().sched.context();
+				auto handler = [&] (boost::system::error_code const& ec,
+				                    std::size_t) {
+					if (ec)
+						ctx.exception = self().make_exception(
+							ec, writable ? "Couldn't send" : "Couldn't receive"
+						);
+					self().sched.impl().wakeup(ctx);
+				};
+				if (writable)
+					self().asio_socket.async_send(boost::asio::null_buffers(),
+					                              handler);
+				else
+					self().asio_socket.async_receive(boost::asio::null_buffers(),
+					                                 handler);
+				self().wait(ctx);
+			}
+
+			size_t _send(Socket::buffer_type const& data, endpoint_type const* ep)
+			{
+				ETC_LOG.debug(self(), "Sending a datagram of", data.size(), "bytes");
+				this->_prepare(ep);
+				while (true)
+				{
+					boost::system::error_code ec;
+					size_t res;
+					if (ep == nullptr)
+						res = self().asio_socket.send(
+							boost::asio::buffer(data), 0, ec
+						);
+					else
+						res = self().asio_socket.send_to(
+							boost::asio::buffer(data), *ep, 0, ec
+						);
+					if (!ec)
+						return res;
+					if (ec != boost::asio::error::would_block &&
+					    ec != boost::asio::error::try_again)
+						std::rethrow_exception(
+							self().make_exception(ec, "Couldn't send")
+						);
+					this->_wait_ready(true);
+				}
+			}
+
+			Socket::buffer_type _receive(endpoint_type* ep)
+			{
+				this->_prepare(nullptr);
+				auto& socket = self().asio_socket;
+				Socket::buffer_type res;
+				bool ready = false;
+				while (true)
+				{
+					boost::system::error_code ec;
+					// Size of the next datagram, if any.
+					etc::size_type size = socket.available(ec);
+					if (size > 0 || ready)
+					{
+						// Nothing available once readable is either an empty
+						// datagram or one that just arrived, which must not be
+						// truncated.
+						bool const largest = (size == 0);
+						res.resize(
+							largest ? static_cast<etc::size_type>(max_udp_size)
+							        : size
+						);
+						size = socket.receive_from(
+							boost::asio::buffer(&res[0], res.size()), *ep, 0, ec
+						);
+						if (!ec)
+						{
+							res.resize(size);
+							if (largest)
+								res.shrink_to_fit();
+							ETC_LOG.debug(self(), "Received a datagram of",
+							              size, "bytes from", *ep);
+							return res;
+						}
+						if (ec != boost::asio::error::would_block &&
+						    ec != boost::asio::error::try_again)
+							std::rethrow_exception(
+								self().make_exception(ec, "Couldn't receive")
+							);
+					}
+					this->_wait_ready(false);
+					ready = true;
+				}
+			}
+		};
+
 		// Helper to determine the accepted client socket type.
 		template<typename AcceptorSocket> struct client_socket;
 
@@ -221,8 +681,7 @@ namespace etc { namespace network {
 						self().sched.impl().wakeup(ctx);
 					}
 				);
-				self().sched.impl().freeze(ctx);
-				ctx.yield();
+				self().wait(ctx);
 				return Socket(std::unique_ptr<Socket::Impl>(impl.release()));
 			}
 		};
@@ -243,15 +702,36 @@ namespace etc { namespace network {
 			typedef AsioSocket asio_socket_type;
 			typedef SocketImpl<AsioSocket, Operations...> self_type;
 
+			// Cancel the pending operation once the deadline is reached.
+			struct DeadlineTimer
+				: public scheduler::TimerWheel::Timer
+			{
+				self_type& socket;
+
+				explicit
+				DeadlineTimer(self_type& socket)
+					: socket(socket)
+				{
+					this->callback = [] (scheduler::TimerWheel::Timer& timer) {
+						auto& socket = static_cast<DeadlineTimer&>(timer).socket;
+						socket.timed_out = true;
+						boost::system::error_code ec;
+						socket.asio_socket.cancel(ec);
+					};
+				}
+			};
+
 			int config;
 			scheduler::Scheduler& sched;
 			AsioSocket asio_socket;
+			std::atomic<bool> timed_out;
 
 			SocketImpl(int config, scheduler::Scheduler& sched)
 				: Socket::Impl{}
 				, config{config}
 				, sched(sched)
 				, asio_socket{sched.impl().service}
+				, timed_out{false}
 			{ ETC_TRACE_CTOR(config); }
 			~SocketImpl() { ETC_TRACE_DTOR(); }
 
@@ -264,6 +744,30 @@ namespace etc { namespace network {
 			size_t write(Socket::buffer_type const& data) override
 			{ return mixin::write(data); }
 
+			size_t read_some(MutableBuffer const* buffers,
+			                 etc::size_type const count) override
+			{ return mixin::read_some(buffers, count); }
+
+			size_t read_into(MutableBuffer const* buffers,
+			                 etc::size_type const count) override
+			{ return mixin::read_into(buffers, count); }
+
+			size_t write_buffers(ConstBuffer const* buffers,
+			                     etc::size_type const count) override
+			{ return mixin::write_buffers(buffers, count); }
+
+			void send_file(std::string const& path,
+			               uint64_t const offset,
+			               uint64_t const size) override
+			{ return mixin::send_file(path, offset, size); }
+
+			void close() override
+			{
+				ETC_LOG.debug(*this, "Closing");
+				boost::system::error_code ec;
+				this->asio_socket.close(ec);
+			}
+
 			void bind(std::string const& address, uint16_t const port) override
 			{ return mixin::bind(address, port); }
 
@@ -273,6 +777,26 @@ namespace etc { namespace network {
 			Socket accept() override
 			{ return mixin::accept(); }
 
+			size_t send_to(Socket::buffer_type const& data,
+			               Endpoint const& peer) override
+			{ return mixin::send_to(data, peer); }
+
+			Socket::buffer_type receive_from(Endpoint& peer) override
+			{ return mixin::receive_from(peer); }
+
+			void send_batch(std::vector<Datagram> const& datagrams) override
+			{ return mixin::send_batch(datagrams); }
+
+			etc::size_type receive_batch(std::vector<Datagram>& datagrams,
+			                             etc::size_type const size) override
+			{ return mixin::receive_batch(datagrams, size); }
+
+			Endpoint local_endpoint() const override
+			{
+				auto ep = this->asio_socket.local_endpoint();
+				return Endpoint{ep.address().to_string(), ep.port()};
+			}
+
 			static
 			ip::address make_address(std::string const& str)
 			{
@@ -281,10 +805,11 @@ namespace etc { namespace network {
 				return ip::address::from_string(str.c_str());
 			}
 
-			static
 			std::exception_ptr make_exception(boost::system::error_code const& ec,
 			                                  std::string message)
 			{
+				if (ec == boost::asio::error::operation_aborted && this->timed_out)
+					return std::make_exception_ptr(TimeoutError{message});
 				return std::make_exception_ptr(
 					SystemError{
 						message,
@@ -293,6 +818,22 @@ namespace etc { namespace network {
 				);
 			}
 
+			/// Yield until the pending operation completes, or is cancelled
+			/// by the deadline.
+			void wait(scheduler::Context& ctx)
+			{
+				auto& sched = this->sched.impl();
+				auto deadline = this->operation_deadline();
+				this->timed_out = false;
+				sched.freeze(ctx);
+				if (deadline == Socket::clock_type::time_point::max())
+					return ctx.yield();
+				DeadlineTimer timer{*this};
+				sched.arm_timer(timer, deadline);
+				ETC_SCOPE_EXIT{ sched.cancel_timer(timer); };
+				ctx.yield();
+			}
+
 			void open_for(ip::address const& addr)
 			{
 				ETC_TRACE.debug(*this, "Opening socket for", addr);
@@ -315,7 +856,8 @@ namespace etc { namespace network {
 		};
 
 		typedef SocketImpl<ip::tcp::socket, Bind, Connect, ReadWrite> ClientTCPSocket;
-		//typedef SocketImpl<ip::udp::socket, Bind, ReadWrite> ClientUDPSocket;
+		typedef SocketImpl<ip::udp::socket, Bind, Connect, Datagrams> ClientUDPSocket;
+		typedef SocketImpl<ip::udp::socket, Bind, Datagrams> ServerUDPSocket;
 
 		template<> struct client_socket<ip::tcp::acceptor>
 		{ typedef ClientTCPSocket type; };
@@ -332,13 +874,15 @@ namespace etc { namespace network {
 		{
 			if (config & config_tcp_protocol)
 				_this.reset(new ClientTCPSocket{config, s});
-		//	else if (config & config_udp_protocol)
-		//		_this.reset(new ClientUDPSocket{config, s});
+			else if (config & config_udp_protocol)
+				_this.reset(new ClientUDPSocket{config, s});
 		}
 		else if (config & config_accept_mode)
 		{
 			if (config & config_tcp_protocol)
 				_this.reset(new AcceptTCPSocket{config, s});
+			else if (config & config_udp_protocol)
+				_this.reset(new ServerUDPSocket{config, s});
 		}
 		if (_this == nullptr)
 			throw exception::Exception{"No implem found for this config"};
@@ -361,6 +905,34 @@ namespace etc { namespace network {
 	size_t Socket::write(buffer_type const& data)
 	{ return _this->write(data); }
 
+	size_t Socket::read_some(MutableBuffer const* buffers,
+	                         etc::size_type const count)
+	{ return _this->read_some(buffers, count); }
+
+	size_t Socket::read_some(MutableBuffer const& buffer)
+	{ return _this->read_some(&buffer, 1); }
+
+	size_t Socket::read_into(MutableBuffer const* buffers,
+	                         etc::size_type const count)
+	{ return _this->read_into(buffers, count); }
+
+	size_t Socket::read_into(MutableBuffer const& buffer)
+	{ return _this->read_into(&buffer, 1); }
+
+	size_t Socket::write(ConstBuffer const* buffers, etc::size_type const count)
+	{ return _this->write_buffers(buffers, count); }
+
+	size_t Socket::write(ConstBuffer const& buffer)
+	{ return _this->write_buffers(&buffer, 1); }
+
+	void Socket::send_file(std::string const& path,
+	                       uint64_t const offset,
+	                       uint64_t const size)
+	{ _this->send_file(path, offset, size); }
+
+	void Socket::close()
+	{ _this->close(); }
+
 	void Socket::listen()
 	{ return _this->listen(); }
 
@@ -373,6 +945,28 @@ namespace etc { namespace network {
 	Socket Socket::accept()
 	{ return _this->accept(); }
 
+	Endpoint Socket::local_endpoint() const
+	{ return _this->local_endpoint(); }
+
+	size_t Socket::send_to(buffer_type const& data, Endpoint const& peer)
+	{ return _this->send_to(data, peer); }
+
+	auto Socket::receive_from(Endpoint& peer) -> buffer_type
+	{ return _this->receive_from(peer); }
+
+	void Socket::send_batch(std::vector<Datagram> const& datagrams)
+	{ _this->send_batch(datagrams); }
+
+	etc::size_type Socket::receive_batch(std::vector<Datagram>& datagrams,
+	                                     etc::size_type const size)
+	{ return _this->receive_batch(datagrams, size); }
+
+	void Socket::deadline(clock_type::time_point const deadline)
+	{ _this->deadline = deadline; }
+
+	void Socket::timeout(clock_type::duration const timeout)
+	{ _this->timeout = timeout; }
+
 	namespace {
 
 		ETC_TEST_CASE(ctor_no_scheduler)
@@ -422,7 +1016,8 @@ namespace etc { namespace network {
 				{
 					{ Socket s(config_tcp_client); s.bind(addr, port); }
 					{ Socket s(config_tcp_accept); s.bind(addr, port); }
-			//		{ Socket s(config_udp_client); s.bind(addr, port); }
+					{ Socket s(config_udp_client); s.bind(addr, port); }
+					{ Socket s(config_udp_server); s.bind(addr, port); }
 				}
 		}
 
@@ -441,6 +1036,272 @@ namespace etc { namespace network {
 			client.write("POUF");
 		}
 
+		SCHED_TEST_CASE(read_timeout)
+		{
+			Socket server(config_tcp_accept);
+			server.bind("127.0.0.1", 12346);
+			server.listen();
+
+			scheduler::spawn("client", [&] {
+				Socket s;
+				s.connect("127.0.0.1", 12346);
+				s.timeout(std::chrono::milliseconds(20));
+				auto start = Socket::clock_type::now();
+				ETC_TEST_THROW_TYPE({ s.read(4); }, TimeoutError);
+				ETC_ENFORCE_GTE(Socket::clock_type::now() - start,
+				                std::chrono::milliseconds(20));
+			});
+			auto client = server.accept();
+			// Nothing is sent before the client gives up.
+			scheduler::current().sleep_for(std::chrono::milliseconds(50));
+		}
+
+		SCHED_TEST_CASE(close_after_timeout)
+		{
+			Socket server(config_tcp_accept);
+			server.bind("127.0.0.1", 0);
+			server.listen();
+			auto port = server.local_endpoint().port;
+
+			Socket s;
+			s.connect("127.0.0.1", port);
+			auto client = server.accept();
+			s.timeout(std::chrono::milliseconds(10));
+			ETC_TEST_THROW_TYPE({ s.read(4); }, TimeoutError);
+			// Without deadline, an aborted operation is not a timeout.
+			s.timeout(Socket::clock_type::duration::zero());
+			scheduler::spawn("closer", [&] { s.close(); });
+			ETC_TEST_THROW_TYPE({ s.read(4); }, SystemError);
+		}
+
+		SCHED_TEST_CASE(accept_deadline)
+		{
+			Socket server(config_tcp_accept);
+			server.bind("127.0.0.1", 12347);
+			server.listen();
+			server.deadline(Socket::clock_type::now() + std::chrono::milliseconds(10));
+			ETC_TEST_THROW_TYPE({ server.accept(); }, TimeoutError);
+			// The deadline stays reached.
+			ETC_TEST_THROW_TYPE({ server.accept(); }, TimeoutError);
+		}
+
+		SCHED_TEST_CASE(scatter_gather)
+		{
+			Socket server(config_tcp_accept);
+			server.bind("127.0.0.1", 0);
+			server.listen();
+			Endpoint address = server.local_endpoint();
+
+			scheduler::spawn("client", [&] {
+				Socket s;
+				s.connect(address.address, address.port);
+				ConstBuffer parts[] = {{"hea", 3}, {"", 0}, {"der", 3}, {"body", 4}};
+				ETC_ENFORCE_EQ(s.write(parts, 4), 10u);
+				// Read until the server closes the connection.
+				ETC_TEST_EQ(s.read(), std::string(10000, 'x'));
+			});
+			auto client = server.accept();
+			BufferPool pool{64};
+			Buffer header = pool.get(6);
+			Buffer body = pool.get(4);
+			MutableBuffer buffers[] = {header, body};
+			ETC_ENFORCE_EQ(client.read_into(buffers, 2), 10u);
+			ETC_TEST_EQ(header.string(), "header");
+			ETC_TEST_EQ(body.string(), "body");
+			client.write(std::string(10000, 'x'));
+		}
+
+		SCHED_TEST_CASE(pooled_echo)
+		{
+			Socket server(config_tcp_accept);
+			server.bind("127.0.0.1", 0);
+			server.listen();
+			Endpoint address = server.local_endpoint();
+			BufferPool pool{1024};
+			int const count = 1000;
+
+			scheduler::spawn("client", [&] {
+				Socket s;
+				s.connect(address.address, address.port);
+				for (int i = 0; i < count; ++i)
+				{
+					Buffer message = pool.get(100);
+					std::memset(message.data(), 'a' + i % 26, message.size());
+					s.write(message);
+					Buffer echo = pool.get(100);
+					ETC_ENFORCE_EQ(s.read_into(echo), 100u);
+					ETC_ENFORCE_EQ(echo.data()[99], 'a' + i % 26);
+				}
+			});
+			auto client = server.accept();
+			Buffer buffer = pool.get(pool.slab_size());
+			etc::size_type received = 0;
+			while (received < count * 100u)
+			{
+				etc::size_type bytes = client.read_some(buffer);
+				ETC_ENFORCE_GT(bytes, 0u);
+				client.write(buffer.slice(0, bytes));
+				received += bytes;
+			}
+			ETC_TEST_EQ(client.read_some(buffer), 0u);
+			// Two messages and the server buffer at most.
+			ETC_ENFORCE_LTE(pool.allocated(), 3u);
+		}
+
+		SCHED_TEST_CASE(udp_echo)
+		{
+			Socket server(config_udp_server);
+			server.bind("127.0.0.1", 0);
+			Endpoint address = server.local_endpoint();
+			ETC_ENFORCE_GT(address.port, 0);
+
+			scheduler::spawn("client", [&] {
+				Socket s(config_udp_client);
+				s.connect(address.address, address.port);
+				ETC_ENFORCE_EQ(s.write("ping"), 4u);
+				ETC_TEST_EQ(s.read(), "pong");
+				ETC_TEST_THROW_TYPE({ s.read(4); }, Exception);
+			});
+			Endpoint peer;
+			ETC_TEST_EQ(server.receive_from(peer), "ping");
+			ETC_TEST_EQ(peer.address, "127.0.0.1");
+			server.send_to("pong", peer);
+		}
+
+		SCHED_TEST_CASE(udp_sizes)
+		{
+			Socket server(config_udp_server);
+			server.bind("127.0.0.1", 0);
+			Endpoint address = server.local_endpoint();
+			std::string const largest(max_udp_size, 'x');
+
+			scheduler::spawn("client", [&] {
+				Socket s(config_udp_client);
+				s.connect(address.address, address.port);
+				s.write("");
+				s.write(largest);
+			});
+			Endpoint peer;
+			ETC_TEST_EQ(server.receive_from(peer), "");
+			ETC_ENFORCE(server.receive_from(peer) == largest);
+		}
+
+		SCHED_TEST_CASE(udp_batch)
+		{
+			Socket server(config_udp_server);
+			server.bind("127.0.0.1", 0);
+			Endpoint address = server.local_endpoint();
+
+			std::vector<Datagram> datagrams;
+			for (int i = 0; i < 100; ++i)
+				datagrams.push_back(Datagram{address, std::to_string(i)});
+			// An empty datagram, and a truncated one.
+			datagrams.push_back(Datagram{address, ""});
+			datagrams.push_back(Datagram{address, std::string(100, 'x')});
+			scheduler::spawn("client", [&] {
+				Socket s(config_udp_client);
+				s.send_batch(datagrams);
+			});
+
+			std::vector<Datagram> received(16);
+			std::vector<std::string> values;
+			while (values.size() < datagrams.size())
+			{
+				etc::size_type count = server.receive_batch(received, 50);
+				ETC_ENFORCE_GT(count, 0u);
+				for (etc::size_type i = 0; i < count; ++i)
+				{
+					ETC_TEST_EQ(received[i].peer.address, "127.0.0.1");
+					values.push_back(received[i].data);
+				}
+			}
+			for (int i = 0; i < 100; ++i)
+				ETC_TEST_EQ(values[i], std::to_string(i));
+			ETC_TEST_EQ(values[100], "");
+			ETC_TEST_EQ(values[101], std::string(50, 'x'));
+		}
+
+		SCHED_TEST_CASE(udp_timeout)
+		{
+			Socket server(config_udp_server);
+			server.bind("127.0.0.1", 0);
+			server.timeout(std::chrono::milliseconds(10));
+			Endpoint peer;
+			ETC_TEST_THROW_TYPE({ server.receive_from(peer); }, TimeoutError);
+			std::vector<Datagram> datagrams(4);
+			ETC_TEST_THROW_TYPE({ server.receive_batch(datagrams); }, TimeoutError);
+			Socket unbound(config_udp_client);
+			ETC_TEST_THROW_TYPE({ unbound.receive_from(peer); }, Exception);
+		}
+
+		// Send windows of datagrams, each one acknowledged by the receiver.
+		double udp_throughput(bool const batched)
+		{
+			int const count = 200000;
+			etc::size_type const window = 64;
+			scheduler::Scheduler sched;
+			double res = 0;
+			sched.spawn("main", [&] (scheduler::Context&) {
+				Socket receiver(config_udp_server);
+				receiver.bind("127.0.0.1", 0);
+				receiver.timeout(std::chrono::seconds(1));
+				Endpoint address = receiver.local_endpoint();
+				Socket sender(config_udp_client);
+				sender.bind("127.0.0.1", 0);
+				sender.timeout(std::chrono::seconds(1));
+				auto start = Socket::clock_type::now();
+				scheduler::spawn("receiver", [&] {
+					std::vector<Datagram> datagrams(window);
+					Endpoint peer;
+					for (int received = 0; received < count; )
+					{
+						etc::size_type left = window;
+						while (left > 0)
+						{
+							if (batched)
+							{
+								datagrams.resize(left);
+								left -= receiver.receive_batch(datagrams, 64);
+							}
+							else
+							{
+								receiver.receive_from(peer);
+								left -= 1;
+							}
+						}
+						received += window;
+						receiver.send_to("ack", sender.local_endpoint());
+					}
+				});
+				std::vector<Datagram> datagrams(
+					window, Datagram{address, std::string(32, 'x')}
+				);
+				Endpoint peer;
+				for (int sent = 0; sent < count; sent += window)
+				{
+					if (batched)
+						sender.send_batch(datagrams);
+					else
+						for (auto& datagram: datagrams)
+							sender.send_to(datagram.data, datagram.peer);
+					ETC_TEST_EQ(sender.receive_from(peer), "ack");
+				}
+				std::chrono::duration<double> elapsed =
+					Socket::clock_type::now() - start;
+				res = count / elapsed.count();
+			});
+			sched.run();
+			return res;
+		}
+
+		ETC_BENCHMARK_CASE(udp_benchmark)
+		{
+			ETC_LOG.info("UDP datagrams one by one:",
+			             udp_throughput(false), "packets per second");
+			ETC_LOG.info("UDP datagrams by batches:",
+			             udp_throughput(true), "packets per second");
+		}
+
 	}
 
 }}
@@ -1,6 +1,9 @@
 #ifndef  ETC_NETWORK_SOCKET_HPP
 # define ETC_NETWORK_SOCKET_HPP
 
+# include "Buffer.hpp"
+# include "Endpoint.hpp"
+
 # include <etc/scheduler.hpp>
 
 # include <memory>
@@ -18,6 +21,7 @@ namespace etc { namespace network {
 		config_tcp_client = (config_tcp_protocol | config_client_mode),
 		config_tcp_accept = (config_tcp_protocol | config_accept_mode | config_reuse_address),
 		config_udp_client = (config_udp_protocol | config_client_mode),
+		config_udp_server = (config_udp_protocol | config_accept_mode | config_reuse_address),
 		_config_mode_mask = (config_client_mode | config_accept_mode),
 		_config_protocol_mask = (config_tcp_protocol | config_udp_protocol),
 
@@ -35,10 +39,19 @@ namespace etc { namespace network {
 
 	};
 
+	/// A datagram and its peer, the connected one when the address is
+	/// empty.
+	struct Datagram
+	{
+		Endpoint    peer;
+		std::string data;
+	};
+
 	class Socket
 	{
 	public:
 		typedef std::string buffer_type;
+		typedef scheduler::Scheduler::clock_type clock_type;
 		struct Impl;
 
 	private:
@@ -68,10 +81,68 @@ namespace etc { namespace network {
 		buffer_type read(int size = 0);
 		size_t write(buffer_type const& data);
 
+		/**
+		 * @brief Read the available bytes into @a buffers, waiting for at
+		 * least one.
+		 *
+		 * Returns the number of bytes read, 0 at the end of the stream.
+		 */
+		size_t read_some(MutableBuffer const* buffers, etc::size_type const count);
+		size_t read_some(MutableBuffer const& buffer);
+
+		/// Fill @a buffers, returns less bytes only at the end of the stream.
+		size_t read_into(MutableBuffer const* buffers, etc::size_type const count);
+		size_t read_into(MutableBuffer const& buffer);
+
+		/// Write every byte of @a buffers, in order, with gathered writes.
+		size_t write(ConstBuffer const* buffers, etc::size_type const count);
+		size_t write(ConstBuffer const& buffer);
+
+		/// Send @a size bytes of the file @a path from @a offset, without
+		/// copying them where possible (sendfile() on Linux).
+		void send_file(std::string const& path,
+		               uint64_t const offset,
+		               uint64_t const size);
+
 		void bind(std::string const& address, uint16_t const port);
 		void connect(std::string const& address, uint16_t const port);
 		void listen();
 		Socket accept();
+
+		/// Close the socket, pending operations fail.
+		void close();
+
+		/// Bound address, with the port picked when binding the port 0.
+		Endpoint local_endpoint() const;
+
+		/// Send a datagram to @a peer (UDP).
+		size_t send_to(buffer_type const& data, Endpoint const& peer);
+
+		/// Receive a datagram, and set @a peer to its sender (UDP).
+		buffer_type receive_from(Endpoint& peer);
+
+		/**
+		 * @brief Send @a datagrams in order, with as few system calls as
+		 * possible (UDP).
+		 */
+		void send_batch(std::vector<Datagram> const& datagrams);
+
+		/**
+		 * @brief Wait for datagrams, and receive at once as many as
+		 * available, up to the size of @a datagrams (UDP).
+		 *
+		 * Returns the number of datagrams received, stored at the front of
+		 * @a datagrams. Datagrams larger than @a size bytes are truncated.
+		 */
+		etc::size_type receive_batch(std::vector<Datagram>& datagrams,
+		                             etc::size_type const size = best_udp_size);
+
+		/// Blocking operations fail with a TimeoutError past @a deadline.
+		void deadline(clock_type::time_point const deadline);
+
+		/// Blocking operations fail with a TimeoutError when waiting for
+		/// the peer longer than @a timeout, zero disables it.
+		void timeout(clock_type::duration const timeout);
 	};
 
 }}
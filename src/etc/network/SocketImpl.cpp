@@ -3,11 +3,25 @@
 
 #include <etc/str.hpp>
 
+#include <algorithm>
+
 namespace etc { namespace network {
 
+	Socket::Impl::Impl()
+		: deadline{clock_type::time_point::max()}
+		, timeout{clock_type::duration::zero()}
+	{}
+
 	Socket::Impl::~Impl()
 	{}
 
+	auto Socket::Impl::operation_deadline() const -> clock_type::time_point
+	{
+		if (this->timeout == clock_type::duration::zero())
+			return this->deadline;
+		return std::min(this->deadline, clock_type::now() + this->timeout);
+	}
+
 	int Socket::Impl::configuration() const
 	{ throw InvalidOperation{}; }
 
@@ -17,6 +31,26 @@ namespace etc { namespace network {
 	size_t Socket::Impl::write(Socket::buffer_type const& data)
 	{ throw InvalidOperation{}; }
 
+	size_t Socket::Impl::read_some(MutableBuffer const* buffers,
+	                               etc::size_type const count)
+	{ throw InvalidOperation{}; }
+
+	size_t Socket::Impl::read_into(MutableBuffer const* buffers,
+	                               etc::size_type const count)
+	{ throw InvalidOperation{}; }
+
+	size_t Socket::Impl::write_buffers(ConstBuffer const* buffers,
+	                                   etc::size_type const count)
+	{ throw InvalidOperation{}; }
+
+	void Socket::Impl::send_file(std::string const& path,
+	                             uint64_t const offset,
+	                             uint64_t const size)
+	{ throw InvalidOperation{}; }
+
+	void Socket::Impl::close()
+	{ throw InvalidOperation{}; }
+
 	void Socket::Impl::bind(std::string const& address, uint16_t const port)
 	{ throw InvalidOperation{}; }
 
@@ -29,6 +63,23 @@ namespace etc { namespace network {
 	void Socket::Impl::connect(std::string const& address, uint16_t port)
 	{ throw InvalidOperation{}; }
 
+	Endpoint Socket::Impl::local_endpoint() const
+	{ throw InvalidOperation{}; }
+
+	size_t Socket::Impl::send_to(Socket::buffer_type const& data,
+	                             Endpoint const& peer)
+	{ throw InvalidOperation{}; }
+
+	Socket::buffer_type Socket::Impl::receive_from(Endpoint& peer)
+	{ throw InvalidOperation{}; }
+
+	void Socket::Impl::send_batch(std::vector<Datagram> const& datagrams)
+	{ throw InvalidOperation{}; }
+
+	etc::size_type Socket::Impl::receive_batch(std::vector<Datagram>& datagrams,
+	                                           etc::size_type const size)
+	{ throw InvalidOperation{}; }
+
 	void Socket::Impl::print(std::ostream& out) const ETC_NOEXCEPT
 	{
 		out << '<'
@@ -41,6 +92,7 @@ namespace etc { namespace network {
 			.replace("socket_", "")
 			.replace(", acceptor_service<ip::tcp> ", "")
 			.replace(", stream_service<ip::tcp> ", "")
+			.replace(", datagram_socket_service<ip::udp> ", "")
 			.replace("> >", ">>")
 			.replace("<", "(")
 			.replace(">", ")")
@@ -11,13 +11,40 @@ namespace etc { namespace network {
 	struct Socket::Impl
 		: public Printable
 	{
+		/// Deadline of the blocking operations.
+		clock_type::time_point deadline;
+		/// Longest wait of a blocking operation, or zero.
+		clock_type::duration   timeout;
+
+		Impl();
+
+		/// Earliest of the deadline and of the timeout from now.
+		clock_type::time_point operation_deadline() const;
+
 		virtual int configuration() const;
 		virtual Socket::buffer_type read(etc::size_type s);
 		virtual size_t write(Socket::buffer_type const& data);
+		virtual size_t read_some(MutableBuffer const* buffers,
+		                         etc::size_type const count);
+		virtual size_t read_into(MutableBuffer const* buffers,
+		                         etc::size_type const count);
+		virtual size_t write_buffers(ConstBuffer const* buffers,
+		                             etc::size_type const count);
+		virtual void send_file(std::string const& path,
+		                       uint64_t const offset,
+		                       uint64_t const size);
+		virtual void close();
 		virtual void bind(std::string const& address, uint16_t const port);
 		virtual void listen();
 		virtual Socket accept();
 		virtual void connect(std::string const& address, uint16_t port);
+		virtual Endpoint local_endpoint() const;
+		virtual size_t send_to(Socket::buffer_type const& data,
+		                       Endpoint const& peer);
+		virtual Socket::buffer_type receive_from(Endpoint& peer);
+		virtual void send_batch(std::vector<Datagram> const& datagrams);
+		virtual etc::size_type receive_batch(std::vector<Datagram>& datagrams,
+		                                     etc::size_type const size);
 		void print(std::ostream& out) const ETC_NOEXCEPT override;
 		virtual ~Impl();
 	};
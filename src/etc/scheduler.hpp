@@ -19,14 +19,14 @@ namespace etc { namespace scheduler {
 		{
 			return current().spawn(
 				std::move(name),
-				[&] (Context&) { std::forward<Callable>(cb)(); }
+				[cb] (Context&) mutable { cb(); }
 			);
 		}
 
 		template<typename Callable>
 		auto spawn_imp(std::string name, Callable cb, long)
 			-> decltype(std::forward<Callable>(cb)(std::declval<Context&>()))
-		{ return current().spawn(std::move(name), cb); }
+		{ return current().spawn(std::move(name), std::move(cb)); }
 	}
 
 	template<typename Callable>
@@ -0,0 +1,239 @@
+#include "Channel.hpp"
+#include "Context.hpp"
+#include "Scheduler.hpp"
+
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace etc { namespace scheduler {
+
+	namespace {
+
+		ETC_LOG_COMPONENT("etc.scheduler.Channel");
+
+		ETC_TEST_CASE(spsc_ping)
+		{
+			Scheduler r;
+			SPSCChannel<int> channel{4};
+			ETC_ENFORCE_EQ(channel.capacity(), 4u);
+			std::vector<int> received;
+			r.spawn("producer", [&] (Context&) {
+				for (int i = 0; i < 100; ++i)
+					channel.send(i);
+				channel.close();
+			});
+			r.spawn("consumer", [&] (Context&) {
+				int value;
+				while (channel.recv(value))
+					received.push_back(value);
+			});
+			r.run();
+			ETC_ENFORCE_EQ(received.size(), 100u);
+			for (int i = 0; i < 100; ++i)
+				ETC_ENFORCE_EQ(received[i], i);
+		}
+
+		ETC_TEST_CASE(mpmc)
+		{
+			Scheduler r{4};
+			Channel<int> channel{16};
+			std::atomic<int> producers{4};
+			std::atomic<long> sum{0};
+			std::atomic<int> count{0};
+			for (int p = 0; p < 4; ++p)
+				r.spawn("producer", [&] (Context&) {
+					for (int i = 1; i <= 1000; ++i)
+						channel.send(i);
+					if (--producers == 0)
+						channel.close();
+				});
+			for (int c = 0; c < 4; ++c)
+				r.spawn("consumer", [&] (Context&) {
+					int value;
+					while (channel.recv(value))
+					{
+						sum += value;
+						count += 1;
+					}
+				});
+			r.run();
+			ETC_ENFORCE_EQ(count.load(), 4000);
+			ETC_ENFORCE_EQ(sum.load(), 4 * 500500);
+		}
+
+		ETC_TEST_CASE(close)
+		{
+			Channel<std::string> channel{2};
+			channel.send("a");
+			ETC_ENFORCE(channel.try_send(std::string("b")));
+			ETC_ENFORCE(!channel.try_send(std::string("c")));
+			channel.close();
+			ETC_ENFORCE(channel.closed());
+			ETC_TEST_THROW_TYPE({ channel.send("d"); }, exception::Exception);
+			std::string value;
+			ETC_ENFORCE(channel.recv(value));
+			ETC_ENFORCE_EQ(value, "a");
+			ETC_ENFORCE(channel.recv(value));
+			ETC_ENFORCE_EQ(value, "b");
+			ETC_ENFORCE(!channel.recv(value));
+			ETC_ENFORCE(!channel.try_recv(value));
+		}
+
+		ETC_TEST_CASE(close_wakes_up)
+		{
+			Scheduler r;
+			Channel<int> channel{1};
+			bool receiver_done = false;
+			bool sender_failed = false;
+			r.spawn("receiver", [&] (Context&) {
+				int value;
+				ETC_ENFORCE(!channel.recv(value));
+				receiver_done = true;
+			});
+			r.spawn("closer", [&] (Context& ctx) {
+				ctx.yield();
+				channel.close();
+			});
+			r.run();
+			Channel<int> full{2};
+			full.send(1);
+			full.send(2);
+			r.spawn("sender", [&] (Context&) {
+				try { full.send(3); }
+				catch (exception::Exception const&) { sender_failed = true; }
+			});
+			r.spawn("closer", [&] (Context& ctx) {
+				ctx.yield();
+				full.close();
+			});
+			r.run();
+			ETC_ENFORCE(receiver_done);
+			ETC_ENFORCE(sender_failed);
+		}
+
+		template<template<typename> class Ring>
+		void test_batch()
+		{
+			Channel<int, Ring> channel{8};
+			std::vector<int> in{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+			ETC_ENFORCE_EQ(channel.try_send_n(in.begin(), in.size()), 8u);
+			ETC_ENFORCE_EQ(channel.size(), 8u);
+			std::vector<int> out(10, -1);
+			ETC_ENFORCE_EQ(channel.try_recv_n(out.begin(), 3), 3u);
+			ETC_ENFORCE_EQ(channel.try_send_n(in.begin() + 8, 2), 2u);
+			ETC_ENFORCE_EQ(channel.try_recv_n(out.begin() + 3, 10), 7u);
+			for (int i = 0; i < 10; ++i)
+				ETC_ENFORCE_EQ(out[i], i);
+			ETC_ENFORCE_EQ(channel.try_recv_n(out.begin(), 10), 0u);
+		}
+
+		ETC_TEST_CASE(batch)
+		{
+			test_batch<MPMCRing>();
+			test_batch<SPSCRing>();
+		}
+
+		ETC_TEST_CASE(thread_and_contexts)
+		{
+			Scheduler r{2};
+			Channel<int> requests{2};
+			Channel<int> responses{2};
+			// Blocking sends and receives from a thread.
+			std::thread thread{[&] {
+				for (int i = 0; i < 100; ++i)
+				{
+					requests.send(i);
+					int value;
+					ETC_ENFORCE(responses.recv(value));
+					ETC_ENFORCE_EQ(value, i * 2);
+				}
+				requests.close();
+			}};
+			r.spawn("server", [&] (Context&) {
+				int value;
+				while (requests.recv(value))
+					responses.send(value * 2);
+			});
+			r.run();
+			thread.join();
+		}
+
+		// Stream @a count values by batches, mixed with blocking operations.
+		// The count is a multiple of the batch size.
+		template<template<typename> class Ring>
+		void transfer(int const count, etc::size_type batch)
+		{
+			Scheduler r;
+			Channel<int, Ring> channel{1024};
+			r.spawn("producer", [&] (Context&) {
+				std::vector<int> values(batch);
+				for (int i = 0; i < count; )
+				{
+					for (auto& value: values)
+						value = i++;
+					auto it = values.begin();
+					etc::size_type left = batch;
+					while (left > 0)
+					{
+						etc::size_type sent = channel.try_send_n(it, left);
+						it += sent;
+						left -= sent;
+						if (left > 0)
+							channel.send(*it++), --left;
+					}
+				}
+				channel.close();
+			});
+			r.spawn("consumer", [&] (Context&) {
+				std::vector<int> values(batch);
+				int expected = 0;
+				while (true)
+				{
+					etc::size_type received = channel.try_recv_n(values.begin(), batch);
+					for (etc::size_type i = 0; i < received; ++i)
+						ETC_ENFORCE_EQ(values[i], expected++);
+					if (received == 0 && !channel.recv(values[0]))
+						break;
+					else if (received == 0)
+						ETC_ENFORCE_EQ(values[0], expected++);
+				}
+				ETC_ENFORCE_EQ(expected, count);
+			});
+			r.run();
+		}
+
+		ETC_TEST_CASE(batch_stream)
+		{
+			transfer<MPMCRing>(64 * 160, 1);
+			transfer<SPSCRing>(64 * 160, 1);
+			transfer<MPMCRing>(64 * 160, 64);
+			transfer<SPSCRing>(64 * 160, 64);
+		}
+
+		template<template<typename> class Ring>
+		double throughput(etc::size_type batch)
+		{
+			int const count = 1000000;
+			auto start = std::chrono::steady_clock::now();
+			transfer<Ring>(count, batch);
+			std::chrono::duration<double> elapsed =
+				std::chrono::steady_clock::now() - start;
+			return count / elapsed.count();
+		}
+
+		ETC_BENCHMARK_CASE(benchmark)
+		{
+			ETC_LOG.info("MPMC:", throughput<MPMCRing>(1), "values/s");
+			ETC_LOG.info("SPSC:", throughput<SPSCRing>(1), "values/s");
+			ETC_LOG.info("MPMC batch of 64:", throughput<MPMCRing>(64), "values/s");
+			ETC_LOG.info("SPSC batch of 64:", throughput<SPSCRing>(64), "values/s");
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,189 @@
+#ifndef  ETC_SCHEDULER_CHANNEL_HPP
+# define ETC_SCHEDULER_CHANNEL_HPP
+
+# include "RingBuffer.hpp"
+# include "WaitList.hpp"
+
+# include <etc/exception.hpp>
+# include <etc/scope_exit.hpp>
+
+# include <atomic>
+# include <mutex>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Bounded channel between contexts and threads.
+	 *
+	 * Values go through a lock-free ring buffer. Only a sender finding the
+	 * channel full or a receiver finding it empty takes the lock, to wait:
+	 * contexts yield to their scheduler, other threads are blocked.
+	 *
+	 * Once closed, sending throws, while receivers get the values left.
+	 */
+	template<typename T, template<typename> class Ring = MPMCRing>
+	class Channel
+	{
+	public:
+		typedef T value_type;
+
+	private:
+		Ring<T>                     _ring;
+		std::atomic<bool>           _closed;
+		std::mutex                  _mutex;
+		/// Waiting for room.
+		WaitList                    _senders;
+		std::atomic<etc::size_type> _waiting_senders;
+		/// Waiting for values.
+		WaitList                    _receivers;
+		std::atomic<etc::size_type> _waiting_receivers;
+
+	public:
+		/// The capacity may be rounded up by the ring buffer.
+		explicit
+		Channel(etc::size_type const capacity)
+			: _ring{capacity}
+			, _closed{false}
+			, _mutex{}
+			, _senders{}
+			, _waiting_senders{0}
+			, _receivers{}
+			, _waiting_receivers{0}
+		{}
+
+		Channel(Channel const&) ETC_DELETED_FUNCTION;
+		Channel& operator =(Channel const&) ETC_DELETED_FUNCTION;
+
+	public:
+		etc::size_type capacity() const
+		{ return _ring.capacity(); }
+
+		/// Approximate count of values.
+		etc::size_type size() const
+		{ return _ring.size(); }
+
+		bool closed() const
+		{ return _closed.load(); }
+
+		/// Wake up every waiter, further sends throw.
+		void close()
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_closed.store(true);
+			_senders.notify_all();
+			_receivers.notify_all();
+		}
+
+	public:
+		/// Send @a value, waiting for room.
+		void send(T value)
+		{
+			if (_closed.load(std::memory_order_relaxed))
+				throw exception::Exception{"Channel closed"};
+			if (!_ring.try_push(value) &&
+			    !this->_wait(_senders, _waiting_senders,
+			                 [&] { return _ring.try_push(value); }))
+				throw exception::Exception{"Channel closed"};
+			this->_notify(_receivers, _waiting_receivers, false);
+		}
+
+		/// Move @a value in when there is room.
+		bool try_send(T& value)
+		{
+			if (_closed.load(std::memory_order_relaxed))
+				throw exception::Exception{"Channel closed"};
+			if (!_ring.try_push(value))
+				return false;
+			this->_notify(_receivers, _waiting_receivers, false);
+			return true;
+		}
+
+		bool try_send(T&& value)
+		{ return this->try_send(value); }
+
+		/// Move values in from @a first, up to @a count, as room allows.
+		template<typename Iterator>
+		etc::size_type try_send_n(Iterator first, etc::size_type const count)
+		{
+			if (_closed.load(std::memory_order_relaxed))
+				throw exception::Exception{"Channel closed"};
+			etc::size_type res = _ring.try_push_n(first, count);
+			if (res > 0)
+				this->_notify(_receivers, _waiting_receivers, res > 1);
+			return res;
+		}
+
+		/// Receive a value, waiting for one. Returns false once the channel
+		/// is closed and empty.
+		bool recv(T& value)
+		{
+			if (!_ring.try_pop(value) &&
+			    !this->_wait(_receivers, _waiting_receivers,
+			                 [&] { return _ring.try_pop(value); }))
+				return false;
+			this->_notify(_senders, _waiting_senders, false);
+			return true;
+		}
+
+		bool try_recv(T& value)
+		{
+			if (!_ring.try_pop(value))
+				return false;
+			this->_notify(_senders, _waiting_senders, false);
+			return true;
+		}
+
+		/// Receive the available values into @a out, up to @a max.
+		template<typename Iterator>
+		etc::size_type try_recv_n(Iterator out, etc::size_type const max)
+		{
+			etc::size_type res = _ring.try_pop_n(out, max);
+			if (res > 0)
+				this->_notify(_senders, _waiting_senders, res > 1);
+			return res;
+		}
+
+	private:
+		// The waiter is counted before trying again, and the other side
+		// checks the count after succeeding: one of them sees the other.
+		template<typename Attempt>
+		bool _wait(WaitList& waiters,
+		           std::atomic<etc::size_type>& waiting,
+		           Attempt attempt)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			waiting.fetch_add(1);
+			ETC_SCOPE_EXIT{ waiting.fetch_sub(1); };
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			while (true)
+			{
+				if (attempt())
+					return true;
+				if (_closed.load())
+					return false;
+				waiters.wait(lock);
+			}
+		}
+
+		void _notify(WaitList& waiters,
+		             std::atomic<etc::size_type>& waiting,
+		             bool all)
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (waiting.load(std::memory_order_relaxed) == 0)
+				return;
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (all)
+				waiters.notify_all();
+			else
+				waiters.notify_one();
+		}
+	};
+
+	/// Channel with a single sender and a single receiver at a time.
+	template<typename T>
+	using SPSCChannel = Channel<T, SPSCRing>;
+
+}}
+
+#endif
@@ -2,14 +2,21 @@
 # define ETC_SCHEDULER_CONTEXT_HPP
 
 # include "fwd.hpp"
+# include "StackPool.hpp"
 
 # include <etc/exception.hpp>
 # include <etc/log.hpp>
 # include <etc/scope_exit.hpp>
+# include <etc/types.hpp>
 
 # include <boost/noncopyable.hpp>
 # include <boost/coroutine/symmetric_coroutine.hpp>
 
+# include <atomic>
+# include <chrono>
+# include <new>
+# include <type_traits>
+
 namespace etc { namespace scheduler {
 
 	typedef boost::coroutines::symmetric_coroutine<void> coroutine_type;
@@ -19,35 +26,123 @@ namespace etc { namespace scheduler {
 	{
 		ETC_LOG_COMPONENT("etc.scheduler.Context");
 
+		/// Scheduling state, see Scheduler::Impl::freeze().
+		enum State
+		{
+			running,
+			freezing,
+			frozen,
+			notified,
+		};
+
+		/// Handlers up to this size are stored in the context.
+		static etc::size_type const inline_handler_size = 64;
+
+		/// Store the handler pointed by @a hdlr in @a ctx, see setup_handler().
+		typedef void (*handler_setup_type)(Context& ctx, void* hdlr);
+
 		coroutine_type::yield_type* _yield;
 		Context* _parent;
 		std::string name;
 		coroutine_type::call_type coro;
 		std::exception_ptr exception;
+		std::atomic<int> state;
+		/// Worker running the context, or Scheduler::any_worker.
+		etc::size_type affinity;
+		/// Time spent running, and waiting for a wakeup.
+		std::chrono::steady_clock::duration run_time;
+		std::chrono::steady_clock::duration wait_time;
+		/// Switched out to wait for a wakeup at (workers only).
+		std::chrono::steady_clock::time_point frozen_since;
 
-		template<typename Handler>
-		Context(std::string name,
-		        Context* parent,
-		        Handler&& hdlr)
+	private:
+		// Hands the context stack to its coroutine.
+		struct StackAllocator
+		{
+			StackPool::stack_type stack;
+
+			void allocate(StackPool::stack_type& res, std::size_t)
+			{ res = this->stack; }
+
+			void deallocate(StackPool::stack_type&)
+			{}
+		};
+
+		StackPool& _pool;
+		StackPool::stack_type _stack;
+		std::aligned_storage<inline_handler_size>::type _storage;
+		void* _handler;
+		void (*_call)(void* handler, Context& ctx);
+		void (*_destroy)(void* handler, bool in_place);
+
+	public:
+		explicit
+		Context(StackPool& pool)
 			: _yield{nullptr}
-			, _parent{parent}
-			, name(std::move(name))
-			, coro(
-				[hdlr, this] (coroutine_type::yield_type& ca) {
-					ETC_LOG.debug("Initiated context", this->name, &ca, &this->coro);
-					ca();
-					ETC_LOG.debug("Awaken context", this->name);
-					_yield = &ca;
-					ETC_SCOPE_EXIT{ _yield = nullptr; };
-					try { hdlr(*this); }
-					// XXX let force_unwind here ?
-					catch (...) { this->exception = std::current_exception(); }
-				}
-			)
-		{ ETC_TRACE_CTOR(this->name); }
+			, _parent{nullptr}
+			, name{}
+			, coro{}
+			, exception{}
+			, state{running}
+			, affinity{0}
+			, run_time{0}
+			, wait_time{0}
+			, frozen_since{}
+			, _pool(pool)
+			, _stack(pool.allocate())
+			, _handler{nullptr}
+			, _call{nullptr}
+			, _destroy{nullptr}
+		{ ETC_TRACE_CTOR(); }
 
 		~Context()
-		{ ETC_TRACE_DTOR(this->name); }
+		{
+			ETC_TRACE_DTOR(this->name);
+			this->release();
+			_pool.deallocate(_stack);
+		}
+
+		/// Forward the handler pointed by @a hdlr to @a ctx.
+		template<typename Handler>
+		static void setup_handler(Context& ctx, void* hdlr)
+		{
+			typedef typename std::remove_reference<Handler>::type value_type;
+			ctx._set_handler(
+				std::forward<Handler>(*static_cast<value_type*>(hdlr))
+			);
+		}
+
+		/// Prepare a new or released context to run the handler @a hdlr,
+		/// stored by @a setup.
+		void reset(std::string name,
+		           Context* parent,
+		           handler_setup_type setup,
+		           void* hdlr,
+		           etc::size_type const affinity)
+		{
+			this->name = std::move(name);
+			_parent = parent;
+			this->exception = std::exception_ptr{};
+			this->state.store(running, std::memory_order_relaxed);
+			this->affinity = affinity;
+			this->run_time = std::chrono::steady_clock::duration{0};
+			this->wait_time = std::chrono::steady_clock::duration{0};
+			this->frozen_since = std::chrono::steady_clock::time_point{};
+			setup(*this, hdlr);
+			this->coro = coroutine_type::call_type(
+				[this] (coroutine_type::yield_type& ca) { this->_run(ca); },
+				boost::coroutines::attributes(_stack.size),
+				StackAllocator{_stack}
+			);
+			ETC_TRACE.debug("Reset context", this->name);
+		}
+
+		/// Destroy the coroutine and the handler, keeping the stack.
+		void release()
+		{
+			this->coro = coroutine_type::call_type{};
+			this->_reset_handler();
+		}
 
 		void yield()
 		{
@@ -62,6 +157,59 @@ namespace etc { namespace scheduler {
 				std::rethrow_exception(this->exception);
 			}
 		}
+
+	private:
+		void _run(coroutine_type::yield_type& ca)
+		{
+			ETC_LOG.debug("Awaken context", this->name);
+			_yield = &ca;
+			ETC_SCOPE_EXIT{ _yield = nullptr; };
+			try { _call(_handler, *this); }
+			// XXX let force_unwind here ?
+			catch (...) { this->exception = std::current_exception(); }
+			this->_reset_handler();
+		}
+
+		template<typename Handler>
+		void _set_handler(Handler&& hdlr)
+		{
+			typedef typename std::decay<Handler>::type handler_type;
+			typedef std::integral_constant<
+				bool,
+				sizeof(handler_type) <= sizeof(_storage) &&
+				alignof(handler_type) <= alignof(decltype(_storage))
+			> in_place;
+			this->_reset_handler();
+			_handler = this->_new_handler<handler_type>(
+				std::forward<Handler>(hdlr),
+				in_place{}
+			);
+			_call = [] (void* handler, Context& ctx) {
+				(*static_cast<handler_type*>(handler))(ctx);
+			};
+			_destroy = [] (void* handler, bool in_place) {
+				if (in_place)
+					static_cast<handler_type*>(handler)->~handler_type();
+				else
+					delete static_cast<handler_type*>(handler);
+			};
+		}
+
+		template<typename T, typename Handler>
+		void* _new_handler(Handler&& hdlr, std::true_type)
+		{ return new (&_storage) T(std::forward<Handler>(hdlr)); }
+
+		template<typename T, typename Handler>
+		void* _new_handler(Handler&& hdlr, std::false_type)
+		{ return new T(std::forward<Handler>(hdlr)); }
+
+		void _reset_handler()
+		{
+			if (_handler == nullptr)
+				return;
+			_destroy(_handler, _handler == &_storage);
+			_handler = nullptr;
+		}
 	};
 
 }}
@@ -0,0 +1,139 @@
+#include "Future.hpp"
+#include "Context.hpp"
+#include "Scheduler.hpp"
+
+#include <etc/test.hpp>
+
+#include <thread>
+
+namespace etc { namespace scheduler { namespace detail {
+
+	FutureStateBase::FutureStateBase()
+		: _mutex{}
+		, _waiters{}
+		, _ready{false}
+	{}
+
+	FutureStateBase::~FutureStateBase()
+	{}
+
+	bool FutureStateBase::ready()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _ready;
+	}
+
+	void FutureStateBase::wait()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_waiters.wait(lock, [&] { return _ready; });
+	}
+
+	void FutureStateBase::_set_ready()
+	{
+		_ready = true;
+		_waiters.notify_all();
+	}
+
+}}}
+
+namespace etc { namespace scheduler {
+
+	namespace {
+
+		ETC_TEST_CASE(get)
+		{
+			Scheduler r{2};
+			int res = 0;
+			r.spawn("main", [&] (Context&) {
+				auto a = spawn_future("a", [] { return 20; });
+				auto b = spawn_future("b", [] { return std::string("22"); });
+				auto c = spawn_future("c", [] {});
+				c.get();
+				res = a.get() + std::stoi(b.get());
+			});
+			r.run();
+			ETC_ENFORCE_EQ(res, 42);
+		}
+
+		ETC_TEST_CASE(exception)
+		{
+			Scheduler r;
+			bool caught = false;
+			r.spawn("main", [&] (Context&) {
+				auto f = spawn_future("throw", [] () -> int {
+					throw exception::Exception{"Task failed"};
+				});
+				try { f.get(); }
+				catch (exception::Exception const&) { caught = true; }
+			});
+			r.run();
+			ETC_ENFORCE(caught);
+		}
+
+		ETC_TEST_CASE(promise)
+		{
+			Scheduler r;
+			int value = 0;
+			bool broken = false;
+			std::unique_ptr<Promise<int>> promise{new Promise<int>};
+			Future<int> future = promise->future();
+			Future<void> never;
+			{
+				Promise<void> dropped;
+				never = dropped.future();
+			}
+			r.spawn("waiter", [&] (Context&) {
+				value = future.get();
+				try { never.get(); }
+				catch (exception::Exception const&) { broken = true; }
+			});
+			r.spawn("setter", [&] (Context& ctx) {
+				ctx.yield();
+				ETC_ENFORCE(!future.ready());
+				promise->set_value(42);
+				ETC_TEST_THROW_TYPE({ promise->set_value(43); }, exception::Exception);
+			});
+			r.run();
+			ETC_ENFORCE_EQ(value, 42);
+			ETC_ENFORCE(broken);
+		}
+
+		ETC_TEST_CASE(wait_from_thread)
+		{
+			Scheduler r;
+			Promise<int> promise;
+			auto future = promise.future();
+			std::thread thread{[&] { ETC_ENFORCE_EQ(future.get(), 12); }};
+			r.spawn("setter", [&] (Context&) { promise.set_value(12); });
+			r.run();
+			thread.join();
+		}
+
+		ETC_TEST_CASE(when_all)
+		{
+			Scheduler r{4};
+			std::vector<int> values;
+			int done = 0;
+			r.spawn("main", [&] (Context&) {
+				std::vector<Future<int>> futures;
+				std::vector<Future<void>> voids;
+				for (int i = 0; i < 100; ++i)
+				{
+					futures.push_back(spawn_future("square", [i] { return i * i; }));
+					voids.push_back(spawn_future("void", [] {}));
+				}
+				values = when_all(std::move(futures)).get();
+				when_all(std::move(voids)).get();
+				done = 1;
+			});
+			r.run();
+			ETC_ENFORCE_EQ(values.size(), 100u);
+			for (int i = 0; i < 100; ++i)
+				ETC_ENFORCE_EQ(values[i], i * i);
+			ETC_ENFORCE_EQ(done, 1);
+		}
+
+	} // !anonymous
+
+}}
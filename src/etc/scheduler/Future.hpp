@@ -0,0 +1,212 @@
+#ifndef  ETC_SCHEDULER_FUTURE_HPP
+# define ETC_SCHEDULER_FUTURE_HPP
+
+# include "WaitList.hpp"
+
+# include <etc/Expected.hpp>
+# include <etc/scheduler.hpp>
+
+# include <memory>
+# include <mutex>
+# include <string>
+# include <vector>
+
+namespace etc { namespace scheduler {
+
+	namespace detail {
+
+		/// State shared by a Promise and its futures.
+		class FutureStateBase
+		{
+		protected:
+			std::mutex _mutex;
+			WaitList   _waiters;
+			bool       _ready;
+
+		public:
+			FutureStateBase();
+			virtual ~FutureStateBase();
+
+		public:
+			bool ready();
+			void wait();
+
+		protected:
+			/// Mark the state ready and wake up the waiters (locked).
+			void _set_ready();
+		};
+
+		template<typename T>
+		class FutureState
+			: public FutureStateBase
+		{
+		public:
+			Expected<T> result;
+
+		public:
+			FutureState()
+				: result{std::exception_ptr{}}
+			{}
+
+			/// Accepts the same arguments as Expected::reset().
+			template<typename... Args>
+			void set(Args&&... args)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (_ready)
+					throw exception::Exception{"Future already set"};
+				this->result.reset(std::forward<Args>(args)...);
+				this->_set_ready();
+			}
+		};
+
+		template<typename T>
+		T take(Expected<T>& result)
+		{ return std::move(result.value()); }
+
+		inline
+		void take(Expected<void>& result)
+		{ result.ensure(); }
+
+	} // !detail
+
+	/**
+	 * @brief Result of an asynchronous task.
+	 *
+	 * Waiting inside a context yields to the scheduler, other threads are
+	 * blocked.
+	 */
+	template<typename T>
+	class Future
+	{
+	public:
+		typedef T value_type;
+
+	private:
+		std::shared_ptr<detail::FutureState<T>> _state;
+
+	public:
+		Future()
+			: _state{}
+		{}
+
+		explicit
+		Future(std::shared_ptr<detail::FutureState<T>> state)
+			: _state{std::move(state)}
+		{}
+
+	public:
+		bool valid() const
+		{ return _state != nullptr; }
+
+		bool ready() const
+		{ return _state->ready(); }
+
+		void wait() const
+		{ _state->wait(); }
+
+		/// Wait for the value, or rethrow the task exception. The value is
+		/// moved out, get() is to be called once.
+		T get()
+		{
+			_state->wait();
+			return detail::take(_state->result);
+		}
+	};
+
+	/// Set the value of futures.
+	template<typename T>
+	class Promise
+	{
+	private:
+		std::shared_ptr<detail::FutureState<T>> _state;
+
+	public:
+		Promise()
+			: _state{std::make_shared<detail::FutureState<T>>()}
+		{}
+
+		Promise(Promise&& other)
+			: _state{std::move(other._state)}
+		{}
+
+		Promise(Promise const&) ETC_DELETED_FUNCTION;
+		Promise& operator =(Promise const&) ETC_DELETED_FUNCTION;
+
+		/// Futures still waiting get an exception.
+		~Promise()
+		{
+			if (_state != nullptr && !_state->ready())
+				_state->set(std::make_exception_ptr(
+					exception::Exception{"Broken promise"}
+				));
+		}
+
+	public:
+		Future<T> future() const
+		{ return Future<T>{_state}; }
+
+		template<typename... Args>
+		void set_value(Args&&... args)
+		{ _state->set(std::forward<Args>(args)...); }
+
+		void set_exception(std::exception_ptr error)
+		{ _state->set(std::move(error)); }
+	};
+
+	/// Spawn @a fn in @a sched, its result is returned through a future.
+	template<typename Fn>
+	auto spawn_future(Scheduler& sched, std::string name, Fn fn)
+		-> Future<decltype(fn())>
+	{
+		typedef decltype(fn()) value_type;
+		auto state = std::make_shared<detail::FutureState<value_type>>();
+		sched.spawn(
+			std::move(name),
+			[state, fn] (Context&) mutable {
+				state->set(Expected<value_type>::of(fn));
+			}
+		);
+		return Future<value_type>{std::move(state)};
+	}
+
+	template<typename Fn>
+	auto spawn_future(std::string name, Fn fn)
+		-> Future<decltype(fn())>
+	{ return spawn_future(current(), std::move(name), std::move(fn)); }
+
+	namespace detail {
+
+		template<typename T>
+		std::vector<T> collect(std::vector<Future<T>>& futures)
+		{
+			std::vector<T> res;
+			res.reserve(futures.size());
+			for (auto& future: futures)
+				res.push_back(future.get());
+			return res;
+		}
+
+		inline
+		void collect(std::vector<Future<void>>& futures)
+		{
+			for (auto& future: futures)
+				future.get();
+		}
+
+	} // !detail
+
+	/// Future of every value, in order, or of the first exception.
+	template<typename T>
+	auto when_all(std::vector<Future<T>> futures)
+		-> Future<decltype(detail::collect(futures))>
+	{
+		return spawn_future(
+			"when_all",
+			[futures] () mutable { return detail::collect(futures); }
+		);
+	}
+
+}}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef  ETC_SCHEDULER_RINGBUFFER_HPP
+# define ETC_SCHEDULER_RINGBUFFER_HPP
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <algorithm>
+# include <atomic>
+# include <memory>
+# include <new>
+# include <type_traits>
+# include <utility>
+
+namespace etc { namespace scheduler {
+
+	namespace detail {
+
+		inline
+		etc::size_type next_power_of_two(etc::size_type value) ETC_NOEXCEPT
+		{
+			etc::size_type res = 1;
+			while (res < value)
+				res <<= 1;
+			return res;
+		}
+
+		template<typename T>
+		struct RingSlot
+		{
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+			T& value() ETC_NOEXCEPT
+			{ return *reinterpret_cast<T*>(&storage); }
+		};
+
+	} // !detail
+
+	/**
+	 * @brief Bounded lock-free queue for any number of producers and
+	 * consumers.
+	 *
+	 * Each slot carries a sequence number telling whether it is ready to be
+	 * written or read for the current lap (Vyukov's queue). The capacity is
+	 * rounded up to a power of two.
+	 */
+	template<typename T>
+	class MPMCRing
+	{
+	private:
+		struct Cell
+			: public detail::RingSlot<T>
+		{
+			std::atomic<etc::size_type> sequence;
+		};
+
+		etc::size_type const        _mask;
+		std::unique_ptr<Cell[]>     _cells;
+		// Keep producers and consumers on different cache lines.
+		char                        _pad0[64];
+		std::atomic<etc::size_type> _enqueue;
+		char                        _pad1[64];
+		std::atomic<etc::size_type> _dequeue;
+		char                        _pad2[64];
+
+	public:
+		explicit
+		MPMCRing(etc::size_type const capacity)
+			: _mask{detail::next_power_of_two(std::max<etc::size_type>(capacity, 2)) - 1}
+			, _cells{new Cell[_mask + 1]}
+			, _enqueue{0}
+			, _dequeue{0}
+		{
+			for (etc::size_type i = 0; i <= _mask; ++i)
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		~MPMCRing()
+		{
+			etc::size_type end = _enqueue.load(std::memory_order_relaxed);
+			for (etc::size_type pos = _dequeue.load(std::memory_order_relaxed);
+			     pos != end;
+			     ++pos)
+				_cells[pos & _mask].value().~T();
+		}
+
+		MPMCRing(MPMCRing const&) ETC_DELETED_FUNCTION;
+		MPMCRing& operator =(MPMCRing const&) ETC_DELETED_FUNCTION;
+
+	public:
+		etc::size_type capacity() const ETC_NOEXCEPT
+		{ return _mask + 1; }
+
+		/// Approximate count of values.
+		etc::size_type size() const ETC_NOEXCEPT
+		{
+			etc::size_type enqueue = _enqueue.load(std::memory_order_relaxed);
+			etc::size_type dequeue = _dequeue.load(std::memory_order_relaxed);
+			return enqueue > dequeue ? enqueue - dequeue : 0;
+		}
+
+		/// Move @a value in, false when full.
+		bool try_push(T& value)
+		{
+			etc::size_type pos = _enqueue.load(std::memory_order_relaxed);
+			Cell* cell;
+			while (true)
+			{
+				cell = &_cells[pos & _mask];
+				etc::size_type seq = cell->sequence.load(std::memory_order_acquire);
+				auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+				if (diff == 0)
+				{
+					if (_enqueue.compare_exchange_weak(pos, pos + 1,
+					                                   std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false;
+				else
+					pos = _enqueue.load(std::memory_order_relaxed);
+			}
+			new (&cell->storage) T(std::move(value));
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Move the front value out, false when empty.
+		bool try_pop(T& value)
+		{
+			etc::size_type pos = _dequeue.load(std::memory_order_relaxed);
+			Cell* cell;
+			while (true)
+			{
+				cell = &_cells[pos & _mask];
+				etc::size_type seq = cell->sequence.load(std::memory_order_acquire);
+				auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+				if (diff == 0)
+				{
+					if (_dequeue.compare_exchange_weak(pos, pos + 1,
+					                                   std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false;
+				else
+					pos = _dequeue.load(std::memory_order_relaxed);
+			}
+			value = std::move(cell->value());
+			cell->value().~T();
+			cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		template<typename Iterator>
+		etc::size_type try_push_n(Iterator first, etc::size_type const count)
+		{
+			etc::size_type res = 0;
+			for (; res < count && this->try_push(*first); ++res, ++first)
+				;
+			return res;
+		}
+
+		template<typename Iterator>
+		etc::size_type try_pop_n(Iterator out, etc::size_type const max)
+		{
+			etc::size_type res = 0;
+			T value;
+			for (; res < max && this->try_pop(value); ++res, ++out)
+				*out = std::move(value);
+			return res;
+		}
+	};
+
+	/**
+	 * @brief Bounded lock-free queue for one producer and one consumer.
+	 *
+	 * Each side caches the index of the other one, and only reloads it when
+	 * the queue looks full or empty. Batches publish their values at once.
+	 */
+	template<typename T>
+	class SPSCRing
+	{
+	private:
+		etc::size_type const                  _mask;
+		std::unique_ptr<detail::RingSlot<T>[]> _slots;
+		char                                  _pad0[64];
+		// Producer side.
+		std::atomic<etc::size_type>           _tail;
+		etc::size_type                        _cached_head;
+		char                                  _pad1[64];
+		// Consumer side.
+		std::atomic<etc::size_type>           _head;
+		etc::size_type                        _cached_tail;
+		char                                  _pad2[64];
+
+	public:
+		explicit
+		SPSCRing(etc::size_type const capacity)
+			: _mask{detail::next_power_of_two(capacity) - 1}
+			, _slots{new detail::RingSlot<T>[_mask + 1]}
+			, _tail{0}
+			, _cached_head{0}
+			, _head{0}
+			, _cached_tail{0}
+		{}
+
+		~SPSCRing()
+		{
+			etc::size_type head = _head.load(std::memory_order_relaxed);
+			etc::size_type tail = _tail.load(std::memory_order_relaxed);
+			for (; head != tail; ++head)
+				_slots[head & _mask].value().~T();
+		}
+
+		SPSCRing(SPSCRing const&) ETC_DELETED_FUNCTION;
+		SPSCRing& operator =(SPSCRing const&) ETC_DELETED_FUNCTION;
+
+	public:
+		etc::size_type capacity() const ETC_NOEXCEPT
+		{ return _mask + 1; }
+
+		etc::size_type size() const ETC_NOEXCEPT
+		{
+			return _tail.load(std::memory_order_acquire) -
+			       _head.load(std::memory_order_acquire);
+		}
+
+		bool try_push(T& value)
+		{ return this->try_push_n(&value, 1) == 1; }
+
+		bool try_pop(T& value)
+		{ return this->try_pop_n(&value, 1) == 1; }
+
+		template<typename Iterator>
+		etc::size_type try_push_n(Iterator first, etc::size_type count)
+		{
+			etc::size_type tail = _tail.load(std::memory_order_relaxed);
+			if (tail + count - _cached_head > this->capacity())
+				_cached_head = _head.load(std::memory_order_acquire);
+			count = std::min(count, this->capacity() - (tail - _cached_head));
+			for (etc::size_type i = 0; i < count; ++i, ++first)
+				new (&_slots[(tail + i) & _mask].storage) T(std::move(*first));
+			if (count > 0)
+				_tail.store(tail + count, std::memory_order_release);
+			return count;
+		}
+
+		template<typename Iterator>
+		etc::size_type try_pop_n(Iterator out, etc::size_type max)
+		{
+			etc::size_type head = _head.load(std::memory_order_relaxed);
+			if (_cached_tail - head < max)
+				_cached_tail = _tail.load(std::memory_order_acquire);
+			max = std::min(max, _cached_tail - head);
+			for (etc::size_type i = 0; i < max; ++i, ++out)
+			{
+				T& value = _slots[(head + i) & _mask].value();
+				*out = std::move(value);
+				value.~T();
+			}
+			if (max > 0)
+				_head.store(head + max, std::memory_order_release);
+			return max;
+		}
+	};
+
+}}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef  ETC_SCHEDULER_RUNQUEUE_HPP
+# define ETC_SCHEDULER_RUNQUEUE_HPP
+
+# include "fwd.hpp"
+
+# include <etc/types.hpp>
+
+# include <atomic>
+# include <cstdint>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Lock-free run queue of a worker.
+	 *
+	 * A bounded FIFO where only the worker owning the queue pushes, while
+	 * any worker can pop: the owner takes its next context from the front,
+	 * idle workers steal half of the queue at once.
+	 */
+	class RunQueue
+	{
+	public:
+		static etc::size_type const capacity = 256;
+
+	private:
+		std::atomic<uint32_t>  _head;
+		// Keep the owner and the thieves on different cache lines.
+		char                   _pad[60];
+		std::atomic<uint32_t>  _tail;
+		std::atomic<Context*>  _slots[capacity];
+
+	public:
+		RunQueue()
+			: _head{0}
+			, _tail{0}
+		{}
+
+		/// Push a context at the back, false when the queue is full (owner
+		/// only).
+		bool push(Context* ctx)
+		{
+			uint32_t head = _head.load(std::memory_order_acquire);
+			uint32_t tail = _tail.load(std::memory_order_relaxed);
+			if (tail - head >= capacity)
+				return false;
+			_slots[tail % capacity].store(ctx, std::memory_order_relaxed);
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Pop the front context, nullptr when empty.
+		Context* pop()
+		{
+			uint32_t head = _head.load(std::memory_order_acquire);
+			while (true)
+			{
+				uint32_t tail = _tail.load(std::memory_order_acquire);
+				if (tail == head)
+					return nullptr;
+				Context* res = _slots[head % capacity].load(std::memory_order_relaxed);
+				// On failure, head is reloaded.
+				if (_head.compare_exchange_weak(head, head + 1,
+				                                std::memory_order_acq_rel))
+					return res;
+			}
+		}
+
+		/**
+		 * @brief Steal half of the contexts of @a victim.
+		 *
+		 * The first stolen context is returned, the others are pushed in
+		 * this queue, which must be empty (owner only).
+		 */
+		Context* steal(RunQueue& victim)
+		{
+			uint32_t tail = _tail.load(std::memory_order_relaxed);
+			uint32_t count;
+			while (true)
+			{
+				uint32_t head = victim._head.load(std::memory_order_acquire);
+				uint32_t victim_tail = victim._tail.load(std::memory_order_acquire);
+				count = victim_tail - head;
+				count -= count / 2;
+				if (count == 0)
+					return nullptr;
+				// Head and tail were read at different times.
+				if (count > capacity / 2)
+					continue;
+				for (uint32_t i = 0; i < count; ++i)
+					_slots[(tail + i) % capacity].store(
+						victim._slots[(head + i) % capacity].load(std::memory_order_relaxed),
+						std::memory_order_relaxed
+					);
+				if (victim._head.compare_exchange_weak(head, head + count,
+				                                       std::memory_order_acq_rel))
+					break;
+			}
+			count -= 1;
+			Context* res = _slots[(tail + count) % capacity].load(std::memory_order_relaxed);
+			if (count > 0)
+				_tail.store(tail + count, std::memory_order_release);
+			return res;
+		}
+
+		etc::size_type size() const
+		{
+			uint32_t head = _head.load(std::memory_order_acquire);
+			uint32_t tail = _tail.load(std::memory_order_acquire);
+			return tail - head;
+		}
+
+		bool empty() const
+		{ return this->size() == 0; }
+	};
+
+}}
+
+#endif
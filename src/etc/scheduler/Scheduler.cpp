@@ -2,15 +2,22 @@
 
 #include <etc/test.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+
 //#include <boost/asio/spawn.hpp>
-#include <boost/asio/deadline_timer.hpp>
 
 namespace etc { namespace scheduler {
 
 	ETC_LOG_COMPONENT("etc.scheduler.Scheduler");
 
-	Scheduler::Scheduler()
-		: _this{new Impl(*this)}
+	etc::size_type const Scheduler::any_worker;
+
+	Scheduler::Scheduler(etc::size_type const thread_count,
+	                     etc::size_type const stack_size)
+		: _this{new Impl(*this, thread_count, stack_size)}
 	{}
 
 	Scheduler::~Scheduler()
@@ -29,34 +36,73 @@ namespace etc { namespace scheduler {
 	}
 
 	void Scheduler::sleep(int sec)
+	{
+		this->sleep_for(std::chrono::seconds(sec));
+	}
+
+	void Scheduler::sleep_until(clock_type::time_point const& deadline)
 	{
 		if (_this->current() == nullptr)
 			throw Exception{"Cannot use sleep() without context"};
 
-		Context& ctx = *_this->current();
-		boost::asio::deadline_timer timer(_this->service);
-		timer.expires_from_now(boost::posix_time::seconds(sec));
-		boost::system::error_code ec;
-		timer.async_wait(
-			[&] (boost::system::error_code const&) {
-				ETC_LOG.debug("Timer expired after", sec, "seconds");
-				this->_this->wakeup(ctx);
+		struct SleepTimer
+			: public TimerWheel::Timer
+		{
+			Impl&    scheduler;
+			Context& ctx;
+
+			SleepTimer(Impl& scheduler, Context& ctx)
+				: scheduler(scheduler)
+				, ctx(ctx)
+			{
+				this->callback = [] (TimerWheel::Timer& timer) {
+					auto& self = static_cast<SleepTimer&>(timer);
+					self.scheduler.wakeup(self.ctx);
+				};
 			}
-		);
+		};
+
+		Context& ctx = *_this->current();
+		SleepTimer timer{*_this, ctx};
 		_this->freeze(ctx);
+		_this->arm_timer(timer, deadline);
+		ETC_SCOPE_EXIT{ _this->cancel_timer(timer); };
 		ctx.yield();
 		ETC_LOG.debug("Waking up job", ctx, ctx.name);
 	}
 
-	void Scheduler::spawn(std::string name,
-	                      handler_type const& fn)
+	void Scheduler::_spawn(std::string name,
+	                       handler_setup_type setup,
+	                       void* hdlr,
+	                       etc::size_type const worker)
+	{
+		_this->push(std::move(name), setup, hdlr, worker);
+	}
+
+	etc::size_type Scheduler::thread_count() const
+	{ return _this->thread_count(); }
+
+	etc::size_type Scheduler::stack_size() const
+	{ return _this->stacks().stack_size(); }
+
+	etc::size_type Scheduler::worker() const
 	{
-		_this->push(std::move(name), fn);
+		auto worker = _this->current_worker();
+		return worker == nullptr ? any_worker : worker->index;
 	}
 
 	Strand Scheduler::strand()
 	{ return Strand{*this, etc::make_unique<Strand::Impl>(_this->service)}; }
 
+	Stats Scheduler::stats() const
+	{ return _this->stats(); }
+
+	void Scheduler::start_trace()
+	{ _this->start_trace(); }
+
+	Trace Scheduler::stop_trace()
+	{ return _this->stop_trace(); }
+
 	namespace {
 
 		ETC_TEST_CASE(run)
@@ -153,6 +199,41 @@ namespace etc { namespace scheduler {
 			catch (...) { /* ok */ }
 		}
 
+		ETC_TEST_CASE(sleep_for)
+		{
+			typedef Scheduler::clock_type clock_type;
+			Scheduler r;
+			clock_type::duration elapsed;
+			r.spawn("main", [&] (Context&) {
+				auto start = clock_type::now();
+				r.sleep_for(std::chrono::milliseconds(5));
+				elapsed = clock_type::now() - start;
+			});
+			r.run();
+			ETC_ENFORCE_GTE(elapsed, std::chrono::milliseconds(5));
+			ETC_ENFORCE_LT(elapsed, std::chrono::milliseconds(100));
+		}
+
+		ETC_TEST_CASE(sleep_many)
+		{
+			typedef Scheduler::clock_type clock_type;
+			Scheduler r{2};
+			std::atomic<int> early{0};
+			std::atomic<int> done{0};
+			auto start = clock_type::now();
+			for (int i = 0; i < 2000; ++i)
+				r.spawn("sleeper", [&, i] (Context&) {
+					auto deadline = start + std::chrono::microseconds(i * 7919 % 20000);
+					r.sleep_until(deadline);
+					if (clock_type::now() < deadline)
+						early += 1;
+					done += 1;
+				});
+			r.run();
+			ETC_ENFORCE_EQ(done.load(), 2000);
+			ETC_ENFORCE_EQ(early.load(), 0);
+		}
+
 		ETC_TEST_CASE(run_in_spawned)
 		{
 			Scheduler r;
@@ -199,6 +280,318 @@ namespace etc { namespace scheduler {
 			r.spawn("Stop", [&] (Context&) { r.stop(); });
 		}
 
+		ETC_TEST_CASE(multi_thread)
+		{
+			Scheduler r{4};
+			ETC_ENFORCE_EQ(r.thread_count(), 4u);
+			std::atomic<int> done{0};
+			std::mutex mutex;
+			std::set<std::thread::id> threads;
+			r.spawn("spawner", [&] (Context&) {
+				for (int i = 0; i < 1000; ++i)
+					r.spawn("job", [&] (Context& ctx) {
+						for (int j = 0; j < 10; ++j)
+						{
+							{
+								std::lock_guard<std::mutex> lock(mutex);
+								threads.insert(std::this_thread::get_id());
+							}
+							ctx.yield();
+						}
+						done += 1;
+					});
+			});
+			r.run();
+			ETC_ENFORCE_EQ(done.load(), 1000);
+			ETC_ENFORCE_LTE(threads.size(), 4u);
+			ETC_LOG.debug("Jobs ran on", threads.size(), "threads");
+		}
+
+		ETC_TEST_CASE(affinity)
+		{
+			Scheduler r{4};
+			auto main_thread = std::this_thread::get_id();
+			std::atomic<int> wrong{0}, done{0};
+			for (int i = 0; i < 20; ++i)
+			{
+				r.spawn("pinned", [&] (Context& ctx) {
+					for (int j = 0; j < 100; ++j)
+					{
+						if (std::this_thread::get_id() != main_thread ||
+						    r.worker() != 0)
+							wrong += 1;
+						ctx.yield();
+					}
+					done += 1;
+				}, 0);
+				r.spawn("free", [&] (Context& ctx) {
+					for (int j = 0; j < 100; ++j)
+						ctx.yield();
+					done += 1;
+				});
+			}
+			ETC_TEST_THROW_TYPE({
+				r.spawn("invalid", [] (Context&) {}, 4);
+			}, Exception);
+			r.run();
+			ETC_ENFORCE_EQ(done.load(), 40);
+			ETC_ENFORCE_EQ(wrong.load(), 0);
+			ETC_ENFORCE_EQ(r.worker(), Scheduler::any_worker);
+		}
+
+		ETC_TEST_CASE(recycle_contexts)
+		{
+			Scheduler r;
+			int done = 0;
+			r.spawn("spawner", [&] (Context& ctx) {
+				for (int i = 0; i < 1000; ++i)
+				{
+					r.spawn("job", [&] (Context&) { done += 1; });
+					ctx.yield();
+				}
+			});
+			r.run();
+			ETC_ENFORCE_EQ(done, 1000);
+			// The spawner and a job at most.
+			ETC_ENFORCE_LTE(r.impl().stacks().allocated(), 2u);
+		}
+
+		ETC_TEST_CASE(handler_storage)
+		{
+			Scheduler r{1, 256 * 1024};
+			ETC_ENFORCE_GTE(r.stack_size(), 256u * 1024u);
+			char big[Context::inline_handler_size * 2] = {1};
+			int sum = 0;
+			r.spawn("big handler", [&, big] (Context&) { sum += big[0]; });
+			r.spawn("deep stack", [&] (Context&) {
+				volatile char buffer[128 * 1024];
+				buffer[0] = 1;
+				buffer[sizeof(buffer) - 1] = 1;
+				sum += buffer[0] + buffer[sizeof(buffer) - 1];
+			});
+			r.run();
+			ETC_ENFORCE_EQ(sum, 3);
+		}
+
+		// Move only, so that it cannot go through a std::function.
+		template<etc::size_type size>
+		struct CountedHandler
+		{
+			int* moves;
+			int* calls;
+			char payload[size];
+
+			CountedHandler(int* moves, int* calls)
+				: moves(moves)
+				, calls(calls)
+				, payload{}
+			{}
+
+			CountedHandler(CountedHandler&& other)
+				: moves(other.moves)
+				, calls(other.calls)
+				, payload{}
+			{ *this->moves += 1; }
+
+			CountedHandler(CountedHandler const&) = delete;
+
+			void operator ()(Context&)
+			{ *this->calls += 1; }
+		};
+
+		template<etc::size_type size>
+		void check_handler_forwarding()
+		{
+			Scheduler r{2};
+			int moves = 0;
+			int calls = 0;
+			r.spawn("handler", CountedHandler<size>{&moves, &calls});
+			r.spawn("pinned", CountedHandler<size>{&moves, &calls}, 1);
+			r.run();
+			ETC_ENFORCE_EQ(calls, 2);
+			// Moved once, from the caller to the context.
+			ETC_ENFORCE_EQ(moves, 2);
+		}
+
+		ETC_TEST_CASE(handler_forwarding)
+		{
+			static_assert(
+				sizeof(CountedHandler<32>) <= Context::inline_handler_size,
+				"Should be stored in the context"
+			);
+			check_handler_forwarding<32>();
+			static_assert(
+				sizeof(CountedHandler<128>) > Context::inline_handler_size,
+				"Should be allocated"
+			);
+			check_handler_forwarding<128>();
+		}
+
+		ETC_TEST_CASE(stats)
+		{
+			typedef Scheduler::clock_type clock_type;
+			Scheduler r{2};
+			for (int i = 0; i < 10; ++i)
+				r.spawn("yield", [&] (Context& ctx) {
+					for (int j = 0; j < 5; ++j)
+						ctx.yield();
+				});
+			r.spawn("sleep", [&] (Context& ctx) {
+				auto end = clock_type::now() + std::chrono::milliseconds(1);
+				while (clock_type::now() < end)
+					;
+				r.sleep_for(std::chrono::milliseconds(2));
+				ETC_ENFORCE_GTE(ctx.run_time, std::chrono::milliseconds(1));
+				ETC_ENFORCE_GTE(ctx.wait_time, std::chrono::milliseconds(2));
+			});
+			r.run();
+			Stats stats = r.stats();
+			ETC_LOG.debug(stats);
+			ETC_ENFORCE_EQ(stats.completed, 11u);
+			ETC_ENFORCE_GTE(stats.yields, 50u);
+			ETC_ENFORCE_GTE(stats.freezes, 1u);
+			ETC_ENFORCE_EQ(stats.switches,
+			               stats.completed + stats.yields + stats.freezes);
+			ETC_ENFORCE_GTE(stats.timers, 1u);
+			ETC_ENFORCE_GTE(stats.run_time, std::chrono::milliseconds(1));
+			ETC_ENFORCE_GTE(stats.wait_time, std::chrono::milliseconds(2));
+			ETC_ENFORCE_EQ(stats.alive, 0u);
+			ETC_ENFORCE_EQ(stats.frozen, 0u);
+			ETC_ENFORCE_EQ(stats.queued, 0u);
+		}
+
+		// Two contexts wake each other from any thread, possibly before
+		// the other one yielded.
+		void ping_pong(Scheduler& r, int const count)
+		{
+			Context* contexts[2] = {nullptr, nullptr};
+			std::atomic<int> ready{0};
+			for (int side = 0; side < 2; ++side)
+				r.spawn("player", [&, side] (Context& ctx) {
+					contexts[side] = &ctx;
+					ready += 1;
+					while (ready.load() < 2)
+						ctx.yield();
+					Context& other = *contexts[1 - side];
+					for (int i = side; i < count; i += 2)
+					{
+						if (i > 0)
+						{
+							r.impl().freeze(ctx);
+							ctx.yield();
+						}
+						r.impl().wakeup(other);
+					}
+				});
+			r.run();
+		}
+
+		ETC_TEST_CASE(wakeup_migration)
+		{
+			for (etc::size_type threads: {1, 2, 4})
+			{
+				Scheduler r{threads};
+				ping_pong(r, 2000);
+			}
+		}
+
+		ETC_TEST_CASE(wakeup_while_yielding)
+		{
+			for (etc::size_type threads: {1, 2, 4})
+			{
+				Scheduler r{threads};
+				std::atomic<Context*> target{nullptr};
+				std::atomic<bool> sent{false};
+				bool woken = false;
+				r.spawn("target", [&] (Context& ctx) {
+					target = &ctx;
+					while (!sent.load())
+						ctx.yield();
+					// The wakeup() already happened.
+					r.impl().freeze(ctx);
+					ctx.yield();
+					woken = true;
+				});
+				r.spawn("waker", [&] (Context& ctx) {
+					while (target.load() == nullptr)
+						ctx.yield();
+					r.impl().wakeup(*target.load());
+					sent = true;
+				});
+				r.run();
+				ETC_ENFORCE(woken);
+			}
+		}
+
+		template<typename Fn>
+		void benchmark(std::string const& name, int const count, Fn fn)
+		{
+			etc::size_type max_threads = std::max<etc::size_type>(
+				2, std::thread::hardware_concurrency()
+			);
+			for (etc::size_type threads = 1; threads <= max_threads; threads *= 2)
+			{
+				Scheduler r{threads};
+				auto start = std::chrono::steady_clock::now();
+				fn(r);
+				auto end = std::chrono::steady_clock::now();
+				auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+					end - start
+				).count();
+				ETC_LOG.info(name, "with", threads, "threads:",
+				             count * 1000000.0 / std::max<int64_t>(us, 1),
+				             "per second");
+			}
+		}
+
+		ETC_BENCHMARK_CASE(benchmark)
+		{
+			// CPU-bound jobs spawned by one context.
+			int const jobs = 20000;
+			benchmark("spawn", jobs, [&] (Scheduler& r) {
+				std::atomic<uint64_t> sum{0};
+				r.spawn("spawner", [&] (Context&) {
+					for (int i = 0; i < jobs; ++i)
+						r.spawn("job", [&, i] (Context&) {
+							uint64_t value = i;
+							for (int j = 0; j < 1000; ++j)
+								value = value * 6364136223846793005u + 1;
+							sum += value;
+						});
+				});
+				r.run();
+			});
+
+			// Spawn a job and wait for its completion.
+			int const round_trips = 50000;
+			benchmark("spawn and complete", round_trips, [&] (Scheduler& r) {
+				r.spawn("spawner", [&] (Context& ctx) {
+					for (int i = 0; i < round_trips; ++i)
+					{
+						r.impl().freeze(ctx);
+						r.spawn("job", [&] (Context&) { r.impl().wakeup(ctx); });
+						ctx.yield();
+					}
+				});
+				r.run();
+			});
+
+			int const yields = 100000;
+			benchmark("yield", yields, [&] (Scheduler& r) {
+				for (int i = 0; i < 8; ++i)
+					r.spawn("yield", [&] (Context& ctx) {
+						for (int j = 0; j < yields / 8; ++j)
+							ctx.yield();
+					});
+				r.run();
+			});
+
+			int const wakeups = 20000;
+			benchmark("wakeup", wakeups, [&] (Scheduler& r) {
+				ping_pong(r, wakeups);
+			});
+		}
+
 	} // !anonymous
 
 }} // !etc::scheduler
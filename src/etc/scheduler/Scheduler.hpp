@@ -2,40 +2,111 @@
 # define ETC_SCHEDULER_SCHEDULER_HPP
 
 # include "fwd.hpp"
+# include "Stats.hpp"
+# include "Trace.hpp"
 
 # include <etc/memory.hpp>
+# include <etc/types.hpp>
 
+# include <chrono>
 # include <functional>
 # include <string>
 
 namespace etc { namespace scheduler {
 
+	/**
+	 * @brief Run coroutines on a pool of worker threads.
+	 *
+	 * Every worker has its own run queue, idle workers steal contexts from
+	 * the others, so that a context can be resumed by any worker after each
+	 * yield. Contexts spawned with a worker affinity are only run by that
+	 * worker, the worker 0 being the thread calling run().
+	 *
+	 * run() returns once every spawned context is done, or when the
+	 * scheduler is stopped.
+	 */
 	class Scheduler
 	{
 	public:
 		typedef std::function<void(Context&)> handler_type;
+		typedef std::chrono::steady_clock clock_type;
 		struct Impl;
+
+		/// No worker affinity.
+		static etc::size_type const any_worker = static_cast<etc::size_type>(-1);
+
 	private:
 		std::unique_ptr<Impl> _this;
 
 	public:
-		Scheduler();
+		/// Use @a thread_count workers, 0 picks a value from the hardware.
+		/// Contexts get stacks of @a stack_size bytes, 0 for the default.
+		explicit
+		Scheduler(etc::size_type const thread_count = 1,
+		          etc::size_type const stack_size = 0);
 		~Scheduler();
 
 		void run();
 		void stop();
-		void spawn(std::string name, handler_type const& fn);
+		/// Spawn a context running @a hdlr, stored in the context itself
+		/// when small enough.
+		template<typename Handler>
+		void spawn(std::string name, Handler&& hdlr);
+		/// Spawn a context only run by @a worker.
+		template<typename Handler>
+		void spawn(std::string name,
+		           Handler&& hdlr,
+		           etc::size_type const worker);
 		void sleep(int sec);
 
+		/// Suspend the current context until @a deadline.
+		void sleep_until(clock_type::time_point const& deadline);
+
+		/// Suspend the current context for @a duration.
+		template<typename Rep, typename Period>
+		void sleep_for(std::chrono::duration<Rep, Period> const& duration)
+		{
+			this->sleep_until(
+				clock_type::now() +
+				std::chrono::duration_cast<clock_type::duration>(duration)
+			);
+		}
+
+		etc::size_type thread_count() const;
+
+		/// Usable stack size of the contexts.
+		etc::size_type stack_size() const;
+
+		/// Worker running the caller, any_worker out of this scheduler.
+		etc::size_type worker() const;
+
 		Strand strand();
 
+		/// Counters since the scheduler creation.
+		Stats stats() const;
+
+		/// Record context switches and idle workers until stop_trace().
+		void start_trace();
+
+		/// Events recorded since start_trace().
+		Trace stop_trace();
+
 	public:
 		inline Impl& impl() { return *_this; }
 		Context* current();
 		Context& context();
+
+	private:
+		typedef void (*handler_setup_type)(Context& ctx, void* hdlr);
+		void _spawn(std::string name,
+		            handler_setup_type setup,
+		            void* hdlr,
+		            etc::size_type const worker);
 	};
 
 
 }}
 
+# include "Scheduler.inl"
+
 #endif
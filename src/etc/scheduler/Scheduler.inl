@@ -0,0 +1,33 @@
+#ifndef  ETC_SCHEDULER_SCHEDULER_INL
+# define ETC_SCHEDULER_SCHEDULER_INL
+
+# include "Context.hpp"
+# include "Scheduler.hpp"
+
+# include <memory>
+
+namespace etc { namespace scheduler {
+
+	template<typename Handler>
+	void Scheduler::spawn(std::string name, Handler&& hdlr)
+	{
+		this->spawn(std::move(name), std::forward<Handler>(hdlr), any_worker);
+	}
+
+	template<typename Handler>
+	void Scheduler::spawn(std::string name,
+	                      Handler&& hdlr,
+	                      etc::size_type const worker)
+	{
+		// The handler is moved or copied once, straight into the context.
+		this->_spawn(
+			std::move(name),
+			&Context::setup_handler<Handler>,
+			const_cast<void*>(static_cast<void const*>(std::addressof(hdlr))),
+			worker
+		);
+	}
+
+}}
+
+#endif
@@ -2,36 +2,707 @@
 
 #include <etc/log.hpp>
 
-#include <unordered_map>
+#include <algorithm>
+#include <iterator>
 
 namespace etc { namespace scheduler {
 
 	ETC_LOG_COMPONENT("etc.scheduler.Scheduler");
 
-	typedef std::unordered_map<std::thread::id, Scheduler*> schedulers_map;
-
 	namespace {
 
-		inline schedulers_map& schedulers()
-		{
-			static schedulers_map scheds;
-			return scheds;
-		}
+		// Contexts migrate between threads: these are only read by the
+		// functions below, never inlined, so that a context does not keep
+		// the thread locals of the thread it ran on before yielding.
+		thread_local Scheduler*               t_scheduler = nullptr;
+		thread_local Scheduler::Impl::Worker* t_worker = nullptr;
+		thread_local Context*                 t_context = nullptr;
 
-	}
+		// The global queue is checked first every few ticks, so that it
+		// cannot starve.
+		etc::size_type const global_check_interval = 61;
+
+		// A busy worker polls I/O every few ticks.
+		etc::size_type const io_check_interval = 31;
+
+		// I/O handlers run by a busy worker at once.
+		etc::size_type const max_io_handlers = 32;
+
+		// Released contexts kept by each worker.
+		etc::size_type const max_free_contexts = 128;
+
+		// Sleeps and deadlines are rounded up to this resolution.
+		std::chrono::microseconds const timer_resolution{100};
+
+		// Trace events kept by each worker.
+		etc::size_type const max_trace_events = 1 << 20;
+
+	} // !anonymous
 
 	void Scheduler::Impl::current_scheduler(Scheduler* sched)
 	{
 		ETC_LOG.debug("Setting the current scheduler to", sched);
-		schedulers()[std::this_thread::get_id()] = sched;
+		t_scheduler = sched;
 	}
 
 	Scheduler& Scheduler::Impl::current_scheduler()
 	{
-		auto it = schedulers().find(std::this_thread::get_id());
-		if (it != schedulers().end() && it->second != nullptr)
-			return *it->second;
+		if (t_scheduler != nullptr)
+			return *t_scheduler;
 		throw exception::Exception("No scheduler available");
 	}
 
+	ETC_NOINLINE
+	Scheduler* Scheduler::Impl::find_current_scheduler()
+	{ return t_scheduler; }
+
+	Scheduler::Impl::Worker::Worker(Impl& scheduler, etc::size_type const index)
+		: scheduler(scheduler)
+		, index{index}
+		, queue{}
+		, mailbox_mutex{}
+		, mailbox{}
+		, mailbox_size{0}
+		, parked{false}
+		, tick{0}
+		, random{static_cast<uint32_t>(index * 2654435761u + 1)}
+		, free_contexts{}
+		, counters{}
+		, trace_mutex{}
+		, trace{}
+		, trace_dropped{0}
+	{}
+
+	Scheduler::Impl::Worker::~Worker()
+	{
+		for (Context* ctx: this->free_contexts)
+			delete ctx;
+	}
+
+	Scheduler::Impl::Impl(Scheduler& sched,
+	                      etc::size_type const thread_count,
+	                      etc::size_type const stack_size)
+		: service()
+		, _sched(sched)
+		, _work(etc::stack_ptr_no_init)
+		, _running{false}
+		, _stopping{false}
+		, _threads{}
+		, _thread_count{thread_count}
+		, _stacks{stack_size}
+		, _workers{}
+		, _global_mutex{}
+		, _global{}
+		, _global_size{0}
+		, _alive{0}
+		, _parked{0}
+		, _errors_mutex{}
+		, _errors{}
+		, _timers_mutex{}
+		, _timers{timer_resolution}
+		, _timers_size{0}
+		, _timer{service}
+		, _timer_armed{false}
+		, _timer_deadline{}
+		, _timers_fired{0}
+		, _tracing{false}
+		, _trace_start{}
+	{
+		if (_thread_count == 0)
+			_thread_count = std::max<etc::size_type>(
+				1, std::thread::hardware_concurrency()
+			);
+		for (etc::size_type i = 0; i < _thread_count; ++i)
+			_workers.emplace_back(new Worker{*this, i});
+		ETC_TRACE_CTOR("with", _thread_count, "threads");
+	}
+
+	Scheduler::Impl::~Impl()
+	{
+		ETC_TRACE_DTOR();
+		_work.clear();
+	}
+
+	ETC_NOINLINE
+	Context* Scheduler::Impl::current()
+	{
+		if (t_worker == nullptr || &t_worker->scheduler != this)
+			return nullptr;
+		return t_context;
+	}
+
+	ETC_NOINLINE
+	Scheduler::Impl::Worker* Scheduler::Impl::current_worker()
+	{
+		if (t_worker == nullptr || &t_worker->scheduler != this)
+			return nullptr;
+		return t_worker;
+	}
+
+	void Scheduler::Impl::run()
+	{
+		if (_running)
+			throw Exception{"Already running scheduler"};
+		_running = true;
+		ETC_SCOPE_EXIT{ _running = false; };
+		if (_alive.load() == 0)
+		{
+			ETC_LOG.debug(*this, "Nothing to run");
+			return;
+		}
+		_stopping.store(false);
+		_errors.clear();
+		// The service may have been stopped out of run().
+		this->service.reset();
+		// Idle workers block in the service.
+		_work.reset(this->service);
+
+		for (etc::size_type i = 1; i < _thread_count; ++i)
+			_threads.emplace_back(
+				[this, i] { this->_run_worker(*_workers[i]); }
+			);
+
+		// Block main thread.
+		ETC_LOG.debug(*this, "Running on main thread");
+		this->_run_worker(*_workers[0]);
+
+		// Wait until every thread is done.
+		ETC_LOG.debug(*this, "Joining", _threads.size(), "threads");
+		for (auto& thread: _threads)
+			if (thread.joinable()) thread.join();
+		_threads.clear();
+		_work.clear();
+
+		this->service.reset();
+
+		if (!_errors.empty())
+		{
+			std::string error_msg = "Scheduler errors:\n";
+			for (auto& pair: _errors)
+				error_msg += "  * " + exception::string(pair.second) + "\n";
+
+			ETC_LOG.error(*this, error_msg);
+			throw Exception{error_msg}; // XXX Should have an exception list.
+		}
+	}
+
+	void Scheduler::Impl::stop()
+	{
+		// Workers, failing jobs and the user may all stop at once.
+		if (_stopping.exchange(true))
+			return;
+		_work.clear();
+		this->service.stop();
+	}
+
+	void Scheduler::Impl::_run_worker(Worker& worker)
+	{
+		t_worker = &worker;
+		current_scheduler(&_sched);
+		ETC_SCOPE_EXIT{
+			current_scheduler(nullptr);
+			t_worker = nullptr;
+		};
+		ETC_LOG.debug(*this, "Worker", worker.index, "started");
+		while (!_stopping.load(std::memory_order_acquire))
+		{
+			try
+			{
+				if (Context* ctx = this->_next(worker))
+					this->_resume(worker, ctx);
+				else
+					this->_park(worker);
+			}
+			catch (...)
+			{
+				ETC_LOG.error("Worker", worker.index, "exited with error:",
+				              exception::string());
+				this->_error(worker.index, std::current_exception());
+			}
+		}
+		ETC_LOG.debug(*this, "Worker", worker.index, "exited gracefully");
+	}
+
+	Context* Scheduler::Impl::_next(Worker& worker)
+	{
+		worker.tick += 1;
+		if (worker.tick % global_check_interval == 0 &&
+		    _global_size.load(std::memory_order_relaxed) > 0)
+		{
+			if (Context* ctx = this->_take_global(worker))
+				return ctx;
+		}
+		if (worker.tick % io_check_interval == 0)
+		{
+			this->_poll_timers();
+			this->_poll_io(worker);
+		}
+
+		// Pinned and local contexts take turns.
+		Context* ctx = nullptr;
+		if ((worker.tick & 1) != 0)
+			ctx = this->_pop_mailbox(worker);
+		if (ctx == nullptr)
+			ctx = worker.queue.pop();
+		if (ctx == nullptr)
+			ctx = this->_pop_mailbox(worker);
+		if (ctx != nullptr)
+			return ctx;
+
+		if (_global_size.load(std::memory_order_relaxed) > 0)
+			if ((ctx = this->_take_global(worker)) != nullptr)
+				return ctx;
+
+		// Woken up contexts land in the local queue.
+		this->_poll_io(worker);
+		if ((ctx = worker.queue.pop()) != nullptr)
+			return ctx;
+
+		// Steal from the other workers, starting from a random one.
+		worker.random ^= worker.random << 13;
+		worker.random ^= worker.random >> 17;
+		worker.random ^= worker.random << 5;
+		etc::size_type count = _workers.size();
+		for (etc::size_type i = 0; i < count; ++i)
+		{
+			Worker& victim = *_workers[(worker.random + i) % count];
+			if (&victim == &worker)
+				continue;
+			if ((ctx = worker.queue.steal(victim.queue)) != nullptr)
+			{
+				worker.counters.steals.add(1);
+				return ctx;
+			}
+		}
+		return nullptr;
+	}
+
+	Context* Scheduler::Impl::_pop_mailbox(Worker& worker)
+	{
+		if (worker.mailbox_size.load(std::memory_order_acquire) == 0)
+			return nullptr;
+		std::lock_guard<std::mutex> lock(worker.mailbox_mutex);
+		if (worker.mailbox.empty())
+			return nullptr;
+		Context* res = worker.mailbox.front();
+		worker.mailbox.pop_front();
+		worker.mailbox_size.fetch_sub(1);
+		return res;
+	}
+
+	Context* Scheduler::Impl::_take_global(Worker& worker)
+	{
+		std::lock_guard<std::mutex> lock(_global_mutex);
+		if (_global.empty())
+			return nullptr;
+		// Take a fair share, the first one is run right away.
+		etc::size_type count = std::min<etc::size_type>(
+			_global.size() / _workers.size() + 1,
+			RunQueue::capacity / 2
+		);
+		Context* res = _global.front();
+		_global.pop_front();
+		for (etc::size_type i = 1; i < count && !_global.empty(); ++i)
+		{
+			if (!worker.queue.push(_global.front()))
+				break;
+			_global.pop_front();
+		}
+		_global_size.store(_global.size(), std::memory_order_relaxed);
+		return res;
+	}
+
+	void Scheduler::Impl::_resume(Worker& worker, Context* ctx)
+	{
+		ETC_TRACE.debug("Switch to job", ctx, ctx->name, "on worker", worker.index);
+		auto begin = clock_type::now();
+		if (ctx->frozen_since != clock_type::time_point{})
+		{
+			auto waited = begin - ctx->frozen_since;
+			ctx->wait_time += waited;
+			ctx->frozen_since = clock_type::time_point{};
+			worker.counters.wait_time.add(waited);
+			worker.counters.thaws.add(1);
+		}
+		// A wakeup() received while queued is kept for the next freeze().
+		int state = ctx->state.load(std::memory_order_acquire);
+		while (state != Context::notified &&
+		       !ctx->state.compare_exchange_weak(state,
+		                                         Context::running,
+		                                         std::memory_order_acq_rel))
+		{}
+		t_context = ctx;
+		{
+			ETC_SCOPE_EXIT{ t_context = nullptr; };
+			ctx->coro();
+		}
+		auto end = clock_type::now();
+		ctx->run_time += end - begin;
+		worker.counters.switches.add(1);
+		worker.counters.run_time.add(end - begin);
+
+		if (!ctx->coro)
+		{
+			std::exception_ptr error = ctx->exception;
+			ETC_LOG.debug("End of job", ctx, ctx->name);
+			worker.counters.completed.add(1);
+			this->_trace(worker, Trace::Kind::done, ctx->name, begin, end);
+			this->_release_context(worker, ctx);
+			if (error != nullptr)
+				this->_error(worker.index, error);
+			if (_alive.fetch_sub(1) == 1)
+			{
+				ETC_LOG.debug(*this, "Every job is done");
+				this->stop();
+			}
+			return;
+		}
+
+		// Frozen contexts wait for a wakeup(), unless it already happened.
+		state = ctx->state.load(std::memory_order_acquire);
+		bool const freezing = (state == Context::freezing);
+		if (freezing)
+		{
+			// The context is not ours anymore once frozen.
+			ctx->frozen_since = end;
+			worker.counters.freezes.add(1);
+			this->_trace(worker, Trace::Kind::freeze, ctx->name, begin, end);
+		}
+		else
+		{
+			worker.counters.yields.add(1);
+			this->_trace(worker, Trace::Kind::yield, ctx->name, begin, end);
+		}
+		while (state == Context::freezing)
+		{
+			if (ctx->state.compare_exchange_weak(state,
+			                                     Context::frozen,
+			                                     std::memory_order_acq_rel))
+			{
+				ETC_TRACE.debug("Job", ctx, ctx->name, "is frozen");
+				return;
+			}
+		}
+		// The wakeup() answered this freeze, otherwise it is kept for the
+		// next one.
+		if (freezing)
+			ctx->state.store(Context::running, std::memory_order_release);
+		this->ready(*ctx);
+	}
+
+	void Scheduler::Impl::push(std::string name,
+	                           Context::handler_setup_type setup,
+	                           void* hdlr,
+	                           etc::size_type const affinity)
+	{
+		ETC_TRACE.debug("Creating new job", name);
+		if (affinity != Scheduler::any_worker && affinity >= _thread_count)
+			throw Exception{"Invalid worker affinity"};
+		Context* ctx = this->_make_context();
+		try
+		{
+			ctx->reset(std::move(name), this->current(), setup, hdlr, affinity);
+		}
+		catch (...)
+		{
+			delete ctx;
+			throw;
+		}
+		_alive.fetch_add(1);
+		this->ready(*ctx);
+	}
+
+	Context* Scheduler::Impl::_make_context()
+	{
+		Worker* worker = this->current_worker();
+		if (worker != nullptr && !worker->free_contexts.empty())
+		{
+			Context* ctx = worker->free_contexts.back();
+			worker->free_contexts.pop_back();
+			return ctx;
+		}
+		return new Context{_stacks};
+	}
+
+	void Scheduler::Impl::_release_context(Worker& worker, Context* ctx)
+	{
+		ctx->release();
+		if (worker.free_contexts.size() < max_free_contexts)
+			worker.free_contexts.push_back(ctx);
+		else
+			delete ctx;
+	}
+
+	void Scheduler::Impl::freeze(Context& ctx)
+	{
+		ETC_LOG.debug("Freeze", ctx, ctx.name);
+		int state = Context::running;
+		// A pending wakeup() is consumed, the next yield() only requeues.
+		if (!ctx.state.compare_exchange_strong(state, Context::freezing,
+		                                       std::memory_order_acq_rel))
+			ctx.state.store(Context::running, std::memory_order_release);
+	}
+
+	void Scheduler::Impl::wakeup(Context& ctx)
+	{
+		ETC_LOG.debug("Awake", ctx, ctx.name);
+		int state = ctx.state.load(std::memory_order_acquire);
+		while (true)
+		{
+			if (state == Context::notified)
+				return;
+			if (state == Context::frozen)
+			{
+				if (ctx.state.compare_exchange_weak(state,
+				                                    Context::running,
+				                                    std::memory_order_acq_rel))
+				{
+					this->ready(ctx);
+					return;
+				}
+			}
+			// Not switched out yet, the worker will schedule it.
+			else if (ctx.state.compare_exchange_weak(state,
+			                                         Context::notified,
+			                                         std::memory_order_acq_rel))
+				return;
+		}
+	}
+
+	void Scheduler::Impl::ready(Context& ctx)
+	{
+		if (ctx.affinity != Scheduler::any_worker)
+		{
+			Worker& target = *_workers[ctx.affinity];
+			{
+				std::lock_guard<std::mutex> lock(target.mailbox_mutex);
+				target.mailbox.push_back(&ctx);
+				target.mailbox_size.fetch_add(1);
+			}
+			this->_notify(&target);
+			return;
+		}
+		Worker* worker = this->current_worker();
+		if (worker == nullptr || !worker->queue.push(&ctx))
+		{
+			std::lock_guard<std::mutex> lock(_global_mutex);
+			_global.push_back(&ctx);
+			_global_size.store(_global.size(), std::memory_order_relaxed);
+		}
+		this->_notify(nullptr);
+	}
+
+	bool Scheduler::Impl::_has_work(Worker& worker)
+	{
+		if (_global_size.load() > 0 || worker.mailbox_size.load() > 0)
+			return true;
+		for (auto& other: _workers)
+			if (!other->queue.empty())
+				return true;
+		return false;
+	}
+
+	void Scheduler::Impl::_park(Worker& worker)
+	{
+		worker.parked.store(true);
+		_parked.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		ETC_SCOPE_EXIT{
+			_parked.fetch_sub(1);
+			worker.parked.store(false);
+		};
+		// A context made ready before we were counted as parked.
+		if (this->_has_work(worker) || _stopping.load())
+			return;
+		ETC_TRACE.debug(*this, "Worker", worker.index, "is parked");
+		auto begin = clock_type::now();
+		// Returns after an I/O handler, a notification, or a stop().
+		worker.counters.io_handlers.add(this->service.run_one());
+		auto end = clock_type::now();
+		worker.counters.parks.add(1);
+		worker.counters.idle_time.add(end - begin);
+		this->_trace(worker, Trace::Kind::idle, std::string{}, begin, end);
+	}
+
+	void Scheduler::Impl::_poll_io(Worker& worker)
+	{
+		etc::size_type i = 0;
+		for (; i < max_io_handlers; ++i)
+			if (this->service.poll_one() == 0)
+				break;
+		if (i > 0)
+			worker.counters.io_handlers.add(i);
+	}
+
+	void Scheduler::Impl::arm_timer(TimerWheel::Timer& timer,
+	                                clock_type::time_point const deadline)
+	{
+		std::lock_guard<std::mutex> lock(_timers_mutex);
+		_timers.arm(timer, deadline);
+		_timers_size.store(_timers.size(), std::memory_order_relaxed);
+		if (!_timer_armed || deadline < _timer_deadline)
+			this->_schedule_timers();
+	}
+
+	void Scheduler::Impl::cancel_timer(TimerWheel::Timer& timer)
+	{
+		std::lock_guard<std::mutex> lock(_timers_mutex);
+		_timers.cancel(timer);
+		_timers_size.store(_timers.size(), std::memory_order_relaxed);
+	}
+
+	void Scheduler::Impl::_poll_timers()
+	{
+		if (_timers_size.load(std::memory_order_relaxed) == 0)
+			return;
+		std::lock_guard<std::mutex> lock(_timers_mutex);
+		_timers_fired += _timers.advance(clock_type::now());
+		_timers_size.store(_timers.size(), std::memory_order_relaxed);
+	}
+
+	void Scheduler::Impl::_schedule_timers()
+	{
+		if (_timers.empty())
+			return;
+		auto deadline = _timers.next_expiry();
+		if (_timer_armed && _timer_deadline <= deadline)
+			return;
+		_timer_armed = true;
+		_timer_deadline = deadline;
+		// Cancels the previous wait, if any.
+		_timer.expires_at(deadline);
+		_timer.async_wait(
+			[this] (boost::system::error_code const& ec) {
+				if (ec)
+					return;
+				std::lock_guard<std::mutex> lock(_timers_mutex);
+				_timer_armed = false;
+				_timers_fired += _timers.advance(clock_type::now());
+				_timers_size.store(_timers.size(), std::memory_order_relaxed);
+				this->_schedule_timers();
+			}
+		);
+	}
+
+	void Scheduler::Impl::_notify(Worker* target)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_parked.load() == 0)
+			return;
+		if (target == nullptr)
+		{
+			// Any parked worker will do.
+			this->service.post([] {});
+			return;
+		}
+		if (!target->parked.load())
+			return;
+		this->service.post(
+			[this, target] {
+				// Another worker got the notification, forward it.
+				if (this->current_worker() != target && target->parked.load())
+					this->_notify(target);
+			}
+		);
+	}
+
+	void Scheduler::Impl::_error(etc::size_type const index,
+	                             std::exception_ptr error)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_errors_mutex);
+			if (_errors.find(index) == _errors.end())
+				_errors[index] = error;
+		}
+		ETC_LOG.debug("Stopping scheduler");
+		this->stop();
+	}
+
+	Stats Scheduler::Impl::stats()
+	{
+		Stats res;
+		uint64_t thaws = 0;
+		for (auto& worker: _workers)
+		{
+			Counters& counters = worker->counters;
+			res.completed += counters.completed.get();
+			res.switches += counters.switches.get();
+			res.yields += counters.yields.get();
+			res.freezes += counters.freezes.get();
+			res.steals += counters.steals.get();
+			res.parks += counters.parks.get();
+			res.io_handlers += counters.io_handlers.get();
+			res.run_time += clock_type::duration(counters.run_time.get());
+			res.wait_time += clock_type::duration(counters.wait_time.get());
+			res.idle_time += clock_type::duration(counters.idle_time.get());
+			res.queued += worker->queue.size() + worker->mailbox_size.load();
+			thaws += counters.thaws.get();
+		}
+		// Counters are read one by one.
+		res.frozen = res.freezes > thaws ? res.freezes - thaws : 0;
+		res.queued += _global_size.load();
+		res.alive = _alive.load();
+		{
+			std::lock_guard<std::mutex> lock(_timers_mutex);
+			res.timers = _timers_fired;
+		}
+		return res;
+	}
+
+	void Scheduler::Impl::start_trace()
+	{
+		for (auto& worker: _workers)
+		{
+			std::lock_guard<std::mutex> lock(worker->trace_mutex);
+			worker->trace.clear();
+			worker->trace_dropped = 0;
+		}
+		_trace_start = clock_type::now();
+		_tracing.store(true);
+	}
+
+	Trace Scheduler::Impl::stop_trace()
+	{
+		Trace res;
+		if (!_tracing.exchange(false))
+			return res;
+		res.start = _trace_start;
+		res.stop = clock_type::now();
+		for (auto& worker: _workers)
+		{
+			std::lock_guard<std::mutex> lock(worker->trace_mutex);
+			std::move(worker->trace.begin(), worker->trace.end(),
+			          std::back_inserter(res.events));
+			res.dropped += worker->trace_dropped;
+			worker->trace.clear();
+			worker->trace.shrink_to_fit();
+			worker->trace_dropped = 0;
+		}
+		std::stable_sort(
+			res.events.begin(),
+			res.events.end(),
+			[] (Trace::Event const& lhs, Trace::Event const& rhs) {
+				return lhs.begin < rhs.begin;
+			}
+		);
+		return res;
+	}
+
+	void Scheduler::Impl::_trace(Worker& worker,
+	                             Trace::Kind const kind,
+	                             std::string const& name,
+	                             clock_type::time_point const begin,
+	                             clock_type::time_point const end)
+	{
+		if (!_tracing.load(std::memory_order_relaxed))
+			return;
+		std::lock_guard<std::mutex> lock(worker.trace_mutex);
+		if (worker.trace.size() >= max_trace_events)
+			worker.trace_dropped += 1;
+		else
+			worker.trace.push_back(
+				Trace::Event{kind, name, worker.index, begin, end}
+			);
+	}
+
 }}
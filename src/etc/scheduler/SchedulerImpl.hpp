@@ -3,10 +3,15 @@
 
 // Avoid winsock.h double include on windows
 # include <boost/asio/io_service.hpp>
+# include <boost/asio/basic_waitable_timer.hpp>
 
 # include "Context.hpp"
+# include "RunQueue.hpp"
 # include "Scheduler.hpp"
+# include "Stats.hpp"
 # include "StrandImpl.hpp"
+# include "TimerWheel.hpp"
+# include "Trace.hpp"
 
 # include <etc/scheduler.hpp>
 # include <etc/exception.hpp>
@@ -14,12 +19,13 @@
 # include <etc/scope_exit.hpp>
 # include <etc/stack_ptr.hpp>
 
-
+# include <atomic>
+# include <deque>
+# include <map>
+# include <memory>
+# include <mutex>
 # include <thread>
 # include <vector>
-# include <queue>
-# include <unordered_set>
-# include <map>
 
 namespace etc { namespace scheduler {
 
@@ -27,212 +33,213 @@ namespace etc { namespace scheduler {
 
 	typedef boost::asio::io_service              service_type;
 	typedef boost::asio::io_service::work        work_type;
-	typedef boost::asio::io_service::strand      strand_type;
+	typedef boost::asio::basic_waitable_timer<
+		Scheduler::clock_type
+	>                                            waitable_timer_type;
 
 	struct Scheduler::Impl
 	{
 		ETC_LOG_COMPONENT("etc.scheduler.Scheduler");
+
+		/// Written by its worker only, read by anyone.
+		struct Counter
+		{
+			std::atomic<uint64_t> value;
+
+			Counter() : value{0} {}
+
+			void add(uint64_t const count)
+			{
+				value.store(value.load(std::memory_order_relaxed) + count,
+				            std::memory_order_relaxed);
+			}
+
+			void add(clock_type::duration const duration)
+			{ this->add(static_cast<uint64_t>(duration.count())); }
+
+			uint64_t get() const
+			{ return value.load(std::memory_order_relaxed); }
+		};
+
+		struct Counters
+		{
+			Counter completed;
+			Counter switches;
+			Counter yields;
+			Counter freezes;
+			/// Frozen contexts resumed.
+			Counter thaws;
+			Counter steals;
+			Counter parks;
+			Counter io_handlers;
+			/// Durations, in clock ticks.
+			Counter run_time;
+			Counter wait_time;
+			Counter idle_time;
+		};
+
+		struct Worker
+		{
+			Impl&                       scheduler;
+			etc::size_type const        index;
+			RunQueue                    queue;
+			/// Contexts with an affinity to this worker.
+			std::mutex                  mailbox_mutex;
+			std::deque<Context*>        mailbox;
+			std::atomic<etc::size_type> mailbox_size;
+			/// Waiting for I/O or for new contexts.
+			std::atomic<bool>           parked;
+			etc::size_type              tick;
+			uint32_t                    random;
+			/// Released contexts, ready to be reset (owner only).
+			std::vector<Context*>       free_contexts;
+			Counters                    counters;
+			/// Events recorded while tracing.
+			std::mutex                  trace_mutex;
+			std::vector<Trace::Event>   trace;
+			etc::size_type              trace_dropped;
+
+			Worker(Impl& scheduler, etc::size_type const index);
+			~Worker();
+		};
+
 	public:
 		service_type                 service;
-		strand_type                  coro_strand;
 	private:
 		Scheduler&                   _sched;
 		etc::stack_ptr<work_type>    _work;
 		bool                         _running;
+		std::atomic<bool>            _stopping;
 		std::vector<std::thread>     _threads;
 		etc::size_type               _thread_count;
-		std::queue<Context*>         _jobs;
-		std::unordered_set<Context*> _frozen;
-		std::vector<Context*>        _jobs_stack;
+		StackPool                    _stacks;
+		std::vector<std::unique_ptr<Worker>> _workers;
+		/// Contexts made ready out of a worker, or that overflowed one.
+		std::mutex                   _global_mutex;
+		std::deque<Context*>         _global;
+		std::atomic<etc::size_type>  _global_size;
+		/// Spawned contexts not done yet.
+		std::atomic<etc::size_type>  _alive;
+		std::atomic<etc::size_type>  _parked;
+		std::mutex                   _errors_mutex;
+		std::map<etc::size_type, std::exception_ptr> _errors;
+		/// Armed timers, and the I/O timer waking up a worker for the
+		/// earliest one.
+		std::mutex                   _timers_mutex;
+		TimerWheel                   _timers;
+		std::atomic<etc::size_type>  _timers_size;
+		waitable_timer_type          _timer;
+		bool                         _timer_armed;
+		clock_type::time_point       _timer_deadline;
+		uint64_t                     _timers_fired;
+		std::atomic<bool>            _tracing;
+		clock_type::time_point       _trace_start;
 
 	private:
 		static void current_scheduler(Scheduler* sched);
 	public:
 		static Scheduler& current_scheduler();
+		/// Scheduler of the calling worker, nullptr out of a worker.
+		static Scheduler* find_current_scheduler();
 
 	public:
 		Impl(Scheduler& sched,
-		     etc::size_type const thread_count = 1)
-			: service()
-			, coro_strand(service)
-			, _sched(sched)
-			, _work(etc::stack_ptr_no_init)
-			, _running{false}
-			, _threads{}
-			, _thread_count{thread_count != 0 ? thread_count : 1}
-		{ ETC_TRACE_CTOR("with", _thread_count, "threads"); }
-
-		~Impl()
-		{
-			ETC_TRACE_DTOR();
-			_work.clear();
-		}
-
-		Context* current()
-		{ return _jobs_stack.empty() ? nullptr : _jobs_stack.back(); }
-
-		void run()
-		{
-			if (_running)
-				throw Exception{"Already running scheduler"};
-			_running = true;
-			ETC_SCOPE_EXIT{ _running = false; };
-
-			std::map<etc::size_type, std::exception_ptr> thread_errors;
-
-			// Service runner stores exceptions (and stop the scheduler).
-			auto runner = [&](etc::size_type const thread_index) {
-				{ // this block prevents parsing errors in gcc47
-					try { this->service.run(); }
-					catch (...) {
-						ETC_LOG.error("Thread",
-									  thread_index,
-									  "exited with error:",
-									  exception::string());
-						thread_errors[thread_index] = std::current_exception();
-						ETC_LOG.debug("Stopping scheduler");
-						this->stop();
-					}
-					ETC_LOG.debug("Thread", thread_index, "exited gracefully");
-				}
-			};
-
-			// Poll coroutines.
-			this->coro_strand.post(
-				[&] { ETC_LOG.debug(*this, "First poll"); _poll(); }
-			);
-
-			// Launch threads.
-			for (etc::size_type i = 1; i < _thread_count; ++i)
-				_threads.emplace_back(runner, i);
-
-			// Block main thread.
-			ETC_LOG.debug(*this, "Running on main thread");
-			runner(0);
+		     etc::size_type const thread_count = 1,
+		     etc::size_type const stack_size = 0);
+		~Impl();
 
-			// Wait until every thread is done.
-			ETC_LOG.debug(*this, "Joining", _threads.size(), "threads");
-			for (auto& thread: _threads)
-				if (thread.joinable()) thread.join();
-			_threads.clear();
+		/// Context running in the calling thread.
+		Context* current();
 
-			this->service.reset();
-
-			if (!thread_errors.empty())
-			{
-				std::string error_msg = "Scheduler errors:\n";
-				for (auto& pair: thread_errors)
-					error_msg += "  * " + exception::string(pair.second) + "\n";
+		/// Worker running in the calling thread, if it is one of ours.
+		Worker* current_worker();
 
-				ETC_LOG.error(*this, error_msg);
-				throw Exception{error_msg}; // XXX Should have an exception list.
-			}
-		}
+		etc::size_type thread_count() const
+		{ return _thread_count; }
 
-		void stop()
-		{ _work.clear(); this->service.stop(); }
+		StackPool& stacks()
+		{ return _stacks; }
 
-		void _poll()
-		{
-			if (_jobs.empty())
-				return;
-
-			Context* job = _jobs.front();
-			_jobs.pop();
-
-			ETC_SCOPE_EXIT{
-				if (!_jobs.empty())
-				{
-					ETC_LOG.debug("Poll ended, rescheduling itself with", _jobs.size(), "jobs left");
-					this->coro_strand.post([this] { _poll(); });
-				}
-				else
-					ETC_LOG.debug("Poll ended without rescheduling");
-			};
-
-			if (_frozen.find(job) != _frozen.end())
-			{
-				ETC_LOG.debug("Skip frozen job", job, job->name);
-				return;
-			}
+		void run();
+		void stop();
 
-			// plant the cleanup guard.
-			ETC_SCOPE_EXIT{
-				if (_frozen.find(job) != _frozen.end())
-				{
-					ETC_LOG.debug("Job", job, job->name, "has been frozen, skipping");
-				}
-				else if (job->coro)
-				{
-					ETC_TRACE.debug("Schedule again job", job, job->name);
-					_jobs.push(job);
-				}
-				else
-				{
-					ETC_TRACE.debug("Delete completed job", job, job->name);
-					delete job;
-				}
-			};
-
-			ETC_TRACE.debug("Switch to job", job, job->name);
-			try
-			{
-				_jobs_stack.push_back(job);
-				current_scheduler(&_sched);
-				ETC_SCOPE_EXIT{
-					current_scheduler(nullptr);
-					_jobs_stack.pop_back();
-				};
-				job->coro();
-				if (job->exception != nullptr && job->_yield == nullptr)
-				{
-					// The job is done but has an exception
-					ETC_SCOPE_EXIT{ job->exception = std::exception_ptr{}; };
-					std::rethrow_exception(job->exception);
-				}
-			}
-			catch (...)
-			{
-				ETC_LOG.error("The job", job, job->name, "exited with error:", exception::string());
-				throw;
-			}
-			ETC_LOG.debug("End of job", job, job->name);
-		}
+		Stats stats();
+		void start_trace();
+		Trace stop_trace();
 
 		template<typename Handler>
-		void push(std::string name, Handler&& hdlr)
+		void push(std::string name,
+		          Handler&& hdlr,
+		          etc::size_type const affinity = Scheduler::any_worker)
 		{
-			ETC_TRACE.debug("Creating new job", name);
-			bool needs_poll = _jobs.empty();
-			_jobs.push(
-				new Context{
-					std::move(name),
-					this->current(),
-					std::forward<Handler>(hdlr)
-				}
+			this->push(
+				std::move(name),
+				&Context::setup_handler<Handler>,
+				const_cast<void*>(static_cast<void const*>(std::addressof(hdlr))),
+				affinity
 			);
-			ETC_LOG.debug("New job", _jobs.front());
-			if (needs_poll)
-				this->service.post([&] { _poll(); });
 		}
 
-		void freeze(Context& ctx)
-		{
-			if (!_work)
-				_work.reset(this->service);
-			ETC_LOG.debug("Freeze", ctx, ctx.name);
-			_frozen.insert(&ctx);
-		}
+		/// Spawn a context whose handler @a hdlr is stored by @a setup.
+		void push(std::string name,
+		          Context::handler_setup_type setup,
+		          void* hdlr,
+		          etc::size_type const affinity);
+
+		/**
+		 * @brief Prepare the current context to wait for a wakeup().
+		 *
+		 * The context must yield right after. A wakeup() can happen from any
+		 * thread, even before the context yielded: the context is only
+		 * scheduled again once it is switched out. A wakeup() received while
+		 * the context was not frozen is consumed by the next freeze().
+		 */
+		void freeze(Context& ctx);
+
+		/// Schedule a frozen context, from any thread.
+		void wakeup(Context& ctx);
+
+		/// Schedule a context ready to run.
+		void ready(Context& ctx);
+
+		/**
+		 * @brief Call the timer callback from a worker once @a deadline is
+		 * reached.
+		 *
+		 * Callbacks are called with the timers locked: they must not arm or
+		 * cancel a timer, and once cancel_timer() returns the callback is
+		 * not running.
+		 */
+		void arm_timer(TimerWheel::Timer& timer,
+		               clock_type::time_point const deadline);
+		void cancel_timer(TimerWheel::Timer& timer);
 
-		void wakeup(Context& ctx)
-		{
-			ETC_LOG.debug("Awake", ctx, ctx.name);
-			_frozen.erase(&ctx);
-			_jobs.push(&ctx);
-			this->service.dispatch([&] { _poll(); });
-			if (_frozen.empty())
-				_work.clear();
-		}
+	private:
+		void _run_worker(Worker& worker);
+		/// A released context of the current worker, or a new one.
+		Context* _make_context();
+		void _release_context(Worker& worker, Context* ctx);
+		Context* _next(Worker& worker);
+		Context* _take_global(Worker& worker);
+		Context* _pop_mailbox(Worker& worker);
+		void _resume(Worker& worker, Context* ctx);
+		void _park(Worker& worker);
+		bool _has_work(Worker& worker);
+		/// Run ready I/O handlers without blocking.
+		void _poll_io(Worker& worker);
+		/// Fire expired timers.
+		void _poll_timers();
+		/// Make sure the I/O timer expires for the earliest timer (locked).
+		void _schedule_timers();
+		/// Wake up an idle worker, or @a target when not null.
+		void _notify(Worker* target);
+		void _error(etc::size_type const index, std::exception_ptr error);
+		/// Record an event when tracing.
+		void _trace(Worker& worker,
+		            Trace::Kind const kind,
+		            std::string const& name,
+		            clock_type::time_point const begin,
+		            clock_type::time_point const end);
 	};
 
 }}
@@ -0,0 +1,177 @@
+#include "StackPool.hpp"
+
+#include <etc/exception.hpp>
+#include <etc/log.hpp>
+#include <etc/platform.hpp>
+#include <etc/test.hpp>
+
+#include <boost/coroutine/stack_traits.hpp>
+
+#include <algorithm>
+
+#ifdef ETC_PLATFORM_WINDOWS
+# include <windows.h>
+#else
+# include <sys/mman.h>
+#endif
+
+namespace etc { namespace scheduler {
+
+	ETC_LOG_COMPONENT("etc.scheduler.StackPool");
+
+	using exception::Exception;
+
+	namespace {
+
+		typedef boost::coroutines::stack_traits traits_type;
+
+		etc::size_type round_to_pages(etc::size_type size)
+		{
+			etc::size_type page = traits_type::page_size();
+			if (size == 0)
+				size = traits_type::default_size();
+			size = std::max<etc::size_type>(size, traits_type::minimum_size());
+			return (size + page - 1) / page * page;
+		}
+
+	} // !anonymous
+
+	StackPool::StackPool(etc::size_type const stack_size,
+	                     etc::size_type const max_cached)
+		: _stack_size{round_to_pages(stack_size)}
+		, _max_cached{max_cached}
+		, _mutex{}
+		, _cache{}
+		, _allocated{0}
+	{ ETC_TRACE_CTOR("with stacks of", _stack_size, "bytes"); }
+
+	StackPool::~StackPool()
+	{
+		ETC_TRACE_DTOR();
+		for (auto& stack: _cache)
+			this->_unmap(stack);
+	}
+
+	StackPool::stack_type StackPool::allocate()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_cache.empty())
+			{
+				stack_type res = _cache.back();
+				_cache.pop_back();
+				return res;
+			}
+			_allocated += 1;
+		}
+		try { return this->_map(); }
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_allocated -= 1;
+			throw;
+		}
+	}
+
+	void StackPool::deallocate(stack_type& stack)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_cache.size() < _max_cached)
+			{
+				_cache.push_back(stack);
+				stack = stack_type{};
+				return;
+			}
+			_allocated -= 1;
+		}
+		this->_unmap(stack);
+	}
+
+	etc::size_type StackPool::allocated()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _allocated;
+	}
+
+	etc::size_type StackPool::cached()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _cache.size();
+	}
+
+	StackPool::stack_type StackPool::_map()
+	{
+		etc::size_type guard = traits_type::page_size();
+		etc::size_type size = _stack_size + guard;
+#ifdef ETC_PLATFORM_WINDOWS
+		void* limit = ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT,
+		                             PAGE_READWRITE);
+		if (limit == nullptr)
+			throw Exception{"Couldn't allocate a coroutine stack"};
+		DWORD old;
+		if (!::VirtualProtect(limit, guard, PAGE_NOACCESS, &old))
+		{
+			::VirtualFree(limit, 0, MEM_RELEASE);
+			throw Exception{"Couldn't protect a coroutine stack"};
+		}
+#else
+		void* limit = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+		                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (limit == MAP_FAILED)
+			throw Exception{"Couldn't allocate a coroutine stack"};
+		if (::mprotect(limit, guard, PROT_NONE) != 0)
+		{
+			::munmap(limit, size);
+			throw Exception{"Couldn't protect a coroutine stack"};
+		}
+#endif
+		stack_type res;
+		res.size = _stack_size;
+		// Stacks grow downward, from the end of the mapping.
+		res.sp = static_cast<char*>(limit) + size;
+		ETC_LOG.debug("New stack at", res.sp);
+		return res;
+	}
+
+	void StackPool::_unmap(stack_type& stack) ETC_NOEXCEPT
+	{
+		etc::size_type size = stack.size + traits_type::page_size();
+		void* limit = static_cast<char*>(stack.sp) - size;
+#ifdef ETC_PLATFORM_WINDOWS
+		::VirtualFree(limit, 0, MEM_RELEASE);
+#else
+		::munmap(limit, size);
+#endif
+		stack = stack_type{};
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(reuse)
+		{
+			StackPool pool{10000, 1};
+			ETC_ENFORCE_EQ(pool.stack_size() % traits_type::page_size(), 0u);
+			ETC_ENFORCE_GTE(pool.stack_size(), 10000u);
+			auto a = pool.allocate();
+			auto b = pool.allocate();
+			ETC_ENFORCE(a.sp != b.sp);
+			ETC_ENFORCE_EQ(a.size, pool.stack_size());
+			// The whole stack is usable.
+			static_cast<char*>(a.sp)[-1] = 42;
+			static_cast<char*>(a.sp)[-static_cast<std::ptrdiff_t>(a.size)] = 42;
+			void* sp = a.sp;
+			pool.deallocate(a);
+			ETC_ENFORCE(a.sp == nullptr);
+			// Only one stack is kept.
+			pool.deallocate(b);
+			ETC_ENFORCE_EQ(pool.cached(), 1u);
+			ETC_ENFORCE_EQ(pool.allocated(), 1u);
+			auto c = pool.allocate();
+			ETC_ENFORCE(c.sp == sp);
+			pool.deallocate(c);
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,65 @@
+#ifndef  ETC_SCHEDULER_STACKPOOL_HPP
+# define ETC_SCHEDULER_STACKPOOL_HPP
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <boost/coroutine/stack_context.hpp>
+
+# include <mutex>
+# include <vector>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Cache of coroutine stacks.
+	 *
+	 * Stacks are mapped with a guard page below them, so that an overflow
+	 * faults instead of silently corrupting the memory around. Released
+	 * stacks are kept for the next contexts, up to a limit.
+	 */
+	class StackPool
+	{
+	public:
+		typedef boost::coroutines::stack_context stack_type;
+
+	private:
+		etc::size_type const    _stack_size;
+		etc::size_type const    _max_cached;
+		std::mutex              _mutex;
+		std::vector<stack_type> _cache;
+		etc::size_type          _allocated;
+
+	public:
+		/// Stacks of @a stack_size bytes rounded up to pages, 0 picks the
+		/// coroutines default.
+		explicit
+		StackPool(etc::size_type const stack_size = 0,
+		          etc::size_type const max_cached = 256);
+		~StackPool();
+
+		StackPool(StackPool const&) ETC_DELETED_FUNCTION;
+		StackPool& operator =(StackPool const&) ETC_DELETED_FUNCTION;
+
+	public:
+		stack_type allocate();
+		void deallocate(stack_type& stack);
+
+		/// Usable size of the stacks.
+		etc::size_type stack_size() const ETC_NOEXCEPT
+		{ return _stack_size; }
+
+		/// Stacks in use or cached.
+		etc::size_type allocated();
+
+		/// Stacks ready to be reused.
+		etc::size_type cached();
+
+	private:
+		stack_type _map();
+		void _unmap(stack_type& stack) ETC_NOEXCEPT;
+	};
+
+}}
+
+#endif
@@ -0,0 +1,45 @@
+#include "Stats.hpp"
+
+#include <ostream>
+
+namespace etc { namespace scheduler {
+
+	Stats::Stats()
+		: completed{0}
+		, switches{0}
+		, yields{0}
+		, freezes{0}
+		, steals{0}
+		, parks{0}
+		, io_handlers{0}
+		, timers{0}
+		, run_time{0}
+		, wait_time{0}
+		, idle_time{0}
+		, alive{0}
+		, frozen{0}
+		, queued{0}
+	{}
+
+	void Stats::print(std::ostream& out) const ETC_NOEXCEPT
+	{
+		typedef std::chrono::duration<double, std::milli> ms;
+		out << "<Stats"
+			<< " completed=" << this->completed
+			<< " switches=" << this->switches
+			<< " yields=" << this->yields
+			<< " freezes=" << this->freezes
+			<< " steals=" << this->steals
+			<< " parks=" << this->parks
+			<< " io_handlers=" << this->io_handlers
+			<< " timers=" << this->timers
+			<< " run=" << ms(this->run_time).count() << "ms"
+			<< " wait=" << ms(this->wait_time).count() << "ms"
+			<< " idle=" << ms(this->idle_time).count() << "ms"
+			<< " alive=" << this->alive
+			<< " frozen=" << this->frozen
+			<< " queued=" << this->queued
+			<< ">";
+	}
+
+}}
@@ -0,0 +1,61 @@
+#ifndef  ETC_SCHEDULER_STATS_HPP
+# define ETC_SCHEDULER_STATS_HPP
+
+# include <etc/printable.hpp>
+# include <etc/types.hpp>
+
+# include <chrono>
+# include <cstdint>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Counters of a scheduler, see Scheduler::stats().
+	 *
+	 * Totals are counted since the scheduler creation, each worker keeping
+	 * its own counters. The other values are read at the time of the call.
+	 */
+	struct Stats
+		: public etc::Printable
+	{
+		typedef std::chrono::steady_clock::duration duration;
+
+		/// Contexts run to completion.
+		uint64_t completed;
+		/// Contexts resumed by a worker.
+		uint64_t switches;
+		/// Contexts switched out while still ready.
+		uint64_t yields;
+		/// Contexts switched out waiting for a wakeup.
+		uint64_t freezes;
+		/// Contexts stolen from another worker.
+		uint64_t steals;
+		/// Workers waiting for I/O or for contexts.
+		uint64_t parks;
+		/// I/O handlers run by the workers.
+		uint64_t io_handlers;
+		/// Fired timers, sleeps and deadlines included.
+		uint64_t timers;
+
+		/// Time spent running contexts.
+		duration run_time;
+		/// Time spent by contexts waiting for a wakeup.
+		duration wait_time;
+		/// Time spent by parked workers.
+		duration idle_time;
+
+		/// Spawned contexts not done yet.
+		etc::size_type alive;
+		/// Contexts waiting for a wakeup, or not resumed since.
+		etc::size_type frozen;
+		/// Contexts ready to run.
+		etc::size_type queued;
+
+		Stats();
+
+		void print(std::ostream& out) const ETC_NOEXCEPT override;
+	};
+
+}}
+
+#endif
@@ -3,13 +3,14 @@
 
 # include "Strand.hpp"
 
+# include <boost/asio/io_service.hpp>
 # include <boost/asio/strand.hpp>
 
 namespace etc { namespace scheduler {
 
 	struct Strand::Impl
 	{
-		boost::asio::strand strand;
+		boost::asio::io_service::strand strand;
 
 		Impl(boost::asio::io_service& service)
 			: strand{service}
@@ -0,0 +1,156 @@
+#include "TaskGroup.hpp"
+#include "SchedulerImpl.hpp"
+#include "WaitList.hpp"
+
+#include <etc/exception.hpp>
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <atomic>
+
+namespace etc { namespace scheduler {
+
+	ETC_LOG_COMPONENT("etc.scheduler.TaskGroup");
+
+	struct TaskGroup::Impl
+	{
+		Scheduler&         scheduler;
+		std::mutex         mutex;
+		WaitList           waiters;
+		etc::size_type     pending;
+		std::exception_ptr error;
+
+		explicit
+		Impl(Scheduler& scheduler)
+			: scheduler(scheduler)
+			, mutex{}
+			, waiters{}
+			, pending{0}
+			, error{}
+		{}
+
+		void done(std::exception_ptr task_error)
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (task_error != nullptr && this->error == nullptr)
+				this->error = std::move(task_error);
+			if (--this->pending == 0)
+				this->waiters.notify_all();
+		}
+
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->waiters.wait(lock, [&] { return this->pending == 0; });
+		}
+	};
+
+	TaskGroup::TaskGroup()
+		: TaskGroup(current())
+	{}
+
+	TaskGroup::TaskGroup(Scheduler& sched)
+		: _this{std::make_shared<Impl>(sched)}
+	{}
+
+	TaskGroup::~TaskGroup()
+	{
+		_this->wait();
+		if (_this->error != nullptr)
+			ETC_LOG.error("Task group destroyed with an error:",
+			              exception::string(_this->error));
+	}
+
+	void TaskGroup::spawn(std::string name, task_type task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_this->mutex);
+			_this->pending += 1;
+		}
+		auto impl = _this;
+		try
+		{
+			_this->scheduler.impl().push(
+				std::move(name),
+				[impl, task] (Context&) {
+					std::exception_ptr error;
+					try { task(); }
+					catch (...) { error = std::current_exception(); }
+					impl->done(std::move(error));
+				}
+			);
+		}
+		catch (...)
+		{
+			_this->done(nullptr);
+			throw;
+		}
+	}
+
+	void TaskGroup::wait()
+	{
+		_this->wait();
+		std::exception_ptr error;
+		{
+			std::lock_guard<std::mutex> lock(_this->mutex);
+			std::swap(error, _this->error);
+		}
+		if (error != nullptr)
+			std::rethrow_exception(error);
+	}
+
+	etc::size_type TaskGroup::pending() const
+	{
+		std::lock_guard<std::mutex> lock(_this->mutex);
+		return _this->pending;
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(wait)
+		{
+			Scheduler r{4};
+			std::atomic<int> done{0};
+			r.spawn("main", [&] (Context&) {
+				TaskGroup group;
+				for (int i = 0; i < 100; ++i)
+					group.spawn("task", [&] {
+						scheduler::current().context().yield();
+						done += 1;
+					});
+				group.wait();
+				ETC_ENFORCE_EQ(done.load(), 100);
+				ETC_ENFORCE_EQ(group.pending(), 0u);
+				// Reusable once done.
+				group.spawn("task", [&] { done += 1; });
+			});
+			r.run();
+			ETC_ENFORCE_EQ(done.load(), 101);
+		}
+
+		ETC_TEST_CASE(first_error)
+		{
+			Scheduler r{2};
+			std::atomic<int> done{0};
+			bool caught = false;
+			r.spawn("main", [&] (Context&) {
+				TaskGroup group;
+				for (int i = 0; i < 10; ++i)
+					group.spawn("task", [&, i] {
+						done += 1;
+						if (i % 2)
+							throw exception::Exception{"Task failed"};
+					});
+				try { group.wait(); }
+				catch (exception::Exception const&) { caught = true; }
+				// Errors are reported once.
+				group.wait();
+			});
+			r.run();
+			ETC_ENFORCE(caught);
+			ETC_ENFORCE_EQ(done.load(), 10);
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,49 @@
+#ifndef  ETC_SCHEDULER_TASKGROUP_HPP
+# define ETC_SCHEDULER_TASKGROUP_HPP
+
+# include "fwd.hpp"
+
+# include <etc/types.hpp>
+
+# include <functional>
+# include <memory>
+# include <string>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Spawn tasks and wait for all of them.
+	 *
+	 * Waiting inside a context yields to the scheduler, other threads are
+	 * blocked. The group waits for its tasks when destroyed.
+	 */
+	class TaskGroup
+	{
+	public:
+		typedef std::function<void()> task_type;
+		struct Impl;
+
+	private:
+		// Shared with the running tasks.
+		std::shared_ptr<Impl> _this;
+
+	public:
+		/// Spawn tasks in the current scheduler.
+		TaskGroup();
+		explicit
+		TaskGroup(Scheduler& sched);
+		~TaskGroup();
+
+	public:
+		void spawn(std::string name, task_type task);
+
+		/// Wait for every task, and rethrow the first exception of a task.
+		void wait();
+
+		/// Tasks not done yet.
+		etc::size_type pending() const;
+	};
+
+}}
+
+#endif
@@ -0,0 +1,328 @@
+#include "TimerWheel.hpp"
+
+#include <etc/assert.hpp>
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace etc { namespace scheduler {
+
+	namespace {
+
+		uint64_t const slot_mask = TimerWheel::slots - 1;
+
+		// Timers beyond the last level are kept in it until they get close.
+		uint64_t const max_delta =
+			(uint64_t(1) << (TimerWheel::levels * TimerWheel::slot_bits)) - 1;
+
+		inline
+		unsigned first_bit(uint64_t value) ETC_NOEXCEPT
+		{
+#ifdef __GNUC__
+			return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+			unsigned res = 0;
+			while (!(value & 1))
+			{
+				value >>= 1;
+				++res;
+			}
+			return res;
+#endif
+		}
+
+		inline
+		void reset(TimerWheel::Timer& head) ETC_NOEXCEPT
+		{
+			head.prev = &head;
+			head.next = &head;
+		}
+
+	} // !anonymous
+
+	TimerWheel::TimerWheel(clock_type::duration const resolution,
+	                       clock_type::time_point const origin)
+		: _resolution{resolution}
+		, _origin{origin}
+		, _current{0}
+		, _size{0}
+	{
+		ETC_ASSERT(resolution.count() > 0);
+		for (unsigned level = 0; level < levels; ++level)
+		{
+			for (auto& head: _slots[level])
+				reset(head);
+			std::fill(_occupied[level], _occupied[level] + slots / 64, 0);
+		}
+	}
+
+	void TimerWheel::arm(Timer& timer, clock_type::time_point const deadline)
+	{
+		ETC_ASSERT(!timer.armed());
+		ETC_ASSERT(timer.callback != nullptr);
+		timer.expiry = std::max(this->_tick(deadline, true), _current + 1);
+		this->_insert(timer);
+		_size += 1;
+	}
+
+	void TimerWheel::cancel(Timer& timer) ETC_NOEXCEPT
+	{
+		if (!timer.armed())
+			return;
+		this->_unlink(timer);
+		_size -= 1;
+	}
+
+	etc::size_type TimerWheel::advance(clock_type::time_point const now)
+	{
+		uint64_t const target = this->_tick(now, false);
+		etc::size_type res = 0;
+		while (_current < target)
+		{
+			if (_size == 0)
+			{
+				_current = target;
+				break;
+			}
+			// Jump to the next occupied slot of the first level, or to where
+			// timers cascade from the other levels.
+			uint64_t next = this->_next_tick();
+			if (next > target)
+			{
+				_current = target;
+				break;
+			}
+			_current = next;
+			if ((_current & slot_mask) == 0)
+				this->_cascade();
+			res += this->_fire(_current & slot_mask);
+		}
+		return res;
+	}
+
+	TimerWheel::clock_type::time_point TimerWheel::next_expiry() const ETC_NOEXCEPT
+	{
+		uint64_t res = this->_next_tick();
+		if (res == std::numeric_limits<uint64_t>::max())
+			return clock_type::time_point::max();
+		return this->_time(res);
+	}
+
+	uint64_t TimerWheel::_next_tick() const ETC_NOEXCEPT
+	{
+		uint64_t res = std::numeric_limits<uint64_t>::max();
+		for (unsigned level = 0; level < levels; ++level)
+		{
+			unsigned shift = level * slot_bits;
+			uint64_t index = (_current >> shift) + 1;
+			unsigned distance = this->_next_occupied(level, index & slot_mask);
+			if (distance < slots)
+				res = std::min(res, (index + distance) << shift);
+		}
+		return res;
+	}
+
+	uint64_t TimerWheel::_tick(clock_type::time_point const time,
+	                           bool round_up) const
+	{
+		if (time <= _origin)
+			return 0;
+		if (time == clock_type::time_point::max())
+			return std::numeric_limits<uint64_t>::max() / 2;
+		auto ticks = (time - _origin) / _resolution;
+		if (round_up && _origin + ticks * _resolution < time)
+			ticks += 1;
+		return static_cast<uint64_t>(ticks);
+	}
+
+	TimerWheel::clock_type::time_point TimerWheel::_time(uint64_t const tick) const
+	{ return _origin + _resolution * static_cast<clock_type::rep>(tick); }
+
+	void TimerWheel::_insert(Timer& timer) ETC_NOEXCEPT
+	{
+		uint64_t delta = std::min(timer.expiry - _current, max_delta);
+		unsigned level = 0;
+		while (level + 1 < levels && delta >= (uint64_t(1) << ((level + 1) * slot_bits)))
+			level += 1;
+		uint64_t expiry = _current + delta;
+		unsigned slot = (expiry >> (level * slot_bits)) & slot_mask;
+		Timer& head = _slots[level][slot];
+		timer.slot = level * slots + slot;
+		timer.prev = head.prev;
+		timer.next = &head;
+		head.prev->next = &timer;
+		head.prev = &timer;
+		_occupied[level][slot / 64] |= uint64_t(1) << (slot % 64);
+	}
+
+	void TimerWheel::_unlink(Timer& timer) ETC_NOEXCEPT
+	{
+		timer.prev->next = timer.next;
+		timer.next->prev = timer.prev;
+		unsigned level = timer.slot / slots;
+		unsigned slot = timer.slot % slots;
+		Timer& head = _slots[level][slot];
+		if (head.next == &head)
+			_occupied[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+		timer.prev = nullptr;
+		timer.next = nullptr;
+	}
+
+	void TimerWheel::_cascade() ETC_NOEXCEPT
+	{
+		for (unsigned level = 1; level < levels; ++level)
+		{
+			unsigned slot = (_current >> (level * slot_bits)) & slot_mask;
+			Timer& head = _slots[level][slot];
+			while (head.next != &head)
+			{
+				Timer& timer = *head.next;
+				this->_unlink(timer);
+				this->_insert(timer);
+			}
+			if (slot != 0)
+				break;
+		}
+	}
+
+	etc::size_type TimerWheel::_fire(unsigned const slot)
+	{
+		etc::size_type res = 0;
+		Timer& head = _slots[0][slot];
+		while (head.next != &head)
+		{
+			Timer& timer = *head.next;
+			this->_unlink(timer);
+			if (timer.expiry > _current)
+			{
+				// Clamped in the last level, not due yet.
+				this->_insert(timer);
+				continue;
+			}
+			_size -= 1;
+			res += 1;
+			timer.callback(timer);
+		}
+		return res;
+	}
+
+	unsigned TimerWheel::_next_occupied(unsigned const level,
+	                                    unsigned const slot) const ETC_NOEXCEPT
+	{
+		uint64_t const* bits = _occupied[level];
+		unsigned word = slot / 64;
+		uint64_t mask = bits[word] & (~uint64_t(0) << (slot % 64));
+		for (unsigned i = 0; i <= slots / 64; ++i)
+		{
+			if (mask != 0)
+			{
+				unsigned res = word * 64 + first_bit(mask);
+				return (res + slots - slot) & slot_mask;
+			}
+			word = (word + 1) % (slots / 64);
+			mask = bits[word];
+			// Back to the first word, only the bits before the slot are left.
+			if (i + 1 == slots / 64)
+				mask &= ~(~uint64_t(0) << (slot % 64));
+		}
+		return slots;
+	}
+
+	namespace {
+
+		typedef TimerWheel::clock_type clock_type;
+		typedef std::chrono::microseconds us;
+
+		struct Probe
+		{
+			TimerWheel::Timer timer;
+			etc::size_type    fired;
+
+			Probe()
+				: fired{0}
+			{
+				timer.callback = [] (TimerWheel::Timer& timer) {
+					static_cast<Probe*>(timer.data)->fired += 1;
+				};
+				timer.data = this;
+			}
+		};
+
+		ETC_TEST_CASE(fire_on_time)
+		{
+			auto origin = clock_type::now();
+			TimerWheel wheel{us(100), origin};
+			// One timer per level, and one clamped in the last level.
+			us const delays[] = {
+				us(100), us(200), us(25000), us(3000000),
+				us(1000000000), us(600000000000),
+			};
+			Probe probes[6];
+			for (int i = 0; i < 6; ++i)
+				wheel.arm(probes[i].timer, origin + delays[i]);
+			ETC_ENFORCE_EQ(wheel.size(), 6u);
+			for (int i = 0; i < 6; ++i)
+			{
+				ETC_ENFORCE_LTE(wheel.next_expiry(), origin + delays[i]);
+				wheel.advance(origin + delays[i] - us(1));
+				ETC_ENFORCE_EQ(probes[i].fired, 0u);
+				ETC_ENFORCE_EQ(wheel.advance(origin + delays[i]), 1u);
+				ETC_ENFORCE_EQ(probes[i].fired, 1u);
+				ETC_ENFORCE(!probes[i].timer.armed());
+			}
+			ETC_ENFORCE(wheel.empty());
+			ETC_ENFORCE(wheel.next_expiry() == clock_type::time_point::max());
+		}
+
+		ETC_TEST_CASE(cancel)
+		{
+			auto origin = clock_type::now();
+			TimerWheel wheel{us(100), origin};
+			Probe a, b, c;
+			wheel.arm(a.timer, origin + us(1000));
+			wheel.arm(b.timer, origin + us(1000));
+			wheel.arm(c.timer, origin + us(1000000));
+			wheel.cancel(a.timer);
+			wheel.cancel(c.timer);
+			wheel.cancel(c.timer);
+			ETC_ENFORCE_EQ(wheel.size(), 1u);
+			ETC_ENFORCE_EQ(wheel.advance(origin + us(2000000)), 1u);
+			ETC_ENFORCE_EQ(a.fired, 0u);
+			ETC_ENFORCE_EQ(b.fired, 1u);
+			ETC_ENFORCE_EQ(c.fired, 0u);
+
+			// A past deadline expires on the next tick.
+			wheel.arm(a.timer, origin);
+			ETC_ENFORCE_EQ(wheel.advance(origin + us(2000000)), 0u);
+			ETC_ENFORCE_EQ(wheel.advance(origin + us(2000100)), 1u);
+		}
+
+		us deadline(etc::size_type const i)
+		{ return us((i + 1) * (i + 1) * 37 % 5000000 + 1); }
+
+		ETC_TEST_CASE(many_timers)
+		{
+			auto origin = clock_type::now();
+			TimerWheel wheel{us(100), origin};
+			std::vector<Probe> probes(1000);
+			for (etc::size_type i = 0; i < probes.size(); ++i)
+				wheel.arm(probes[i].timer, origin + deadline(i));
+			etc::size_type fired = 0;
+			for (auto now = origin; fired < probes.size(); now += us(7919))
+			{
+				fired += wheel.advance(now);
+				for (etc::size_type i = 0; i < probes.size(); ++i)
+				{
+					// Deadlines are rounded up to the resolution.
+					auto ticks = (deadline(i).count() + 99) / 100;
+					bool due = origin + us(ticks * 100) <= now;
+					ETC_ENFORCE_EQ(probes[i].fired, due ? 1u : 0u);
+				}
+			}
+			ETC_ENFORCE(wheel.empty());
+		}
+
+	} // !anonymous
+
+}}
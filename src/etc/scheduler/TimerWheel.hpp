@@ -0,0 +1,117 @@
+#ifndef  ETC_SCHEDULER_TIMERWHEEL_HPP
+# define ETC_SCHEDULER_TIMERWHEEL_HPP
+
+# include <etc/compiler.hpp>
+# include <etc/types.hpp>
+
+# include <chrono>
+# include <cstdint>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Hierarchical timer wheel.
+	 *
+	 * Time is cut in ticks of a fixed resolution. Timers expiring in the
+	 * next 256 ticks sit in the slot of their tick, later ones in one of the
+	 * 256 slots of a coarser level, and are moved down when their slot is
+	 * reached. Timers are intrusive: arming and cancelling a timer are
+	 * constant time and never allocate.
+	 *
+	 * The wheel is not thread safe.
+	 */
+	class TimerWheel
+	{
+	public:
+		typedef std::chrono::steady_clock clock_type;
+
+		static unsigned const levels = 4;
+		static unsigned const slot_bits = 8;
+		static unsigned const slots = 1 << slot_bits;
+
+		struct Timer
+		{
+			Timer*   prev;
+			Timer*   next;
+			/// Tick of the expiry.
+			uint64_t expiry;
+			uint32_t slot;
+			/// Called by advance() when the timer expires.
+			void   (*callback)(Timer&);
+			void*    data;
+
+			Timer() ETC_NOEXCEPT
+				: prev{nullptr}
+				, next{nullptr}
+				, expiry{0}
+				, slot{0}
+				, callback{nullptr}
+				, data{nullptr}
+			{}
+
+			bool armed() const ETC_NOEXCEPT
+			{ return this->prev != nullptr; }
+		};
+
+	private:
+		clock_type::duration const   _resolution;
+		clock_type::time_point const _origin;
+		/// Last tick reached by advance().
+		uint64_t                     _current;
+		etc::size_type               _size;
+		/// Sentinels of the slot lists.
+		Timer                        _slots[levels][slots];
+		uint64_t                     _occupied[levels][slots / 64];
+
+	public:
+		TimerWheel(clock_type::duration const resolution,
+		           clock_type::time_point const origin = clock_type::now());
+
+		TimerWheel(TimerWheel const&) ETC_DELETED_FUNCTION;
+		TimerWheel& operator =(TimerWheel const&) ETC_DELETED_FUNCTION;
+
+	public:
+		/// Arm a disarmed timer, a past deadline expires on the next tick.
+		void arm(Timer& timer, clock_type::time_point const deadline);
+
+		/// Disarm a timer, if armed.
+		void cancel(Timer& timer) ETC_NOEXCEPT;
+
+		/**
+		 * @brief Fire the timers expired at @a now.
+		 *
+		 * Callbacks must not arm or cancel timers of this wheel. Returns
+		 * the number of fired timers.
+		 */
+		etc::size_type advance(clock_type::time_point const now);
+
+		/// No timer fires before the returned time.
+		clock_type::time_point next_expiry() const ETC_NOEXCEPT;
+
+		etc::size_type size() const ETC_NOEXCEPT
+		{ return _size; }
+
+		bool empty() const ETC_NOEXCEPT
+		{ return _size == 0; }
+
+		clock_type::duration resolution() const ETC_NOEXCEPT
+		{ return _resolution; }
+
+	private:
+		uint64_t _tick(clock_type::time_point const time, bool round_up) const;
+		clock_type::time_point _time(uint64_t const tick) const;
+		void _insert(Timer& timer) ETC_NOEXCEPT;
+		void _unlink(Timer& timer) ETC_NOEXCEPT;
+		void _cascade() ETC_NOEXCEPT;
+		/// Next tick with timers to fire or to cascade.
+		uint64_t _next_tick() const ETC_NOEXCEPT;
+		etc::size_type _fire(unsigned const slot);
+		/// Distance from @a slot to the next occupied slot of @a level, in
+		/// [0, slots), or slots when empty.
+		unsigned _next_occupied(unsigned const level,
+		                        unsigned const slot) const ETC_NOEXCEPT;
+	};
+
+}}
+
+#endif
@@ -0,0 +1,178 @@
+#include "Trace.hpp"
+#include "Context.hpp"
+#include "Scheduler.hpp"
+
+#include <etc/test.hpp>
+
+#include <iomanip>
+#include <ostream>
+#include <set>
+#include <sstream>
+
+namespace etc { namespace scheduler {
+
+	namespace {
+
+		void write_string(std::ostream& out, std::string const& str)
+		{
+			out << '"';
+			for (char c: str)
+			{
+				switch (c)
+				{
+				case '"': out << "\\\""; break;
+				case '\\': out << "\\\\"; break;
+				case '\n': out << "\\n"; break;
+				case '\t': out << "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+						out << "\\u" << std::hex << std::setw(4)
+						    << std::setfill('0') << static_cast<int>(c)
+						    << std::dec << std::setfill(' ');
+					else
+						out << c;
+				}
+			}
+			out << '"';
+		}
+
+		char const* kind_string(Trace::Kind const kind)
+		{
+			switch (kind)
+			{
+			case Trace::Kind::yield: return "yield";
+			case Trace::Kind::freeze: return "freeze";
+			case Trace::Kind::done: return "done";
+			case Trace::Kind::idle: return "idle";
+			}
+			return "unknown";
+		}
+
+	} // !anonymous
+
+	Trace::Trace()
+		: start{}
+		, stop{}
+		, events{}
+		, dropped{0}
+	{}
+
+	void Trace::write_chrome_trace(std::ostream& out) const
+	{
+		// Timestamps are in microseconds.
+		typedef std::chrono::duration<double, std::micro> us;
+		std::set<etc::size_type> workers;
+		for (auto& event: this->events)
+			workers.insert(event.worker);
+
+		auto flags = out.flags();
+		out << std::fixed << std::setprecision(3);
+		out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		bool first = true;
+		for (auto worker: workers)
+		{
+			out << (first ? "\n" : ",\n");
+			first = false;
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+			    << worker << ",\"args\":{\"name\":\"worker " << worker << "\"}}";
+		}
+		for (auto& event: this->events)
+		{
+			out << (first ? "\n" : ",\n");
+			first = false;
+			out << "{\"name\":";
+			write_string(out, event.kind == Kind::idle ? "idle" : event.name);
+			out << ",\"cat\":\"" << kind_string(event.kind) << "\""
+			    << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.worker
+			    << ",\"ts\":" << us(event.begin - this->start).count()
+			    << ",\"dur\":" << us(event.end - event.begin).count()
+			    << "}";
+		}
+		out << "\n]}\n";
+		out.flags(flags);
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(chrome_trace)
+		{
+			Trace trace;
+			trace.start = Trace::clock_type::now();
+			trace.stop = trace.start + std::chrono::milliseconds(3);
+			trace.events.push_back(Trace::Event{
+				Trace::Kind::yield,
+				"a \"quoted\" name",
+				0,
+				trace.start,
+				trace.start + std::chrono::microseconds(1500),
+			});
+			trace.events.push_back(Trace::Event{
+				Trace::Kind::idle,
+				"",
+				1,
+				trace.start + std::chrono::milliseconds(1),
+				trace.start + std::chrono::milliseconds(3),
+			});
+			std::ostringstream out;
+			trace.write_chrome_trace(out);
+			std::string json = out.str();
+			ETC_ENFORCE_EQ(
+				json,
+				"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+				"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+				"\"args\":{\"name\":\"worker 0\"}},\n"
+				"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+				"\"args\":{\"name\":\"worker 1\"}},\n"
+				"{\"name\":\"a \\\"quoted\\\" name\",\"cat\":\"yield\",\"ph\":\"X\","
+				"\"pid\":1,\"tid\":0,\"ts\":0.000,\"dur\":1500.000},\n"
+				"{\"name\":\"idle\",\"cat\":\"idle\",\"ph\":\"X\","
+				"\"pid\":1,\"tid\":1,\"ts\":1000.000,\"dur\":2000.000}\n"
+				"]}\n"
+			);
+		}
+
+		ETC_TEST_CASE(record)
+		{
+			Scheduler r{2};
+			r.start_trace();
+			r.spawn("sleeper", [&] (Context&) {
+				r.sleep_for(std::chrono::milliseconds(1));
+			});
+			r.spawn("yielder", [&] (Context& ctx) {
+				for (int i = 0; i < 3; ++i)
+					ctx.yield();
+			});
+			r.run();
+			Trace trace = r.stop_trace();
+			ETC_ENFORCE_EQ(trace.dropped, 0u);
+			etc::size_type sleeper = 0, yielder = 0;
+			for (auto& event: trace.events)
+			{
+				ETC_ENFORCE_LTE(event.begin, event.end);
+				ETC_ENFORCE_LTE(trace.start, event.begin);
+				ETC_ENFORCE_LTE(event.end, trace.stop);
+				if (event.name == "sleeper")
+				{
+					ETC_ENFORCE(event.kind == (sleeper == 0 ? Trace::Kind::freeze
+					                                        : Trace::Kind::done));
+					sleeper += 1;
+				}
+				else if (event.name == "yielder")
+				{
+					ETC_ENFORCE(event.kind == (yielder < 3 ? Trace::Kind::yield
+					                                       : Trace::Kind::done));
+					yielder += 1;
+				}
+			}
+			ETC_ENFORCE_EQ(sleeper, 2u);
+			ETC_ENFORCE_EQ(yielder, 4u);
+
+			// Nothing is recorded once stopped.
+			r.spawn("untraced", [] (Context&) {});
+			r.run();
+			ETC_ENFORCE_EQ(r.stop_trace().events.size(), 0u);
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,63 @@
+#ifndef  ETC_SCHEDULER_TRACE_HPP
+# define ETC_SCHEDULER_TRACE_HPP
+
+# include <etc/types.hpp>
+
+# include <chrono>
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Context switches recorded by a scheduler.
+	 *
+	 * See Scheduler::start_trace() and Scheduler::stop_trace().
+	 */
+	class Trace
+	{
+	public:
+		typedef std::chrono::steady_clock clock_type;
+
+		enum class Kind
+		{
+			/// A context ran, until it yielded.
+			yield,
+			/// A context ran, until it waited for a wakeup.
+			freeze,
+			/// A context ran to completion.
+			done,
+			/// A worker was parked.
+			idle,
+		};
+
+		struct Event
+		{
+			Kind                   kind;
+			/// Context name, empty for idle workers.
+			std::string            name;
+			etc::size_type         worker;
+			clock_type::time_point begin;
+			clock_type::time_point end;
+		};
+
+	public:
+		clock_type::time_point start;
+		clock_type::time_point stop;
+		/// Sorted by begin time.
+		std::vector<Event>     events;
+		/// Events not recorded, past the limit of each worker.
+		etc::size_type         dropped;
+
+	public:
+		Trace();
+
+		/// Write the events in the Chrome trace event format (JSON), with a
+		/// thread per worker.
+		void write_chrome_trace(std::ostream& out) const;
+	};
+
+}}
+
+#endif
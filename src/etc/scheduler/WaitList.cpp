@@ -0,0 +1,102 @@
+#include "WaitList.hpp"
+#include "SchedulerImpl.hpp"
+
+#include <etc/test.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace etc { namespace scheduler {
+
+	WaitList::WaitList()
+		: _condition{}
+		, _contexts{}
+		, _threads{0}
+	{}
+
+	WaitList::~WaitList()
+	{}
+
+	void WaitList::wait(std::unique_lock<std::mutex>& lock)
+	{
+		Scheduler* sched = Scheduler::Impl::find_current_scheduler();
+		Context* ctx = sched != nullptr ? sched->current() : nullptr;
+		if (ctx == nullptr)
+		{
+			_threads += 1;
+			ETC_SCOPE_EXIT{ _threads -= 1; };
+			_condition.wait(lock);
+			return;
+		}
+		auto entry = std::make_pair(sched, ctx);
+		_contexts.push_back(entry);
+		sched->impl().freeze(*ctx);
+		lock.unlock();
+		ETC_SCOPE_EXIT{
+			lock.lock();
+			// Still there when the context was resumed by an exception.
+			auto it = std::find(_contexts.begin(), _contexts.end(), entry);
+			if (it != _contexts.end())
+				_contexts.erase(it);
+		};
+		ctx->yield();
+	}
+
+	void WaitList::notify_one()
+	{
+		if (!_contexts.empty())
+		{
+			auto entry = _contexts.front();
+			_contexts.erase(_contexts.begin());
+			entry.first->impl().wakeup(*entry.second);
+		}
+		else if (_threads > 0)
+			_condition.notify_one();
+	}
+
+	void WaitList::notify_all()
+	{
+		for (auto& entry: _contexts)
+			entry.first->impl().wakeup(*entry.second);
+		_contexts.clear();
+		if (_threads > 0)
+			_condition.notify_all();
+	}
+
+	namespace {
+
+		ETC_TEST_CASE(contexts_and_threads)
+		{
+			Scheduler r{2};
+			std::mutex mutex;
+			WaitList waiters;
+			int value = 0;
+			std::atomic<int> woken{0};
+			for (int i = 0; i < 10; ++i)
+				r.spawn("waiter", [&] (Context&) {
+					std::unique_lock<std::mutex> lock(mutex);
+					waiters.wait(lock, [&] { return value == 1; });
+					woken += 1;
+				});
+			r.spawn("notifier", [&] (Context& ctx) {
+				for (int i = 0; i < 10; ++i)
+					ctx.yield();
+				std::unique_lock<std::mutex> lock(mutex);
+				value = 1;
+				waiters.notify_all();
+			});
+			// Waits out of the scheduler, blocking.
+			std::thread thread{[&] {
+				std::unique_lock<std::mutex> lock(mutex);
+				waiters.wait(lock, [&] { return value == 1; });
+				woken += 1;
+			}};
+			r.run();
+			thread.join();
+			ETC_ENFORCE_EQ(woken.load(), 11);
+			ETC_ENFORCE(waiters.empty());
+		}
+
+	} // !anonymous
+
+}}
@@ -0,0 +1,55 @@
+#ifndef  ETC_SCHEDULER_WAITLIST_HPP
+# define ETC_SCHEDULER_WAITLIST_HPP
+
+# include "fwd.hpp"
+
+# include <etc/types.hpp>
+
+# include <condition_variable>
+# include <mutex>
+# include <utility>
+# include <vector>
+
+namespace etc { namespace scheduler {
+
+	/**
+	 * @brief Contexts and threads waiting for a condition.
+	 *
+	 * Works like a condition variable, except that a waiting context yields
+	 * to its scheduler instead of blocking the worker thread. The mutex
+	 * passed to wait() must protect the condition, and be held when
+	 * notifying.
+	 */
+	class WaitList
+	{
+	private:
+		std::condition_variable _condition;
+		std::vector<std::pair<Scheduler*, Context*>> _contexts;
+		etc::size_type _threads;
+
+	public:
+		WaitList();
+		~WaitList();
+
+	public:
+		/// Wait for a notification, @a lock is released meanwhile.
+		void wait(std::unique_lock<std::mutex>& lock);
+
+		/// Wait until @a ready returns true.
+		template<typename Predicate>
+		void wait(std::unique_lock<std::mutex>& lock, Predicate ready)
+		{
+			while (!ready())
+				this->wait(lock);
+		}
+
+		void notify_one();
+		void notify_all();
+
+		bool empty() const
+		{ return _contexts.empty() && _threads == 0; }
+	};
+
+}}
+
+#endif
@@ -0,0 +1,108 @@
+#include "parallel.hpp"
+
+#include <etc/log.hpp>
+#include <etc/test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace etc { namespace scheduler {
+
+	ETC_LOG_COMPONENT("etc.scheduler.parallel");
+
+	namespace {
+
+		ETC_TEST_CASE(for_each_index)
+		{
+			Scheduler r{4};
+			r.spawn("main", [&] (Context&) {
+				for (etc::size_type grain: {0, 1, 7, 1000})
+				{
+					std::vector<std::atomic<int>> seen(1000);
+					for (auto& count: seen)
+						count = 0;
+					parallel_for(0, 1000, [&] (int i) { seen[i] += 1; }, grain);
+					for (auto& count: seen)
+						ETC_ENFORCE_EQ(count.load(), 1);
+				}
+				// Empty range.
+				parallel_for(10, 10, [] (int) { ETC_ERROR("Called"); });
+			});
+			r.run();
+		}
+
+		ETC_TEST_CASE(nested)
+		{
+			Scheduler r{2};
+			std::atomic<int> sum{0};
+			r.spawn("main", [&] (Context&) {
+				parallel_for(0, 10, [&] (int) {
+					parallel_for(0, 10, [&] (int j) { sum += j; });
+				});
+			});
+			r.run();
+			ETC_ENFORCE_EQ(sum.load(), 450);
+		}
+
+		ETC_TEST_CASE(reduce)
+		{
+			Scheduler r{4};
+			uint64_t sum = 0;
+			std::string word;
+			r.spawn("main", [&] (Context&) {
+				sum = parallel_reduce(
+					uint64_t(1), uint64_t(100001), uint64_t(0),
+					[] (uint64_t i) { return i; },
+					[] (uint64_t a, uint64_t b) { return a + b; }
+				);
+				// Chunks are reduced in order.
+				word = parallel_reduce(
+					0, 26, std::string(),
+					[] (int i) { return std::string(1, char('a' + i)); },
+					[] (std::string const& a, std::string const& b) { return a + b; },
+					3
+				);
+			});
+			r.run();
+			ETC_ENFORCE_EQ(sum, 5000050000u);
+			ETC_ENFORCE_EQ(word, "abcdefghijklmnopqrstuvwxyz");
+		}
+
+		ETC_BENCHMARK_CASE(benchmark)
+		{
+			int const count = 1 << 20;
+			etc::size_type max_threads = std::max<etc::size_type>(
+				2, std::thread::hardware_concurrency()
+			);
+			for (etc::size_type threads = 1; threads <= max_threads; threads *= 2)
+			{
+				Scheduler r{threads};
+				uint64_t res = 0;
+				auto start = std::chrono::steady_clock::now();
+				r.spawn("main", [&] (Context&) {
+					res = parallel_reduce(
+						0, count, uint64_t(0),
+						[] (int i) {
+							uint64_t value = i;
+							for (int j = 0; j < 100; ++j)
+								value = value * 6364136223846793005u + 1;
+							return value;
+						},
+						[] (uint64_t a, uint64_t b) { return a ^ b; }
+					);
+				});
+				r.run();
+				auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - start
+				).count();
+				ETC_LOG.info("parallel_reduce with", threads, "threads:",
+				             count * 1000000.0 / std::max<int64_t>(us, 1),
+				             "items per second (", res, ")");
+			}
+		}
+
+	} // !anonymous
+
+}}
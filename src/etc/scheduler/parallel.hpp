@@ -0,0 +1,109 @@
+#ifndef  ETC_SCHEDULER_PARALLEL_HPP
+# define ETC_SCHEDULER_PARALLEL_HPP
+
+# include "Scheduler.hpp"
+# include "TaskGroup.hpp"
+
+# include <etc/scheduler.hpp>
+
+# include <algorithm>
+# include <vector>
+
+namespace etc { namespace scheduler {
+
+	namespace detail {
+
+		/// Chunks per worker when the grain size is not given, so that
+		/// uneven chunks still balance.
+		etc::size_type const chunks_per_worker = 8;
+
+		inline
+		etc::size_type grain_size(Scheduler& sched,
+		                          etc::size_type const count,
+		                          etc::size_type const grain)
+		{
+			if (grain != 0)
+				return grain;
+			etc::size_type chunks = sched.thread_count() * chunks_per_worker;
+			return std::max<etc::size_type>(1, (count + chunks - 1) / chunks);
+		}
+
+	} // !detail
+
+	/**
+	 * @brief Call @a fn for each index in [begin, end) on the workers of
+	 * the current scheduler.
+	 *
+	 * The range is split in chunks of @a grain indices, 0 picks a size from
+	 * the worker count. The calling context runs the last chunk itself.
+	 */
+	template<typename Index, typename Fn>
+	void parallel_for(Index const begin,
+	                  Index const end,
+	                  Fn&& fn,
+	                  etc::size_type grain = 0)
+	{
+		if (!(begin < end))
+			return;
+		Scheduler& sched = current();
+		etc::size_type count = static_cast<etc::size_type>(end - begin);
+		grain = detail::grain_size(sched, count, grain);
+		TaskGroup group{sched};
+		Index first = begin;
+		for (; static_cast<etc::size_type>(end - first) > grain; first += grain)
+		{
+			Index last = first + grain;
+			group.spawn("parallel_for", [first, last, &fn] {
+				for (Index i = first; i < last; ++i)
+					fn(i);
+			});
+		}
+		for (Index i = first; i < end; ++i)
+			fn(i);
+		group.wait();
+	}
+
+	/**
+	 * @brief Reduce the values @a map returns for each index in [begin,
+	 * end) with @a reduce.
+	 *
+	 * Chunks are reduced from @a identity in parallel, then together in
+	 * order: @a reduce needs to be associative, not commutative.
+	 */
+	template<typename Index, typename T, typename Map, typename Reduce>
+	T parallel_reduce(Index const begin,
+	                  Index const end,
+	                  T const& identity,
+	                  Map&& map,
+	                  Reduce&& reduce,
+	                  etc::size_type grain = 0)
+	{
+		if (!(begin < end))
+			return identity;
+		Scheduler& sched = current();
+		etc::size_type count = static_cast<etc::size_type>(end - begin);
+		grain = detail::grain_size(sched, count, grain);
+		std::vector<T> partials((count + grain - 1) / grain, identity);
+		parallel_for(
+			etc::size_type(0),
+			partials.size(),
+			[&] (etc::size_type const chunk) {
+				Index first = begin + static_cast<Index>(chunk * grain);
+				Index last = first + static_cast<Index>(
+					std::min(grain, count - chunk * grain)
+				);
+				T& res = partials[chunk];
+				for (Index i = first; i < last; ++i)
+					res = reduce(res, map(i));
+			},
+			1
+		);
+		T res = identity;
+		for (auto& partial: partials)
+			res = reduce(res, partial);
+		return res;
+	}
+
+}}
+
+#endif
@@ -53,6 +53,11 @@ namespace etc { namespace test {
 
 # define ETC_TEST_CASE(name) ETC_TEST_CASE_WITH(name, ::etc::test::Case)
 
+/**
+ * @brief   Declare a benchmark, skipped unless ETC_TEST_BENCHMARKS is set.
+ */
+# define ETC_BENCHMARK_CASE(name) ETC_TEST_CASE_WITH(name, ::etc::test::Benchmark)
+
 # define ETC_TEST_CASE_WITH(name, base) \
 	static class etc_test_case_ ## name \
 		: public base \
@@ -109,4 +109,14 @@ namespace etc { namespace test {
 	CaseSetup::~CaseSetup()
 	{}
 
+	///////////////////////////////////////////////////////////////////////////
+	// Benchmark class.
+
+	Benchmark::Benchmark(std::string const& file,
+	                     unsigned int line,
+	                     std::string const& name,
+	                     CaseSetupBase* setup)
+		: Case{file, line, name, setup}
+	{}
+
 }}
@@ -60,6 +60,21 @@ namespace etc { namespace test {
 		virtual ~CaseSetup();
 	};
 
+	/// Timed test cases, only ran when ETC_TEST_BENCHMARKS is set.
+	class ETC_API Benchmark
+		: public Case
+	{
+	public:
+		Benchmark(std::string const& file,
+		          unsigned int line,
+		          std::string const& name,
+		          CaseSetupBase* setup);
+	};
+
+	class ETC_API BenchmarkSetup
+		: public CaseSetupBase
+	{};
+
 }}
 
 #endif
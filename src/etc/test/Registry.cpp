@@ -8,6 +8,7 @@
 #include <etc/log.hpp>
 #include <etc/path.hpp>
 #include <etc/scope_exit.hpp>
+#include <etc/sys/environ.hpp>
 
 #include <vector>
 
@@ -39,12 +40,19 @@ namespace etc { namespace test {
 	{
 		size_t failure = 0;
 		size_t count = 0;
+		size_t skipped = 0;
+		bool const benchmarks = sys::environ::contains("ETC_TEST_BENCHMARKS");
 		ETC_TRACE("Launching tests");
 		backtrace::Backtrace bt_base;
 		for (auto ptr: _this->cases)
 		{
 			if (!path::match(pattern, ptr->name))
 				continue;
+			if (!benchmarks && dynamic_cast<Benchmark*>(ptr) != nullptr)
+			{
+				skipped++;
+				continue;
+			}
 			bool success = false;
 			std::string error;
 			try {
@@ -87,6 +95,9 @@ namespace etc { namespace test {
 			}
 			count++;
 		}
+		if (skipped > 0)
+			ETC_LOG.debug("Skipped", skipped,
+			              "benchmarks, set ETC_TEST_BENCHMARKS to run them");
 		if (failure == 0)
 			ETC_LOG("Ran successfully", count, "tests");
 		else
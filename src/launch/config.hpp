@@ -17,7 +17,9 @@
  *   - CUBE_ROOT: The root directory of cube frameworks (different versions).
  *   - CUBE_VERSION: Use a specific version.
  *   - CUBE_GAMES_ROOT: Where to store the games
- *   - CUBE_RELEASE_SERVER: Adresse used to fetch cube and games.
+ *   - CUBE_RELEASE_SERVER: Adresse used to fetch cube and games, updates
+ *     are only fetched when it is set.
+ *   - CUBE_OFFLINE: Never fetch updates.
  *
  *   See below for their default value.
  */
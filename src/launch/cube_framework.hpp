@@ -3,6 +3,9 @@
 
 # include "version.hpp"
 
+# include <wrappers/boost/filesystem.hpp>
+
+# include <cstdio>
 # include <string>
 
 struct cube_framework
@@ -12,8 +15,16 @@ struct cube_framework
 	cube_framework(std::string path)
 		: path{path}
 	{
-		// XXX find out version
+		// Frameworks are installed in "<cube root>/<version>/bin".
+		std::string dir = this->directory().filename().string();
+		int major, minor, patch;
+		if (std::sscanf(dir.c_str(), "%d.%d.%d", &major, &minor, &patch) == 3)
+			v = version(major, minor, patch);
 	}
+
+	/// Root directory of the framework.
+	boost::filesystem::path directory() const
+	{ return boost::filesystem::path(path).parent_path().parent_path(); }
 };
 
 #endif
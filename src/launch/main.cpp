@@ -51,6 +51,19 @@
  *      | YES                                                   |
  *      V                                                       |
  *  (LAUNCH selected cube version with the game) <--------------/
+ *
+ *  ## Fetching a cube version
+ *
+ *  Releases are described by manifests listing the content hashes of their
+ *  files and of their chunks (see etc::delta::Manifest). The release server
+ *  provides:
+ *    - /cube/latest: The latest version.
+ *    - /cube/<version>/manifest: The manifest of a version.
+ *    - /chunks/<digest>: The content of a chunk.
+ *
+ *  The new version is assembled next to the newest installed one, sharing
+ *  its unchanged files and chunks, so that only the changed chunks are
+ *  downloaded. Its manifest is saved in "<cube root>/<version>.manifest".
  */
 
 #include "version.hpp"
@@ -58,6 +71,12 @@
 #include "cube_framework.hpp"
 #include "config.hpp"
 
+#include <etc/delta/Manifest.hpp>
+#include <etc/delta/update.hpp>
+#include <etc/http/Client.hpp>
+#include <etc/http/Request.hpp>
+#include <etc/http/Response.hpp>
+#include <etc/scheduler.hpp>
 #include <etc/temp/File.hpp>
 #include <etc/sys/environ.hpp>
 #include <etc/path.hpp>
@@ -79,6 +98,7 @@ namespace algo = boost::algorithm;
 #include <iostream>
 #include <cstdlib>
 #include <fstream>
+#include <sstream>
 
 #ifndef _WIN32
 # include <sys/stat.h> // chmod
@@ -106,7 +126,7 @@ namespace {
 
 bool has_internet(config const&)
 {
-    return false;
+	return env::contains("CUBE_RELEASE_SERVER") && !env::contains("CUBE_OFFLINE");
 }
 
 
@@ -190,6 +210,9 @@ void inspect_dir(std::vector<cube_framework>& res, std::string const& directory)
 	for (; it != end; ++it)
 	{
 		ETC_TRACE.debug("Checking: ", it->path());
+		// Versions being fetched (see etc::delta::update()).
+		if (it->path().extension() == ".partial")
+			continue;
 		auto bin = it->path() / CUBE_BINARY;
 		if (fs::exists(bin))
 		{
@@ -278,8 +301,60 @@ void launch_game(std::vector<cube_framework> const& frameworks, cube_game const&
 	spawn_process(cmd, {g.path});
 }
 
-void with_internet(config const&)
+std::string fetch(etc::http::Client& client, std::string const& url)
+{
+	auto res = client.fire(etc::http::Request().url(url));
+	if (res.code() != etc::http::ResponseCode::ok)
+		throw std::runtime_error{"Couldn't fetch " + url};
+	return res.read();
+}
+
+// Install the latest cube version, unless a version is selected.
+void update_cube(config const& cfg)
 {
+	if (!cfg.cube_version().empty())
+		return;
+	etc::http::Client client{cfg.cube_release_server()};
+	std::string latest = algo::trim_copy(fetch(client, "/cube/latest"));
+	if (latest.empty() || latest.find_first_of("/\\") != std::string::npos)
+		throw std::runtime_error{"Invalid latest cube version '" + latest + "'"};
+	fs::path target = etc::path::absolute(cfg.cube_root(), latest);
+	if (fs::exists(target))
+	{
+		ETC_LOG.debug("Cube", latest, "is up-to-date");
+		return;
+	}
+
+	std::istringstream manifest_data{
+		fetch(client, "/cube/" + latest + "/manifest")
+	};
+	auto manifest = etc::delta::Manifest::load(manifest_data);
+
+	// Reuse the newest installed version.
+	etc::delta::Manifest previous;
+	std::string previous_directory;
+	auto frameworks = find_cube_frameworks(cfg);
+	if (!frameworks.empty())
+	{
+		previous_directory = frameworks[0].directory().string();
+		std::string path = previous_directory + ".manifest";
+		if (fs::exists(path))
+			previous = etc::delta::Manifest::load(path);
+		else
+			previous = etc::delta::Manifest::scan(previous_directory);
+	}
+
+	ETC_LOG.info("Fetching cube", latest, "from", cfg.cube_release_server());
+	etc::delta::update(
+		previous,
+		previous_directory,
+		manifest,
+		target.string(),
+		[&] (etc::delta::Manifest::Chunk const& chunk) {
+			return fetch(client, "/chunks/" + chunk.digest);
+		}
+	);
+	manifest.save(target.string() + ".manifest");
 }
 
 void without_internet(config const& cfg)
@@ -293,6 +368,16 @@ void without_internet(config const& cfg)
     launch_game(cube_frameworks, game);
 }
 
+void with_internet(config const& cfg)
+{
+	etc::scheduler::Scheduler sched;
+	sched.spawn("update cube", [&] (etc::scheduler::Context&) {
+		update_cube(cfg);
+	});
+	sched.run();
+	without_internet(cfg);
+}
+
 
 } // ! anonymous
 
@@ -114,6 +114,9 @@
 # ifndef GL_COMPRESSED_RG
 #  define GL_COMPRESSED_RG                  0x8226
 # endif
+# ifndef GL_TEXTURE_2D_ARRAY
+#  define GL_TEXTURE_2D_ARRAY               0x8C1A
+# endif
 # ifndef GL_INVALID_FRAMEBUFFER_OPERATION_EXT
 #  define GL_INVALID_FRAMEBUFFER_OPERATION_EXT 0x0506
 # endif